@@ -58,6 +58,7 @@ class ProfileType:
     UNQUANTIZED = 0
     QINT8 = 1
     QINT4 = 2
+    CALIBRATED = 3
 
 
 @dataclass(frozen=True)
@@ -126,6 +127,7 @@ class MagicType:
     PARAMETERS = 0xDEADBEEF  # 8 bytes
     TOKENIZER = 0xBADDCAFE  # 8 bytes
     TENSORS = 0xFACEFEED  # 8 bytes
+    INDEX = 0xF00DFACE  # 8 bytes; optional, precedes the end marker
     END = 0x0FFFFFFF  # 8 bytes
     ALIGNMENT = 32  # Default 32-byte alignment
     VERSION = 2  # ALT model file format
@@ -139,6 +141,7 @@ class MagicType:
             MagicType.PARAMETERS,
             MagicType.TENSORS,
             MagicType.TOKENIZER,
+            MagicType.INDEX,
         }
 
     @staticmethod
@@ -162,6 +165,10 @@ class MagicType:
     def is_tensors(marker: int) -> bool:
         return marker == MagicType.TENSORS
 
+    @staticmethod
+    def is_index(marker: int) -> bool:
+        return marker == MagicType.INDEX
+
     @staticmethod
     def is_end(marker: int) -> bool:
         """Check if the marker is the end marker."""
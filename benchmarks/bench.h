@@ -0,0 +1,186 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file benchmarks/bench.h
+ *
+ * @brief Minimal timing harness shared by the benchmark executables.
+ *
+ * Each measurement calibrates an iteration count until a run lasts at least
+ * the minimum time, then keeps the fastest of BENCH_TRIALS runs. Results are
+ * written as a single JSON document so they can be diffed between versions.
+ *
+ * Usage: bench_<name> [--quick] [--output <path>] [--input <path>]
+ */
+
+#ifndef ALT_BENCH_H
+#define ALT_BENCH_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_TRIALS 3 /**< Timed runs per measurement; the fastest is reported */
+#define BENCH_MIN_NS 100000000ull /**< Minimum duration of a timed run (100 ms) */
+#define BENCH_QUICK_MIN_NS 10000000ull /**< Minimum duration with --quick (10 ms) */
+
+/**
+ * @brief Function under measurement. One call is one operation.
+ */
+typedef void (*BenchFunction)(void* context);
+
+/**
+ * @struct Bench
+ * @brief Output stream and settings of a benchmark run.
+ */
+typedef struct Bench {
+    FILE* out; /**< Destination of the JSON document */
+    const char* input; /**< Optional input file, NULL if not given */
+    uint64_t min_ns; /**< Minimum duration of a timed run */
+    uint32_t count; /**< Number of results written so far */
+    bool quick; /**< Smaller sweeps and shorter runs */
+} Bench;
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+static inline uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief Parses the command line and opens the JSON document.
+ *
+ * @return true on success, false on invalid arguments or an unwritable output.
+ */
+static inline bool bench_init(Bench* bench, const char* name, int argc, char** argv) {
+    bench->out = stdout;
+    bench->input = NULL;
+    bench->min_ns = BENCH_MIN_NS;
+    bench->count = 0;
+    bench->quick = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--quick")) {
+            bench->quick = true;
+            bench->min_ns = BENCH_QUICK_MIN_NS;
+        } else if (0 == strcmp(argv[i], "--output") && i + 1 < argc) {
+            bench->out = fopen(argv[++i], "w");
+            if (!bench->out) {
+                fprintf(stderr, "%s: Failed to open '%s' for writing.\n", name, argv[i]);
+                return false;
+            }
+        } else if (0 == strcmp(argv[i], "--input") && i + 1 < argc) {
+            bench->input = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--output <path>] [--input <path>]\n", name);
+            return false;
+        }
+    }
+
+    fprintf(bench->out, "{\n  \"benchmark\": \"%s\",\n  \"results\": [", name);
+    return true;
+}
+
+/**
+ * @brief Measures a function and appends one JSON result.
+ *
+ * @param name Operation label (e.g. "tensor_matmul").
+ * @param type Data type label.
+ * @param shape Shape label (e.g. "256x256").
+ * @param bytes Bytes read and written by one operation, for GB/s.
+ * @param flops Floating point operations of one operation, 0 if not meaningful.
+ */
+static inline void bench_measure(
+    Bench* bench,
+    const char* name,
+    const char* type,
+    const char* shape,
+    BenchFunction function,
+    void* context,
+    double bytes,
+    double flops
+) {
+    function(context); // Warm caches, page in buffers, and initialize dispatch
+
+    // Double the iteration count until a run lasts long enough to time reliably
+    uint64_t iterations = 1;
+    uint64_t elapsed = 0;
+    for (;;) {
+        uint64_t start = bench_now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            function(context);
+        }
+        elapsed = bench_now() - start;
+        if (elapsed >= bench->min_ns || iterations >= (1ull << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    for (uint32_t trial = 1; trial < BENCH_TRIALS; ++trial) {
+        uint64_t start = bench_now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            function(context);
+        }
+        uint64_t run = bench_now() - start;
+        elapsed = run < elapsed ? run : elapsed;
+    }
+
+    const double ns = (double) elapsed / (double) iterations;
+    fprintf(
+        bench->out,
+        "%s\n    {\"name\": \"%s\", \"type\": \"%s\", \"shape\": \"%s\", \"iterations\": "
+        "%" PRIu64 ", \"ns_per_op\": %.3f, \"gb_per_s\": %.3f, \"gflop_per_s\": %.3f}",
+        bench->count ? "," : "",
+        name,
+        type,
+        shape,
+        iterations,
+        ns,
+        bytes / ns,
+        flops / ns
+    );
+    fflush(bench->out);
+    bench->count++;
+}
+
+/**
+ * @brief Appends one JSON result of untimed measurements, such as accuracy.
+ *
+ * @param name Measurement label (e.g. "quant_error").
+ * @param type Data type label.
+ * @param shape Shape or input label.
+ * @param fields Pre-formatted JSON members without braces (e.g. "\"mse\": 0.5").
+ */
+static inline void bench_record(
+    Bench* bench, const char* name, const char* type, const char* shape, const char* fields
+) {
+    fprintf(
+        bench->out,
+        "%s\n    {\"name\": \"%s\", \"type\": \"%s\", \"shape\": \"%s\", %s}",
+        bench->count ? "," : "",
+        name,
+        type,
+        shape,
+        fields
+    );
+    fflush(bench->out);
+    bench->count++;
+}
+
+/**
+ * @brief Closes the JSON document and the output stream.
+ */
+static inline void bench_finish(Bench* bench) {
+    fprintf(bench->out, "\n  ]\n}\n");
+    if (bench->out != stdout) {
+        fclose(bench->out);
+    }
+}
+
+#endif // ALT_BENCH_H
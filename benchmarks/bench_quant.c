@@ -0,0 +1,313 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file benchmarks/bench_quant.c
+ *
+ * @brief Accuracy and throughput of every quantized type on representative weights.
+ *
+ * Each float32 sample is converted to every type quantize_tensor supports, and
+ * to packed qint4 storage, and back. A "quant_error" result records the MSE,
+ * max abs error, cosine similarity, and bytes per weight, followed by the
+ * quantize and dequantize throughput.
+ *
+ * Samples are synthetic weight distributions (Gaussian, heavy-tailed Student-t,
+ * and Gaussian with outlier columns) and, with --input <model.alt>, the leading
+ * rows of every tensor in the file's Tensor Section.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface/logger.h"
+#include "interface/random.h"
+
+#include "kernels/quantize.h"
+#include "model/magic.h"
+#include "tensors.h"
+
+#include "bench.h"
+
+#define BENCH_QUANT_COLS 4096 /**< Row length of the synthetic samples */
+#define BENCH_QUANT_SIGMA 0.02f /**< Standard deviation of the synthetic weights */
+
+/**
+ * @struct BenchQuant
+ * @brief Operands shared by the measured conversions.
+ */
+typedef struct BenchQuant {
+    const Tensor* source; /**< Float32 sample */
+    const Tensor* encoded; /**< Sample converted to the target type */
+    const QuantizeQ4Packed* packed; /**< Sample in packed qint4 storage */
+    DataTypeId target; /**< Type under test */
+} BenchQuant;
+
+/**
+ * @struct BenchError
+ * @brief Error of a round trip against its float32 source.
+ */
+typedef struct BenchError {
+    double mse; /**< Mean squared error */
+    double max_abs; /**< Largest absolute error */
+    double cosine; /**< Cosine similarity of source and round trip */
+} BenchError;
+
+// ---------------------- Measured Operations ----------------------
+
+static void bench_quantize(void* context) {
+    BenchQuant* bench = (BenchQuant*) context;
+    tensor_free(quantize_tensor(bench->source, bench->target, NULL));
+}
+
+static void bench_dequantize(void* context) {
+    BenchQuant* bench = (BenchQuant*) context;
+    tensor_free(quantize_tensor(bench->encoded, TYPE_FLOAT32, NULL));
+}
+
+static void bench_pack(void* context) {
+    BenchQuant* bench = (BenchQuant*) context;
+    quantize_q4_packed_free(quantize_tensor_q4_packed(bench->source, Q4_PACKED_GROUP, NULL));
+}
+
+static void bench_unpack(void* context) {
+    BenchQuant* bench = (BenchQuant*) context;
+    tensor_free(dequantize_tensor_q4_packed(bench->packed, NULL));
+}
+
+// ---------------------- Samples ----------------------
+
+// Fills a [rows, BENCH_QUANT_COLS] sample from the named distribution
+static void bench_distribution(Tensor* tensor, const char* name) {
+    float* data = (float*) tensor->data;
+    random_seed(4242);
+    for (uint64_t i = 0; i < tensor->size; ++i) {
+        double x = (double) random_gaussian(0.0f, 1.0f);
+        if (0 == strcmp(name, "student_t3")) {
+            // Three degrees of freedom: finite variance, heavy tails
+            const double a = (double) random_gaussian(0.0f, 1.0f);
+            const double b = (double) random_gaussian(0.0f, 1.0f);
+            const double c = (double) random_gaussian(0.0f, 1.0f);
+            x /= sqrt((a * a + b * b + c * c) / 3.0);
+        } else if (0 == strcmp(name, "outlier_columns") && 0 == i % BENCH_QUANT_COLS % 97) {
+            x *= 30.0; // A few input channels dominate, as in trained linear layers
+        }
+        data[i] = (float) x * BENCH_QUANT_SIGMA;
+    }
+}
+
+// ---------------------- Accuracy ----------------------
+
+static BenchError bench_error(const float* x, const float* y, uint64_t length) {
+    double squared = 0.0, dot = 0.0, xx = 0.0, yy = 0.0;
+    BenchError error = {0};
+    for (uint64_t i = 0; i < length; ++i) {
+        const double d = (double) x[i] - (double) y[i];
+        squared += d * d;
+        dot += (double) x[i] * (double) y[i];
+        xx += (double) x[i] * (double) x[i];
+        yy += (double) y[i] * (double) y[i];
+        error.max_abs = fabs(d) > error.max_abs ? fabs(d) : error.max_abs;
+    }
+    error.mse = squared / (double) length;
+    error.cosine = xx > 0.0 && yy > 0.0 ? dot / sqrt(xx * yy) : (xx == yy ? 1.0 : 0.0);
+    return error;
+}
+
+// Records the accuracy and size of one round trip
+static void bench_record_error(
+    Bench* bench,
+    const char* type,
+    const char* label,
+    const Tensor* source,
+    const Tensor* decoded,
+    uint64_t out
+) {
+    const BenchError error
+        = bench_error((const float*) source->data, (const float*) decoded->data, source->size);
+
+    char fields[256];
+    snprintf(
+        fields,
+        sizeof(fields),
+        "\"values\": %" PRIu64 ", \"bytes_per_weight\": %.4f, \"mse\": %.6e, "
+        "\"max_abs_error\": %.6e, \"cosine\": %.8f",
+        (uint64_t) source->size,
+        (double) out / (double) source->size,
+        error.mse,
+        error.max_abs,
+        error.cosine
+    );
+    bench_record(bench, "quant_error", type, label, fields);
+}
+
+// Measures packed qint4 storage, whose codes and scales live in separate arrays
+static void bench_sample_packed(Bench* bench, const char* label, const Tensor* source) {
+    QuantizeQ4Packed* packed = quantize_tensor_q4_packed(source, Q4_PACKED_GROUP, NULL);
+    Tensor* decoded = packed ? dequantize_tensor_q4_packed(packed, NULL) : NULL;
+    if (!decoded) {
+        LOG_ERROR("%s: Failed to pack %s.\n", __func__, label);
+        quantize_q4_packed_free(packed);
+        return;
+    }
+
+    const uint64_t in = tensor_byte_size(source);
+    const uint64_t out
+        = quantize_q4_packed_nibble_bytes(packed) + quantize_q4_packed_scale_bytes(packed);
+    bench_record_error(bench, "qint4_packed", label, source, decoded, out);
+
+    BenchQuant ctx = {.source = source, .packed = packed};
+    const double bytes = (double) (in + out);
+    bench_measure(bench, "quantize_tensor", "qint4_packed", label, bench_pack, &ctx, bytes, 0);
+    bench_measure(bench, "dequantize_tensor", "qint4_packed", label, bench_unpack, &ctx, bytes, 0);
+
+    tensor_free(decoded);
+    quantize_q4_packed_free(packed);
+}
+
+// Measures every supported type on one float32 sample
+static void bench_sample(Bench* bench, const char* label, const Tensor* source) {
+    const uint32_t cols = tensor_shape_data(source)[source->rank - 1];
+
+    for (uint32_t id = 0; id < TYPE_COUNT; ++id) {
+        const DataTypeId target = (DataTypeId) id;
+        if (!quantize_is_supported(target) || 0 != cols % data_type_values(target)) {
+            continue; // Not a numeric type, or the rows do not fill whole elements
+        }
+
+        Tensor* encoded = quantize_tensor(source, target, NULL);
+        Tensor* decoded = encoded ? quantize_tensor(encoded, TYPE_FLOAT32, NULL) : NULL;
+        if (!decoded) {
+            LOG_ERROR("%s: Failed to convert %s to %s.\n", __func__, label, data_type_name(target));
+            tensor_free(encoded);
+            continue;
+        }
+
+        const uint64_t in = tensor_byte_size(source);
+        const uint64_t out = tensor_byte_size(encoded);
+        bench_record_error(bench, data_type_name(target), label, source, decoded, out);
+
+        BenchQuant ctx = {.source = source, .encoded = encoded, .target = target};
+        const double bytes = (double) (in + out);
+        bench_measure(
+            bench, "quantize_tensor", data_type_name(target), label, bench_quantize, &ctx, bytes, 0
+        );
+        bench_measure(
+            bench,
+            "dequantize_tensor",
+            data_type_name(target),
+            label,
+            bench_dequantize,
+            &ctx,
+            bytes,
+            0
+        );
+
+        tensor_free(decoded);
+        tensor_free(encoded);
+    }
+
+    if (0 == cols % 2) {
+        bench_sample_packed(bench, label, source);
+    }
+}
+
+// ---------------------- Suites ----------------------
+
+static void bench_suite_synthetic(Bench* bench, uint32_t rows) {
+    const char* distributions[] = {"gaussian", "student_t3", "outlier_columns"};
+
+    Tensor* source = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){rows, BENCH_QUANT_COLS});
+    if (!source) {
+        LOG_ERROR("%s: Failed to allocate the sample.\n", __func__);
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(distributions) / sizeof(distributions[0]); ++i) {
+        char label[64];
+        snprintf(label, sizeof(label), "%s/%ux%u", distributions[i], rows, BENCH_QUANT_COLS);
+        bench_distribution(source, distributions[i]);
+        bench_sample(bench, label, source);
+    }
+
+    tensor_free(source);
+}
+
+// Converts up to limit values of whole rows of a mapped tensor to a float32 [rows, cols] sample
+static Tensor* bench_read_tensor(MagicFile* magic, const MagicTensorInfo* info, uint64_t limit) {
+    const DataTypeId type = (DataTypeId) info->data_type;
+    const uint32_t cols = (uint32_t) info->shape[info->n_dims - 1];
+    const uint64_t values = (uint64_t) cols * data_type_values(type);
+    const uint64_t available = (uint64_t) info->size / ((uint64_t) cols * data_type_size(type));
+    const uint64_t wanted = limit / values > 0 ? limit / values : 1;
+    const uint32_t rows = (uint32_t) (wanted < available ? wanted : available);
+
+    // The sample only reads the stored rows, so they are used in place
+    void* data = (void*) magic_file_tensor_data(magic, info);
+    Tensor* stored = data ? tensor_create_from_data(type, 2, (uint32_t[]){rows, cols}, data) : NULL;
+    if (!stored || TYPE_FLOAT32 == type) {
+        return stored;
+    }
+    Tensor* source = quantize_tensor(stored, TYPE_FLOAT32, NULL);
+    tensor_free(stored);
+    return source;
+}
+
+// Measures the leading rows of every tensor of a model file
+static void bench_suite_model(Bench* bench, const char* path, uint64_t limit) {
+    MagicFile* magic = magic_file_map(path);
+    if (!magic) {
+        return;
+    }
+
+    int32_t version, alignment;
+    int64_t size;
+    MagicTensorSection section;
+    if (MAGIC_SUCCESS != magic_file_read_start_marker(magic, &version, &alignment)
+        || MAGIC_SUCCESS != magic_file_seek_section(magic, MAGIC_TENSORS, &size)
+        || MAGIC_SUCCESS != magic_file_read_tensor_section(magic, &section)) {
+        LOG_ERROR("%s: '%s' has no readable Tensor Section.\n", __func__, path);
+        magic_file_close(magic);
+        return;
+    }
+
+    for (int64_t i = 0; i < section.tensor_count; ++i) {
+        MagicTensorInfo info;
+        if (MAGIC_SUCCESS != magic_file_read_tensor_info(magic, &info)) {
+            break;
+        }
+
+        if (quantize_is_supported((DataTypeId) info.data_type)) {
+            Tensor* source = bench_read_tensor(magic, &info, limit);
+            if (source) {
+                bench_sample(bench, info.name, source);
+                tensor_free(source);
+            }
+        }
+
+        const bool next = 0 == fseek(magic->data, info.offset + info.size, SEEK_SET);
+        magic_tensor_info_free(&info);
+        if (!next) {
+            break;
+        }
+    }
+
+    magic_file_close(magic);
+}
+
+int main(int argc, char** argv) {
+    global_logger.log_level = LOG_LEVEL_WARN; // Each conversion logs its throughput at info level
+
+    Bench bench;
+    if (!bench_init(&bench, "bench_quant", argc, argv)) {
+        return 1;
+    }
+
+    bench_suite_synthetic(&bench, bench.quick ? 16 : 1024);
+    if (bench.input) {
+        bench_suite_model(&bench, bench.input, bench.quick ? 1u << 16 : 1u << 22);
+    }
+
+    bench_finish(&bench);
+    return 0;
+}
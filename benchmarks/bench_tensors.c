@@ -0,0 +1,388 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file benchmarks/bench_tensors.c
+ *
+ * @brief Throughput of tensor management and the compute kernels.
+ *
+ * Sweeps shapes and data types over creation, element access, bulk copies,
+ * elementwise ops, reductions, matmul, and gemv, and prints ns/op, GB/s, and
+ * GFLOP/s as JSON. Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface/logger.h"
+#include "interface/random.h"
+
+#include "kernels/elementwise.h"
+#include "kernels/matmul.h"
+#include "kernels/reduce.h"
+#include "tensors.h"
+
+#include "bench.h"
+
+/**
+ * @struct BenchTensor
+ * @brief Operands shared by the measured functions.
+ */
+typedef struct BenchTensor {
+    DataTypeId type; /**< Data type under test */
+    uint32_t dims[2]; /**< Shape of the primary operand */
+    Tensor* a; /**< Primary operand */
+    Tensor* b; /**< Secondary operand (weights, addend, or view) */
+    Tensor* c; /**< Output */
+    void* buffer; /**< Host buffer for bulk copies */
+    FlexArray* indices; /**< Reused index array for checked access */
+    volatile float sink; /**< Keeps reads from being optimized away */
+} BenchTensor;
+
+// Fills a float32 tensor with deterministic values in [-1, 1]
+static void bench_fill(Tensor* tensor) {
+    float* data = (float*) tensor->data;
+    random_seed(1337);
+    for (uint64_t i = 0; i < tensor->size; ++i) {
+        data[i] = random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// Releases every operand and resets the context
+static void bench_release(BenchTensor* bench) {
+    tensor_free(bench->a);
+    tensor_free(bench->b);
+    tensor_free(bench->c);
+    free(bench->buffer);
+    flex_array_free(bench->indices);
+    bench->a = bench->b = bench->c = NULL;
+    bench->buffer = NULL;
+    bench->indices = NULL;
+}
+
+// ---------------------- Measured Operations ----------------------
+
+static void bench_create_free(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_free(tensor_create(bench->type, 2, bench->dims));
+}
+
+static void bench_create_uninitialized_free(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_free(tensor_create_uninitialized(bench->type, 2, bench->dims));
+}
+
+static void bench_get_element(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    uint32_t* index = (uint32_t*) bench->indices->data;
+    char value[16];
+    for (index[0] = 0; index[0] < bench->dims[0]; ++index[0]) {
+        for (index[1] = 0; index[1] < bench->dims[1]; ++index[1]) {
+            tensor_get_element(bench->a, bench->indices, value);
+        }
+    }
+    bench->sink = (float) value[0];
+}
+
+static void bench_get_f32_2d(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    const float* data = (const float*) bench->a->data;
+    const uint64_t* stride = tensor_stride_data(bench->a);
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < bench->dims[0]; ++i) {
+        for (uint32_t j = 0; j < bench->dims[1]; ++j) {
+            sum += tensor_get_f32_2d(data, stride, i, j);
+        }
+    }
+    bench->sink = sum;
+}
+
+static void bench_set_bulk(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_set_bulk(bench->a, bench->buffer);
+}
+
+static void bench_set_bulk_strided(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_set_bulk(bench->b, bench->buffer);
+}
+
+static void bench_add(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_add(bench->a, bench->b, bench->c);
+}
+
+static void bench_reduce_rows(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_reduce(bench->a, 1, REDUCE_SUM, bench->c);
+}
+
+static void bench_reduce_cols(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_reduce(bench->a, 0, REDUCE_SUM, bench->b);
+}
+
+static void bench_matmul(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_matmul(bench->a, bench->b, bench->c);
+}
+
+static void bench_gemv(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    tensor_gemv(bench->b, bench->a, bench->c);
+}
+
+// Row conversions use dims[1] as the stride of the float side
+static void bench_encode_fp16(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    quantize_row_fp16(bench->a->data, bench->b->data, bench->a->size, bench->dims[1]);
+}
+
+static void bench_decode_fp16(void* context) {
+    BenchTensor* bench = (BenchTensor*) context;
+    dequantize_row_fp16(bench->b->data, bench->a->data, bench->a->size, bench->dims[1]);
+}
+
+// ---------------------- Suites ----------------------
+
+// Creation, element access, and bulk copies for every storage type
+static void bench_suite_storage(Bench* bench, const uint32_t* sizes, uint32_t count) {
+    const DataTypeId types[] = {TYPE_FLOAT32, TYPE_FLOAT16, TYPE_QUANT8};
+
+    for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+        for (uint32_t s = 0; s < count; ++s) {
+            BenchTensor ctx = {.type = types[t], .dims = {sizes[s], sizes[s]}};
+            const char* type = data_type_name(ctx.type);
+            const double elements = (double) sizes[s] * sizes[s];
+            const double bytes = elements * data_type_size(ctx.type);
+            char shape[32];
+            snprintf(shape, sizeof(shape), "%ux%u", sizes[s], sizes[s]);
+
+            ctx.a = tensor_create(ctx.type, 2, ctx.dims);
+            ctx.b = tensor_view_transpose(ctx.a, 0, 1);
+            ctx.buffer = calloc((size_t) elements, data_type_size(ctx.type));
+            ctx.indices = tensor_create_indices(2, (uint32_t[]){0, 0});
+            if (!ctx.a || !ctx.b || !ctx.buffer || !ctx.indices) {
+                LOG_ERROR("%s: Failed to allocate %s %s operands.\n", __func__, type, shape);
+                bench_release(&ctx);
+                continue;
+            }
+
+            bench_measure(bench, "tensor_create", type, shape, bench_create_free, &ctx, bytes, 0);
+            bench_measure(
+                bench,
+                "tensor_create_uninitialized",
+                type,
+                shape,
+                bench_create_uninitialized_free,
+                &ctx,
+                0,
+                0
+            );
+            bench_measure(
+                bench, "tensor_get_element", type, shape, bench_get_element, &ctx, bytes, 0
+            );
+            if (TYPE_FLOAT32 == ctx.type) {
+                bench_measure(
+                    bench, "tensor_get_f32_2d", type, shape, bench_get_f32_2d, &ctx, bytes, 0
+                );
+            }
+            bench_measure(
+                bench, "tensor_set_bulk", type, shape, bench_set_bulk, &ctx, 2 * bytes, 0
+            );
+            bench_measure(
+                bench,
+                "tensor_set_bulk_strided",
+                type,
+                shape,
+                bench_set_bulk_strided,
+                &ctx,
+                2 * bytes,
+                0
+            );
+            bench_release(&ctx);
+        }
+    }
+}
+
+// Elementwise ops and reductions over float32 matrices
+static void bench_suite_vector(Bench* bench, const uint32_t* sizes, uint32_t count) {
+    for (uint32_t s = 0; s < count; ++s) {
+        const uint32_t n = sizes[s];
+        const double elements = (double) n * n;
+        BenchTensor ctx = {.type = TYPE_FLOAT32, .dims = {n, n}};
+        char shape[32];
+        snprintf(shape, sizeof(shape), "%ux%u", n, n);
+
+        ctx.a = tensor_create(TYPE_FLOAT32, 2, ctx.dims);
+        ctx.b = tensor_create(TYPE_FLOAT32, 2, ctx.dims);
+        ctx.c = tensor_create(TYPE_FLOAT32, 2, ctx.dims);
+        if (!ctx.a || !ctx.b || !ctx.c) {
+            LOG_ERROR("%s: Failed to allocate %s operands.\n", __func__, shape);
+            bench_release(&ctx);
+            continue;
+        }
+        bench_fill(ctx.a);
+        bench_fill(ctx.b);
+
+        const double bytes = elements * sizeof(float);
+        bench_measure(bench, "tensor_add", "float32", shape, bench_add, &ctx, 3 * bytes, elements);
+        bench_release(&ctx);
+
+        // Row sums write one value per row, column sums one per column
+        ctx.a = tensor_create(TYPE_FLOAT32, 2, ctx.dims);
+        ctx.b = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+        ctx.c = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+        if (!ctx.a || !ctx.b || !ctx.c) {
+            LOG_ERROR("%s: Failed to allocate %s reduction operands.\n", __func__, shape);
+            bench_release(&ctx);
+            continue;
+        }
+        bench_fill(ctx.a);
+
+        bench_measure(
+            bench, "tensor_reduce_axis1", "float32", shape, bench_reduce_rows, &ctx, bytes, elements
+        );
+        bench_measure(
+            bench, "tensor_reduce_axis0", "float32", shape, bench_reduce_cols, &ctx, bytes, elements
+        );
+        bench_release(&ctx);
+    }
+}
+
+// Contiguous and strided fp16 row conversions
+static void bench_suite_convert(Bench* bench, uint32_t length) {
+    for (uint32_t step = 1; step <= 2; ++step) {
+        BenchTensor ctx = {.type = TYPE_FLOAT16, .dims = {length, step}};
+        char shape[32];
+        snprintf(shape, sizeof(shape), "%u/step%u", length, step);
+
+        ctx.a = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){length * step});
+        ctx.b = tensor_create(TYPE_FLOAT16, 1, (uint32_t[]){length});
+        if (!ctx.a || !ctx.b) {
+            LOG_ERROR("%s: Failed to allocate %s operands.\n", __func__, shape);
+            bench_release(&ctx);
+            continue;
+        }
+        bench_fill(ctx.a);
+
+        const double bytes = (double) length * (sizeof(float) + sizeof(uint16_t));
+        bench_measure(
+            bench, "quantize_row_fp16", "float16", shape, bench_encode_fp16, &ctx, bytes, 0
+        );
+        bench_measure(
+            bench, "dequantize_row_fp16", "float16", shape, bench_decode_fp16, &ctx, bytes, 0
+        );
+        bench_release(&ctx);
+    }
+}
+
+// Creates a [rows, cols] weight tensor; packed types hold several columns per element
+static Tensor* bench_weight(DataTypeId type, uint32_t rows, uint32_t cols, bool repack) {
+    const uint32_t values = data_type_values(type);
+    Tensor* weight = tensor_create(type, 2, (uint32_t[]){rows, cols / values});
+    if (weight && TYPE_FLOAT32 == type) {
+        bench_fill(weight);
+    }
+    if (weight && repack) {
+        Tensor* panels = tensor_repack(weight, TENSOR_TILE_PANEL, MATMUL_NR / values);
+        tensor_free(weight);
+        weight = panels;
+    }
+    return weight;
+}
+
+// Matmul and gemv for every weight type, with and without load-time repacking
+static void bench_suite_linear(Bench* bench, const uint32_t* sizes, uint32_t count, uint32_t rows) {
+    const DataTypeId types[] = {
+        TYPE_FLOAT32,
+        TYPE_FLOAT16,
+        TYPE_QUANT8,
+        TYPE_QUANT4,
+        TYPE_BLOCK_Q8,
+        TYPE_BLOCK_Q4,
+        TYPE_BLOCK_Q4_MIN,
+        TYPE_BFLOAT16,
+        TYPE_FP8_E4M3,
+        TYPE_FP8_E5M2,
+    };
+
+    for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+        const DataTypeId id = types[t];
+        const double weight_size = (double) data_type_size(id) / data_type_values(id);
+        const uint32_t layouts = data_type_values(id) <= MATMUL_NR ? 2 : 1; // Blocks span panels
+
+        for (uint32_t s = 0; s < count; ++s) {
+            const uint32_t n = sizes[s];
+            char shape[32];
+            snprintf(shape, sizeof(shape), "%ux%ux%u", rows, n, n);
+
+            for (uint32_t repack = 0; repack < layouts; ++repack) {
+                BenchTensor ctx = {.type = id};
+                ctx.a = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){rows, n});
+                ctx.b = bench_weight(id, n, n, repack);
+                ctx.c = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){rows, n});
+                if (!ctx.a || !ctx.b || !ctx.c) {
+                    LOG_ERROR("%s: Failed to allocate %s matmul operands.\n", __func__, shape);
+                    bench_release(&ctx);
+                    continue;
+                }
+                bench_fill(ctx.a);
+
+                const double bytes = (double) n * n * weight_size + 2.0 * rows * n * sizeof(float);
+                bench_measure(
+                    bench,
+                    repack ? "tensor_matmul_repacked" : "tensor_matmul",
+                    data_type_name(id),
+                    shape,
+                    bench_matmul,
+                    &ctx,
+                    bytes,
+                    2.0 * rows * n * n
+                );
+                bench_release(&ctx);
+            }
+
+            // gemv streams the weights once per call, so it is bandwidth bound
+            BenchTensor ctx = {.type = id};
+            ctx.a = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+            ctx.b = bench_weight(id, n, n, false);
+            ctx.c = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+            if (!ctx.a || !ctx.b || !ctx.c) {
+                LOG_ERROR("%s: Failed to allocate %ux%u gemv operands.\n", __func__, n, n);
+                bench_release(&ctx);
+                continue;
+            }
+            bench_fill(ctx.a);
+
+            snprintf(shape, sizeof(shape), "%ux%u", n, n);
+            const double bytes = (double) n * n * weight_size + 2.0 * n * sizeof(float);
+            const double flops = 2.0 * n * n;
+            bench_measure(
+                bench, "tensor_gemv", data_type_name(id), shape, bench_gemv, &ctx, bytes, flops
+            );
+            bench_release(&ctx);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    global_logger.log_level = LOG_LEVEL_WARN; // Debug logging would dominate the timings
+
+    Bench bench;
+    if (!bench_init(&bench, "bench_tensors", argc, argv)) {
+        return 1;
+    }
+
+    const uint32_t storage[] = {64, 512, 2048};
+    const uint32_t linear[] = {256, 1024, 4096};
+    const uint32_t quick[] = {64, 256};
+    const uint32_t count = bench.quick ? 2 : 3;
+
+    bench_suite_storage(&bench, bench.quick ? quick : storage, count);
+    bench_suite_vector(&bench, bench.quick ? quick : storage, count);
+    bench_suite_convert(&bench, bench.quick ? 1u << 16 : 1u << 22);
+    bench_suite_linear(&bench, bench.quick ? quick : linear, count, bench.quick ? 16 : 64);
+
+    bench_finish(&bench);
+    return 0;
+}
@@ -736,10 +736,9 @@ void mlp_train(MLP* model, MNISTDataset* dataset) {
 
 // General section
 
-MagicState save_general_section(MagicFile* magic_file, const char* model_name, const char* author) {
+MagicState save_general_section(MagicWriter* writer, const char* model_name, const char* author) {
     // General configuration
     const int32_t data_type = TYPE_FLOAT32;
-    const int32_t data_type_size = sizeof(data_type);
 
     // General model name
     const int32_t model_name_len = strlen(model_name) + 1;
@@ -758,47 +757,43 @@ MagicState save_general_section(MagicFile* magic_file, const char* model_name, c
     }
     uuid_unparse_lower(binuuid, uuid);
 
-    // Calculate General Section size
-    uint64_t general_size = data_type_size + sizeof(model_name_len) + model_name_len
-                            + sizeof(author_len) + author_len + sizeof(uuid_len) + uuid_len;
-
-    // Write section marker
-    if (magic_file_write_section_marker(magic_file, MAGIC_GENERAL, general_size) != MAGIC_SUCCESS) {
+    // Write section marker; the size is patched in when the section ends
+    if (magic_writer_begin_section(writer, MAGIC_GENERAL) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write general section marker.\n", __func__);
         free(uuid);
         return MAGIC_ERROR;
     }
 
     // Write the data type
-    if (fwrite(&data_type, data_type_size, 1, magic_file->data) != 1) {
+    if (magic_writer_write(writer, &data_type, sizeof(data_type)) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write data type.\n", __func__);
         free(uuid);
         return MAGIC_ERROR;
     }
     // Write the model name and length
-    if (fwrite(&model_name_len, sizeof(int32_t), 1, magic_file->data) != 1
-        || fwrite(model_name, model_name_len, 1, magic_file->data) != 1) {
+    if (magic_writer_write(writer, &model_name_len, sizeof(int32_t)) != MAGIC_SUCCESS
+        || magic_writer_write(writer, model_name, model_name_len) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write model name.\n", __func__);
         free(uuid);
         return MAGIC_ERROR;
     }
     // Write the author name and length
-    if (fwrite(&author_len, sizeof(int32_t), 1, magic_file->data) != 1
-        || fwrite(author, author_len, 1, magic_file->data) != 1) {
+    if (magic_writer_write(writer, &author_len, sizeof(int32_t)) != MAGIC_SUCCESS
+        || magic_writer_write(writer, author, author_len) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write author name.\n", __func__);
         free(uuid);
         return MAGIC_ERROR;
     }
     // Write the UUID and length
-    if (fwrite(&uuid_len, sizeof(int32_t), 1, magic_file->data) != 1
-        || fwrite(uuid, uuid_len, 1, magic_file->data) != 1) {
+    if (magic_writer_write(writer, &uuid_len, sizeof(int32_t)) != MAGIC_SUCCESS
+        || magic_writer_write(writer, uuid, uuid_len) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write UUID.\n", __func__);
         free(uuid);
         return MAGIC_ERROR;
     }
     free(uuid); // Cleanup
 
-    return MAGIC_SUCCESS;
+    return magic_writer_end_section(writer);
 }
 
 MagicState load_general_section(MagicFile* magic_file, char** model_name, char** author, char** uuid) {
@@ -887,33 +882,26 @@ MagicState load_general_section(MagicFile* magic_file, char** model_name, char**
 
 /// @todo Input, Output, and Hidden sizes are also hyperparameters.
 
-MagicState save_parameters_section(MagicFile* magic_file, Parameters* params) {
-    // Calculate the size of the Parameters Section
-    int64_t param_size = sizeof(params->error_threshold) +
-                         sizeof(params->learning_rate) +
-                         sizeof(params->n_epochs) +
-                         sizeof(params->n_layers) +
-                         (sizeof(uint32_t) * params->n_layers); // Layer sizes array
-
-    // Write section marker
-    if (magic_file_write_section_marker(magic_file, MAGIC_PARAMETERS, param_size) != MAGIC_SUCCESS) {
+MagicState save_parameters_section(MagicWriter* writer, Parameters* params) {
+    // Write section marker; the size is patched in when the section ends
+    if (magic_writer_begin_section(writer, MAGIC_PARAMETERS) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write parameters section marker.\n", __func__);
         return MAGIC_ERROR;
     }
 
     // Write number of layers
-    if (fwrite(&params->n_layers, sizeof(uint32_t), 1, magic_file->data) != 1) {
+    if (magic_writer_write(writer, &params->n_layers, sizeof(uint32_t)) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write number of layers.\n", __func__);
         return MAGIC_ERROR;
     }
 
     // Write layer sizes array
-    if (fwrite(params->layer_sizes, sizeof(uint32_t), params->n_layers, magic_file->data) != params->n_layers) {
+    if (magic_writer_write(writer, params->layer_sizes, sizeof(uint32_t) * params->n_layers) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write layer sizes array.\n", __func__);
         return MAGIC_ERROR;
     }
 
-    return MAGIC_SUCCESS;
+    return magic_writer_end_section(writer);
 }
 
 MagicState load_parameters_section(MagicFile* magic_file, Parameters* params) {
@@ -956,23 +944,14 @@ MagicState load_parameters_section(MagicFile* magic_file, Parameters* params) {
     return MAGIC_SUCCESS;
 }
 
-MagicState save_tensors_section(MagicFile* magic_file, MLP* model) {
+MagicState save_tensors_section(MagicWriter* writer, MLP* model) {
     if (model->params->n_layers < 2) {
         LOG_ERROR("Invalid number of layers: %u\n", model->params->n_layers);
         return MAGIC_ERROR;
     }
 
-    // Calculate the size of the Tensors Section
-    uint64_t tensors_size = 0;
-    for (uint32_t i = 0; i < model->params->n_layers - 1; i++) {
-        Layer* layer = &model->layers[i];
-        tensors_size += sizeof(uint32_t) * 2; // input_size, output_size
-        tensors_size += sizeof(float) * (layer->input_size * layer->output_size); // weights
-        tensors_size += sizeof(float) * layer->output_size; // biases
-    }
-
-    // Write section marker
-    if (magic_file_write_section_marker(magic_file, MAGIC_TENSORS, tensors_size) != MAGIC_SUCCESS) {
+    // Write section marker; the size is patched in when the section ends
+    if (magic_writer_begin_section(writer, MAGIC_TENSORS) != MAGIC_SUCCESS) {
         LOG_ERROR("%s: Failed to write tensors section marker.\n", __func__);
         return MAGIC_ERROR;
     }
@@ -986,25 +965,25 @@ MagicState save_tensors_section(MagicFile* magic_file, MLP* model) {
             return MAGIC_ERROR;
         }
         // Write input and output sizes
-        if (fwrite(&layer->input_size, sizeof(uint32_t), 1, magic_file->data) != 1 ||
-            fwrite(&layer->output_size, sizeof(uint32_t), 1, magic_file->data) != 1) {
+        if (magic_writer_write(writer, &layer->input_size, sizeof(uint32_t)) != MAGIC_SUCCESS ||
+            magic_writer_write(writer, &layer->output_size, sizeof(uint32_t)) != MAGIC_SUCCESS) {
             LOG_ERROR("%s: Failed to write layer dimensions.\n", __func__);
             return MAGIC_ERROR;
         }
         // Write weights
-        uint32_t weights_length = layer->input_size * layer->output_size;
-        if (fwrite(layer->weights, sizeof(float), weights_length, magic_file->data) != weights_length) {
+        size_t weights_length = (size_t) layer->input_size * layer->output_size;
+        if (magic_writer_write(writer, layer->weights, sizeof(float) * weights_length) != MAGIC_SUCCESS) {
             LOG_ERROR("%s: Failed to write layer weights.\n", __func__);
             return MAGIC_ERROR;
         }
         // Write biases
-        if (fwrite(layer->biases, sizeof(float), layer->output_size, magic_file->data) != layer->output_size) {
+        if (magic_writer_write(writer, layer->biases, sizeof(float) * layer->output_size) != MAGIC_SUCCESS) {
             LOG_ERROR("%s: Failed to write layer biases.\n", __func__);
             return MAGIC_ERROR;
         }
     }
 
-    return MAGIC_SUCCESS;
+    return magic_writer_end_section(writer);
 }
 
 MagicState load_tensors_section(MagicFile* magic_file, MLP* model) {
@@ -1072,7 +1051,7 @@ MagicState load_tensors_section(MagicFile* magic_file, MLP* model) {
 }
 
 MagicState mlp_save(MLP* model, const char* filepath) {
-    MagicFile* magic = magic_file_open(filepath, "wb");
+    MagicWriter* magic = magic_writer_open(filepath, 0);
     if (!magic) {
         LOG_ERROR("%s: Failed to open file %s for writing.\n", __func__, filepath);
         return MAGIC_FILE_ERROR;
@@ -1080,12 +1059,12 @@ MagicState mlp_save(MLP* model, const char* filepath) {
 
     #define CLEANUP_AND_RETURN(state) \
         do { \
-            magic_file_close(magic); \
-            return state; \
+            MagicState closed = magic_writer_close(magic); \
+            return MAGIC_SUCCESS == (state) ? closed : (state); \
         } while (0)
 
     // Write Start Marker
-    if (MAGIC_SUCCESS != magic_file_write_start_marker(magic, MAGIC_VERSION, MAGIC_ALIGNMENT)) {
+    if (MAGIC_SUCCESS != magic_writer_write_start_marker(magic, MAGIC_VERSION, MAGIC_ALIGNMENT)) {
         LOG_ERROR("%s: Failed to write start marker to file %s.\n", __func__, filepath);
         CLEANUP_AND_RETURN(MAGIC_ERROR);
     }
@@ -1109,12 +1088,13 @@ MagicState mlp_save(MLP* model, const char* filepath) {
     }
 
     // End Marker
-    if (MAGIC_SUCCESS != magic_file_write_end_marker(magic)) {
+    if (MAGIC_SUCCESS != magic_writer_finish(magic, false)) {
         LOG_ERROR("%s: Failed to write end marker to file %s.\n", __func__, filepath);
         CLEANUP_AND_RETURN(MAGIC_ERROR);
     }
 
     CLEANUP_AND_RETURN(MAGIC_SUCCESS);
+    #undef CLEANUP_AND_RETURN
 }
 
 MagicState mlp_load(MLP* model, const char* filepath) {
@@ -1168,12 +1148,18 @@ MagicState mlp_load(MLP* model, const char* filepath) {
     free(model_name);
     free(author);
     free(uuid);
+    if (MAGIC_SUCCESS != magic_file_pad(magic)) {
+        CLEANUP_AND_RETURN(MAGIC_ERROR);
+    }
 
     // Parameters Section
     if (MAGIC_SUCCESS != load_parameters_section(magic, model->params)) {
         LOG_ERROR("%s: Failed to load parameters section from file %s.\n", __func__, filepath);
         CLEANUP_AND_RETURN(MAGIC_ERROR);
     }
+    if (MAGIC_SUCCESS != magic_file_pad(magic)) {
+        CLEANUP_AND_RETURN(MAGIC_ERROR);
+    }
     LOG_INFO(
         "%s: Loaded parameters - Epochs: %u, Learning Rate: %.4f, Error Threshold: %.4f\n",
         __func__,
@@ -208,35 +208,17 @@ TensorState initialize_weights(Tensor* weights) {
 
     LOG_DEBUG("Initializing weights tensor with random values...\n");
 
-    uint32_t rows, cols;
-    FlexState flex_state;
-
-    // Get the dimensions of the weights tensor
-    flex_state = flex_array_get(weights->shape, 0, &rows); // Number of rows
-    if (flex_state != FLEX_ARRAY_SUCCESS) {
-        LOG_ERROR("Failed to get the number of rows for weights tensor.\n");
-        return TENSOR_INVALID_SHAPE;
-    }
-
-    flex_state = flex_array_get(weights->shape, 1, &cols); // Number of columns
-    if (flex_state != FLEX_ARRAY_SUCCESS) {
-        LOG_ERROR("Failed to get the number of columns for weights tensor.\n");
-        return TENSOR_INVALID_SHAPE;
+    // Validate the weights once, then stream random values through a cursor
+    TensorCursor cursor;
+    TensorState state = tensor_cursor_init(&cursor, weights);
+    if (state != TENSOR_SUCCESS) {
+        LOG_ERROR("Failed to create cursor for weights tensor.\n");
+        return state;
     }
 
     // Randomly initialize weights
-    float random_weights[rows][cols];
-    for (uint32_t i = 0; i < rows; i++) {
-        for (uint32_t j = 0; j < cols; j++) {
-            random_weights[i][j] = (float) rand() / (float) RAND_MAX; // Random value in range [0, 1]
-        }
-    }
-
-    // Set the weights tensor in bulk
-    TensorState state = tensor_set_bulk(weights, random_weights);
-    if (state != TENSOR_SUCCESS) {
-        LOG_ERROR("Failed to set weights tensor in bulk.\n");
-        return state;
+    for (; tensor_cursor_valid(&cursor); tensor_cursor_next(&cursor)) {
+        *(float*) tensor_cursor_get(&cursor) = (float) rand() / (float) RAND_MAX; // Random value in range [0, 1]
     }
 
     LOG_DEBUG("Weights tensor successfully initialized.\n");
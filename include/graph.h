@@ -0,0 +1,184 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/graph.h
+ *
+ * @brief Lazy tensor expression graph with operator fusion and arena memory planning.
+ *
+ * Features:
+ * - Records matmul, elementwise, and reduction ops without executing them.
+ * - Fuses elementwise chains into their producer, so a chain such as
+ *   (x @ w + bias) * gamma runs as one matmul plus one in-place epilogue.
+ * - Computes liveness and packs every intermediate into a single arena,
+ *   reusing storage once a value is dead and updating in place when possible.
+ * - Executing a planned graph performs no allocations of its own.
+ *
+ * Notes:
+ * - Inputs are tensors owned by the caller (e.g. from tensor_create); their
+ *   contents may change between executions.
+ * - Only nodes marked as outputs are guaranteed to hold valid data after execution.
+ * - Node handles stay valid until graph_free.
+ */
+
+#ifndef ALT_GRAPH_H
+#define ALT_GRAPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "kernels/elementwise.h"
+#include "kernels/matmul.h"
+#include "kernels/reduce.h"
+#include "tensors.h"
+
+#define GRAPH_ALIGNMENT 64 /**< Alignment of intermediates within the arena */
+
+/**
+ * @enum GraphOp
+ * @brief Primary operation of a node.
+ */
+typedef enum GraphOp {
+    GRAPH_INPUT, /**< Caller supplied tensor */
+    GRAPH_MATMUL, /**< tensor_matmul(source, weight) followed by the fused steps */
+    GRAPH_ELEMENTWISE, /**< tensor_elementwise(source, steps) */
+    GRAPH_REDUCE /**< tensor_reduce(source, axis) followed by the fused steps */
+} GraphOp;
+
+/**
+ * @struct GraphStage
+ * @brief Work that materializes a node: its recorded op, or the op of the
+ * producer it absorbed followed by the combined steps.
+ */
+typedef struct GraphStage {
+    GraphOp op; /**< Primary operation */
+    struct GraphNode* source; /**< First operand */
+    struct GraphNode* weight; /**< Weight operand of a matmul */
+    ReduceOp reduce; /**< Reduction of a GRAPH_REDUCE stage */
+    uint32_t axis; /**< Reduced axis of a GRAPH_REDUCE stage */
+    ElementwiseStep steps[ELEMENTWISE_MAX_STEPS]; /**< Chain or epilogue applied to the result */
+    struct GraphNode* operands[ELEMENTWISE_MAX_STEPS]; /**< Operand node of each binary step */
+    uint32_t count; /**< Number of steps */
+} GraphStage;
+
+/**
+ * @struct GraphNode
+ * @brief A value in the graph and the operation producing it.
+ *
+ * The recorded fields never change after recording; graph_plan derives the
+ * fused stage and the absorbed flag from them on every call.
+ */
+typedef struct GraphNode {
+    GraphOp op; /**< Primary operation */
+    uint32_t id; /**< Position in recording (and execution) order */
+    DataTypeId type; /**< Data type of the result */
+    uint32_t rank; /**< Rank of the result */
+    uint32_t shape[TENSOR_MAX_RANK]; /**< Shape of the result */
+    Tensor* tensor; /**< Result tensor (borrowed for inputs, arena backed after planning) */
+
+    struct GraphNode* source; /**< First operand (x, A, or the reduced tensor) */
+    struct GraphNode* weight; /**< Weight operand of a matmul */
+    ReduceOp reduce; /**< Reduction of a GRAPH_REDUCE node */
+    uint32_t axis; /**< Reduced axis of a GRAPH_REDUCE node */
+
+    ElementwiseStep steps[ELEMENTWISE_MAX_STEPS]; /**< Chain or epilogue applied to the result */
+    struct GraphNode* operands[ELEMENTWISE_MAX_STEPS]; /**< Operand node of each binary step */
+    uint32_t count; /**< Number of steps */
+
+    GraphStage stage; /**< Work executed after fusion (set by graph_plan) */
+    uint32_t consumers; /**< Number of references from other nodes */
+    uint32_t last_use; /**< Id of the last node reading this value */
+    uint64_t offset; /**< Byte offset within the arena */
+    size_t bytes; /**< Byte size of the result */
+    bool output; /**< Kept alive until the end of execution */
+    bool absorbed; /**< Fused into its only consumer by the last plan; never materialized */
+} GraphNode;
+
+/**
+ * @struct Graph
+ * @brief Recorded nodes and the arena backing their intermediates.
+ */
+typedef struct Graph {
+    GraphNode** nodes; /**< Nodes in recording order */
+    uint32_t count; /**< Number of nodes */
+    uint32_t capacity; /**< Allocated node slots */
+    void* arena; /**< Storage for every intermediate */
+    size_t arena_size; /**< Byte size of the arena */
+    bool planned; /**< Set by graph_plan, cleared by recording */
+} Graph;
+
+/**
+ * @brief Creates an empty graph.
+ *
+ * @return Pointer to the graph or NULL on failure.
+ */
+Graph* graph_create(void);
+
+/**
+ * @brief Frees a graph, its nodes, and its arena. Input tensors are not freed.
+ */
+void graph_free(Graph* graph);
+
+/**
+ * @brief Records a caller owned tensor as an input.
+ *
+ * @return Node handle or NULL on failure.
+ */
+GraphNode* graph_input(Graph* graph, Tensor* tensor);
+
+/**
+ * @brief Records C = A * B (see tensor_matmul).
+ *
+ * @return Node handle or NULL on failure. NULL operands propagate.
+ */
+GraphNode* graph_matmul(Graph* graph, GraphNode* a, GraphNode* b);
+
+/**
+ * @brief Records a broadcasting binary op (add, sub, mul, or div).
+ *
+ * @return Node handle or NULL on failure. NULL operands propagate.
+ */
+GraphNode* graph_binary(Graph* graph, ElementwiseOp op, GraphNode* a, GraphNode* b);
+
+/**
+ * @brief Records out = alpha * x.
+ */
+GraphNode* graph_scale(Graph* graph, GraphNode* x, float alpha);
+
+/**
+ * @brief Records out = function(x).
+ */
+GraphNode* graph_activate(Graph* graph, GraphNode* x, ElementwiseFunction function);
+
+/**
+ * @brief Records a reduction of x along axis (see tensor_reduce).
+ */
+GraphNode* graph_reduce(Graph* graph, GraphNode* x, uint32_t axis, ReduceOp op);
+
+/**
+ * @brief Marks a node as an output so its value survives execution.
+ */
+void graph_mark_output(GraphNode* node);
+
+/**
+ * @brief Fuses nodes, computes liveness, and assigns arena offsets.
+ *
+ * Allocates the arena once. Recording more nodes, including on nodes fused
+ * by an earlier plan, requires planning again.
+ *
+ * @return TensorState indicating the result of planning.
+ */
+TensorState graph_plan(Graph* graph);
+
+/**
+ * @brief Executes a planned graph in recording order.
+ *
+ * @return TensorState of the first failing node, or TENSOR_SUCCESS.
+ */
+TensorState graph_execute(Graph* graph);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_GRAPH_H
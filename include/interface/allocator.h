@@ -0,0 +1,104 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/interface/allocator.h
+ *
+ * @brief Aligned, pooled storage allocator for tensor data.
+ *
+ * Features:
+ * - Guarantees at least ALLOCATOR_ALIGNMENT byte alignment for SIMD loads.
+ * - Recycles freed buffers by size class to avoid allocator churn.
+ * - Optionally backs large buffers with huge pages (MAP_HUGETLB or transparent huge pages).
+ * - Skips zero-filling unless explicitly requested.
+ *
+ * Notes:
+ * - Size classes are spaced four per power of two, so rounding wastes at most 25%.
+ * - Buffers must be released with allocator_free, never with free().
+ */
+
+#ifndef ALT_ALLOCATOR_H
+#define ALT_ALLOCATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ALLOCATOR_ALIGNMENT 64 /**< Default (and minimum) alignment in bytes */
+#define ALLOCATOR_HUGE_PAGE_SIZE (2UL << 20) /**< Huge page size (2 MiB) */
+#define ALLOCATOR_HUGE_PAGE_THRESHOLD (4UL << 20) /**< Minimum size backed by huge pages */
+#define ALLOCATOR_CACHE_LIMIT (512UL << 20) /**< Default bytes kept in the free pools */
+
+/**
+ * @enum AllocatorFlags
+ * @brief Options controlling a single allocation.
+ */
+typedef enum AllocatorFlags {
+    ALLOCATOR_NONE = 0, /**< Uninitialized memory */
+    ALLOCATOR_ZERO = 1 << 0, /**< Zero-fill the buffer */
+    ALLOCATOR_HUGE_PAGES = 1 << 1 /**< Use huge pages for large buffers */
+} AllocatorFlags;
+
+/**
+ * @struct AllocatorStats
+ * @brief Counters describing allocator activity.
+ */
+typedef struct AllocatorStats {
+    uint64_t allocations; /**< Total calls to allocator_alloc */
+    uint64_t reuses; /**< Allocations served from the free pools */
+    uint64_t huge_pages; /**< Allocations backed by huge page mappings */
+    size_t cached_bytes; /**< Bytes currently held in the free pools */
+} AllocatorStats;
+
+/**
+ * @brief Allocates an aligned buffer.
+ *
+ * @param size Number of bytes requested.
+ * @param alignment Alignment in bytes (power of two). Raised to ALLOCATOR_ALIGNMENT if smaller.
+ * @param flags Bitwise OR of AllocatorFlags.
+ * @return Pointer to the buffer or NULL on failure.
+ */
+void* allocator_alloc(size_t size, size_t alignment, uint32_t flags);
+
+/**
+ * @brief Returns a buffer to its size class pool, or releases it if the pool is full.
+ *
+ * @param ptr Pointer returned by allocator_alloc. NULL is ignored.
+ */
+void allocator_free(void* ptr);
+
+/**
+ * @brief Returns the usable capacity of a buffer, which may exceed the requested size.
+ *
+ * @param ptr Pointer returned by allocator_alloc.
+ * @return Capacity in bytes, or 0 for NULL.
+ */
+size_t allocator_capacity(const void* ptr);
+
+/**
+ * @brief Sets the maximum number of bytes retained in the free pools.
+ *
+ * @param limit Limit in bytes. Zero disables pooling.
+ */
+void allocator_set_cache_limit(size_t limit);
+
+/**
+ * @brief Releases all pooled buffers back to the system.
+ */
+void allocator_trim(void);
+
+/**
+ * @brief Retrieves a snapshot of the allocator counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void allocator_get_stats(AllocatorStats* stats);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_ALLOCATOR_H
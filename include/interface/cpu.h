@@ -0,0 +1,87 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/interface/cpu.h
+ *
+ * @brief Runtime detection of the instruction set extensions of the host CPU.
+ *
+ * Features:
+ * - CPUID (with the XCR0 register state the OS enables) on x86, HWCAP on AArch64.
+ * - Probed once; every kernel module selects its function-pointer table from the
+ *   same feature set, so one binary runs the best available path on any host.
+ * - The ALT_CPU_DISABLE environment variable masks features by name, e.g.
+ *   ALT_CPU_DISABLE=avx512f,avx2 to compare paths or work around a faulty host.
+ *   "all" leaves only the portable scalar kernels.
+ *
+ * Notes:
+ * - Masking a feature does not mask those built on it: a kernel that needs
+ *   several features checks all of them.
+ */
+
+#ifndef ALT_CPU_H
+#define ALT_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CPU_DISABLE_ENV "ALT_CPU_DISABLE" /**< Comma-separated feature names to mask */
+
+/**
+ * @brief Instruction set extensions the kernels dispatch on, as bit flags.
+ */
+typedef enum CpuFeature {
+    CPU_SSE42 = 1u << 0, /**< SSE4.2 */
+    CPU_AVX2 = 1u << 1, /**< AVX2 (with OS-enabled YMM state) */
+    CPU_FMA = 1u << 2, /**< FMA3 */
+    CPU_F16C = 1u << 3, /**< Half-precision conversions */
+    CPU_AVX512F = 1u << 4, /**< AVX-512 Foundation (with OS-enabled ZMM state) */
+    CPU_AVX512BW = 1u << 5, /**< AVX-512 byte and word instructions */
+    CPU_AVX512VL = 1u << 6, /**< AVX-512 on 128- and 256-bit registers */
+    CPU_AVX512VNNI = 1u << 7, /**< AVX-512 integer dot products */
+    CPU_AVXVNNI = 1u << 8, /**< VEX-encoded integer dot products */
+    CPU_NEON = 1u << 9, /**< AArch64 Advanced SIMD */
+    CPU_DOTPROD = 1u << 10, /**< AArch64 SDOT/UDOT */
+    CPU_CRC32 = 1u << 11, /**< AArch64 CRC32 and CRC32C */
+} CpuFeature;
+
+#define CPU_FEATURE_COUNT 12 /**< Number of CpuFeature flags */
+
+/**
+ * @brief Probes the host CPU, ignoring the named features.
+ *
+ * Unlike cpu_features, the result is not cached and the environment is not read.
+ *
+ * @param disabled Comma-separated feature names (see cpu_feature_name), "all",
+ *                 or NULL. Unknown names are ignored.
+ * @return Bitwise OR of the available CpuFeature flags.
+ */
+uint32_t cpu_probe(const char* disabled);
+
+/**
+ * @brief Returns the features of the host CPU, minus those in ALT_CPU_DISABLE.
+ *
+ * The probe runs once; later calls return the cached result.
+ */
+uint32_t cpu_features(void);
+
+/**
+ * @brief Returns whether the host supports every feature in the mask.
+ *
+ * @param features Bitwise OR of CpuFeature flags.
+ */
+bool cpu_has(uint32_t features);
+
+/**
+ * @brief Returns the lowercase name of a single feature (e.g. "avx512vnni"), or NULL.
+ */
+const char* cpu_feature_name(CpuFeature feature);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_CPU_H
@@ -0,0 +1,42 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/interface/crc32c.h
+ *
+ * @brief CRC-32C (Castagnoli) checksums of byte ranges.
+ *
+ * Features:
+ * - The SSE4.2 crc32 instruction on x86-64 and the CRC32 extension on AArch64,
+ *   selected at runtime through cpu.h.
+ * - A slicing-by-8 table fallback on every other host.
+ *
+ * Notes:
+ * - Checksums chain: crc32c_update(crc32c_update(0, a), b) is the checksum of a
+ *   followed by b, so a range can be hashed in pieces.
+ */
+
+#ifndef ALT_CRC32C_H
+#define ALT_CRC32C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Extends a checksum with more bytes.
+ *
+ * @param crc Checksum of the preceding bytes, or 0 to start.
+ * @param data Bytes to add.
+ * @param size Number of bytes.
+ * @return Checksum of the preceding bytes followed by data.
+ */
+uint32_t crc32c_update(uint32_t crc, const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_CRC32C_H
@@ -7,13 +7,26 @@
  *
  * Features:
  * - Single and half-precision floating-point support.
+ * - bfloat16 and 8-bit floating-point (OCP FP8 E4M3 and E5M2) support.
  * - 8-bit and 4-bit quantized integer support.
+ * - Block quantization with one fp16 scale (and optional min) per BLOCK_SIZE values.
  * - Minimal dependencies with a consistent, extensible design.
  *
  * Notes:
  * - A modern transformer typically consists of 32 blocks.
  * - Each block contains a single layer with 9 sub-layers.
  * - The number of blocks corresponds to the number of layers.
+ * - QuantBits stores a scale next to every value (32 bits per q8 value, 16 per
+ *   q4 value). The block formats amortize the scale over a block instead:
+ *   8.5 bits per weight for BlockQ8, 4.5 for BlockQ4, and 5 for BlockQ4Min.
+ * - Packed q4 rows keep the qint4 codes but split them from their scales: the
+ *   nibbles are contiguous (16 bytes per 32 weights) and one fp16 scale per
+ *   group lives in a side array, 4.5 bits per weight for groups of 32.
+ * - A tensor element of a block type is a whole block, so the innermost
+ *   dimension counts blocks (see data_type_values).
+ * - Encoding to bfloat16 and fp8 rounds to nearest even. Finite values beyond
+ *   the fp8 range saturate to the largest finite value; E4M3 has no infinity,
+ *   so infinities saturate too. NaN stays NaN.
  */
 
 #ifndef ALT_DATA_TYPES_H
@@ -58,6 +71,7 @@ extern "C" {
 #define BLOCK_SIZE 32 /**< Standard block size for quantization */
 #define Q8_ELEMENTS BLOCK_SIZE /**< Elements in an 8-bit quantized block */
 #define Q4_NIBBLES (BLOCK_SIZE / 2) /**< Nibbles in a 4-bit quantized block */
+#define Q4_PACKED_GROUP BLOCK_SIZE /**< Default values per scale of packed 4-bit rows */
 
 // Union for floating-point bit manipulation
 typedef union FloatBits {
@@ -77,6 +91,37 @@ typedef QuantBits Q4; /**< 4-bit quantization */
 typedef QuantBits Q8Row[Q8_ELEMENTS]; /**< Array of 8-bit quantized values */
 typedef QuantBits Q4Row[Q4_NIBBLES]; /**< Array of 4-bit quantized values */
 
+// Block quantization: x = scale * q (+ min), one scale per BLOCK_SIZE values
+
+/**
+ * @brief Symmetric 8-bit block: q in [-127, 127].
+ */
+typedef struct BlockQ8 {
+    uint16_t scale; /**< fp16 step size */
+    int8_t quants[Q8_ELEMENTS]; /**< Signed quantized values */
+} BlockQ8;
+
+/**
+ * @brief Symmetric 4-bit block: x = scale * (q - 8) with q in [0, 15].
+ *
+ * Byte j holds value j in its low nibble and value j + Q4_NIBBLES in its high nibble.
+ */
+typedef struct BlockQ4 {
+    uint16_t scale; /**< fp16 step size */
+    uint8_t nibbles[Q4_NIBBLES]; /**< Packed unsigned quantized values */
+} BlockQ4;
+
+/**
+ * @brief Asymmetric 4-bit block: x = scale * q + min with q in [0, 15].
+ *
+ * Uses the same nibble layout as BlockQ4.
+ */
+typedef struct BlockQ4Min {
+    uint16_t scale; /**< fp16 step size */
+    uint16_t min; /**< fp16 block minimum */
+    uint8_t nibbles[Q4_NIBBLES]; /**< Packed unsigned quantized values */
+} BlockQ4Min;
+
 // Supported data types
 typedef enum DataTypeId {
     TYPE_FLOAT32, /**< 32-bit floating-point (IEEE-754) */
@@ -92,6 +137,14 @@ typedef enum DataTypeId {
     TYPE_BOOL, /**< Boolean */
     TYPE_CHAR, /**< 1-byte character */
     TYPE_WCHAR, /**< Wide character */
+    TYPE_BLOCK_Q8, /**< 8-bit symmetric block quantization (BlockQ8) */
+    TYPE_BLOCK_Q4, /**< 4-bit symmetric block quantization (BlockQ4) */
+    TYPE_BLOCK_Q4_MIN, /**< 4-bit block quantization with a minimum (BlockQ4Min) */
+    TYPE_BFLOAT16, /**< 16-bit brain floating-point (truncated float32) */
+    TYPE_FP8_E4M3, /**< 8-bit floating-point, 4 exponent and 3 mantissa bits */
+    TYPE_FP8_E5M2, /**< 8-bit floating-point, 5 exponent and 2 mantissa bits */
+    TYPE_INT64, /**< 64-bit signed integer */
+    TYPE_UINT64, /**< 64-bit unsigned integer */
     TYPE_COUNT /**< Total number of types */
 } DataTypeId;
 
@@ -113,25 +166,44 @@ typedef struct DataType {
 
 // Static array of supported types
 static const DataType TYPES[TYPE_COUNT] = {
-    [TYPE_FLOAT32] = {"float32", _Alignof(float),    sizeof(float),    TYPE_IS_SIGNED,      TYPE_FLOAT32},
-    [TYPE_FLOAT16] = {"float16", _Alignof(uint16_t), sizeof(uint16_t), TYPE_IS_UNSIGNED,    TYPE_FLOAT16},
-    [TYPE_QUANT8] = {"qint8",   _Alignof(Q8),       sizeof(Q8),       TYPE_NOT_APPLICABLE, TYPE_QUANT8 },
-    [TYPE_QUANT4] = {"qint4",   _Alignof(Q4),       sizeof(Q4),       TYPE_NOT_APPLICABLE, TYPE_QUANT4 },
-    [TYPE_INT32] = {"int32",   _Alignof(int32_t),  sizeof(int32_t),  TYPE_IS_SIGNED,      TYPE_INT32  },
-    [TYPE_INT16] = {"int16",   _Alignof(int16_t),  sizeof(int16_t),  TYPE_IS_SIGNED,      TYPE_INT16  },
-    [TYPE_INT8] = {"int8",    _Alignof(int8_t),   sizeof(int8_t),   TYPE_IS_SIGNED,      TYPE_INT8   },
-    [TYPE_UINT32] = {"uint32",  _Alignof(uint32_t), sizeof(uint32_t), TYPE_IS_UNSIGNED,    TYPE_UINT32 },
-    [TYPE_UINT16] = {"uint16",  _Alignof(uint16_t), sizeof(uint16_t), TYPE_IS_UNSIGNED,    TYPE_UINT16 },
-    [TYPE_UINT8] = {"uint8",   _Alignof(uint8_t),  sizeof(uint8_t),  TYPE_IS_UNSIGNED,    TYPE_UINT8  },
-    [TYPE_BOOL] = {"bool",    _Alignof(bool),     sizeof(bool),     TYPE_NOT_APPLICABLE, TYPE_BOOL   },
-    [TYPE_CHAR] = {"char",    _Alignof(char),     sizeof(char),     TYPE_IS_UNSIGNED,    TYPE_CHAR   },
-    [TYPE_WCHAR] = {"wchar",   _Alignof(wchar_t),  sizeof(wchar_t),  TYPE_IS_UNSIGNED,    TYPE_WCHAR  }
+    [TYPE_FLOAT32] = {"float32",      _Alignof(float),      sizeof(float),      TYPE_IS_SIGNED,      TYPE_FLOAT32     },
+    [TYPE_FLOAT16] = {"float16",      _Alignof(uint16_t),   sizeof(uint16_t),   TYPE_IS_UNSIGNED,    TYPE_FLOAT16     },
+    [TYPE_QUANT8] = {"qint8",        _Alignof(Q8),         sizeof(Q8),         TYPE_NOT_APPLICABLE, TYPE_QUANT8      },
+    [TYPE_QUANT4] = {"qint4",        _Alignof(Q4),         sizeof(Q4),         TYPE_NOT_APPLICABLE, TYPE_QUANT4      },
+    [TYPE_INT32] = {"int32",        _Alignof(int32_t),    sizeof(int32_t),    TYPE_IS_SIGNED,      TYPE_INT32       },
+    [TYPE_INT16] = {"int16",        _Alignof(int16_t),    sizeof(int16_t),    TYPE_IS_SIGNED,      TYPE_INT16       },
+    [TYPE_INT8] = {"int8",         _Alignof(int8_t),     sizeof(int8_t),     TYPE_IS_SIGNED,      TYPE_INT8        },
+    [TYPE_UINT32] = {"uint32",       _Alignof(uint32_t),   sizeof(uint32_t),   TYPE_IS_UNSIGNED,    TYPE_UINT32      },
+    [TYPE_UINT16] = {"uint16",       _Alignof(uint16_t),   sizeof(uint16_t),   TYPE_IS_UNSIGNED,    TYPE_UINT16      },
+    [TYPE_UINT8] = {"uint8",        _Alignof(uint8_t),    sizeof(uint8_t),    TYPE_IS_UNSIGNED,    TYPE_UINT8       },
+    [TYPE_BOOL] = {"bool",         _Alignof(bool),       sizeof(bool),       TYPE_NOT_APPLICABLE, TYPE_BOOL        },
+    [TYPE_CHAR] = {"char",         _Alignof(char),       sizeof(char),       TYPE_IS_UNSIGNED,    TYPE_CHAR        },
+    [TYPE_WCHAR] = {"wchar",        _Alignof(wchar_t),    sizeof(wchar_t),    TYPE_IS_UNSIGNED,    TYPE_WCHAR       },
+    [TYPE_BLOCK_Q8] = {"block_q8",     _Alignof(BlockQ8),    sizeof(BlockQ8),    TYPE_NOT_APPLICABLE, TYPE_BLOCK_Q8    },
+    [TYPE_BLOCK_Q4] = {"block_q4",     _Alignof(BlockQ4),    sizeof(BlockQ4),    TYPE_NOT_APPLICABLE, TYPE_BLOCK_Q4    },
+    [TYPE_BLOCK_Q4_MIN] = {"block_q4_min", _Alignof(BlockQ4Min), sizeof(BlockQ4Min), TYPE_NOT_APPLICABLE, TYPE_BLOCK_Q4_MIN},
+    [TYPE_BFLOAT16] = {"bfloat16",     _Alignof(uint16_t),   sizeof(uint16_t),   TYPE_IS_UNSIGNED,    TYPE_BFLOAT16    },
+    [TYPE_FP8_E4M3] = {"fp8_e4m3",     _Alignof(uint8_t),    sizeof(uint8_t),    TYPE_IS_UNSIGNED,    TYPE_FP8_E4M3    },
+    [TYPE_FP8_E5M2] = {"fp8_e5m2",     _Alignof(uint8_t),    sizeof(uint8_t),    TYPE_IS_UNSIGNED,    TYPE_FP8_E5M2    },
+    [TYPE_INT64] = {"int64",        _Alignof(int64_t),    sizeof(int64_t),    TYPE_IS_SIGNED,      TYPE_INT64       },
+    [TYPE_UINT64] = {"uint64",       _Alignof(uint64_t),   sizeof(uint64_t),   TYPE_IS_UNSIGNED,    TYPE_UINT64      }
 };
 
 // Data type management
 const DataType* data_type_get(DataTypeId id); /**< Retrieve metadata by type ID */
 uint32_t data_type_size(DataTypeId id); /**< Get size of type by ID */
 const char* data_type_name(DataTypeId id); /**< Get name of type by ID */
+uint32_t data_type_values(DataTypeId id); /**< Logical values stored per element */
+
+/**
+ * @brief Returns the 256-entry float32 decode table of an 8-bit floating-point type.
+ *
+ * Entry c is the value of code c, so decoding is a single load per value.
+ *
+ * @param id An fp8 type.
+ * @return The shared read-only table, or NULL if the type is not table decoded.
+ */
+const float* data_type_decode_table(DataTypeId id);
 
 // Scalar conversions
 
@@ -143,6 +215,16 @@ float decode_scalar_fp32(uint32_t bits); /**< Decode bits to 32-bit float */
 uint16_t quantize_scalar_fp16(float value); /**< Quantize 32-bit float to 16-bit */
 float dequantize_scalar_fp16(uint16_t bits); /**< Dequantize 16-bit to 32-bit float */
 
+// Brain floating-point
+uint16_t quantize_scalar_bf16(float value); /**< Quantize 32-bit float to bfloat16 */
+float dequantize_scalar_bf16(uint16_t bits); /**< Dequantize bfloat16 to 32-bit float */
+
+// 8-bit floating-point
+uint8_t quantize_scalar_fp8_e4m3(float value); /**< Quantize 32-bit float to E4M3 */
+float dequantize_scalar_fp8_e4m3(uint8_t bits); /**< Dequantize E4M3 to 32-bit float */
+uint8_t quantize_scalar_fp8_e5m2(float value); /**< Quantize 32-bit float to E5M2 */
+float dequantize_scalar_fp8_e5m2(uint8_t bits); /**< Dequantize E5M2 to 32-bit float */
+
 // 8-bit integer quantization
 Q8 quantize_scalar_q8(float value); /**< Quantize 32-bit float to 8-bit */
 float dequantize_scalar_q8(Q8 q8); /**< Dequantize 8-bit to 32-bit float */
@@ -158,6 +240,26 @@ void dequantize_scalar_q4_reference(Q4 q4, float* a, float* b); /**< Dequantize
 void quantize_row_fp16(const float* input, uint16_t* output, uint32_t length, uint32_t step_size);
 void dequantize_row_fp16(const uint16_t* input, float* output, uint32_t length, uint32_t step_size);
 
+// Brain floating-point
+void quantize_row_bf16(const float* input, uint16_t* output, uint32_t length, uint32_t step_size);
+void dequantize_row_bf16(
+    const uint16_t* input, float* output, uint32_t length, uint32_t step_size
+);
+
+// 8-bit floating-point (decoding reads a 256-entry table)
+void quantize_row_fp8_e4m3(
+    const float* input, uint8_t* output, uint32_t length, uint32_t step_size
+);
+void dequantize_row_fp8_e4m3(
+    const uint8_t* input, float* output, uint32_t length, uint32_t step_size
+);
+void quantize_row_fp8_e5m2(
+    const float* input, uint8_t* output, uint32_t length, uint32_t step_size
+);
+void dequantize_row_fp8_e5m2(
+    const uint8_t* input, float* output, uint32_t length, uint32_t step_size
+);
+
 // 8-bit integer quantization
 void quantize_row_q8(const float* input, Q8Row output, uint32_t length, uint32_t step_size);
 void dequantize_row_q8(const Q8Row input, float* output, uint32_t length, uint32_t step_size);
@@ -166,6 +268,68 @@ void dequantize_row_q8(const Q8Row input, float* output, uint32_t length, uint32
 void quantize_row_q4(const float* input, Q4Row output, uint32_t length, uint32_t step_size);
 void dequantize_row_q4(const Q4Row input, float* output, uint32_t length, uint32_t step_size);
 
+/**
+ * @brief Packed 4-bit quantization with the scales in a side array.
+ *
+ * Codes match qint4: byte j holds value 2j in its high nibble and value 2j + 1
+ * in its low nibble, two's complement in [-8, 7], and x = scale * q. Each group
+ * of values shares one fp16 scale, max|x| / 7 over the group; a partial last
+ * group is allowed. With a group of 2 the encoding and decoding are exactly
+ * those of quantize_row_q4 and dequantize_row_q4 (contiguous, step_size 1).
+ *
+ * @param nibbles length / 2 bytes of codes.
+ * @param scales One fp16 scale per group: ceil(length / group) entries.
+ * @param length Number of values; must be even.
+ * @param group Values per scale; must be even (Q4_PACKED_GROUP by default).
+ */
+void quantize_row_q4_packed(
+    const float* input, uint8_t* nibbles, uint16_t* scales, uint32_t length, uint32_t group
+);
+void dequantize_row_q4_packed(
+    const uint8_t* nibbles, const uint16_t* scales, float* output, uint32_t length, uint32_t group
+);
+
+/**
+ * @brief Converts a qint4 row to packed storage with a group of 2, losslessly.
+ */
+void q4_row_pack(const Q4Row input, uint8_t* nibbles, uint16_t* scales, uint32_t length);
+
+// Block quantization (contiguous rows; a partial last block is zero padded)
+
+void quantize_row_block_q8(const float* input, BlockQ8* output, uint32_t length);
+void dequantize_row_block_q8(const BlockQ8* input, float* output, uint32_t length);
+
+void quantize_row_block_q4(const float* input, BlockQ4* output, uint32_t length);
+void dequantize_row_block_q4(const BlockQ4* input, float* output, uint32_t length);
+
+void quantize_row_block_q4_min(const float* input, BlockQ4Min* output, uint32_t length);
+void dequantize_row_block_q4_min(const BlockQ4Min* input, float* output, uint32_t length);
+
+/**
+ * @brief Importance-weighted block quantization.
+ *
+ * Each block tries clipping ratios of its range, refits the scale (and min) of
+ * every candidate by weighted least squares, and keeps the encoding of least
+ * sum_j importance[j] * (x[j] - x'[j])^2. The unclipped candidate is the plain
+ * encoder's, so the weighted error never exceeds that of quantize_row_block_*.
+ * Decode with the matching dequantize_row_block_* function.
+ *
+ * @param input Row of length values.
+ * @param importance Weight of each value (e.g. the mean squared activation of
+ *                   its input channel), or NULL to minimize the plain squared error.
+ * @param output Destination blocks.
+ * @param length Number of values in the row.
+ */
+void quantize_row_block_q8_weighted(
+    const float* input, const float* importance, BlockQ8* output, uint32_t length
+);
+void quantize_row_block_q4_weighted(
+    const float* input, const float* importance, BlockQ4* output, uint32_t length
+);
+void quantize_row_block_q4_min_weighted(
+    const float* input, const float* importance, BlockQ4Min* output, uint32_t length
+);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
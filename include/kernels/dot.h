@@ -0,0 +1,81 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/kernels/dot.h
+ *
+ * @brief Fused dot products over quantized and half-precision operands.
+ *
+ * Features:
+ * - q8 · q8 and q4 · q8 block dot products accumulated in int32
+ *   (vpdpbusd on AVX-512 VNNI, vpmaddubsw on AVX2, sdot on NEON).
+ * - Block scales are applied once per block, never per value.
+ * - f16 · f32 dot product converting in registers (F16C, AVX-512, NEON).
+ * - 8-bit code · f32 dot product decoding through a 256-entry table
+ *   (vgatherdps on AVX2 and AVX-512), used for the fp8 types.
+ *
+ * Notes:
+ * - Operands are never decoded into temporary float rows.
+ * - The float operand of a quantized dot is quantized once to BlockQ8
+ *   (see quantize_row_block_q8) and reused across every weight row.
+ * - Kernels are selected once at runtime; a scalar fallback is always available.
+ */
+
+#ifndef ALT_KERNELS_DOT_H
+#define ALT_KERNELS_DOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+
+#include "interface/data_types.h"
+
+/**
+ * @brief Computes the dot product of two BlockQ8 rows.
+ *
+ * @param x First row.
+ * @param y Second row.
+ * @param blocks Number of blocks in each row.
+ * @return The dot product of the dequantized rows.
+ */
+float dot_q8_q8(const BlockQ8* x, const BlockQ8* y, size_t blocks);
+
+/**
+ * @brief Computes the dot product of a BlockQ4 row and a BlockQ8 row.
+ *
+ * @param x Weight row.
+ * @param y Activation row quantized to BlockQ8.
+ * @param blocks Number of blocks in each row.
+ * @return The dot product of the dequantized rows.
+ */
+float dot_q4_q8(const BlockQ4* x, const BlockQ8* y, size_t blocks);
+
+/**
+ * @brief Computes the dot product of an fp16 row and a float32 row.
+ *
+ * @param x Half-precision row.
+ * @param y Single-precision row.
+ * @param length Number of values in each row.
+ * @return The dot product accumulated in float32.
+ */
+float dot_f16_f32(const uint16_t* x, const float* y, size_t length);
+
+/**
+ * @brief Computes the dot product of a row of 8-bit codes and a float32 row.
+ *
+ * Each code is decoded by table lookup (see data_type_decode_table).
+ *
+ * @param table 256-entry table holding the value of every code.
+ * @param x Row of codes.
+ * @param y Single-precision row.
+ * @param length Number of values in each row.
+ * @return The dot product accumulated in float32.
+ */
+float dot_lut_f32(const float* table, const uint8_t* x, const float* y, size_t length);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_KERNELS_DOT_H
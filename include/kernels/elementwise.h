@@ -0,0 +1,124 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/kernels/elementwise.h
+ *
+ * @brief Broadcasting elementwise kernels for tensors.
+ *
+ * Features:
+ * - Add, subtract, multiply, and divide with NumPy style broadcasting.
+ * - Scaling, residual addition, and activation application.
+ * - Fused chains such as (x + residual) * gamma evaluated in a single pass over memory.
+ * - AVX2, AVX-512, and NEON kernels selected at runtime with a scalar fallback.
+ *
+ * Notes:
+ * - All operands and outputs are float32 and may be strided views.
+ * - Operands broadcast against the output shape: trailing dimensions are aligned,
+ *   and each operand dimension must equal the output dimension or be 1.
+ * - The output may alias x or any step operand exactly (in-place), but must not
+ *   partially overlap any operand.
+ */
+
+#ifndef ALT_KERNELS_ELEMENTWISE_H
+#define ALT_KERNELS_ELEMENTWISE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "tensors.h"
+
+#define ELEMENTWISE_MAX_STEPS 8 /**< Maximum number of fused steps */
+#define ELEMENTWISE_CHUNK 1024 /**< Elements processed per L1 resident chunk */
+
+/**
+ * @enum ElementwiseOp
+ * @brief Operation applied by a single fused step.
+ */
+typedef enum ElementwiseOp {
+    ELEMENTWISE_ADD, /**< acc + operand */
+    ELEMENTWISE_SUB, /**< acc - operand */
+    ELEMENTWISE_MUL, /**< acc * operand */
+    ELEMENTWISE_DIV, /**< acc / operand */
+    ELEMENTWISE_SCALE, /**< acc * scalar */
+    ELEMENTWISE_ACTIVATE /**< function(acc) */
+} ElementwiseOp;
+
+/**
+ * @brief Scalar activation function, e.g. activate_relu or activate_silu.
+ */
+typedef float (*ElementwiseFunction)(float);
+
+/**
+ * @struct ElementwiseStep
+ * @brief A single operation in a fused elementwise chain.
+ */
+typedef struct ElementwiseStep {
+    ElementwiseOp op; /**< Operation to apply */
+    const Tensor* operand; /**< Broadcast operand for add, sub, mul, and div */
+    float scalar; /**< Factor for ELEMENTWISE_SCALE */
+    ElementwiseFunction function; /**< Function for ELEMENTWISE_ACTIVATE */
+} ElementwiseStep;
+
+/**
+ * @brief Evaluates a chain of elementwise steps in a single pass: out = steps(x).
+ *
+ * The input is loaded one L1 sized chunk at a time, every step is applied to
+ * the chunk, and the result is stored once, so the chain costs one read of
+ * each operand and one write of the output regardless of its length.
+ *
+ * @param x Float32 input, broadcast against out.
+ * @param steps Array of steps applied in order.
+ * @param count Number of steps (at most ELEMENTWISE_MAX_STEPS).
+ * @param out Float32 output tensor. Its shape defines the result shape.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState
+tensor_elementwise(const Tensor* x, const ElementwiseStep* steps, uint32_t count, Tensor* out);
+
+/**
+ * @brief Computes out = a + b with broadcasting.
+ */
+TensorState tensor_add(const Tensor* a, const Tensor* b, Tensor* out);
+
+/**
+ * @brief Computes out = a - b with broadcasting.
+ */
+TensorState tensor_sub(const Tensor* a, const Tensor* b, Tensor* out);
+
+/**
+ * @brief Computes out = a * b with broadcasting.
+ */
+TensorState tensor_mul(const Tensor* a, const Tensor* b, Tensor* out);
+
+/**
+ * @brief Computes out = a / b with broadcasting.
+ */
+TensorState tensor_div(const Tensor* a, const Tensor* b, Tensor* out);
+
+/**
+ * @brief Computes out = alpha * x.
+ */
+TensorState tensor_scale(const Tensor* x, float alpha, Tensor* out);
+
+/**
+ * @brief Adds a residual in place: x += residual.
+ *
+ * @param x Float32 tensor updated in place.
+ * @param residual Float32 tensor broadcast against x.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState tensor_residual_add(Tensor* x, const Tensor* residual);
+
+/**
+ * @brief Applies an activation function to every element: out = function(x).
+ *
+ * activate_relu is vectorized; other functions are applied per element.
+ */
+TensorState tensor_activate(const Tensor* x, ElementwiseFunction function, Tensor* out);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_KERNELS_ELEMENTWISE_H
@@ -0,0 +1,86 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/kernels/matmul.h
+ *
+ * @brief Cache-blocked matrix multiplication for tensors.
+ *
+ * Features:
+ * - Panel packing with L1/L2 tiling (MR x NR micro-tiles, KC x NC panels).
+ * - AVX2, AVX-512, and NEON micro-kernels selected at runtime with a scalar fallback.
+ * - Float32 activations with float32, float16, q8, q4, or block quantized weight operands.
+ *
+ * Notes:
+ * - Activations and outputs are always float32.
+ * - Weight operands are decoded to float32 while packing, so no full-size
+ *   dequantized copy of the weights is ever materialized.
+ * - For TYPE_QUANT4, each element holds two values, so the innermost dimension
+ *   counts packed pairs and decodes to twice as many columns. Block types hold
+ *   BLOCK_SIZE values per element (see data_type_values).
+ * - Weights repacked once at load time into MATMUL_NR wide column panels
+ *   (tensor_repack with TENSOR_TILE_PANEL rows) skip packing entirely for
+ *   float32 and decode contiguous panel rows for the other types.
+ */
+
+#ifndef ALT_KERNELS_MATMUL_H
+#define ALT_KERNELS_MATMUL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "tensors.h"
+
+// Blocking parameters for the packed micro-kernels
+#define MATMUL_MR 6 /**< Rows per micro-tile (A panel height) */
+#define MATMUL_NR 16 /**< Columns per micro-tile (B panel width) */
+#define MATMUL_KC 256 /**< Depth of packed panels (L1 resident B micro-panel) */
+#define MATMUL_MC 72 /**< Rows of packed A block (L2 resident) */
+#define MATMUL_NC 4080 /**< Columns of packed B block (L3 resident) */
+#define MATMUL_ALIGNMENT 64 /**< Alignment of packed buffers in bytes */
+
+/**
+ * @brief Computes the matrix product C = A * B.
+ *
+ * @param a Float32 tensor of shape [M, K]. May be a strided view.
+ * @param b Weight tensor of shape [K, N] (float32, float16, q8, q4, or a block type).
+ *          Non-float32 weights must have unit stride along their last dimension.
+ *          Tiled weights must hold full height panels of MATMUL_NR values.
+ * @param c Float32 tensor of shape [M, N] receiving the result. It is overwritten.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState tensor_matmul(const Tensor* a, const Tensor* b, Tensor* c);
+
+/**
+ * @brief Computes the matrix-vector product y = W * x.
+ *
+ * Each row of W is reduced against x with a vectorized dot product. This is
+ * the decode-time path for linear layers. Float16, block_q8, block_q4, and fp8
+ * rows use the fused kernels in kernels/dot.h; for block weights x is quantized
+ * once to block_q8, and fp8 codes decode through their value table. Other types
+ * decode each row to float32 first.
+ *
+ * @param w Row-major weight tensor of shape [M, K] (float32, float16, q8, q4, or a block type).
+ * @param x Float32 tensor of shape [K].
+ * @param y Float32 tensor of shape [M] receiving the result. It is overwritten.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState tensor_gemv(const Tensor* w, const Tensor* x, Tensor* y);
+
+/**
+ * @brief Computes the dot product of two contiguous float32 vectors.
+ *
+ * Uses the widest vector unit available on the host.
+ *
+ * @param x First input vector.
+ * @param y Second input vector.
+ * @param length Number of elements in each vector.
+ * @return The dot product of x and y.
+ */
+float matmul_dot_f32(const float* x, const float* y, size_t length);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_KERNELS_MATMUL_H
@@ -0,0 +1,187 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/kernels/quantize.h
+ *
+ * @brief Threaded bulk conversion of whole tensors between numeric types.
+ *
+ * Features:
+ * - Rows are split across the thread pool (see threads.h).
+ * - Block formats use the vectorized abs-max and rounding row encoders in
+ *   data_types.h, so one row costs a handful of instructions per block.
+ * - Any decodable source type can be requantized; rows of non-float32 sources
+ *   are decoded into a per-thread scratch row first.
+ * - Every conversion reports the throughput it achieved.
+ * - Calibration accumulates per-channel activation statistics from sample
+ *   inputs and weights the block encoders' error by them.
+ * - Packed qint4 storage streams 16 bytes of codes per 32 weights, with the
+ *   scales in a separate array.
+ *
+ * Notes:
+ * - The source must be contiguous and row-major. The innermost dimension is the row.
+ * - The row length must be a whole number of target elements (even for qint4,
+ *   a multiple of BLOCK_SIZE for the block types).
+ */
+
+#ifndef ALT_KERNELS_QUANTIZE_H
+#define ALT_KERNELS_QUANTIZE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "tensors.h"
+
+#define QUANTIZE_GRAIN 65536 /**< Minimum values per thread partition */
+#define QUANTIZE_IMPORTANCE_FLOOR 1e-3 /**< Least relative weight of a calibrated channel */
+
+/**
+ * @struct QuantizeReport
+ * @brief Volume and throughput of a tensor conversion.
+ */
+typedef struct QuantizeReport {
+    uint64_t values; /**< Logical values converted */
+    uint64_t bytes; /**< Bytes read plus bytes written */
+    uint32_t threads; /**< Thread partitions used */
+    double seconds; /**< Wall time of the conversion */
+    double values_per_second; /**< Conversion rate in values */
+    double gb_per_second; /**< Memory throughput in GB/s */
+} QuantizeReport;
+
+/**
+ * @brief Returns whether quantize_tensor converts from and to the given type.
+ */
+bool quantize_is_supported(DataTypeId id);
+
+/**
+ * @brief Converts a tensor into a new row-major tensor of the target type.
+ *
+ * The throughput is logged at info level and, if report is not NULL, stored there.
+ *
+ * @param tensor Contiguous source tensor of any floating-point or quantized type.
+ * @param target Destination floating-point or quantized type.
+ * @param report Optional destination for the conversion statistics.
+ * @return Pointer to the converted tensor or NULL on failure.
+ */
+Tensor* quantize_tensor(const Tensor* tensor, DataTypeId target, QuantizeReport* report);
+
+/**
+ * @struct QuantizeCalibration
+ * @brief Activation statistics of the input channels of one linear layer.
+ *
+ * For y = W x, the error of output i is sum_j (W[i][j] - W'[i][j]) x[j], and its
+ * expectation over samples weights the squared error of column j by E[x[j]^2].
+ */
+typedef struct QuantizeCalibration {
+    double* sums; /**< Sum of squared activations per channel */
+    uint32_t channels; /**< Input channels (values per weight row) */
+    uint64_t samples; /**< Activation vectors observed */
+} QuantizeCalibration;
+
+/**
+ * @brief Creates empty statistics for a layer with the given input width.
+ *
+ * @return Pointer to the calibration or NULL on failure.
+ */
+QuantizeCalibration* quantize_calibration_create(uint32_t channels);
+
+/**
+ * @brief Frees calibration statistics.
+ */
+void quantize_calibration_free(QuantizeCalibration* calibration);
+
+/**
+ * @brief Accumulates a batch of activations captured at the layer's input.
+ *
+ * @param calibration Statistics to update.
+ * @param activations Contiguous float32 tensor whose last dimension is channels,
+ *                    e.g. the [tokens, channels] input of a linear layer while the
+ *                    model runs sample text.
+ * @return TENSOR_SUCCESS or TENSOR_ERROR on invalid input.
+ */
+TensorState
+quantize_calibration_observe(QuantizeCalibration* calibration, const Tensor* activations);
+
+/**
+ * @brief Computes the relative importance of every channel.
+ *
+ * Importance is the mean squared activation normalized to a mean of 1, floored
+ * at QUANTIZE_IMPORTANCE_FLOOR so no channel is ignored entirely.
+ *
+ * @param importance Destination of calibration->channels values.
+ * @return TENSOR_SUCCESS or TENSOR_ERROR on invalid input.
+ */
+TensorState
+quantize_calibration_importance(const QuantizeCalibration* calibration, float* importance);
+
+/**
+ * @brief Quantizes a weight matrix to a block type, minimizing the layer's output error.
+ *
+ * Each block chooses its scale and clipping with the weighted block encoders in
+ * data_types.h, weighting every value by the importance of its input channel.
+ *
+ * @param weights Contiguous [..., channels] weights of any decodable type.
+ * @param target TYPE_BLOCK_Q8, TYPE_BLOCK_Q4, or TYPE_BLOCK_Q4_MIN.
+ * @param calibration Statistics of the layer's inputs, or NULL to weight channels equally.
+ * @param report Optional destination for the conversion statistics.
+ * @return Pointer to the converted tensor or NULL on failure.
+ */
+Tensor* quantize_tensor_calibrated(
+    const Tensor* weights,
+    DataTypeId target,
+    const QuantizeCalibration* calibration,
+    QuantizeReport* report
+);
+
+/**
+ * @struct QuantizeQ4Packed
+ * @brief A tensor in packed qint4 storage (see quantize_row_q4_packed).
+ *
+ * Codes and scales are separate row-major arrays, each aligned to a cache line,
+ * so a kernel streaming the weights reads whole lines of nibbles and touches a
+ * scale once per group.
+ */
+typedef struct QuantizeQ4Packed {
+    uint8_t* nibbles; /**< rows * values / 2 bytes of codes */
+    uint16_t* scales; /**< rows * groups fp16 scales */
+    uint32_t rank; /**< Rank of the tensor */
+    uint32_t shape[TENSOR_MAX_RANK]; /**< Logical shape; the last dimension counts values */
+    uint64_t rows; /**< Product of the leading dimensions */
+    uint32_t values; /**< Values per row */
+    uint32_t group; /**< Values per scale */
+    uint32_t groups; /**< Scales per row; a partial last group is allowed */
+} QuantizeQ4Packed;
+
+/**
+ * @brief Packs a tensor into qint4 codes with one scale per group of each row.
+ *
+ * @param tensor Contiguous source tensor of any floating-point or quantized type,
+ *               with an even number of values per row.
+ * @param group Even number of values per scale (Q4_PACKED_GROUP by default).
+ * @param report Optional destination for the conversion statistics.
+ * @return Pointer to the packed storage or NULL on failure.
+ */
+QuantizeQ4Packed* quantize_tensor_q4_packed(
+    const Tensor* tensor, uint32_t group, QuantizeReport* report
+);
+
+/**
+ * @brief Unpacks packed qint4 storage into a new float32 tensor of its logical shape.
+ *
+ * @return Pointer to the float32 tensor or NULL on failure.
+ */
+Tensor* dequantize_tensor_q4_packed(const QuantizeQ4Packed* packed, QuantizeReport* report);
+
+size_t quantize_q4_packed_nibble_bytes(const QuantizeQ4Packed* packed); /**< Bytes of codes */
+size_t quantize_q4_packed_scale_bytes(const QuantizeQ4Packed* packed); /**< Bytes of scales */
+
+/**
+ * @brief Frees packed qint4 storage.
+ */
+void quantize_q4_packed_free(QuantizeQ4Packed* packed);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_KERNELS_QUANTIZE_H
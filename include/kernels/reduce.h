@@ -0,0 +1,87 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/kernels/reduce.h
+ *
+ * @brief Vectorized and threaded reductions over tensor axes.
+ *
+ * Features:
+ * - Sum, mean, max, argmax, and L2 norm along any axis of a float32 tensor.
+ * - Pairwise summation for contiguous lines and Kahan-compensated accumulation
+ *   across rows, so error does not grow linearly with the axis length.
+ * - AVX2, AVX-512, and NEON kernels selected at runtime with a scalar fallback.
+ * - Large reductions are split across the thread pool (see threads.h).
+ *
+ * Notes:
+ * - The input may be a strided view; the output must be contiguous.
+ * - The output shape is the input shape with the axis removed, or with the axis
+ *   kept as a dimension of size 1. A rank 1 input reduces to shape [1].
+ * - Argmax writes TYPE_UINT32 indices and returns the first maximum. NaNs are ignored.
+ */
+
+#ifndef ALT_KERNELS_REDUCE_H
+#define ALT_KERNELS_REDUCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "tensors.h"
+
+#define REDUCE_BLOCK 256 /**< Leaf size of the pairwise summation tree */
+#define REDUCE_CHUNK 1024 /**< Elements gathered per chunk for strided lines */
+#define REDUCE_GRAIN 32768 /**< Minimum elements per thread partition */
+
+/**
+ * @enum ReduceOp
+ * @brief Reduction applied along an axis.
+ */
+typedef enum ReduceOp {
+    REDUCE_SUM, /**< Sum of elements */
+    REDUCE_MEAN, /**< Arithmetic mean */
+    REDUCE_MAX, /**< Largest element */
+    REDUCE_ARGMAX, /**< Index of the first largest element */
+    REDUCE_L2 /**< Euclidean norm: sqrt(sum(x^2)) */
+} ReduceOp;
+
+/**
+ * @brief Reduces a tensor along one axis.
+ *
+ * @param x Float32 input tensor. May be a strided view.
+ * @param axis Axis to reduce, in [0, rank).
+ * @param op Reduction to apply.
+ * @param out Contiguous output tensor: float32, or uint32 for REDUCE_ARGMAX.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState tensor_reduce(const Tensor* x, uint32_t axis, ReduceOp op, Tensor* out);
+
+/**
+ * @brief Sums a contiguous float32 vector using pairwise summation.
+ */
+float reduce_sum_f32(const float* x, size_t length);
+
+/**
+ * @brief Sums the squares of a contiguous float32 vector using pairwise summation.
+ */
+float reduce_sum_squares_f32(const float* x, size_t length);
+
+/**
+ * @brief Returns the largest element of a contiguous float32 vector, or -INFINITY if empty.
+ */
+float reduce_max_f32(const float* x, size_t length);
+
+/**
+ * @brief Returns the index of the first largest element of a contiguous float32 vector.
+ *
+ * @param x Input vector.
+ * @param length Number of elements (must be non-zero).
+ * @param value Optional pointer receiving the largest element.
+ * @return Index of the largest element.
+ */
+uint64_t reduce_argmax_f32(const float* x, size_t length, float* value);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_KERNELS_REDUCE_H
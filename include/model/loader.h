@@ -0,0 +1,143 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/model/loader.h
+ *
+ * @brief Parallel loading of the Tensor Section into runtime tensors.
+ *
+ * Features:
+ * - Tensors are located through the Index Section (see magic.h), or through
+ *   one pass over the tensor metadata when the file has no index.
+ * - Worker threads claim tensors one at a time, so large and small tensors
+ *   balance across the pool, and each reads its tensor with pread.
+ * - The kernel is told the access pattern up front and asked to read ahead of
+ *   the workers, so disk reads overlap with conversion.
+ * - Each tensor is converted to the runtime type and optionally repacked into
+ *   tiles as soon as it is read, and optionally checked against its checksum.
+ * - The checksums of a whole file are verified in parallel with loader_verify,
+ *   or one entry at a time on a background thread with loader_verify_start,
+ *   e.g. while a mapped model already serves requests.
+ *
+ * Notes:
+ * - Tensors of a mapped file (see magic_file_map) that need neither conversion
+ *   nor repacking borrow the mapping: keep the file open while they are in use.
+ * - Tensors the conversion does not apply to keep their stored type and layout.
+ */
+
+#ifndef ALT_MODEL_LOADER_H
+#define ALT_MODEL_LOADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <pthread.h>
+
+#include "tensors.h"
+
+#include "model/magic.h"
+
+#define LOADER_KEEP_TYPE TYPE_COUNT /**< Target type that keeps the stored type */
+
+/**
+ * @struct LoaderOptions
+ * @brief How stored tensors become runtime tensors.
+ */
+typedef struct LoaderOptions {
+    DataTypeId target; /**< Runtime type, or LOADER_KEEP_TYPE */
+    uint32_t tile_rows; /**< Tile height for rank 2 tensors, or TENSOR_TILE_PANEL */
+    uint32_t tile_cols; /**< Tile width in elements, 0 keeps the row-major layout */
+    uint32_t lookahead; /**< Tensors read ahead of the workers, 0 for one per thread */
+    bool verify; /**< Check each stored tensor against the checksum in the index */
+} LoaderOptions;
+
+/**
+ * @struct LoaderTensors
+ * @brief Tensors of a Tensor Section with their metadata, in file order.
+ */
+typedef struct LoaderTensors {
+    MagicTensorInfo* infos; /**< Stored metadata of each tensor */
+    Tensor** tensors; /**< Runtime tensor of each tensor */
+    int64_t count; /**< Number of tensors */
+    uint64_t bytes; /**< Tensor data read from the file */
+    double seconds; /**< Wall time of the load */
+} LoaderTensors;
+
+/**
+ * @struct LoaderVerifier
+ * @brief Verification of a file's checksums on a background thread.
+ */
+typedef struct LoaderVerifier {
+    MagicFile* magic_file; /**< File being verified */
+    const MagicIndex* index; /**< Its index, with checksums */
+    pthread_t thread; /**< Verifying thread */
+    int64_t total; /**< Entries to verify: sections, then tensors */
+    int64_t checked; /**< Entries verified so far */
+    int64_t corrupt; /**< Entries whose data differs from their checksum so far */
+    int failed; /**< Set if an entry could not be read */
+    int stop; /**< Set to abandon the verification */
+} LoaderVerifier;
+
+/**
+ * @brief Loads every tensor of the Tensor Section in parallel.
+ *
+ * @param magic_file An open or mapped model file.
+ * @param index The file's index, or NULL to locate the tensors by their metadata.
+ * @param options Conversion and layout, or NULL to keep the stored tensors as they are.
+ * @return The loaded tensors, or NULL on failure. Release them with loader_free.
+ */
+LoaderTensors*
+loader_read_tensors(MagicFile* magic_file, const MagicIndex* index, const LoaderOptions* options);
+
+/**
+ * @brief Returns the tensor with the given name, or NULL if there is none.
+ */
+Tensor* loader_find(const LoaderTensors* loaded, const char* name);
+
+/**
+ * @brief Frees the loaded tensors and their metadata.
+ */
+void loader_free(LoaderTensors* loaded);
+
+/**
+ * @brief Verifies the checksum of every section and tensor of an index in parallel.
+ *
+ * @param magic_file An open or mapped model file.
+ * @param index The file's index, with checksums.
+ * @return The number of corrupt entries, each logged, or -1 if the index has no
+ *         checksums or an entry cannot be read.
+ */
+int64_t loader_verify(MagicFile* magic_file, const MagicIndex* index);
+
+/**
+ * @brief Starts verifying the checksums of an index on a background thread.
+ *
+ * The thread reads with pread or from the mapping, so the file stays usable,
+ * and it leaves the thread pool to the caller. The file and the index must
+ * outlive the verifier.
+ *
+ * @param magic_file An open or mapped model file.
+ * @param index The file's index, with checksums.
+ * @return The running verifier, or NULL on failure. Release it with loader_verify_finish.
+ */
+LoaderVerifier* loader_verify_start(MagicFile* magic_file, const MagicIndex* index);
+
+/**
+ * @brief Returns the number of entries the verifier has checked so far.
+ */
+int64_t loader_verify_progress(const LoaderVerifier* verifier);
+
+/**
+ * @brief Waits for the verifier, or stops it after the current entry, and frees it.
+ *
+ * @param verifier The verifier.
+ * @param cancel Whether to stop before the remaining entries.
+ * @return As loader_verify, or -1 if the verification was stopped before the end.
+ */
+int64_t loader_verify_finish(LoaderVerifier* verifier, bool cancel);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ALT_MODEL_LOADER_H
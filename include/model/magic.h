@@ -10,6 +10,21 @@
  * adhering to the ALT file format specification. Each function is designed to
  * handle a specific aspect of file management without making assumptions about
  * the content of the file.
+ *
+ * A file opened with magic_file_map is mapped read-only: the field readers parse
+ * it from memory, and magic_file_tensor_data returns tensor data in place, so
+ * loading costs page faults instead of copies and processes share one page
+ * cache copy of the weights.
+ *
+ * An optional Index Section before the end marker lists the offset and size of
+ * every section and of every tensor, so readers can jump to one section or one
+ * layer without parsing what precedes it. Its entries may also carry a CRC-32C
+ * checksum of every tensor's data and of every section's other bytes, which
+ * magic_file_checksum_index computes and loader_verify checks.
+ *
+ * MagicWriter writes a file in one sequential pass: sections are opened and
+ * closed around their contents, their sizes are back-patched on close, and
+ * everything streams through a large buffer flushed with writev.
  */
 
 #ifndef ALT_MODEL_MAGIC_H
@@ -34,9 +49,12 @@
 #define MAGIC_PARAMETERS 0xDEADBEEF /**< Model parameters section. */
 #define MAGIC_TOKENIZER 0xBADDCAFE /**< Tokenizer data section. */
 #define MAGIC_TENSORS 0xFACEFEED /**< Tensor data section. */
+#define MAGIC_INDEX 0xF00DFACE /**< Optional index of sections and tensors. */
 #define MAGIC_END 0x0FFFFFFF /**< End marker (absolute end of the file). */
 #define MAGIC_ALIGNMENT 32 /**< Default alignment (32 bytes). */
 #define MAGIC_VERSION 2 /**< Current ALT file format version. */
+#define MAGIC_MAX_DIMS 8 /**< Maximum rank of a stored tensor. */
+#define MAGIC_WRITER_BUFFER (8u << 20) /**< Default MagicWriter buffer size (8 MiB). */
 
 // --------------------------- MagicState Enum ---------------------------------
 
@@ -48,9 +66,32 @@ typedef enum MagicState {
     MAGIC_ERROR, /**< General error during the operation. */
     MAGIC_INVALID_MARKER, /**< Invalid section marker encountered. */
     MAGIC_ALIGNMENT_ERROR, /**< Alignment error during reading/writing. */
-    MAGIC_FILE_ERROR /**< File operation error (e.g., open/close failure). */
+    MAGIC_FILE_ERROR, /**< File operation error (e.g., open/close failure). */
+    MAGIC_CHECKSUM_ERROR /**< Data differs from its recorded checksum. */
 } MagicState;
 
+// --------------------------- MagicChecksum Enum ------------------------------
+
+/**
+ * @brief Checksum recorded in the entries of an Index Section.
+ */
+typedef enum MagicChecksum {
+    MAGIC_CHECKSUM_NONE, /**< Entries carry no checksums. */
+    MAGIC_CHECKSUM_CRC32C /**< CRC-32C (Castagnoli) in the low 32 bits of each checksum. */
+} MagicChecksum;
+
+// ------------------------- MagicQuantProfile Enum ----------------------------
+
+/**
+ * @brief How the quantized tensors of a Tensor Section were produced.
+ */
+typedef enum MagicQuantProfile {
+    MAGIC_PROFILE_UNQUANTIZED, /**< Tensors keep their source precision. */
+    MAGIC_PROFILE_QINT8, /**< Plain 8-bit quantization. */
+    MAGIC_PROFILE_QINT4, /**< Plain 4-bit quantization. */
+    MAGIC_PROFILE_CALIBRATED /**< Block scales and clipping chosen from sample activations. */
+} MagicQuantProfile;
+
 // ---------------------------- MagicFile Struct --------------------------------
 
 /**
@@ -65,8 +106,113 @@ typedef struct MagicFile {
     const char* filepath; /**< Path to the model file. */
     const char* mode; /**< File mode (e.g., "rb" for read binary). */
     FILE* data; /**< File pointer to the open model. */
+    void* map; /**< Read-only mapping of the whole file, NULL for plain streams. */
+    size_t map_size; /**< Byte size of the mapping. */
 } MagicFile;
 
+// ------------------------- Tensor Section Structs ----------------------------
+
+/**
+ * @struct MagicTensorSection
+ * @brief Configuration and metadata fields opening the Tensor Section.
+ */
+typedef struct MagicTensorSection {
+    int32_t data_type; /**< Primary DataTypeId of the tensors. */
+    int32_t quant_profile; /**< MagicQuantProfile, 0 if unquantized. */
+    int32_t context_len; /**< Maximum context length in tokens. */
+    int64_t tensor_count; /**< Number of tensors in the section. */
+    int64_t shape_count; /**< Sum of the ranks of all tensors. */
+    int32_t block_count; /**< Number of standard blocks (layers). */
+    int32_t unique_count; /**< Number of unique components. */
+} MagicTensorSection;
+
+/**
+ * @struct MagicTensorInfo
+ * @brief Per-tensor metadata and the location of its data in the file.
+ *
+ * The shape is the storage shape of the tensor: its innermost dimension counts
+ * elements of data_type, as for tensor_create (see data_type_values).
+ */
+typedef struct MagicTensorInfo {
+    int32_t component_type; /**< Primary model component (layers, embed_tokens, ...). */
+    int32_t block_index; /**< Block index, or negative for unique components. */
+    int32_t layer_type; /**< Subdivision within a block, if any. */
+    int32_t projection_type; /**< Subdivision of the layer type, if any. */
+    int32_t n_dims; /**< Number of dimensions. */
+    int32_t shape[MAGIC_MAX_DIMS]; /**< Size of each dimension. */
+    char* name; /**< UTF-8 tensor name, owned by the struct. */
+    int32_t data_type; /**< DataTypeId of the stored elements. */
+    float delta; /**< Scaling factor for quantized data. */
+    float min; /**< Minimum for range-based quantization, 0 if unused. */
+    float max; /**< Maximum for range-based quantization, 0 if unused. */
+    int8_t packing_flag; /**< 1 if the data is packed, 0 otherwise. */
+    int64_t offset; /**< File offset of the tensor data (aligned). */
+    int64_t size; /**< Byte size of the tensor data. */
+} MagicTensorInfo;
+
+// -------------------------- Index Section Structs ----------------------------
+
+/**
+ * @struct MagicIndexEntry
+ * @brief Location of one section in the file.
+ */
+typedef struct MagicIndexEntry {
+    int64_t marker; /**< Section marker identifier. */
+    int64_t offset; /**< File offset of the section marker. */
+    int64_t size; /**< Section size, as recorded after the marker. */
+    uint64_t checksum; /**< Checksum of the section's bytes outside tensor data. */
+} MagicIndexEntry;
+
+/**
+ * @struct MagicTensorEntry
+ * @brief Identity and location of one tensor in the Tensor Section.
+ */
+typedef struct MagicTensorEntry {
+    int32_t component_type; /**< Primary model component (layers, embed_tokens, ...). */
+    int32_t block_index; /**< Block index, or negative for unique components. */
+    int32_t layer_type; /**< Subdivision within a block, if any. */
+    int32_t projection_type; /**< Subdivision of the layer type, if any. */
+    int64_t info; /**< File offset of the tensor metadata. */
+    int64_t offset; /**< File offset of the tensor data (aligned). */
+    int64_t size; /**< Byte size of the tensor data. */
+    uint64_t checksum; /**< Checksum of the tensor data. */
+} MagicTensorEntry;
+
+/**
+ * @struct MagicIndex
+ * @brief Contents of the Index Section. Initialize to zero, release with magic_index_free.
+ */
+typedef struct MagicIndex {
+    MagicIndexEntry* sections; /**< One entry per indexed section. */
+    int64_t section_count; /**< Number of section entries. */
+    MagicTensorEntry* tensors; /**< One entry per tensor, in file order. */
+    int64_t tensor_count; /**< Number of tensor entries. */
+    int64_t checksum; /**< MagicChecksum of the entries. */
+} MagicIndex;
+
+// --------------------------- MagicWriter Struct -----------------------------
+
+/**
+ * @struct MagicWriter
+ * @brief Sequential, buffered writer of ALT model files.
+ *
+ * Bytes accumulate in the buffer and reach the file when it fills; writes larger
+ * than the free space are passed to the file directly, behind the pending bytes.
+ * The Index Section is recorded as sections and tensors are written.
+ */
+typedef struct MagicWriter {
+    const char* filepath; /**< Path to the model file. */
+    int fd; /**< Descriptor of the file being written. */
+    uint8_t* buffer; /**< Pending bytes, which follow the flushed ones. */
+    size_t capacity; /**< Byte size of the buffer. */
+    size_t length; /**< Number of pending bytes. */
+    int64_t flushed; /**< Number of bytes already in the file. */
+    int64_t section; /**< File offset of the open section marker, or -1. */
+    int64_t marker; /**< Marker of the open section. */
+    uint32_t checksum; /**< CRC-32C of the open section so far, outside tensor data. */
+    MagicIndex index; /**< Sections and tensors written so far, with their checksums. */
+} MagicWriter;
+
 // ------------------------- Function Declarations -----------------------------
 
 // ------------------------- MagicFile Management ------------------------------
@@ -84,6 +230,19 @@ typedef struct MagicFile {
  */
 MagicFile* magic_file_open(const char* filepath, const char* mode);
 
+/**
+ * @brief Maps the model file read-only and opens a stream over the mapping.
+ *
+ * @param filepath The path to the model file to be mapped.
+ *
+ * Every read function works on the result as on a file opened in "rb" mode, but
+ * parses from memory. Tensor data is accessed in place with
+ * magic_file_tensor_data and stays valid until magic_file_close.
+ *
+ * @return A MagicFile pointer on success, or NULL on failure.
+ */
+MagicFile* magic_file_map(const char* filepath);
+
 /**
  * @brief Closes the model file.
  *
@@ -192,6 +351,281 @@ MagicState magic_file_write_section_marker(MagicFile* magic_file, int64_t marker
  */
 MagicState magic_file_read_section_marker(MagicFile* magic_file, int64_t* marker, int64_t* size);
 
+/**
+ * @brief Finds a section by skipping over the sections before it.
+ *
+ * @param magic_file Pointer to the MagicFile structure, positioned at a section marker.
+ * @param marker The section marker identifier to find.
+ * @param size Pointer to store the size of the section found.
+ *
+ * Each skipped section is passed over using its recorded size and alignment
+ * padding, so its contents are never parsed. On success the file pointer is
+ * positioned at the first field of the section.
+ *
+ * @return MAGIC_SUCCESS if found, MAGIC_INVALID_MARKER if the end of the file is
+ *         reached first, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_seek_section(MagicFile* magic_file, int64_t marker, int64_t* size);
+
+// ------------------------ Tensor Section Functions ---------------------------
+
+/**
+ * @brief Writes the configuration and metadata fields of the Tensor Section.
+ *
+ * @param magic_file Pointer to the MagicFile structure, positioned after the section marker.
+ * @param section The fields to write.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState
+magic_file_write_tensor_section(MagicFile* magic_file, const MagicTensorSection* section);
+
+/**
+ * @brief Reads the configuration and metadata fields of the Tensor Section.
+ *
+ * @param magic_file Pointer to the MagicFile structure, positioned after the section marker.
+ * @param section Pointer to store the fields.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_read_tensor_section(MagicFile* magic_file, MagicTensorSection* section);
+
+/**
+ * @brief Rewrites the quant_profile field of an existing Tensor Section in place.
+ *
+ * The file must be open for update ("r+b"). A checksum of the section in the
+ * index is updated to match. The stream position is unspecified afterwards.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param profile The MagicQuantProfile that produced the tensors.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_INVALID_MARKER if the file has no Tensor
+ *         Section, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_write_quant_profile(MagicFile* magic_file, int32_t profile);
+
+/**
+ * @brief Writes the metadata of one tensor and pads to the start of its data.
+ *
+ * The caller writes the tensor data immediately afterwards.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param info The tensor metadata; offset and size are ignored.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR for invalid metadata, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_write_tensor_info(MagicFile* magic_file, const MagicTensorInfo* info);
+
+/**
+ * @brief Reads the metadata of one tensor and locates its data.
+ *
+ * On success the file pointer is positioned at the tensor data, and offset and
+ * size describe it. Seek to offset + size to read the next tensor.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param info Pointer to store the metadata. Release it with magic_tensor_info_free.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR for invalid metadata, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_read_tensor_info(MagicFile* magic_file, MagicTensorInfo* info);
+
+/**
+ * @brief Returns the data of a tensor inside a mapped file.
+ *
+ * The data is read-only, aligned to MAGIC_ALIGNMENT, and valid until the file is
+ * closed; wrap it with tensor_create_from_data to compute on it without a copy.
+ *
+ * @param magic_file Pointer to a MagicFile opened with magic_file_map.
+ * @param info Metadata read with magic_file_read_tensor_info.
+ *
+ * @return Pointer to info->size bytes of tensor data, or NULL if the file is not
+ *         mapped or the data lies outside it.
+ */
+const void* magic_file_tensor_data(MagicFile* magic_file, const MagicTensorInfo* info);
+
+/**
+ * @brief Releases the name owned by a MagicTensorInfo.
+ */
+void magic_tensor_info_free(MagicTensorInfo* info);
+
+// ------------------------ Index Section Functions ----------------------------
+
+/**
+ * @brief Records the location of a section being written.
+ *
+ * @param index The index to extend.
+ * @param marker The section marker identifier.
+ * @param offset File offset of the section marker.
+ * @param size The section size written after the marker.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if the entry cannot be stored.
+ */
+MagicState
+magic_index_add_section(MagicIndex* index, int64_t marker, int64_t offset, int64_t size);
+
+/**
+ * @brief Records the location of a tensor being written.
+ *
+ * @param index The index to extend.
+ * @param info The metadata passed to magic_file_write_tensor_info.
+ * @param info_offset File offset at which the metadata was written.
+ * @param data_offset File offset at which the tensor data starts.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR for invalid metadata or if the
+ *         entry cannot be stored.
+ */
+MagicState magic_index_add_tensor(
+    MagicIndex* index, const MagicTensorInfo* info, int64_t info_offset, int64_t data_offset
+);
+
+/**
+ * @brief Finds the entry of a section, or NULL if it is not indexed.
+ */
+const MagicIndexEntry* magic_index_find_section(const MagicIndex* index, int64_t marker);
+
+/**
+ * @brief Finds the first tensor with the given identity, or NULL if there is none.
+ *
+ * For example, block 17 with the layer and projection types of self_attn.q_proj,
+ * or the lm_head component with block index -2.
+ */
+const MagicTensorEntry* magic_index_find_tensor(
+    const MagicIndex* index,
+    int32_t component_type,
+    int32_t block_index,
+    int32_t layer_type,
+    int32_t projection_type
+);
+
+/**
+ * @brief Releases the entries owned by a MagicIndex.
+ */
+void magic_index_free(MagicIndex* index);
+
+/**
+ * @brief Writes the Index Section.
+ *
+ * Call after the last section is padded, immediately before the end marker. The
+ * section ends with its own offset, so readers find it from the end of the file.
+ *
+ * @param magic_file Pointer to the MagicFile structure, positioned on an alignment boundary.
+ * @param index The entries to write.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ALIGNMENT_ERROR if the stream is not
+ *         aligned, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_write_index(MagicFile* magic_file, const MagicIndex* index);
+
+/**
+ * @brief Reads the Index Section without parsing any other section.
+ *
+ * The stream position is unspecified afterwards; use magic_file_seek_entry or
+ * magic_file_read_tensor_entry to continue.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param index Pointer to store the entries. Release them with magic_index_free.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_INVALID_MARKER if the file has no index,
+ *         MAGIC_ERROR for an inconsistent index, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_read_index(MagicFile* magic_file, MagicIndex* index);
+
+/**
+ * @brief Jumps to an indexed section.
+ *
+ * On success the file pointer is positioned at the first field of the section,
+ * as after magic_file_seek_section.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param entry The section entry.
+ * @param size Pointer to store the size of the section.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_INVALID_MARKER if the entry does not
+ *         point at its section, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState
+magic_file_seek_entry(MagicFile* magic_file, const MagicIndexEntry* entry, int64_t* size);
+
+/**
+ * @brief Jumps to an indexed tensor and reads its metadata.
+ *
+ * On success the file pointer is positioned at the tensor data, as after
+ * magic_file_read_tensor_info.
+ *
+ * @param magic_file Pointer to the MagicFile structure.
+ * @param entry The tensor entry.
+ * @param info Pointer to store the metadata. Release it with magic_tensor_info_free.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if the metadata disagrees with
+ *         the entry, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_read_tensor_entry(
+    MagicFile* magic_file, const MagicTensorEntry* entry, MagicTensorInfo* info
+);
+
+/**
+ * @brief Computes the CRC-32C of an indexed tensor's data.
+ *
+ * Reads from the mapping, or with pread, so the stream position is unchanged
+ * and several threads may check one file at once.
+ *
+ * @param magic_file Pointer to the MagicFile structure, opened for reading.
+ * @param entry The tensor entry.
+ * @param checksum Pointer to store the checksum.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_checksum_tensor(
+    MagicFile* magic_file, const MagicTensorEntry* entry, uint64_t* checksum
+);
+
+/**
+ * @brief Computes the CRC-32C of an indexed section's fields.
+ *
+ * The checksum covers the bytes after the section size, except the data of the
+ * tensors of the index, which their own entries cover. As magic_file_checksum_tensor,
+ * the stream position is unchanged.
+ *
+ * @param magic_file Pointer to the MagicFile structure, opened for reading.
+ * @param index The index whose tensors are excluded.
+ * @param entry The section entry.
+ * @param checksum Pointer to store the checksum.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if the tensors are out of order
+ *         or outside the section, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_file_checksum_section(
+    MagicFile* magic_file, const MagicIndex* index, const MagicIndexEntry* entry, uint64_t* checksum
+);
+
+/**
+ * @brief Rewrites the recorded checksum of a section edited in place.
+ *
+ * Does nothing for files without an index or without checksums. Pending
+ * writes, such as the edit itself, are flushed before the section is read.
+ *
+ * @param magic_file Pointer to the MagicFile structure, opened for update.
+ * @param marker The marker of the edited section.
+ *
+ * @return MAGIC_SUCCESS on success, or the state of the failed read or write.
+ */
+MagicState magic_file_update_checksum(MagicFile* magic_file, int64_t marker);
+
+/**
+ * @brief Records the CRC-32C of every section and tensor of an index.
+ *
+ * For indexes built outside a MagicWriter, which checksums as it writes:
+ * compute them from the file read back before writing the Index Section.
+ * Pending writes are flushed first, so a file still being written can be
+ * checksummed in place if it was opened for update, e.g. "w+b".
+ *
+ * @param magic_file Pointer to the MagicFile structure, opened for reading or update.
+ * @param index The index to update.
+ *
+ * @return MAGIC_SUCCESS on success, or the state of the failed computation.
+ */
+MagicState magic_file_checksum_index(MagicFile* magic_file, MagicIndex* index);
+
 // ------------------------ End Marker Functions -------------------------------
 
 /**
@@ -218,6 +652,112 @@ MagicState magic_file_write_end_marker(MagicFile* magic_file);
  */
 MagicState magic_file_read_end_marker(MagicFile* magic_file);
 
+// ------------------------ MagicWriter Functions ------------------------------
+
+/**
+ * @brief Creates or truncates a model file for sequential writing.
+ *
+ * @param filepath The path to the model file.
+ * @param capacity Byte size of the write buffer, or 0 for MAGIC_WRITER_BUFFER.
+ *
+ * @return A MagicWriter pointer on success, or NULL on failure.
+ */
+MagicWriter* magic_writer_open(const char* filepath, size_t capacity);
+
+/**
+ * @brief Flushes the pending bytes, closes the file, and frees the writer.
+ *
+ * Call magic_writer_finish first to complete the file.
+ *
+ * @return MAGIC_SUCCESS on success, or MAGIC_FILE_ERROR if the file could not be
+ *         written or closed. The writer is freed either way.
+ */
+MagicState magic_writer_close(MagicWriter* writer);
+
+/**
+ * @brief Returns the file offset of the next byte written.
+ */
+int64_t magic_writer_tell(const MagicWriter* writer);
+
+/**
+ * @brief Appends bytes to the file.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_write(MagicWriter* writer, const void* data, size_t size);
+
+/**
+ * @brief Appends zero bytes up to the next MAGIC_ALIGNMENT boundary.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_pad(MagicWriter* writer);
+
+/**
+ * @brief Writes the pending bytes to the file.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_flush(MagicWriter* writer);
+
+/**
+ * @brief Writes the Start Marker and its padding. Must be written first.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_write_start_marker(MagicWriter* writer, int32_t version, int32_t alignment);
+
+/**
+ * @brief Opens a section by writing its marker and a placeholder size.
+ *
+ * The contents follow through magic_writer_write and the other writers.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if a section is already open,
+ *         MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_begin_section(MagicWriter* writer, int64_t marker);
+
+/**
+ * @brief Closes the open section: back-patches its size, pads, and indexes it.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if no section is open,
+ *         MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_end_section(MagicWriter* writer);
+
+/**
+ * @brief Writes the configuration and metadata fields of an open Tensor Section.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR outside a Tensor Section,
+ *         MAGIC_FILE_ERROR otherwise.
+ */
+MagicState
+magic_writer_write_tensor_section(MagicWriter* writer, const MagicTensorSection* section);
+
+/**
+ * @brief Writes the metadata and data of one tensor into an open Tensor Section.
+ *
+ * @param writer The writer.
+ * @param info The tensor metadata; offset and size are ignored.
+ * @param data The stored tensor data, of the size implied by the shape and type.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR for invalid metadata or outside
+ *         a Tensor Section, MAGIC_FILE_ERROR otherwise.
+ */
+MagicState
+magic_writer_write_tensor(MagicWriter* writer, const MagicTensorInfo* info, const void* data);
+
+/**
+ * @brief Completes the file with an optional Index Section and the end marker.
+ *
+ * @param writer The writer, with no section open.
+ * @param index Whether to write the Index Section of everything written.
+ *
+ * @return MAGIC_SUCCESS on success, MAGIC_ERROR if a section is open,
+ *         MAGIC_FILE_ERROR otherwise.
+ */
+MagicState magic_writer_finish(MagicWriter* writer, bool index);
+
 // ------------------------ Magic Field Functions ------------------------
 
 MagicState magic_file_read_bool_field(MagicFile* magic_file, bool* field);
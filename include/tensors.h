@@ -16,6 +16,8 @@ extern "C" {
 #include "interface/data_types.h"
 #include "interface/flex_array.h"
 
+#define TENSOR_MAX_RANK 8 /**< Maximum rank supported by cursors */
+
 /**
  * @enum TensorState
  * @brief Return codes for tensor operations.
@@ -32,6 +34,17 @@ typedef enum TensorState {
     TENSOR_MEMORY_ALLOCATION_FAILED /**< Memory allocation failed */
 } TensorState;
 
+/**
+ * @enum TensorLayout
+ * @brief Memory layout of the tensor elements.
+ */
+typedef enum TensorLayout {
+    TENSOR_LAYOUT_ROW_MAJOR, /**< Elements addressed through the strides */
+    TENSOR_LAYOUT_TILED /**< Rank 2 tiles stored contiguously, tiles in row-major order */
+} TensorLayout;
+
+#define TENSOR_TILE_PANEL 0 /**< Tile height spanning every row, i.e. column panels */
+
 /**
  * @struct Tensor
  * @brief Representation of an N-dimensional tensor.
@@ -39,14 +52,22 @@ typedef enum TensorState {
 typedef struct Tensor {
     uint32_t rank; /**< Number of dimensions */
     FlexArray* shape; /**< Array defining the size of each dimension */
+    FlexArray* stride; /**< Array defining the element step of each dimension (uint64) */
+    uint64_t size; /**< Number of elements, validated against overflow at creation */
     const DataType* type; /**< Data type of the tensor elements */
     void* data; /**< Flattened array storing tensor elements */
+    const struct Tensor* base; /**< Tensor owning the data for views, NULL if owned, self if borrowed */
+    TensorLayout layout; /**< Memory layout of the data */
+    uint32_t tile[2]; /**< Tile rows and columns in elements (tiled layout only) */
 } Tensor;
 
 /**
  * @brief Creates a new tensor with the specified data type, rank, and shape.
  *
  * The tensor takes ownership of the provided shape and frees it on failure.
+ * The element count and byte size are checked for overflow once here, so
+ * indexing never needs to repeat the check. Storage comes from the pooled
+ * allocator, is ALLOCATOR_ALIGNMENT aligned, and is zero-initialized.
  *
  * @param id Data type identifier for the tensor elements.
  * @param rank Number of dimensions.
@@ -55,10 +76,40 @@ typedef struct Tensor {
  */
 Tensor* tensor_create(DataTypeId id, uint32_t rank, uint32_t* dimensions);
 
+/**
+ * @brief Creates a new tensor without zero-filling its storage.
+ *
+ * Use this when the caller overwrites every element anyway, such as for
+ * activations and kernel outputs.
+ *
+ * @param id Data type identifier for the tensor elements.
+ * @param rank Number of dimensions.
+ * @param dimensions Array of length rank defining the shape.
+ * @return Pointer to the created tensor or NULL on failure.
+ */
+Tensor* tensor_create_uninitialized(DataTypeId id, uint32_t rank, uint32_t* dimensions);
+
+/**
+ * @brief Creates a contiguous tensor over caller-owned storage.
+ *
+ * The tensor borrows the data and never frees it, which lets arenas and
+ * mapped files back tensors without copies. The caller keeps the storage
+ * alive for the lifetime of the tensor and its views.
+ *
+ * @param id Data type identifier for the tensor elements.
+ * @param rank Number of dimensions.
+ * @param dimensions Array of length rank defining the shape.
+ * @param data Storage holding at least tensor_byte_size bytes.
+ * @return Pointer to the created tensor or NULL on failure.
+ */
+Tensor* tensor_create_from_data(DataTypeId id, uint32_t rank, uint32_t* dimensions, void* data);
+
 /**
  * @brief Frees a tensor and its owned resources.
  *
- * Frees the tensor's shape, data, and the tensor itself.
+ * Frees the tensor's shape, stride, data, and the tensor itself.
+ * Owned data is returned to the allocator pool for reuse.
+ * Views never free the data they share with their base tensor.
  *
  * @param tensor Pointer to the tensor to be freed.
  */
@@ -75,6 +126,18 @@ void tensor_free(Tensor* tensor);
  */
 FlexArray* tensor_create_shape(uint32_t rank, uint32_t* dimensions);
 
+/**
+ * @brief Dynamically creates a row-major stride object as a FlexArray.
+ *
+ * The last dimension is the fastest moving and has a stride of 1. Strides are
+ * stored as uint64 values.
+ *
+ * @param rank Number of dimensions.
+ * @param dimensions Array of length rank defining the shape.
+ * @return Pointer to the created FlexArray stride or NULL on failure.
+ */
+FlexArray* tensor_create_stride(uint32_t rank, uint32_t* dimensions);
+
 /**
  * @brief Dynamically creates a indices object as a FlexArray.
  *
@@ -90,30 +153,53 @@ FlexArray* tensor_create_indices(uint32_t rank, uint32_t* dimensions);
  * @brief Computes the size of the tensor based on its shape.
  *
  * @param tensor Pointer to the tensor.
- * @param size Pointer to store the computed size.
+ * @param size Pointer to store the computed number of elements.
  * @return TensorState indicating the result of the operation.
  */
-TensorState tensor_compute_shape(const Tensor* tensor, uint32_t* size);
+TensorState tensor_compute_shape(const Tensor* tensor, uint64_t* size);
+
+/**
+ * @brief Computes the number of bytes spanned by the tensor elements.
+ *
+ * @param tensor Pointer to the tensor.
+ * @return Size in bytes, or 0 if the tensor is invalid.
+ */
+size_t tensor_byte_size(const Tensor* tensor);
+
+/**
+ * @brief Checks whether the tensor elements are densely packed in row-major order.
+ *
+ * Tiled tensors are never contiguous.
+ *
+ * @param tensor Pointer to the tensor.
+ * @return true if the strides match a row-major layout of the shape, false otherwise.
+ */
+bool tensor_is_contiguous(const Tensor* tensor);
 
 /**
  * @brief Computes a flat index from multidimensional indices.
  *
+ * The flat index is the element offset from the tensor's data pointer and is
+ * derived from the tensor's strides, so it is valid for views as well.
+ *
  * @param tensor Pointer to the tensor.
  * @param indices FlexArray of indices.
  * @param index Pointer to store the computed flat index.
  * @return TensorState indicating the result of the operation.
  */
-TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices, uint32_t* index);
+TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices, uint64_t* index);
 
 /**
  * @brief Computes multidimensional indices from a flat index.
  *
+ * The flat index is interpreted in logical row-major order over the shape.
+ *
  * @param tensor Pointer to the tensor.
  * @param indices FlexArray to store the computed indices.
  * @param index Flat index.
  * @return TensorState indicating the result of the operation.
  */
-TensorState tensor_compute_array(const Tensor* tensor, FlexArray* indices, const uint32_t index);
+TensorState tensor_compute_array(const Tensor* tensor, FlexArray* indices, const uint64_t index);
 
 /**
  * @brief Retrieves an element from the tensor at the specified indices.
@@ -152,10 +238,249 @@ TensorState tensor_set_element(Tensor* tensor, const FlexArray* indices, void* v
  * - Calculates the size of the tensor's data using its shape and rank.
  * - Copies the data using `memcpy` for efficient bulk transfer.
  *
- * @note Assumes a dense tensor with compatible dimensions and a consistent memory layout.
+ * @note The source buffer is always read as dense row-major data. Strided views are
+ *       filled element by element.
  */
 TensorState tensor_set_bulk(Tensor* tensor, const void* data);
 
+// ------------------------------ Tensor Views ------------------------------
+
+/**
+ * @brief Creates a view restricted to a range along a single axis.
+ *
+ * The view shares the storage of the given tensor. No element data is copied
+ * and the cost is O(rank).
+ *
+ * @param tensor Pointer to the source tensor or view.
+ * @param axis Dimension to slice.
+ * @param start First index along the axis.
+ * @param length Number of indices to keep along the axis.
+ * @return Pointer to the created view or NULL on failure.
+ *
+ * @note The view must not outlive the tensor owning the storage.
+ */
+Tensor* tensor_view_slice(const Tensor* tensor, uint32_t axis, uint32_t start, uint32_t length);
+
+/**
+ * @brief Creates a view with two axes swapped.
+ *
+ * The view shares the storage of the given tensor. Only the shape and stride
+ * entries are exchanged, so the cost is O(rank).
+ *
+ * @param tensor Pointer to the source tensor or view.
+ * @param axis_a First axis to swap.
+ * @param axis_b Second axis to swap.
+ * @return Pointer to the created view or NULL on failure.
+ *
+ * @note The view must not outlive the tensor owning the storage.
+ */
+Tensor* tensor_view_transpose(const Tensor* tensor, uint32_t axis_a, uint32_t axis_b);
+
+/**
+ * @brief Creates a view with a new shape over the same elements.
+ *
+ * The total number of elements must match. Only contiguous tensors may be
+ * reshaped without a copy; strided views are rejected.
+ *
+ * @param tensor Pointer to the source tensor or view.
+ * @param rank Number of dimensions of the new shape.
+ * @param dimensions Array of length rank defining the new shape.
+ * @return Pointer to the created view or NULL on failure.
+ *
+ * @note The view must not outlive the tensor owning the storage.
+ */
+Tensor* tensor_view_reshape(const Tensor* tensor, uint32_t rank, uint32_t* dimensions);
+
+// ------------------------------ Tiled Layouts ------------------------------
+
+/**
+ * @brief Copies a rank 2 tensor into a tiled layout.
+ *
+ * Each tile of tile_rows x tile_cols elements is stored contiguously in
+ * row-major order, and tiles follow each other in row-major order. Edge tiles
+ * are zero padded. Column panels for the matmul kernels use
+ * tile_rows = TENSOR_TILE_PANEL and tile_cols = MATMUL_NR values.
+ *
+ * Repacking is meant to run once at load time. Element access works on the
+ * result, but views, cursors, and bulk writes require the row-major layout.
+ *
+ * @param tensor Row-major rank 2 tensor. May be a strided view.
+ * @param tile_rows Tile height in rows, or TENSOR_TILE_PANEL for full height.
+ * @param tile_cols Tile width in elements.
+ * @return Pointer to the tiled tensor or NULL on failure.
+ */
+Tensor* tensor_repack(const Tensor* tensor, uint32_t tile_rows, uint32_t tile_cols);
+
+/**
+ * @brief Copies a tiled tensor back into a new row-major tensor.
+ *
+ * @param tensor Tiled rank 2 tensor.
+ * @return Pointer to the row-major tensor or NULL on failure.
+ */
+Tensor* tensor_unpack(const Tensor* tensor);
+
+/**
+ * @brief Returns the element offset of (row, col) in a tiled tensor.
+ */
+static inline uint64_t tensor_tiled_offset(const Tensor* tensor, uint64_t row, uint64_t col) {
+    const uint64_t tile_rows = tensor->tile[0], tile_cols = tensor->tile[1];
+    const uint64_t cols = ((const uint32_t*) tensor->shape->data)[1];
+    const uint64_t tiles_per_row = (cols + tile_cols - 1) / tile_cols;
+    const uint64_t tile = (row / tile_rows) * tiles_per_row + col / tile_cols;
+    return (tile * tile_rows + row % tile_rows) * tile_cols + col % tile_cols;
+}
+
+// ------------------------------ Fast Access ------------------------------
+
+/**
+ * @brief Unchecked accessors for inner loops.
+ *
+ * These take plain coordinates and the tensor's precomputed strides and
+ * perform no validation. Bounds must be guaranteed by the caller, e.g. by
+ * looping over the tensor's shape or by walking a TensorCursor.
+ *
+ * @code
+ * const uint64_t* stride = tensor_stride_data(tensor);
+ * float* data = (float*) tensor->data;
+ * for (uint32_t i = 0; i < rows; i++) {
+ *     for (uint32_t j = 0; j < cols; j++) {
+ *         tensor_set_f32_2d(data, stride, i, j, 0.0f);
+ *     }
+ * }
+ * @endcode
+ */
+
+static inline const uint32_t* tensor_shape_data(const Tensor* tensor) {
+    return (const uint32_t*) tensor->shape->data;
+}
+
+static inline const uint64_t* tensor_stride_data(const Tensor* tensor) {
+    return (const uint64_t*) tensor->stride->data;
+}
+
+#define TENSOR_OFFSET_1D(s, i) ((i) * (s)[0])
+#define TENSOR_OFFSET_2D(s, i, j) ((i) * (s)[0] + (j) * (s)[1])
+#define TENSOR_OFFSET_3D(s, i, j, k) ((i) * (s)[0] + (j) * (s)[1] + (k) * (s)[2])
+#define TENSOR_OFFSET_4D(s, i, j, k, l) ((i) * (s)[0] + (j) * (s)[1] + (k) * (s)[2] + (l) * (s)[3])
+
+// Generates typed get/set accessors for ranks 1 through 4
+#define TENSOR_DEFINE_ACCESSORS(suffix, type) \
+    static inline type tensor_get_##suffix##_1d(const type* data, const uint64_t* s, uint64_t i) { \
+        return data[TENSOR_OFFSET_1D(s, i)]; \
+    } \
+    static inline type tensor_get_##suffix##_2d( \
+        const type* data, const uint64_t* s, uint64_t i, uint64_t j \
+    ) { \
+        return data[TENSOR_OFFSET_2D(s, i, j)]; \
+    } \
+    static inline type tensor_get_##suffix##_3d( \
+        const type* data, const uint64_t* s, uint64_t i, uint64_t j, uint64_t k \
+    ) { \
+        return data[TENSOR_OFFSET_3D(s, i, j, k)]; \
+    } \
+    static inline type tensor_get_##suffix##_4d( \
+        const type* data, const uint64_t* s, uint64_t i, uint64_t j, uint64_t k, uint64_t l \
+    ) { \
+        return data[TENSOR_OFFSET_4D(s, i, j, k, l)]; \
+    } \
+    static inline void tensor_set_##suffix##_1d(type* data, const uint64_t* s, uint64_t i, type v) { \
+        data[TENSOR_OFFSET_1D(s, i)] = v; \
+    } \
+    static inline void tensor_set_##suffix##_2d( \
+        type* data, const uint64_t* s, uint64_t i, uint64_t j, type v \
+    ) { \
+        data[TENSOR_OFFSET_2D(s, i, j)] = v; \
+    } \
+    static inline void tensor_set_##suffix##_3d( \
+        type* data, const uint64_t* s, uint64_t i, uint64_t j, uint64_t k, type v \
+    ) { \
+        data[TENSOR_OFFSET_3D(s, i, j, k)] = v; \
+    } \
+    static inline void tensor_set_##suffix##_4d( \
+        type* data, const uint64_t* s, uint64_t i, uint64_t j, uint64_t k, uint64_t l, type v \
+    ) { \
+        data[TENSOR_OFFSET_4D(s, i, j, k, l)] = v; \
+    }
+
+TENSOR_DEFINE_ACCESSORS(f32, float)
+TENSOR_DEFINE_ACCESSORS(f16, uint16_t)
+TENSOR_DEFINE_ACCESSORS(i32, int32_t)
+TENSOR_DEFINE_ACCESSORS(u8, uint8_t)
+
+// ------------------------------ Tensor Cursor ------------------------------
+
+/**
+ * @struct TensorCursor
+ * @brief Validated iterator over the elements of a tensor in logical row-major order.
+ *
+ * The tensor is validated once by tensor_cursor_init. Advancing the cursor is
+ * a pointer increment for contiguous tensors and an odometer step for strided
+ * views, with no per-element checks.
+ *
+ * @code
+ * TensorCursor cursor;
+ * if (tensor_cursor_init(&cursor, tensor) == TENSOR_SUCCESS) {
+ *     for (; tensor_cursor_valid(&cursor); tensor_cursor_next(&cursor)) {
+ *         *(float*) tensor_cursor_get(&cursor) = 1.0f;
+ *     }
+ * }
+ * @endcode
+ */
+typedef struct TensorCursor {
+    char* data; /**< Pointer to the current element */
+    uint64_t index; /**< Logical row-major position of the current element */
+    uint64_t size; /**< Number of elements to visit */
+    uint32_t element_size; /**< Size of a single element in bytes */
+    uint32_t rank; /**< Number of dimensions */
+    bool contiguous; /**< True if elements are densely packed */
+    uint32_t shape[TENSOR_MAX_RANK]; /**< Copy of the tensor shape */
+    uint64_t stride[TENSOR_MAX_RANK]; /**< Copy of the tensor strides in bytes */
+    uint32_t indices[TENSOR_MAX_RANK]; /**< Coordinates of the current element */
+} TensorCursor;
+
+/**
+ * @brief Validates a tensor and positions the cursor on its first element.
+ *
+ * @param cursor Pointer to the cursor to initialize.
+ * @param tensor Pointer to the tensor or view to walk.
+ * @return TensorState indicating the result of the operation.
+ */
+TensorState tensor_cursor_init(TensorCursor* cursor, const Tensor* tensor);
+
+/**
+ * @brief Checks whether the cursor points to an element.
+ */
+static inline bool tensor_cursor_valid(const TensorCursor* cursor) {
+    return cursor->index < cursor->size;
+}
+
+/**
+ * @brief Returns a pointer to the current element.
+ */
+static inline void* tensor_cursor_get(const TensorCursor* cursor) {
+    return cursor->data;
+}
+
+/**
+ * @brief Advances the cursor to the next element in logical row-major order.
+ */
+static inline void tensor_cursor_next(TensorCursor* cursor) {
+    cursor->index++;
+    if (cursor->contiguous) {
+        cursor->data += cursor->element_size;
+        return;
+    }
+
+    for (int axis = cursor->rank - 1; axis >= 0; --axis) {
+        cursor->data += cursor->stride[axis];
+        if (++cursor->indices[axis] < cursor->shape[axis]) {
+            return;
+        }
+        cursor->data -= cursor->stride[axis] * cursor->shape[axis];
+        cursor->indices[axis] = 0;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -1,10 +1,82 @@
 /**
+ * Copyright © 2024 Austin Berrio
+ *
  * @file include/threads.h
+ *
+ * @brief Persistent worker pool with a blocking parallel-for.
+ *
+ * Features:
+ * - Workers are created lazily on first use and parked between jobs.
+ * - A job splits a range into contiguous partitions; the caller runs the first one.
+ * - Nested calls from inside a task run serially instead of deadlocking.
+ *
+ * Notes:
+ * - Jobs are serialized: concurrent callers wait for each other.
  */
 
 #ifndef ALT_THREADS
 #define ALT_THREADS
 
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
 #include <pthread.h>
+#include <stdint.h>
+
+#define THREAD_MAX_COUNT 64 /**< Upper bound on worker threads (including the caller) */
+
+/**
+ * @brief Task executed for one partition of a parallel-for.
+ *
+ * @param context Caller supplied context.
+ * @param start First index of the partition (inclusive).
+ * @param end Last index of the partition (exclusive).
+ * @param partition Index of the partition, in [0, partitions).
+ */
+typedef void (*ThreadTask)(void* context, uint64_t start, uint64_t end, uint32_t partition);
+
+/**
+ * @brief Returns the number of threads used by parallel-for.
+ *
+ * Defaults to the number of online processors, capped at THREAD_MAX_COUNT.
+ */
+uint32_t thread_get_count(void);
+
+/**
+ * @brief Sets the number of threads used by parallel-for.
+ *
+ * @param count Number of threads. Zero restores the default.
+ */
+void thread_set_count(uint32_t count);
+
+/**
+ * @brief Returns the number of partitions a parallel-for would use.
+ *
+ * @param length Number of indices in the range.
+ * @param grain Minimum number of indices per partition.
+ * @return Number of partitions, at least 1.
+ */
+uint32_t thread_partitions(uint64_t length, uint64_t grain);
+
+/**
+ * @brief Runs task over [0, length) split into contiguous partitions and waits for completion.
+ *
+ * @param length Number of indices in the range.
+ * @param grain Minimum number of indices per partition.
+ * @param task Function executed once per partition.
+ * @param context Pointer passed through to task.
+ * @return Number of partitions used.
+ */
+uint32_t thread_parallel_for(uint64_t length, uint64_t grain, ThreadTask task, void* context);
+
+/**
+ * @brief Stops and joins all pool workers. The pool restarts on the next parallel-for.
+ */
+void thread_pool_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
 
 #endif // ALT_THREADS
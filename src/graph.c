@@ -0,0 +1,526 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/graph.c
+ *
+ * @brief Lazy tensor expression graph with operator fusion and arena memory planning.
+ *
+ * Planning runs three passes over the nodes in recording order:
+ * - Fusion: an elementwise node absorbs its producer when it is the producer's
+ *   only consumer, prepending the producer's work to its own steps. Fusion only
+ *   rewrites the planned stages, so the recording can grow and be planned again.
+ * - Liveness: every materialized value records the last node that reads it.
+ * - Placement: values are assigned first-fit offsets among the blocks still
+ *   live, and elementwise nodes overwrite a source that dies at that node.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "interface/allocator.h"
+#include "interface/logger.h"
+
+#include "graph.h"
+
+#define GRAPH_ALWAYS_LIVE UINT32_MAX
+
+// Live block of the arena during placement
+typedef struct GraphBlock {
+    uint64_t offset;
+    uint64_t end;
+    GraphNode* node;
+} GraphBlock;
+
+// Recording
+
+Graph* graph_create(void) {
+    Graph* graph = (Graph*) calloc(1, sizeof(Graph));
+    if (!graph) {
+        LOG_ERROR("%s: Failed to allocate memory for Graph.\n", __func__);
+    }
+    return graph;
+}
+
+// Releases the arena and the tensors created by the last plan
+static void graph_release_plan(Graph* graph) {
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (GRAPH_INPUT != node->op) {
+            tensor_free(node->tensor);
+            node->tensor = NULL;
+        }
+    }
+    allocator_free(graph->arena);
+    graph->arena = NULL;
+    graph->arena_size = 0;
+    graph->planned = false;
+}
+
+void graph_free(Graph* graph) {
+    if (!graph) {
+        return;
+    }
+
+    graph_release_plan(graph);
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        free(graph->nodes[i]);
+    }
+    free(graph->nodes);
+    free(graph);
+}
+
+static GraphNode* graph_add_node(
+    Graph* graph, GraphOp op, DataTypeId type, uint32_t rank, const uint32_t* shape
+) {
+    if (graph->count == graph->capacity) {
+        uint32_t capacity = graph->capacity ? graph->capacity * 2 : 16;
+        GraphNode** nodes = (GraphNode**) realloc(graph->nodes, capacity * sizeof(GraphNode*));
+        if (!nodes) {
+            LOG_ERROR("%s: Failed to grow node list to %u entries.\n", __func__, capacity);
+            return NULL;
+        }
+        graph->nodes = nodes;
+        graph->capacity = capacity;
+    }
+
+    GraphNode* node = (GraphNode*) calloc(1, sizeof(GraphNode));
+    if (!node) {
+        LOG_ERROR("%s: Failed to allocate memory for GraphNode.\n", __func__);
+        return NULL;
+    }
+
+    node->op = op;
+    node->id = graph->count;
+    node->type = type;
+    node->rank = rank;
+    memcpy(node->shape, shape, rank * sizeof(uint32_t));
+
+    graph->nodes[graph->count++] = node;
+    graph->planned = false;
+    return node;
+}
+
+GraphNode* graph_input(Graph* graph, Tensor* tensor) {
+    if (!graph || !tensor || !tensor->data || tensor->rank > TENSOR_MAX_RANK) {
+        LOG_ERROR("%s: Invalid graph or tensor provided.\n", __func__);
+        return NULL;
+    }
+
+    GraphNode* node
+        = graph_add_node(graph, GRAPH_INPUT, tensor->type->id, tensor->rank, tensor_shape_data(tensor));
+    if (node) {
+        node->tensor = tensor;
+    }
+    return node;
+}
+
+GraphNode* graph_matmul(Graph* graph, GraphNode* a, GraphNode* b) {
+    if (!graph || !a || !b) {
+        return NULL; // Propagate failures from earlier recordings
+    }
+    if (2 != a->rank || 2 != b->rank || TYPE_FLOAT32 != a->type) {
+        LOG_ERROR("%s: Expected a float32 [M, K] activation and a [K, N] weight.\n", __func__);
+        return NULL;
+    }
+    if (a->shape[1] != b->shape[0]) {
+        LOG_ERROR("%s: Inner dimensions differ: %u != %u.\n", __func__, a->shape[1], b->shape[0]);
+        return NULL;
+    }
+
+    uint32_t columns = b->shape[1] * data_type_values(b->type);
+    GraphNode* node
+        = graph_add_node(graph, GRAPH_MATMUL, TYPE_FLOAT32, 2, (uint32_t[]){a->shape[0], columns});
+    if (node) {
+        node->source = a;
+        node->weight = b;
+    }
+    return node;
+}
+
+GraphNode* graph_binary(Graph* graph, ElementwiseOp op, GraphNode* a, GraphNode* b) {
+    if (!graph || !a || !b) {
+        return NULL;
+    }
+    if (op > ELEMENTWISE_DIV || TYPE_FLOAT32 != a->type || TYPE_FLOAT32 != b->type) {
+        LOG_ERROR("%s: Expected a binary op on float32 nodes.\n", __func__);
+        return NULL;
+    }
+
+    // Broadcast shape with trailing dimensions aligned
+    uint32_t rank = a->rank > b->rank ? a->rank : b->rank;
+    uint32_t shape[TENSOR_MAX_RANK];
+    for (uint32_t d = 0; d < rank; ++d) {
+        uint32_t da = d + a->rank >= rank ? a->shape[d + a->rank - rank] : 1;
+        uint32_t db = d + b->rank >= rank ? b->shape[d + b->rank - rank] : 1;
+        if (da != db && 1 != da && 1 != db) {
+            LOG_ERROR("%s: Cannot broadcast dimension %u (%u vs %u).\n", __func__, d, da, db);
+            return NULL;
+        }
+        shape[d] = 1 == da ? db : da;
+    }
+
+    GraphNode* node = graph_add_node(graph, GRAPH_ELEMENTWISE, TYPE_FLOAT32, rank, shape);
+    if (node) {
+        node->source = a;
+        node->steps[0] = (ElementwiseStep) {.op = op};
+        node->operands[0] = b;
+        node->count = 1;
+    }
+    return node;
+}
+
+static GraphNode* graph_unary(Graph* graph, GraphNode* x, ElementwiseStep step) {
+    if (!graph || !x) {
+        return NULL;
+    }
+    if (TYPE_FLOAT32 != x->type) {
+        LOG_ERROR("%s: Expected a float32 node.\n", __func__);
+        return NULL;
+    }
+
+    GraphNode* node = graph_add_node(graph, GRAPH_ELEMENTWISE, TYPE_FLOAT32, x->rank, x->shape);
+    if (node) {
+        node->source = x;
+        node->steps[0] = step;
+        node->count = 1;
+    }
+    return node;
+}
+
+GraphNode* graph_scale(Graph* graph, GraphNode* x, float alpha) {
+    return graph_unary(graph, x, (ElementwiseStep) {.op = ELEMENTWISE_SCALE, .scalar = alpha});
+}
+
+GraphNode* graph_activate(Graph* graph, GraphNode* x, ElementwiseFunction function) {
+    if (!function) {
+        LOG_ERROR("%s: Invalid activation function.\n", __func__);
+        return NULL;
+    }
+    return graph_unary(
+        graph, x, (ElementwiseStep) {.op = ELEMENTWISE_ACTIVATE, .function = function}
+    );
+}
+
+GraphNode* graph_reduce(Graph* graph, GraphNode* x, uint32_t axis, ReduceOp op) {
+    if (!graph || !x) {
+        return NULL;
+    }
+    if (TYPE_FLOAT32 != x->type || axis >= x->rank) {
+        LOG_ERROR("%s: Expected a float32 node with axis < rank.\n", __func__);
+        return NULL;
+    }
+
+    // Drop the reduced axis; rank 1 inputs reduce to [1]
+    uint32_t shape[TENSOR_MAX_RANK] = {1};
+    uint32_t rank = 0;
+    for (uint32_t d = 0; d < x->rank; ++d) {
+        if (d != axis) {
+            shape[rank++] = x->shape[d];
+        }
+    }
+
+    DataTypeId type = REDUCE_ARGMAX == op ? TYPE_UINT32 : TYPE_FLOAT32;
+    GraphNode* node = graph_add_node(graph, GRAPH_REDUCE, type, rank ? rank : 1, shape);
+    if (node) {
+        node->source = x;
+        node->reduce = op;
+        node->axis = axis;
+    }
+    return node;
+}
+
+void graph_mark_output(GraphNode* node) {
+    if (node) {
+        node->output = true;
+    }
+}
+
+// Fusion
+
+static bool graph_same_shape(const GraphNode* a, const GraphNode* b) {
+    return a->rank == b->rank && 0 == memcmp(a->shape, b->shape, a->rank * sizeof(uint32_t));
+}
+
+// Returns true if node can absorb producer as the first stage of its steps
+static bool graph_fusible(const GraphNode* producer, const GraphNode* node) {
+    return producer && GRAPH_INPUT != producer->op && !producer->absorbed && !producer->output
+           && 1 == producer->consumers && TYPE_FLOAT32 == producer->type
+           && graph_same_shape(producer, node)
+           && producer->stage.count + node->stage.count <= ELEMENTWISE_MAX_STEPS;
+}
+
+// Restores every stage to the recorded op and counts the consumers of each value
+static void graph_reset_stages(Graph* graph) {
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        node->stage = (GraphStage) {
+            .op = node->op,
+            .source = node->source,
+            .weight = node->weight,
+            .reduce = node->reduce,
+            .axis = node->axis,
+            .count = node->count,
+        };
+        memcpy(node->stage.steps, node->steps, node->count * sizeof(ElementwiseStep));
+        memcpy(node->stage.operands, node->operands, node->count * sizeof(GraphNode*));
+        node->consumers = 0;
+        node->absorbed = false;
+    }
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (node->source) {
+            node->source->consumers++;
+        }
+        if (node->weight) {
+            node->weight->consumers++;
+        }
+        for (uint32_t s = 0; s < node->count; ++s) {
+            if (node->operands[s]) {
+                node->operands[s]->consumers++;
+            }
+        }
+    }
+}
+
+static void graph_fuse(Graph* graph) {
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        GraphStage* stage = &node->stage;
+        if (GRAPH_ELEMENTWISE != stage->op) {
+            continue;
+        }
+
+        // Commutative ops may swap operands to put the fusible producer first
+        ElementwiseOp op = stage->steps[0].op;
+        if (1 == stage->count && (ELEMENTWISE_ADD == op || ELEMENTWISE_MUL == op)
+            && !graph_fusible(stage->source, node) && graph_fusible(stage->operands[0], node)) {
+            GraphNode* swap = stage->source;
+            stage->source = stage->operands[0];
+            stage->operands[0] = swap;
+        }
+
+        GraphNode* producer = stage->source;
+        if (!graph_fusible(producer, node)) {
+            continue;
+        }
+
+        // Producer steps run first, then this node's steps
+        const GraphStage* first = &producer->stage;
+        GraphStage fused = *first;
+        memcpy(fused.steps + first->count, stage->steps, stage->count * sizeof(ElementwiseStep));
+        memcpy(fused.operands + first->count, stage->operands, stage->count * sizeof(GraphNode*));
+        fused.count += stage->count;
+
+        *stage = fused;
+        producer->absorbed = true;
+    }
+}
+
+// Liveness and placement
+
+static void graph_touch(GraphNode* value, uint32_t id) {
+    if (value && GRAPH_ALWAYS_LIVE != value->last_use && id > value->last_use) {
+        value->last_use = id;
+    }
+}
+
+static void graph_liveness(Graph* graph) {
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        node->last_use = node->output ? GRAPH_ALWAYS_LIVE : node->id;
+    }
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (node->absorbed) {
+            continue;
+        }
+        const GraphStage* stage = &node->stage;
+        graph_touch(stage->source, node->id);
+        graph_touch(stage->weight, node->id);
+        for (uint32_t s = 0; s < stage->count; ++s) {
+            graph_touch(stage->operands[s], node->id);
+        }
+    }
+}
+
+// Returns true if an elementwise node may overwrite its source in place
+static bool graph_in_place(const GraphNode* node) {
+    const GraphStage* stage = &node->stage;
+    const GraphNode* source = stage->source;
+    if (GRAPH_ELEMENTWISE != stage->op || GRAPH_INPUT == source->op || source->output
+        || source->last_use != node->id || !graph_same_shape(source, node)) {
+        return false;
+    }
+    for (uint32_t s = 0; s < stage->count; ++s) {
+        if (stage->operands[s] == source) {
+            return false; // Later steps would read values already overwritten
+        }
+    }
+    return true;
+}
+
+static TensorState graph_place(Graph* graph) {
+    GraphBlock* blocks = (GraphBlock*) malloc((graph->count + 1) * sizeof(GraphBlock));
+    if (!blocks) {
+        LOG_ERROR("%s: Failed to allocate placement blocks.\n", __func__);
+        return TENSOR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    uint32_t live = 0;
+    uint64_t arena_size = 0;
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (GRAPH_INPUT == node->op || node->absorbed) {
+            continue;
+        }
+
+        uint64_t size = 1;
+        for (uint32_t d = 0; d < node->rank; ++d) {
+            size *= node->shape[d];
+        }
+        node->bytes = (size_t) size * data_type_size(node->type);
+        const uint64_t bytes = (node->bytes + GRAPH_ALIGNMENT - 1) & ~((uint64_t) GRAPH_ALIGNMENT - 1);
+
+        // Release blocks whose values are no longer read
+        uint32_t kept = 0;
+        for (uint32_t b = 0; b < live; ++b) {
+            if (blocks[b].node->last_use >= node->id) {
+                blocks[kept++] = blocks[b];
+            }
+        }
+        live = kept;
+
+        // Reuse a dying source in place
+        if (graph_in_place(node)) {
+            for (uint32_t b = 0; b < live; ++b) {
+                if (blocks[b].node == node->stage.source) {
+                    blocks[b].node = node;
+                    break;
+                }
+            }
+            node->offset = node->stage.source->offset;
+            continue;
+        }
+
+        // First fit among the gaps between live blocks (kept sorted by offset)
+        uint64_t offset = 0;
+        uint32_t position = 0;
+        for (; position < live; ++position) {
+            if (blocks[position].offset >= offset + bytes) {
+                break;
+            }
+            if (blocks[position].end > offset) {
+                offset = blocks[position].end;
+            }
+        }
+
+        memmove(&blocks[position + 1], &blocks[position], (live - position) * sizeof(GraphBlock));
+        blocks[position] = (GraphBlock) {.offset = offset, .end = offset + bytes, .node = node};
+        live++;
+
+        node->offset = offset;
+        if (offset + bytes > arena_size) {
+            arena_size = offset + bytes;
+        }
+    }
+
+    free(blocks);
+    graph->arena_size = (size_t) arena_size;
+    return TENSOR_SUCCESS;
+}
+
+TensorState graph_plan(Graph* graph) {
+    if (!graph) {
+        LOG_ERROR("%s: Invalid graph provided.\n", __func__);
+        return TENSOR_ERROR;
+    }
+
+    graph_release_plan(graph);
+    graph_reset_stages(graph);
+    graph_fuse(graph);
+    graph_liveness(graph);
+
+    TensorState state = graph_place(graph);
+    if (TENSOR_SUCCESS != state) {
+        return state;
+    }
+
+    if (graph->arena_size) {
+        graph->arena = allocator_alloc(graph->arena_size, GRAPH_ALIGNMENT, ALLOCATOR_NONE);
+        if (!graph->arena) {
+            LOG_ERROR("%s: Failed to allocate a %zu byte arena.\n", __func__, graph->arena_size);
+            return TENSOR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (GRAPH_INPUT == node->op || node->absorbed) {
+            continue;
+        }
+
+        void* data = (char*) graph->arena + node->offset;
+        node->tensor = tensor_create_from_data(node->type, node->rank, node->shape, data);
+        if (!node->tensor) {
+            LOG_ERROR("%s: Failed to create tensor for node %u.\n", __func__, node->id);
+            graph_release_plan(graph);
+            return TENSOR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    graph->planned = true;
+    return TENSOR_SUCCESS;
+}
+
+// Execution
+
+TensorState graph_execute(Graph* graph) {
+    if (!graph || !graph->planned) {
+        LOG_ERROR("%s: Graph must be planned before execution.\n", __func__);
+        return TENSOR_ERROR;
+    }
+
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        GraphNode* node = graph->nodes[i];
+        if (GRAPH_INPUT == node->op || node->absorbed) {
+            continue;
+        }
+
+        GraphStage* stage = &node->stage;
+        for (uint32_t s = 0; s < stage->count; ++s) {
+            stage->steps[s].operand = stage->operands[s] ? stage->operands[s]->tensor : NULL;
+        }
+
+        TensorState state = TENSOR_SUCCESS;
+        switch (stage->op) {
+            case GRAPH_ELEMENTWISE:
+                state = tensor_elementwise(
+                    stage->source->tensor, stage->steps, stage->count, node->tensor
+                );
+                break;
+            case GRAPH_MATMUL:
+                state = tensor_matmul(stage->source->tensor, stage->weight->tensor, node->tensor);
+                break;
+            case GRAPH_REDUCE:
+                state = tensor_reduce(
+                    stage->source->tensor, stage->axis, stage->reduce, node->tensor
+                );
+                break;
+            default:
+                state = TENSOR_ERROR;
+                break;
+        }
+
+        // Fused epilogue of a matmul or reduction runs in place on its result
+        if (TENSOR_SUCCESS == state && GRAPH_ELEMENTWISE != stage->op && stage->count > 0) {
+            state = tensor_elementwise(node->tensor, stage->steps, stage->count, node->tensor);
+        }
+
+        if (TENSOR_SUCCESS != state) {
+            LOG_ERROR("%s: Node %u failed with state %d.\n", __func__, node->id, state);
+            return state;
+        }
+    }
+
+    return TENSOR_SUCCESS;
+}
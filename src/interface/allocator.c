@@ -0,0 +1,291 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/interface/allocator.c
+ *
+ * @brief Aligned, pooled storage allocator for tensor data.
+ *
+ * Every buffer is preceded by a block header stored in the alignment padding,
+ * so a buffer can be returned to the pool of its size class without the caller
+ * tracking its size. Freed blocks form an intrusive singly linked list per class.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "interface/logger.h"
+
+#include "interface/allocator.h"
+
+#define ALLOCATOR_MAGIC 0xA110CA7Eu
+#define ALLOCATOR_CLASS_STEPS 4 // Size classes per power of two
+#define ALLOCATOR_CLASS_COUNT (64 * ALLOCATOR_CLASS_STEPS)
+
+typedef enum AllocatorKind {
+    ALLOCATOR_KIND_HEAP, // posix_memalign
+    ALLOCATOR_KIND_MAP // mmap, possibly with huge pages
+} AllocatorKind;
+
+typedef struct AllocatorBlock {
+    struct AllocatorBlock* next; // Next free block in the same size class
+    void* base; // Start of the underlying allocation
+    size_t capacity; // Usable bytes after the header padding
+    size_t length; // Bytes of the underlying allocation
+    uint32_t alignment; // Alignment of the user pointer
+    uint32_t kind; // AllocatorKind
+    uint32_t class_index; // Size class of the capacity
+    uint32_t magic; // Guards against foreign pointers
+} AllocatorBlock;
+
+_Static_assert(sizeof(AllocatorBlock) <= ALLOCATOR_ALIGNMENT, "Block header exceeds alignment");
+
+static pthread_mutex_t allocator_mutex = PTHREAD_MUTEX_INITIALIZER;
+static AllocatorBlock* allocator_pools[ALLOCATOR_CLASS_COUNT];
+static size_t allocator_cache_limit = ALLOCATOR_CACHE_LIMIT;
+static AllocatorStats allocator_stats;
+
+// Size classes
+
+// Rounds a size up to its class and returns the class index
+static uint32_t allocator_size_class(size_t size, size_t* capacity) {
+    if (size <= ALLOCATOR_ALIGNMENT) {
+        *capacity = ALLOCATOR_ALIGNMENT;
+        return 0;
+    }
+
+    // Split each power of two into ALLOCATOR_CLASS_STEPS evenly spaced classes
+    uint32_t exponent = 63 - (uint32_t) __builtin_clzll((unsigned long long) size - 1);
+    size_t step = (size_t) 1 << (exponent - 2);
+    size_t rounded = (size + step - 1) & ~(step - 1);
+    uint32_t sub = (uint32_t) (rounded >> (exponent - 2)) - ALLOCATOR_CLASS_STEPS - 1;
+
+    *capacity = rounded;
+    return exponent * ALLOCATOR_CLASS_STEPS + sub;
+}
+
+static AllocatorBlock* allocator_block(const void* ptr) {
+    AllocatorBlock* block = (AllocatorBlock*) ((char*) ptr - sizeof(AllocatorBlock));
+    return ALLOCATOR_MAGIC == block->magic ? block : NULL;
+}
+
+// System allocations
+
+static void* allocator_map(size_t length, uint32_t flags, bool* huge) {
+    *huge = false;
+
+#ifdef MAP_HUGETLB
+    // Explicit huge pages only succeed when the system has a reserved pool
+    if (flags & ALLOCATOR_HUGE_PAGES) {
+        void* base = mmap(
+            NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+        );
+        if (MAP_FAILED != base) {
+            *huge = true;
+            return base;
+        }
+    }
+#endif
+
+    void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == base) {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    // Fall back to transparent huge pages; failure only costs performance
+    if ((flags & ALLOCATOR_HUGE_PAGES) && 0 == madvise(base, length, MADV_HUGEPAGE)) {
+        *huge = true;
+    }
+#endif
+
+    return base;
+}
+
+static AllocatorBlock* allocator_create_block(
+    size_t capacity, uint32_t class_index, size_t alignment, uint32_t flags, bool* zeroed
+) {
+    size_t length = 0;
+    if (__builtin_add_overflow(capacity, alignment, &length)) {
+        LOG_ERROR("%s: Allocation size overflow detected: capacity=%zu.\n", __func__, capacity);
+        return NULL;
+    }
+
+    void* base = NULL;
+    uint32_t kind = ALLOCATOR_KIND_HEAP;
+    bool huge = false;
+
+    if ((flags & ALLOCATOR_HUGE_PAGES) && capacity >= ALLOCATOR_HUGE_PAGE_THRESHOLD) {
+        length = (length + ALLOCATOR_HUGE_PAGE_SIZE - 1) & ~(ALLOCATOR_HUGE_PAGE_SIZE - 1);
+        base = allocator_map(length, flags, &huge);
+        kind = ALLOCATOR_KIND_MAP;
+        *zeroed = true; // Anonymous mappings are zero-filled by the kernel
+    } else if (0 != posix_memalign(&base, alignment, length)) {
+        base = NULL;
+    }
+
+    if (!base) {
+        LOG_ERROR("%s: Failed to allocate %zu bytes.\n", __func__, length);
+        return NULL;
+    }
+
+    // The header sits directly in front of the aligned user pointer
+    AllocatorBlock* block = (AllocatorBlock*) ((char*) base + alignment - sizeof(AllocatorBlock));
+    block->next = NULL;
+    block->base = base;
+    block->capacity = capacity;
+    block->length = length;
+    block->alignment = (uint32_t) alignment;
+    block->kind = kind;
+    block->class_index = class_index;
+    block->magic = ALLOCATOR_MAGIC;
+
+    if (huge) {
+        __atomic_add_fetch(&allocator_stats.huge_pages, 1, __ATOMIC_RELAXED);
+    }
+
+    return block;
+}
+
+static void allocator_release_block(AllocatorBlock* block) {
+    block->magic = 0;
+    if (ALLOCATOR_KIND_MAP == block->kind) {
+        munmap(block->base, block->length);
+    } else {
+        free(block->base);
+    }
+}
+
+// Public interface
+
+void* allocator_alloc(size_t size, size_t alignment, uint32_t flags) {
+    if (alignment < ALLOCATOR_ALIGNMENT) {
+        alignment = ALLOCATOR_ALIGNMENT;
+    }
+    if (alignment & (alignment - 1) || alignment > UINT32_MAX) {
+        LOG_ERROR("%s: Alignment must be a power of two: alignment=%zu.\n", __func__, alignment);
+        return NULL;
+    }
+    if (size > SIZE_MAX / 2) {
+        LOG_ERROR("%s: Allocation size overflow detected: size=%zu.\n", __func__, size);
+        return NULL;
+    }
+
+    size_t capacity = 0;
+    uint32_t class_index = allocator_size_class(size, &capacity);
+
+    AllocatorBlock* block = NULL;
+    bool zeroed = false;
+
+    pthread_mutex_lock(&allocator_mutex);
+    allocator_stats.allocations++;
+
+    // Reuse the first pooled block that satisfies the requested alignment
+    AllocatorBlock** link = &allocator_pools[class_index];
+    while (*link) {
+        if ((*link)->alignment >= alignment) {
+            block = *link;
+            *link = block->next;
+            allocator_stats.cached_bytes -= block->capacity;
+            allocator_stats.reuses++;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    pthread_mutex_unlock(&allocator_mutex);
+
+    if (!block) {
+        block = allocator_create_block(capacity, class_index, alignment, flags, &zeroed);
+    }
+
+    if (!block) {
+        return NULL;
+    }
+
+    block->next = NULL;
+    void* ptr = (char*) block + sizeof(AllocatorBlock);
+    if ((flags & ALLOCATOR_ZERO) && !zeroed) {
+        memset(ptr, 0, size);
+    }
+
+    return ptr;
+}
+
+void allocator_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    AllocatorBlock* block = allocator_block(ptr);
+    if (!block) {
+        LOG_ERROR("%s: Pointer %p was not allocated by the allocator.\n", __func__, ptr);
+        return;
+    }
+
+    pthread_mutex_lock(&allocator_mutex);
+    if (allocator_stats.cached_bytes + block->capacity <= allocator_cache_limit) {
+        block->next = allocator_pools[block->class_index];
+        allocator_pools[block->class_index] = block;
+        allocator_stats.cached_bytes += block->capacity;
+        block = NULL;
+    }
+    pthread_mutex_unlock(&allocator_mutex);
+
+    if (block) {
+        allocator_release_block(block); // Pool is full
+    }
+}
+
+size_t allocator_capacity(const void* ptr) {
+    if (!ptr) {
+        return 0;
+    }
+
+    AllocatorBlock* block = allocator_block(ptr);
+    return block ? block->capacity : 0;
+}
+
+void allocator_set_cache_limit(size_t limit) {
+    pthread_mutex_lock(&allocator_mutex);
+    allocator_cache_limit = limit;
+    bool trim = allocator_stats.cached_bytes > limit;
+    pthread_mutex_unlock(&allocator_mutex);
+
+    if (trim) {
+        allocator_trim();
+    }
+}
+
+void allocator_trim(void) {
+    AllocatorBlock* released = NULL;
+
+    // Detach every pool under the lock, then release outside of it
+    pthread_mutex_lock(&allocator_mutex);
+    for (uint32_t i = 0; i < ALLOCATOR_CLASS_COUNT; i++) {
+        while (allocator_pools[i]) {
+            AllocatorBlock* block = allocator_pools[i];
+            allocator_pools[i] = block->next;
+            block->next = released;
+            released = block;
+        }
+    }
+    allocator_stats.cached_bytes = 0;
+    pthread_mutex_unlock(&allocator_mutex);
+
+    while (released) {
+        AllocatorBlock* next = released->next;
+        allocator_release_block(released);
+        released = next;
+    }
+}
+
+void allocator_get_stats(AllocatorStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&allocator_mutex);
+    *stats = allocator_stats;
+    pthread_mutex_unlock(&allocator_mutex);
+}
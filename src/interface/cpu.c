@@ -0,0 +1,176 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/interface/cpu.c
+ *
+ * @brief Runtime detection of the instruction set extensions of the host CPU.
+ *
+ * A feature only counts as available when the OS also saves its registers:
+ * AVX needs the YMM state and AVX-512 the opmask and ZMM state in XCR0.
+ */
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interface/logger.h"
+
+#include "interface/cpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+    #include <sys/auxv.h>
+#endif
+
+static const char* const cpu_feature_names[CPU_FEATURE_COUNT] = {
+    "sse4.2",
+    "avx2",
+    "fma",
+    "f16c",
+    "avx512f",
+    "avx512bw",
+    "avx512vl",
+    "avx512vnni",
+    "avxvnni",
+    "neon",
+    "dotprod",
+    "crc32",
+};
+
+const char* cpu_feature_name(CpuFeature feature) {
+    for (uint32_t i = 0; i < CPU_FEATURE_COUNT; ++i) {
+        if ((uint32_t) feature == 1u << i) {
+            return cpu_feature_names[i];
+        }
+    }
+    return NULL;
+}
+
+// Host probes
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Register state the OS saves on context switches
+static uint64_t cpu_xgetbv(void) {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t) edx << 32) | eax;
+}
+
+static uint32_t cpu_probe_host(void) {
+    uint32_t eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+
+    uint32_t features = ecx & (1u << 20) ? CPU_SSE42 : 0;
+    const bool osxsave = ecx & (1u << 27);
+    const bool avx = ecx & (1u << 28);
+    const bool fma = ecx & (1u << 12);
+    const bool f16c = ecx & (1u << 29);
+
+    const uint64_t xcr0 = osxsave ? cpu_xgetbv() : 0;
+    const bool ymm = 0x6 == (xcr0 & 0x6); // SSE and AVX state
+    const bool zmm = ymm && 0xE0 == (xcr0 & 0xE0); // Opmask, ZMM_Hi256, and Hi16_ZMM state
+    if (!avx || !ymm) {
+        return features;
+    }
+    features |= (fma ? CPU_FMA : 0) | (f16c ? CPU_F16C : 0);
+
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return features;
+    }
+    uint32_t subleaves;
+    __cpuid_count(7, 0, subleaves, ebx, ecx, edx);
+    features |= ebx & (1u << 5) ? CPU_AVX2 : 0;
+    if (zmm) {
+        features |= ebx & (1u << 16) ? CPU_AVX512F : 0;
+        features |= ebx & (1u << 30) ? CPU_AVX512BW : 0;
+        features |= ebx & (1u << 31) ? CPU_AVX512VL : 0;
+        features |= ecx & (1u << 11) ? CPU_AVX512VNNI : 0;
+    }
+    if (subleaves >= 1) {
+        __cpuid_count(7, 1, eax, ebx, ecx, edx);
+        features |= eax & (1u << 4) ? CPU_AVXVNNI : 0;
+    }
+    return features;
+}
+
+#elif defined(__aarch64__)
+
+static uint32_t cpu_probe_host(void) {
+    #if defined(__linux__)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    uint32_t features = hwcap & (1ul << 1) ? CPU_NEON : 0; // HWCAP_ASIMD
+    features |= hwcap & (1ul << 20) ? CPU_DOTPROD : 0; // HWCAP_ASIMDDP
+    features |= hwcap & (1ul << 7) ? CPU_CRC32 : 0; // HWCAP_CRC32
+    return features;
+    #else
+    return CPU_NEON; // Advanced SIMD is mandatory in AArch64
+    #endif
+}
+
+#else
+
+static uint32_t cpu_probe_host(void) {
+    return 0;
+}
+
+#endif
+
+// Masks the comma-separated feature names out of features
+static uint32_t cpu_mask(uint32_t features, const char* disabled) {
+    while (disabled && *disabled) {
+        const char* end = strchr(disabled, ',');
+        size_t length = end ? (size_t) (end - disabled) : strlen(disabled);
+
+        char name[16] = {0};
+        for (size_t i = 0; i < length && i < sizeof(name) - 1; ++i) {
+            name[i] = (char) tolower((unsigned char) disabled[i]);
+        }
+        if (0 == strcmp(name, "all")) {
+            return 0;
+        }
+        for (uint32_t i = 0; i < CPU_FEATURE_COUNT; ++i) {
+            if (0 == strcmp(name, cpu_feature_names[i])) {
+                features &= ~(1u << i);
+            }
+        }
+
+        disabled = end ? end + 1 : NULL;
+    }
+    return features;
+}
+
+uint32_t cpu_probe(const char* disabled) {
+    return cpu_mask(cpu_probe_host(), disabled);
+}
+
+// Cached features
+
+static uint32_t cpu_host_features = 0;
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+
+static void cpu_init(void) {
+    cpu_host_features = cpu_probe(getenv(CPU_DISABLE_ENV));
+
+    char names[128] = {0};
+    for (uint32_t i = 0; i < CPU_FEATURE_COUNT; ++i) {
+        if (cpu_host_features & (1u << i)) {
+            strncat(names, " ", sizeof(names) - strlen(names) - 1);
+            strncat(names, cpu_feature_names[i], sizeof(names) - strlen(names) - 1);
+        }
+    }
+    LOG_DEBUG("%s: CPU features:%s.\n", __func__, cpu_host_features ? names : " none");
+}
+
+uint32_t cpu_features(void) {
+    pthread_once(&cpu_once, cpu_init);
+    return cpu_host_features;
+}
+
+bool cpu_has(uint32_t features) {
+    return features == (cpu_features() & features);
+}
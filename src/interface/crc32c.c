@@ -0,0 +1,120 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/interface/crc32c.c
+ *
+ * @brief CRC-32C (Castagnoli) checksums of byte ranges.
+ *
+ * The reflected polynomial 0x82F63B78 is the one the x86 and AArch64
+ * instructions implement, so every path produces the same checksums.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #include <arm_acle.h>
+#endif
+
+#include "interface/cpu.h"
+#include "interface/crc32c.h"
+
+#define CRC32C_POLY 0x82F63B78u /**< Reflected Castagnoli polynomial */
+
+typedef uint32_t (*Crc32cUpdate)(uint32_t crc, const uint8_t* data, size_t size);
+
+// Portable slicing-by-8: table[k][b] is the checksum of b followed by k zero bytes
+
+static uint32_t crc32c_table[8][256];
+
+static void crc32c_table_init(void) {
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) {
+            const uint32_t crc = crc32c_table[k - 1][b];
+            crc32c_table[k][b] = (crc >> 8) ^ crc32c_table[0][crc & 0xFF];
+        }
+    }
+}
+
+static uint32_t crc32c_scalar(uint32_t crc, const uint8_t* data, size_t size) {
+    for (; size >= 8; size -= 8, data += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, data, sizeof(uint32_t));
+        memcpy(&hi, data + 4, sizeof(uint32_t));
+        lo ^= crc; // Little-endian, as on every supported host
+        crc = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF]
+              ^ crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24]
+              ^ crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF]
+              ^ crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+    }
+    for (; size > 0; --size) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) static uint32_t
+crc32c_sse42(uint32_t crc, const uint8_t* data, size_t size) {
+    uint64_t wide = crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(uint64_t));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = (uint32_t) wide;
+    for (; size > 0; --size) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crc"))) static uint32_t
+crc32c_arm(uint32_t crc, const uint8_t* data, size_t size) {
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(uint64_t));
+        crc = __crc32cd(crc, word);
+    }
+    for (; size > 0; --size) {
+        crc = __crc32cb(crc, *data++);
+    }
+    return crc;
+}
+
+#endif
+
+// Runtime dispatch
+
+static Crc32cUpdate crc32c_kernel = crc32c_scalar;
+static pthread_once_t crc32c_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_dispatch_init(void) {
+    crc32c_table_init();
+#if defined(__x86_64__)
+    if (cpu_has(CPU_SSE42)) {
+        crc32c_kernel = crc32c_sse42;
+    }
+#elif defined(__aarch64__)
+    if (cpu_has(CPU_CRC32)) {
+        crc32c_kernel = crc32c_arm;
+    }
+#endif
+}
+
+uint32_t crc32c_update(uint32_t crc, const void* data, size_t size) {
+    pthread_once(&crc32c_dispatch_once, crc32c_dispatch_init);
+    return ~crc32c_kernel(~crc, (const uint8_t*) data, size);
+}
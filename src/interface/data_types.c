@@ -8,9 +8,19 @@
  * Focused on:
  * - Single and half-precision floating-point.
  * - 8-bit and 4-bit quantized integers.
+ * - Block quantization with per-block scales.
  * - Minimal dependencies and consistent design.
  */
 
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+#include "interface/cpu.h"
 #include "interface/data_types.h"
 
 // Data type management
@@ -33,6 +43,19 @@ const char* data_type_name(DataTypeId id) {
     return type ? type->name : "Unknown";
 }
 
+uint32_t data_type_values(DataTypeId id) {
+    switch (id) {
+        case TYPE_QUANT4:
+            return 2; // Packed pair
+        case TYPE_BLOCK_Q8:
+        case TYPE_BLOCK_Q4:
+        case TYPE_BLOCK_Q4_MIN:
+            return BLOCK_SIZE;
+        default:
+            return 1;
+    }
+}
+
 // Scalar Conversions
 
 // 32-bit encoding and decoding
@@ -80,7 +103,7 @@ float dequantize_scalar_fp16(uint16_t bits) {
     const float exp_scale = 0x1.0p-112f;
     const float normalized_value = decode_scalar_fp32((two_w >> 4) + exp_offset) * exp_scale;
 
-    const uint32_t magic_mask = 0x7E000000;
+    const uint32_t magic_mask = 126u << 23; // 0.5f, so subnormals decode as (0.5 + m * 2^-24) - 0.5
     const float magic_bias = 0.5f;
     const float denormalized_value = decode_scalar_fp32((two_w >> 17) | magic_mask) - magic_bias;
 
@@ -91,6 +114,93 @@ float dequantize_scalar_fp16(uint16_t bits) {
     return decode_scalar_fp32(result);
 }
 
+// Brain floating-point quantization
+uint16_t quantize_scalar_bf16(float value) {
+    const uint32_t bits = encode_scalar_fp32(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return (uint16_t) ((bits >> 16) | 0x0040); // Keep NaN quiet
+    }
+    // Round to nearest even on the discarded low half
+    return (uint16_t) ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+float dequantize_scalar_bf16(uint16_t bits) {
+    return decode_scalar_fp32((uint32_t) bits << 16);
+}
+
+// 8-bit floating-point quantization
+
+// Parameters of an 8-bit float with 1 sign bit; codes below are unsigned
+typedef struct Fp8Format {
+    uint32_t mantissa; // Mantissa bits
+    uint32_t bias; // Exponent bias
+    uint32_t max; // Largest finite code
+    uint32_t inf; // Infinity code, or max when the format has none
+    uint32_t nan; // Quiet NaN code
+    float subnormal; // 2^(bias - 1 + mantissa): one subnormal step becomes 1
+} Fp8Format;
+
+static const Fp8Format FP8_E4M3 = {3, 7, 0x7E, 0x7E, 0x7F, 0x1.0p+9f};
+static const Fp8Format FP8_E5M2 = {2, 15, 0x7B, 0x7C, 0x7E, 0x1.0p+16f};
+
+static inline uint8_t fp8_encode(float value, const Fp8Format* format) {
+    const uint32_t bits = encode_scalar_fp32(value);
+    const uint32_t sign = (bits >> 24) & 0x80;
+    const uint32_t abs = bits & 0x7FFFFFFF;
+    if (abs >= 0x7F800000) {
+        return (uint8_t) (sign | (abs > 0x7F800000 ? format->nan : format->inf));
+    }
+
+    uint32_t code;
+    if (abs < (128 - format->bias) << 23) {
+        // Below the smallest normal the code counts subnormal steps; 2^mantissa steps is normal
+        code = (uint32_t) nearbyintf(decode_scalar_fp32(abs) * format->subnormal);
+    } else {
+        // Round to nearest even on the dropped mantissa bits, then rebias the exponent
+        const uint32_t shift = 23 - format->mantissa;
+        const uint32_t rounded = (abs + (1u << (shift - 1)) - 1 + ((abs >> shift) & 1)) >> shift;
+        code = rounded - ((127 - format->bias) << format->mantissa);
+    }
+    return (uint8_t) (sign | (code < format->max ? code : format->max));
+}
+
+static inline float fp8_decode(uint8_t bits, const Fp8Format* format) {
+    const uint32_t sign = (uint32_t) (bits & 0x80) << 24;
+    const uint32_t abs = bits & 0x7F;
+    const uint32_t exponent = abs >> format->mantissa;
+    const uint32_t mantissa = abs & ((1u << format->mantissa) - 1);
+
+    float value;
+    if (abs > format->inf) {
+        value = NAN;
+    } else if (abs == format->inf && format->inf != format->max) {
+        value = INFINITY;
+    } else if (0 == exponent) {
+        value = (float) mantissa / format->subnormal;
+    } else {
+        value = decode_scalar_fp32(
+            ((exponent + 127 - format->bias) << 23) | (mantissa << (23 - format->mantissa))
+        );
+    }
+    return decode_scalar_fp32(encode_scalar_fp32(value) | sign);
+}
+
+uint8_t quantize_scalar_fp8_e4m3(float value) {
+    return fp8_encode(value, &FP8_E4M3);
+}
+
+float dequantize_scalar_fp8_e4m3(uint8_t bits) {
+    return fp8_decode(bits, &FP8_E4M3);
+}
+
+uint8_t quantize_scalar_fp8_e5m2(float value) {
+    return fp8_encode(value, &FP8_E5M2);
+}
+
+float dequantize_scalar_fp8_e5m2(uint8_t bits) {
+    return fp8_decode(bits, &FP8_E5M2);
+}
+
 // 8-bit quantization with residual baking
 Q8 quantize_scalar_q8(float value) {
     Q8 q8;
@@ -204,15 +314,170 @@ void dequantize_scalar_q4_reference(Q4 q4, float* a, float* b) {
 // Vector Conversions (1D arrays)
 
 // Half-precision floating-point quantization
+
+// Row converters over count values; step is the stride of the float side
+typedef void (*Fp16Encode)(const float* input, uint16_t* output, size_t count, size_t step);
+typedef void (*Fp16Decode)(const uint16_t* input, float* output, size_t count, size_t step);
+
+static void fp16_encode_scalar(const float* input, uint16_t* output, size_t count, size_t step) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j] = quantize_scalar_fp16(input[j * step]);
+    }
+}
+
+static void fp16_decode_scalar(const uint16_t* input, float* output, size_t count, size_t step) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j * step] = dequantize_scalar_fp16(input[j]);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Gather offsets are 32-bit, so wider strides take the scalar path
+    #define FP16_MAX_GATHER_STEP ((size_t) INT32_MAX / 16)
+
+__attribute__((target("avx2,f16c"))) static void
+fp16_encode_avx2(const float* input, uint16_t* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 8 <= count; j += 8) {
+            __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(input + j), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128((__m128i*) (output + j), h);
+        }
+    } else if (step <= FP16_MAX_GATHER_STEP) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i index = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step));
+        for (; j + 8 <= count; j += 8) {
+            __m256 x = _mm256_i32gather_ps(input + j * step, index, 4);
+            __m128i h = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128((__m128i*) (output + j), h);
+        }
+    }
+    fp16_encode_scalar(input + j * step, output + j, count - j, step);
+}
+
+__attribute__((target("avx2,f16c"))) static void
+fp16_decode_avx2(const uint16_t* input, float* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 8 <= count; j += 8) {
+            __m256 x = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (input + j)));
+            _mm256_storeu_ps(output + j, x);
+        }
+    } else {
+        // No scatter on AVX2: convert in registers, then store lane by lane
+        float lanes[8];
+        for (; j + 8 <= count; j += 8) {
+            _mm256_storeu_ps(lanes, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (input + j))));
+            for (size_t l = 0; l < 8; ++l) {
+                output[(j + l) * step] = lanes[l];
+            }
+        }
+    }
+    fp16_decode_scalar(input + j, output + j * step, count - j, step);
+}
+
+__attribute__((target("avx512f"))) static void
+fp16_encode_avx512(const float* input, uint16_t* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 16 <= count; j += 16) {
+            __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(input + j), _MM_FROUND_TO_NEAREST_INT);
+            _mm256_storeu_si256((__m256i*) (output + j), h);
+        }
+    } else if (step <= FP16_MAX_GATHER_STEP) {
+        const __m512i index = _mm512_mullo_epi32(
+            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm512_set1_epi32(step)
+        );
+        for (; j + 16 <= count; j += 16) {
+            __m512 x = _mm512_i32gather_ps(index, input + j * step, 4);
+            _mm256_storeu_si256(
+                (__m256i*) (output + j), _mm512_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT)
+            );
+        }
+    }
+    fp16_encode_scalar(input + j * step, output + j, count - j, step);
+}
+
+__attribute__((target("avx512f"))) static void
+fp16_decode_avx512(const uint16_t* input, float* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 16 <= count; j += 16) {
+            __m512 x = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*) (input + j)));
+            _mm512_storeu_ps(output + j, x);
+        }
+    } else if (step <= FP16_MAX_GATHER_STEP) {
+        const __m512i index = _mm512_mullo_epi32(
+            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm512_set1_epi32(step)
+        );
+        for (; j + 16 <= count; j += 16) {
+            __m512 x = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*) (input + j)));
+            _mm512_i32scatter_ps(output + j * step, index, x, 4);
+        }
+    }
+    fp16_decode_scalar(input + j, output + j * step, count - j, step);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static void fp16_encode_neon(const float* input, uint16_t* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 4 <= count; j += 4) {
+            float16x4_t h = vcvt_f16_f32(vld1q_f32(input + j));
+            vst1_u16(output + j, vreinterpret_u16_f16(h));
+        }
+    }
+    fp16_encode_scalar(input + j * step, output + j, count - j, step);
+}
+
+static void fp16_decode_neon(const uint16_t* input, float* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 4 <= count; j += 4) {
+            float16x4_t h = vreinterpret_f16_u16(vld1_u16(input + j));
+            vst1q_f32(output + j, vcvt_f32_f16(h));
+        }
+    }
+    fp16_decode_scalar(input + j, output + j * step, count - j, step);
+}
+
+#endif
+
+// Runtime dispatch
+
+static Fp16Encode fp16_encode = fp16_encode_scalar;
+static Fp16Decode fp16_decode = fp16_decode_scalar;
+static pthread_once_t fp16_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void fp16_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX512F)) {
+        fp16_encode = fp16_encode_avx512;
+        fp16_decode = fp16_decode_avx512;
+    } else if (cpu_has(CPU_AVX2 | CPU_F16C)) {
+        fp16_encode = fp16_encode_avx2;
+        fp16_decode = fp16_decode_avx2;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        fp16_encode = fp16_encode_neon;
+        fp16_decode = fp16_decode_neon;
+    }
+#endif
+}
+
 void quantize_row_fp16(const float* input, uint16_t* output, uint32_t length, uint32_t step_size) {
     assert(input != NULL);
     assert(output != NULL);
     assert(length > 0);
     assert(step_size > 0);
 
-    for (uint32_t i = 0, j = 0; i < length; i += step_size, ++j) {
-        output[j] = quantize_scalar_fp16(input[i]);
-    }
+    pthread_once(&fp16_dispatch_once, fp16_dispatch_init);
+    fp16_encode(input, output, ((size_t) length + step_size - 1) / step_size, step_size);
 }
 
 void dequantize_row_fp16(const uint16_t* input, float* output, uint32_t length, uint32_t step_size) {
@@ -221,8 +486,292 @@ void dequantize_row_fp16(const uint16_t* input, float* output, uint32_t length,
     assert(length > 0);
     assert(step_size > 0);
 
-    for (uint32_t i = 0, j = 0; i < length; i += step_size, ++j) {
-        output[i] = dequantize_scalar_fp16(input[j]);
+    pthread_once(&fp16_dispatch_once, fp16_dispatch_init);
+    fp16_decode(input, output, ((size_t) length + step_size - 1) / step_size, step_size);
+}
+
+// Brain floating-point quantization (same signatures as the fp16 converters)
+
+static void bf16_encode_scalar(const float* input, uint16_t* output, size_t count, size_t step) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j] = quantize_scalar_bf16(input[j * step]);
+    }
+}
+
+static void bf16_decode_scalar(const uint16_t* input, float* output, size_t count, size_t step) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j * step] = dequantize_scalar_bf16(input[j]);
+    }
+}
+
+// 8-bit floating-point quantization; decoding reads a 256-entry table per format
+
+typedef void (*Fp8Encode)(
+    const float* input, uint8_t* output, size_t count, size_t step, const Fp8Format* format
+);
+typedef void (*Fp8Decode)(
+    const uint8_t* input, float* output, size_t count, size_t step, const float* table
+);
+
+static float fp8_e4m3_table[256];
+static float fp8_e5m2_table[256];
+
+static void fp8_encode_scalar(
+    const float* input, uint8_t* output, size_t count, size_t step, const Fp8Format* format
+) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j] = fp8_encode(input[j * step], format);
+    }
+}
+
+static void fp8_decode_scalar(
+    const uint8_t* input, float* output, size_t count, size_t step, const float* table
+) {
+    for (size_t j = 0; j < count; ++j) {
+        output[j * step] = table[input[j]];
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2"))) static void
+bf16_encode_avx2(const float* input, uint16_t* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i round = _mm256_set1_epi32(0x7FFF);
+        const __m256i magnitude = _mm256_set1_epi32(0x7FFFFFFF);
+        const __m256i inf = _mm256_set1_epi32(0x7F800000);
+        const __m256i quiet_bit = _mm256_set1_epi32(0x40);
+        for (; j + 8 <= count; j += 8) {
+            const __m256i x = _mm256_castps_si256(_mm256_loadu_ps(input + j));
+            const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), one);
+            __m256i h = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(x, round), lsb), 16);
+            const __m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(x, magnitude), inf);
+            const __m256i quiet = _mm256_or_si256(_mm256_srli_epi32(x, 16), quiet_bit);
+            h = _mm256_blendv_epi8(h, quiet, nan);
+            const __m128i packed = _mm_packus_epi32(
+                _mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1)
+            );
+            _mm_storeu_si128((__m128i*) (output + j), packed);
+        }
+    }
+    bf16_encode_scalar(input + j * step, output + j, count - j, step);
+}
+
+__attribute__((target("avx2"))) static void
+bf16_decode_avx2(const uint16_t* input, float* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 8 <= count; j += 8) {
+            const __m256i h = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) (input + j)));
+            _mm256_storeu_si256((__m256i*) (output + j), _mm256_slli_epi32(h, 16));
+        }
+    }
+    bf16_decode_scalar(input + j, output + j * step, count - j, step);
+}
+
+// Mirrors fp8_encode on 8 lanes: both rounding paths are computed, then selected
+__attribute__((target("avx2"))) static void fp8_encode_avx2(
+    const float* input, uint8_t* output, size_t count, size_t step, const Fp8Format* format
+) {
+    size_t j = 0;
+    if (1 == step) {
+        const uint32_t shift = 23 - format->mantissa;
+        const __m256i magnitude = _mm256_set1_epi32(0x7FFFFFFF);
+        const __m256i inf = _mm256_set1_epi32(0x7F800000);
+        const __m256i normal = _mm256_set1_epi32((int) ((128 - format->bias) << 23));
+        const __m256i rebias = _mm256_set1_epi32((int) ((127 - format->bias) << format->mantissa));
+        const __m256i round = _mm256_set1_epi32((int) ((1u << (shift - 1)) - 1));
+        const __m256i shifts = _mm256_set1_epi32((int) shift);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i sign_bit = _mm256_set1_epi32(0x80);
+        const __m256 subnormal = _mm256_set1_ps(format->subnormal);
+        for (; j + 8 <= count; j += 8) {
+            const __m256i x = _mm256_castps_si256(_mm256_loadu_ps(input + j));
+            const __m256i abs = _mm256_and_si256(x, magnitude);
+            const __m256i sign = _mm256_and_si256(_mm256_srli_epi32(x, 24), sign_bit);
+
+            const __m256 scaled = _mm256_mul_ps(_mm256_castsi256_ps(abs), subnormal);
+            const __m256i low = _mm256_cvtps_epi32(scaled);
+            const __m256i lsb = _mm256_and_si256(_mm256_srlv_epi32(abs, shifts), one);
+            const __m256i rounded = _mm256_srlv_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(abs, round), lsb), shifts
+            );
+            __m256i code = _mm256_sub_epi32(rounded, rebias);
+            code = _mm256_blendv_epi8(code, low, _mm256_cmpgt_epi32(normal, abs));
+            code = _mm256_min_epu32(code, _mm256_set1_epi32((int) format->max));
+            code = _mm256_blendv_epi8(
+                code, _mm256_set1_epi32((int) format->inf), _mm256_cmpeq_epi32(abs, inf)
+            );
+            code = _mm256_blendv_epi8(
+                code, _mm256_set1_epi32((int) format->nan), _mm256_cmpgt_epi32(abs, inf)
+            );
+            code = _mm256_or_si256(code, sign);
+
+            const __m128i words = _mm_packus_epi32(
+                _mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1)
+            );
+            _mm_storel_epi64((__m128i*) (output + j), _mm_packus_epi16(words, words));
+        }
+    }
+    fp8_encode_scalar(input + j * step, output + j, count - j, step, format);
+}
+
+__attribute__((target("avx2"))) static void fp8_decode_avx2(
+    const uint8_t* input, float* output, size_t count, size_t step, const float* table
+) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 8 <= count; j += 8) {
+            const __m128i codes = _mm_loadl_epi64((const __m128i*) (input + j));
+            const __m256i index = _mm256_cvtepu8_epi32(codes);
+            _mm256_storeu_ps(output + j, _mm256_i32gather_ps(table, index, 4));
+        }
+    }
+    fp8_decode_scalar(input + j, output + j * step, count - j, step, table);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static void bf16_encode_neon(const float* input, uint16_t* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 4 <= count; j += 4) {
+            const uint32x4_t x = vreinterpretq_u32_f32(vld1q_f32(input + j));
+            const uint32x4_t lsb = vandq_u32(vshrq_n_u32(x, 16), vdupq_n_u32(1));
+            uint32x4_t h = vshrq_n_u32(vaddq_u32(vaddq_u32(x, vdupq_n_u32(0x7FFF)), lsb), 16);
+            const uint32x4_t nan
+                = vcgtq_u32(vandq_u32(x, vdupq_n_u32(0x7FFFFFFF)), vdupq_n_u32(0x7F800000));
+            h = vbslq_u32(nan, vorrq_u32(vshrq_n_u32(x, 16), vdupq_n_u32(0x40)), h);
+            vst1_u16(output + j, vmovn_u32(h));
+        }
+    }
+    bf16_encode_scalar(input + j * step, output + j, count - j, step);
+}
+
+static void bf16_decode_neon(const uint16_t* input, float* output, size_t count, size_t step) {
+    size_t j = 0;
+    if (1 == step) {
+        for (; j + 4 <= count; j += 4) {
+            vst1q_f32(output + j, vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(input + j), 16)));
+        }
+    }
+    bf16_decode_scalar(input + j, output + j * step, count - j, step);
+}
+
+#endif
+
+static Fp16Encode bf16_encode = bf16_encode_scalar;
+static Fp16Decode bf16_decode = bf16_decode_scalar;
+static Fp8Encode fp8_encode_row = fp8_encode_scalar;
+static Fp8Decode fp8_decode_row = fp8_decode_scalar;
+static pthread_once_t float_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void float_dispatch_init(void) {
+    for (uint32_t code = 0; code < 256; ++code) {
+        fp8_e4m3_table[code] = fp8_decode((uint8_t) code, &FP8_E4M3);
+        fp8_e5m2_table[code] = fp8_decode((uint8_t) code, &FP8_E5M2);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX2)) {
+        bf16_encode = bf16_encode_avx2;
+        bf16_decode = bf16_decode_avx2;
+        fp8_encode_row = fp8_encode_avx2;
+        fp8_decode_row = fp8_decode_avx2;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        bf16_encode = bf16_encode_neon;
+        bf16_decode = bf16_decode_neon;
+    }
+#endif
+}
+
+void quantize_row_bf16(const float* input, uint16_t* output, uint32_t length, uint32_t step_size) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    bf16_encode(input, output, ((size_t) length + step_size - 1) / step_size, step_size);
+}
+
+void dequantize_row_bf16(
+    const uint16_t* input, float* output, uint32_t length, uint32_t step_size
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    bf16_decode(input, output, ((size_t) length + step_size - 1) / step_size, step_size);
+}
+
+void quantize_row_fp8_e4m3(
+    const float* input, uint8_t* output, uint32_t length, uint32_t step_size
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    size_t count = ((size_t) length + step_size - 1) / step_size;
+    fp8_encode_row(input, output, count, step_size, &FP8_E4M3);
+}
+
+void dequantize_row_fp8_e4m3(
+    const uint8_t* input, float* output, uint32_t length, uint32_t step_size
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    size_t count = ((size_t) length + step_size - 1) / step_size;
+    fp8_decode_row(input, output, count, step_size, fp8_e4m3_table);
+}
+
+void quantize_row_fp8_e5m2(
+    const float* input, uint8_t* output, uint32_t length, uint32_t step_size
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    size_t count = ((size_t) length + step_size - 1) / step_size;
+    fp8_encode_row(input, output, count, step_size, &FP8_E5M2);
+}
+
+void dequantize_row_fp8_e5m2(
+    const uint8_t* input, float* output, uint32_t length, uint32_t step_size
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+    assert(step_size > 0);
+
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    size_t count = ((size_t) length + step_size - 1) / step_size;
+    fp8_decode_row(input, output, count, step_size, fp8_e5m2_table);
+}
+
+const float* data_type_decode_table(DataTypeId id) {
+    pthread_once(&float_dispatch_once, float_dispatch_init);
+    switch (id) {
+        case TYPE_FP8_E4M3:
+            return fp8_e4m3_table;
+        case TYPE_FP8_E5M2:
+            return fp8_e5m2_table;
+        default:
+            return NULL;
     }
 }
 
@@ -250,6 +799,10 @@ void dequantize_row_q8(const Q8Row input, float* output, uint32_t length, uint32
 }
 
 // 4-bit integer quantization
+
+// Two's complement value of each nibble
+static const int8_t Q4_SIGNED[16] = {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1};
+
 void quantize_row_q4(const float* input, Q4Row output, uint32_t length, uint32_t step_size) {
     assert(input != NULL);
     assert(output != NULL);
@@ -269,8 +822,735 @@ void dequantize_row_q4(const Q4Row input, float* output, uint32_t length, uint32
     assert(step_size > 0);
     assert((length / step_size) % 2 == 0); // Ensure output size is even for Q4
 
+    // Matches dequantize_scalar_q4_index, decoding each scale once and sign extending by table
     for (uint32_t i = 0, j = 0; i < length; i += 2 * step_size, ++j) {
-        output[i] = dequantize_scalar_q4_index(input[j], 0);      // Lower nibble
-        output[i + step_size] = dequantize_scalar_q4_index(input[j], 1); // Upper nibble
+        const float step = dequantize_scalar_fp16(input[j].scalar);
+        output[i] = (float) (Q4_SIGNED[input[j].bits >> 4] * step);
+        output[i + step_size] = (float) (Q4_SIGNED[input[j].bits & 0x0F] * step);
+    }
+}
+
+// Block quantization
+
+// Copies the next block of a row, zero padding past the end
+static uint32_t block_load(const float* input, uint32_t length, uint32_t offset, float* block) {
+    uint32_t count = length - offset < BLOCK_SIZE ? length - offset : BLOCK_SIZE;
+    memcpy(block, input + offset, count * sizeof(float));
+    memset(block + count, 0, (BLOCK_SIZE - count) * sizeof(float));
+    return count;
+}
+
+// Encodes 4-bit values using the shared nibble layout (value j low, value j + 16 high)
+static void block_pack_nibbles(const float* block, float inverse, float bias, uint8_t* nibbles) {
+    for (uint32_t j = 0; j < Q4_NIBBLES; ++j) {
+        // Clamp before converting so NaN maps to 15 instead of an undefined conversion
+        const int lo = (int) fmaxf(0.0f, fminf(15.0f, roundf(block[j] * inverse + bias)));
+        const int hi
+            = (int) fmaxf(0.0f, fminf(15.0f, roundf(block[j + Q4_NIBBLES] * inverse + bias)));
+        nibbles[j] = (uint8_t) (lo | (hi << 4));
+    }
+}
+
+// Block encoders over one full block of BLOCK_SIZE values
+typedef void (*BlockEncodeQ8)(const float* block, BlockQ8* output);
+typedef void (*BlockEncodeQ4)(const float* block, BlockQ4* output);
+
+static void block_encode_q8_scalar(const float* block, BlockQ8* output) {
+    float amax = 0.0f;
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        amax = fmaxf(amax, fabsf(block[j]));
+    }
+
+    // Round the scale first so encoding matches what decoding will see
+    output->scale = quantize_scalar_fp16(amax / 127.0f);
+    float scale = dequantize_scalar_fp16(output->scale);
+    float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        float q = roundf(block[j] * inverse);
+        output->quants[j] = (int8_t) fmaxf(-127.0f, fminf(127.0f, q));
+    }
+}
+
+static void block_encode_q4_scalar(const float* block, BlockQ4* output) {
+    // Map the value of largest magnitude to -8 so its sign gets the extra level
+    float extreme = 0.0f;
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        if (fabsf(block[j]) > fabsf(extreme)) {
+            extreme = block[j];
+        }
+    }
+
+    output->scale = quantize_scalar_fp16(extreme / -8.0f);
+    float scale = dequantize_scalar_fp16(output->scale);
+    float inverse = scale != 0.0f ? 1.0f / scale : 0.0f;
+    block_pack_nibbles(block, inverse, 8.0f, output->nibbles);
+}
+
+// Returns the first value of largest magnitude, given that magnitude
+static inline float block_extreme(const float* block, float amax) {
+    for (uint32_t j = 0; amax > 0.0f && j < BLOCK_SIZE; ++j) {
+        if (fabsf(block[j]) == amax) {
+            return block[j];
+        }
+    }
+    return 0.0f;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Without fma in the target, x * inverse + bias rounds twice exactly like the scalar path
+
+__attribute__((target("avx2"))) static inline float block_amax_avx2(const __m256* v) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 m = _mm256_max_ps(_mm256_andnot_ps(sign, v[0]), _mm256_andnot_ps(sign, v[1]));
+    m = _mm256_max_ps(m, _mm256_max_ps(_mm256_andnot_ps(sign, v[2]), _mm256_andnot_ps(sign, v[3])));
+    __m128 h = _mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+    h = _mm_max_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_max_ss(h, _mm_movehdup_ps(h));
+    return _mm_cvtss_f32(h);
+}
+
+// Rounds half away from zero, matching roundf
+__attribute__((target("avx2"))) static inline __m256 block_round_avx2(__m256 x) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 t = _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const __m256 fraction = _mm256_andnot_ps(sign, _mm256_sub_ps(x, t));
+    const __m256 half = _mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+    const __m256 one = _mm256_or_ps(_mm256_and_ps(x, sign), _mm256_set1_ps(1.0f));
+    return _mm256_add_ps(t, _mm256_and_ps(half, one));
+}
+
+__attribute__((target("avx2"))) static void
+block_encode_q8_avx2(const float* block, BlockQ8* output) {
+    __m256 v[4];
+    for (int r = 0; r < 4; ++r) {
+        v[r] = _mm256_loadu_ps(block + 8 * r);
+    }
+
+    output->scale = quantize_scalar_fp16(block_amax_avx2(v) / 127.0f);
+    const float scale = dequantize_scalar_fp16(output->scale);
+    const __m256 inverse = _mm256_set1_ps(scale > 0.0f ? 1.0f / scale : 0.0f);
+
+    __m256i q[4];
+    for (int r = 0; r < 4; ++r) {
+        __m256 x = block_round_avx2(_mm256_mul_ps(v[r], inverse));
+        x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-127.0f)), _mm256_set1_ps(127.0f));
+        q[r] = _mm256_cvttps_epi32(x);
+    }
+
+    // Packing interleaves 128-bit lanes; the permute restores value order
+    const __m256i words = _mm256_packs_epi16(
+        _mm256_packs_epi32(q[0], q[1]), _mm256_packs_epi32(q[2], q[3])
+    );
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    _mm256_storeu_si256((__m256i*) output->quants, _mm256_permutevar8x32_epi32(words, order));
+}
+
+__attribute__((target("avx2"))) static void
+block_encode_q4_avx2(const float* block, BlockQ4* output) {
+    __m256 v[4];
+    for (int r = 0; r < 4; ++r) {
+        v[r] = _mm256_loadu_ps(block + 8 * r);
+    }
+
+    output->scale = quantize_scalar_fp16(block_extreme(block, block_amax_avx2(v)) / -8.0f);
+    const float scale = dequantize_scalar_fp16(output->scale);
+    const __m256 inverse = _mm256_set1_ps(scale != 0.0f ? 1.0f / scale : 0.0f);
+
+    __m256i q[4];
+    for (int r = 0; r < 4; ++r) {
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(v[r], inverse), _mm256_set1_ps(8.0f));
+        x = _mm256_max_ps(block_round_avx2(x), _mm256_setzero_ps());
+        x = _mm256_min_ps(x, _mm256_set1_ps(15.0f));
+        q[r] = _mm256_cvttps_epi32(x);
+    }
+
+    // Value j goes to the low nibble of byte j, value j + 16 to the high nibble
+    const __m256i lo = _mm256_or_si256(q[0], _mm256_slli_epi32(q[2], 4));
+    const __m256i hi = _mm256_or_si256(q[1], _mm256_slli_epi32(q[3], 4));
+    const __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+    const __m128i bytes = _mm_packus_epi16(
+        _mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1)
+    );
+    _mm_storeu_si128((__m128i*) output->nibbles, bytes);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static inline float block_amax_neon(const float32x4_t* v) {
+    float32x4_t m = vmaxq_f32(vabsq_f32(v[0]), vabsq_f32(v[1]));
+    for (int r = 2; r < 8; ++r) {
+        m = vmaxq_f32(m, vabsq_f32(v[r]));
+    }
+    return vmaxvq_f32(m);
+}
+
+// Narrows eight vectors of small non-negative integers to 32 bytes
+static inline void block_narrow_neon(const float32x4_t* x, uint8x16_t* lo, uint8x16_t* hi) {
+    uint16x8_t w[4];
+    for (int r = 0; r < 4; ++r) {
+        w[r] = vcombine_u16(
+            vmovn_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(x[2 * r]))),
+            vmovn_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(x[2 * r + 1])))
+        );
+    }
+    *lo = vcombine_u8(vmovn_u16(w[0]), vmovn_u16(w[1]));
+    *hi = vcombine_u8(vmovn_u16(w[2]), vmovn_u16(w[3]));
+}
+
+static void block_encode_q8_neon(const float* block, BlockQ8* output) {
+    float32x4_t v[8];
+    for (int r = 0; r < 8; ++r) {
+        v[r] = vld1q_f32(block + 4 * r);
+    }
+
+    output->scale = quantize_scalar_fp16(block_amax_neon(v) / 127.0f);
+    const float scale = dequantize_scalar_fp16(output->scale);
+    const float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+    // Quantized values are biased by 127 so they narrow as unsigned bytes
+    float32x4_t x[8];
+    for (int r = 0; r < 8; ++r) {
+        x[r] = vrndaq_f32(vmulq_n_f32(v[r], inverse));
+        x[r] = vminq_f32(vmaxq_f32(x[r], vdupq_n_f32(-127.0f)), vdupq_n_f32(127.0f));
+        x[r] = vaddq_f32(x[r], vdupq_n_f32(127.0f));
+    }
+
+    uint8x16_t lo, hi;
+    block_narrow_neon(x, &lo, &hi);
+    const uint8x16_t bias = vdupq_n_u8(127);
+    vst1q_s8(output->quants, vreinterpretq_s8_u8(vsubq_u8(lo, bias)));
+    vst1q_s8(output->quants + 16, vreinterpretq_s8_u8(vsubq_u8(hi, bias)));
+}
+
+static void block_encode_q4_neon(const float* block, BlockQ4* output) {
+    float32x4_t v[8];
+    for (int r = 0; r < 8; ++r) {
+        v[r] = vld1q_f32(block + 4 * r);
+    }
+
+    output->scale = quantize_scalar_fp16(block_extreme(block, block_amax_neon(v)) / -8.0f);
+    const float scale = dequantize_scalar_fp16(output->scale);
+    const float inverse = scale != 0.0f ? 1.0f / scale : 0.0f;
+
+    float32x4_t x[8];
+    for (int r = 0; r < 8; ++r) {
+        x[r] = vrndaq_f32(vaddq_f32(vmulq_n_f32(v[r], inverse), vdupq_n_f32(8.0f)));
+        x[r] = vminq_f32(vmaxq_f32(x[r], vdupq_n_f32(0.0f)), vdupq_n_f32(15.0f));
+    }
+
+    uint8x16_t lo, hi;
+    block_narrow_neon(x, &lo, &hi);
+    vst1q_u8(output->nibbles, vorrq_u8(lo, vshlq_n_u8(hi, 4)));
+}
+
+#endif
+
+// 4-bit blocks decode through a 16-entry table holding the value of every code
+typedef void (*BlockDecodeNibbles)(const uint8_t* nibbles, const float* table, float* output);
+
+static void block_decode_scalar(const uint8_t* nibbles, const float* table, float* output) {
+    for (uint32_t j = 0; j < Q4_NIBBLES; ++j) {
+        output[j] = table[nibbles[j] & 0x0F];
+        output[j + Q4_NIBBLES] = table[nibbles[j] >> 4];
+    }
+}
+
+// Packed 4-bit rows store value 2j in the high nibble of byte j and value 2j + 1 in the low one
+static void q4_packed_decode_scalar(const uint8_t* nibbles, const float* table, float* output) {
+    for (uint32_t j = 0; j < Q4_NIBBLES; ++j) {
+        output[2 * j] = table[nibbles[j] >> 4];
+        output[2 * j + 1] = table[nibbles[j] & 0x0F];
+    }
+}
+
+// Decodes only the first count values of a trailing partial block
+static inline void block_decode_partial(
+    const uint8_t* nibbles, const float* table, float* output, uint32_t count
+) {
+    for (uint32_t j = 0; j < count; ++j) {
+        const uint8_t byte = nibbles[j % Q4_NIBBLES];
+        output[j] = table[j < Q4_NIBBLES ? byte & 0x0F : byte >> 4];
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Looks up 8 codes: vpermps selects within each half of the table, the code's bit 3 picks the half
+__attribute__((target("avx2"))) static inline __m256
+block_lookup_avx2(__m128i codes, __m256 low, __m256 high) {
+    const __m256i index = _mm256_cvtepu8_epi32(codes);
+    const __m256 select = _mm256_castsi256_ps(_mm256_slli_epi32(index, 28));
+    return _mm256_blendv_ps(
+        _mm256_permutevar8x32_ps(low, index), _mm256_permutevar8x32_ps(high, index), select
+    );
+}
+
+__attribute__((target("avx2"))) static void
+block_decode_avx2(const uint8_t* nibbles, const float* table, float* output) {
+    const __m256 low = _mm256_loadu_ps(table);
+    const __m256 high = _mm256_loadu_ps(table + 8);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i bytes = _mm_loadu_si128((const __m128i*) nibbles);
+    const __m128i lo = _mm_and_si128(bytes, mask);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+
+    _mm256_storeu_ps(output, block_lookup_avx2(lo, low, high));
+    _mm256_storeu_ps(output + 8, block_lookup_avx2(_mm_srli_si128(lo, 8), low, high));
+    _mm256_storeu_ps(output + 16, block_lookup_avx2(hi, low, high));
+    _mm256_storeu_ps(output + 24, block_lookup_avx2(_mm_srli_si128(hi, 8), low, high));
+}
+
+__attribute__((target("avx2"))) static void
+q4_packed_decode_avx2(const uint8_t* nibbles, const float* table, float* output) {
+    const __m256 low = _mm256_loadu_ps(table);
+    const __m256 high = _mm256_loadu_ps(table + 8);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i bytes = _mm_loadu_si128((const __m128i*) nibbles);
+    const __m128i lo = _mm_and_si128(bytes, mask);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+
+    // Interleave back into value order: high nibble first
+    const __m128i first = _mm_unpacklo_epi8(hi, lo);
+    const __m128i second = _mm_unpackhi_epi8(hi, lo);
+    _mm256_storeu_ps(output, block_lookup_avx2(first, low, high));
+    _mm256_storeu_ps(output + 8, block_lookup_avx2(_mm_srli_si128(first, 8), low, high));
+    _mm256_storeu_ps(output + 16, block_lookup_avx2(second, low, high));
+    _mm256_storeu_ps(output + 24, block_lookup_avx2(_mm_srli_si128(second, 8), low, high));
+}
+
+#endif
+
+static BlockEncodeQ8 block_encode_q8 = block_encode_q8_scalar;
+static BlockEncodeQ4 block_encode_q4 = block_encode_q4_scalar;
+static BlockDecodeNibbles block_decode = block_decode_scalar;
+static BlockDecodeNibbles q4_packed_decode = q4_packed_decode_scalar;
+static pthread_once_t block_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void block_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX2)) {
+        block_encode_q8 = block_encode_q8_avx2;
+        block_encode_q4 = block_encode_q4_avx2;
+        block_decode = block_decode_avx2;
+        q4_packed_decode = q4_packed_decode_avx2;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        block_encode_q8 = block_encode_q8_neon;
+        block_encode_q4 = block_encode_q4_neon;
+    }
+#endif
+}
+
+// Decodes up to one block of the remaining values; all paths share the table, so they agree bitwise
+static inline void block_decode_table(
+    const uint8_t* nibbles, const float* table, float* output, uint32_t remaining
+) {
+    if (remaining >= BLOCK_SIZE) {
+        block_decode(nibbles, table, output);
+    } else {
+        block_decode_partial(nibbles, table, output, remaining);
+    }
+}
+
+void quantize_row_block_q8(const float* input, BlockQ8* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    pthread_once(&block_dispatch_once, block_dispatch_init);
+
+    // Full blocks are encoded in place; only a partial final block is copied
+    float block[BLOCK_SIZE];
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const bool full = length - i >= BLOCK_SIZE;
+        if (!full) {
+            block_load(input, length, i, block);
+        }
+        block_encode_q8(full ? input + i : block, &output[b]);
+    }
+}
+
+void dequantize_row_block_q8(const BlockQ8* input, float* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const float scale = dequantize_scalar_fp16(input[b].scale);
+        const uint32_t count = length - i < BLOCK_SIZE ? length - i : BLOCK_SIZE;
+        for (uint32_t j = 0; j < count; ++j) {
+            output[i + j] = scale * input[b].quants[j];
+        }
+    }
+}
+
+void quantize_row_block_q4(const float* input, BlockQ4* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    pthread_once(&block_dispatch_once, block_dispatch_init);
+
+    float block[BLOCK_SIZE];
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const bool full = length - i >= BLOCK_SIZE;
+        if (!full) {
+            block_load(input, length, i, block);
+        }
+        block_encode_q4(full ? input + i : block, &output[b]);
+    }
+}
+
+void dequantize_row_block_q4(const BlockQ4* input, float* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    pthread_once(&block_dispatch_once, block_dispatch_init);
+    float table[16];
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const float scale = dequantize_scalar_fp16(input[b].scale);
+        for (int q = 0; q < 16; ++q) {
+            table[q] = scale * (float) (q - 8);
+        }
+        block_decode_table(input[b].nibbles, table, output + i, length - i);
+    }
+}
+
+void quantize_row_block_q4_min(const float* input, BlockQ4Min* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    float block[BLOCK_SIZE];
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        uint32_t count = block_load(input, length, i, block);
+
+        // Padding must not widen the range of a partial block
+        float lo = block[0], hi = block[0];
+        for (uint32_t j = 1; j < count; ++j) {
+            lo = fminf(lo, block[j]);
+            hi = fmaxf(hi, block[j]);
+        }
+
+        output[b].min = quantize_scalar_fp16(lo);
+        output[b].scale = quantize_scalar_fp16((hi - lo) / 15.0f);
+        float min = dequantize_scalar_fp16(output[b].min);
+        float scale = dequantize_scalar_fp16(output[b].scale);
+        float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+        for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+            block[j] -= min;
+        }
+        block_pack_nibbles(block, inverse, 0.0f, output[b].nibbles);
+    }
+}
+
+void dequantize_row_block_q4_min(const BlockQ4Min* input, float* output, uint32_t length) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    pthread_once(&block_dispatch_once, block_dispatch_init);
+    float table[16];
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const float scale = dequantize_scalar_fp16(input[b].scale);
+        const float min = dequantize_scalar_fp16(input[b].min);
+        for (int q = 0; q < 16; ++q) {
+            table[q] = scale * (float) q + min;
+        }
+        block_decode_table(input[b].nibbles, table, output + i, length - i);
+    }
+}
+
+// Importance-weighted block quantization
+
+#define BLOCK_CLIP_STEPS 16 /**< Candidate clipping ratios tried per block */
+#define BLOCK_CLIP_MIN 0.5f /**< Smallest fraction of the block range that is kept */
+
+// Candidate encoding of one block: x = scale * (q - offset) + min
+typedef struct BlockFit {
+    uint16_t scale_bits; // Stored fp16 scale
+    uint16_t min_bits; // Stored fp16 min, unused by the symmetric formats
+    float scale; // Decoded scale
+    float min; // Decoded min
+    double error; // Weighted squared error of the block
+    int q[BLOCK_SIZE]; // Codes, offset included
+} BlockFit;
+
+// Loads the importance of the next block; padding past the end carries no weight
+static void block_load_weights(
+    const float* importance, uint32_t length, uint32_t offset, float* weights
+) {
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        const bool inside = offset + j < length;
+        weights[j] = inside ? (importance ? importance[offset + j] : 1.0f) : 0.0f;
+    }
+}
+
+// Rounds the fit's scale and min to fp16 and picks the nearest code for every value
+static void block_fit_codes(
+    const float* x, const float* w, BlockFit* fit, float scale, float min, float offset, int top
+) {
+    fit->scale_bits = quantize_scalar_fp16(scale);
+    fit->min_bits = quantize_scalar_fp16(min);
+    fit->scale = dequantize_scalar_fp16(fit->scale_bits);
+    fit->min = dequantize_scalar_fp16(fit->min_bits);
+
+    // Same rounding as the plain encoders, so the unclipped candidate reproduces them
+    const float inverse = fit->scale != 0.0f ? 1.0f / fit->scale : 0.0f;
+    const int bottom = 0 == offset && 127 == top ? -127 : 0;
+    fit->error = 0.0;
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        // Clamp before converting, as the scalar encoders do, so NaN maps to top
+        const float code = roundf((x[j] - fit->min) * inverse + offset);
+        const int q = (int) fmaxf((float) bottom, fminf((float) top, code));
+        const float decoded = fit->scale * (float) (q - (int) offset) + fit->min;
+        const double d = (double) x[j] - (double) decoded;
+        fit->q[j] = q;
+        fit->error += (double) w[j] * d * d;
+    }
+}
+
+// Refits scale (and min) to fixed codes by weighted least squares, then rounds to new codes
+static void block_refit(
+    const float* x,
+    const float* w,
+    const BlockFit* fit,
+    BlockFit* out,
+    float offset,
+    int top,
+    bool asymmetric
+) {
+    double sw = 0.0, sv = 0.0, svv = 0.0, sx = 0.0, sxv = 0.0;
+    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+        const double v = (double) fit->q[j] - (double) offset;
+        const double wj = (double) w[j], xj = (double) x[j];
+        sw += wj;
+        sv += wj * v;
+        svv += wj * v * v;
+        sx += wj * xj;
+        sxv += wj * xj * v;
+    }
+
+    double scale = fit->scale, min = fit->min;
+    if (asymmetric) {
+        const double det = svv * sw - sv * sv;
+        if (det > 0.0) {
+            scale = (sxv * sw - sx * sv) / det;
+            min = (svv * sx - sv * sxv) / det;
+        }
+    } else if (svv > 0.0) {
+        scale = sxv / svv;
+    }
+    block_fit_codes(x, w, out, (float) scale, (float) min, offset, top);
+}
+
+// Fits the codes of one candidate that keeps ratio of the unclipped block range
+static void block_clip_fit(
+    const float* x,
+    const float* w,
+    DataTypeId id,
+    float ratio,
+    float extreme,
+    float lo,
+    float hi,
+    BlockFit* fit
+) {
+    if (TYPE_BLOCK_Q8 == id) {
+        block_fit_codes(x, w, fit, ratio * fabsf(extreme) / 127.0f, 0.0f, 0.0f, 127);
+    } else if (TYPE_BLOCK_Q4 == id) {
+        block_fit_codes(x, w, fit, ratio * extreme / -8.0f, 0.0f, 8.0f, 15);
+    } else {
+        const float range = hi - lo;
+        const float min = ratio < 1.0f ? lo + (1.0f - ratio) * range / 2.0f : lo;
+        block_fit_codes(x, w, fit, ratio * range / 15.0f, min, 0.0f, 15);
+    }
+}
+
+// Searches clipping ratios of the block range and keeps the fit of least weighted error
+static void block_search(
+    const float* x, const float* w, uint32_t count, DataTypeId id, BlockFit* best
+) {
+    // The unclipped range of each format, as the plain encoders compute it
+    float extreme = 0.0f, lo = x[0], hi = x[0];
+    for (uint32_t j = 0; j < count; ++j) {
+        extreme = fabsf(x[j]) > fabsf(extreme) ? x[j] : extreme;
+        lo = fminf(lo, x[j]);
+        hi = fmaxf(hi, x[j]);
+    }
+
+    const bool asymmetric = TYPE_BLOCK_Q4_MIN == id;
+    const float offset = TYPE_BLOCK_Q4 == id ? 8.0f : 0.0f;
+    const int top = TYPE_BLOCK_Q8 == id ? 127 : 15;
+
+    // The unclipped fit seeds the search, so a block whose errors are all NaN, which never
+    // compare smaller, still encodes as the plain encoders would
+    block_clip_fit(x, w, id, 1.0f, extreme, lo, hi, best);
+
+    BlockFit fit = *best, refit;
+    for (uint32_t step = 0; step < BLOCK_CLIP_STEPS; ++step) {
+        if (step > 0) {
+            const float ratio
+                = 1.0f - (1.0f - BLOCK_CLIP_MIN) * (float) step / (float) (BLOCK_CLIP_STEPS - 1);
+            block_clip_fit(x, w, id, ratio, extreme, lo, hi, &fit);
+        }
+        block_refit(x, w, &fit, &refit, offset, top, asymmetric);
+
+        // Ties keep the earlier, less clipped candidate
+        if (fit.error < best->error) {
+            *best = fit;
+        }
+        if (refit.error < best->error) {
+            *best = refit;
+        }
+    }
+}
+
+void quantize_row_block_q8_weighted(
+    const float* input, const float* importance, BlockQ8* output, uint32_t length
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    float block[BLOCK_SIZE], weights[BLOCK_SIZE];
+    BlockFit fit;
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const uint32_t count = block_load(input, length, i, block);
+        block_load_weights(importance, length, i, weights);
+        block_search(block, weights, count, TYPE_BLOCK_Q8, &fit);
+        output[b].scale = fit.scale_bits;
+        for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+            output[b].quants[j] = (int8_t) fit.q[j];
+        }
+    }
+}
+
+void quantize_row_block_q4_weighted(
+    const float* input, const float* importance, BlockQ4* output, uint32_t length
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    float block[BLOCK_SIZE], weights[BLOCK_SIZE];
+    BlockFit fit;
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const uint32_t count = block_load(input, length, i, block);
+        block_load_weights(importance, length, i, weights);
+        block_search(block, weights, count, TYPE_BLOCK_Q4, &fit);
+        output[b].scale = fit.scale_bits;
+        for (uint32_t j = 0; j < Q4_NIBBLES; ++j) {
+            output[b].nibbles[j] = (uint8_t) (fit.q[j] | (fit.q[j + Q4_NIBBLES] << 4));
+        }
+    }
+}
+
+void quantize_row_block_q4_min_weighted(
+    const float* input, const float* importance, BlockQ4Min* output, uint32_t length
+) {
+    assert(input != NULL);
+    assert(output != NULL);
+    assert(length > 0);
+
+    float block[BLOCK_SIZE], weights[BLOCK_SIZE];
+    BlockFit fit;
+    for (uint32_t i = 0, b = 0; i < length; i += BLOCK_SIZE, ++b) {
+        const uint32_t count = block_load(input, length, i, block);
+        block_load_weights(importance, length, i, weights);
+        block_search(block, weights, count, TYPE_BLOCK_Q4_MIN, &fit);
+        output[b].scale = fit.scale_bits;
+        output[b].min = fit.min_bits;
+        for (uint32_t j = 0; j < Q4_NIBBLES; ++j) {
+            output[b].nibbles[j] = (uint8_t) (fit.q[j] | (fit.q[j + Q4_NIBBLES] << 4));
+        }
+    }
+}
+
+// Packed 4-bit quantization
+
+// Same code as quantize_scalar_q4: divide by the unrounded step, round half away, clamp.
+// Clamping happens before the conversion to int, and NaN maps to 0.
+static inline uint8_t q4_packed_code(float value, float step) {
+    const float q = roundf(value / step);
+    const int code = isnan(q) ? 0 : (int) fmaxf(-8.0f, fminf(7.0f, q));
+    return (uint8_t) (code & 0x0F);
+}
+
+void quantize_row_q4_packed(
+    const float* input, uint8_t* nibbles, uint16_t* scales, uint32_t length, uint32_t group
+) {
+    assert(input != NULL);
+    assert(nibbles != NULL);
+    assert(scales != NULL);
+    assert(length > 0 && length % 2 == 0);
+    assert(group > 0 && group % 2 == 0);
+
+    for (uint32_t start = 0, g = 0; start < length; start += group, ++g) {
+        const uint32_t end = length - start < group ? length : start + group;
+        float max_abs = 0.0f;
+        for (uint32_t i = start; i < end; ++i) {
+            max_abs = fmaxf(max_abs, fabsf(input[i]));
+        }
+
+        // An all-zero group keeps a unit scale, as quantize_scalar_q4 does
+        if (0.0f == max_abs) {
+            scales[g] = quantize_scalar_fp16(1.0f);
+            memset(nibbles + start / 2, 0, (end - start) / 2);
+            continue;
+        }
+
+        const float step = max_abs / 7.0f;
+        scales[g] = quantize_scalar_fp16(step);
+        for (uint32_t i = start; i < end; i += 2) {
+            const uint8_t hi = q4_packed_code(input[i], step);
+            const uint8_t lo = q4_packed_code(input[i + 1], step);
+            nibbles[i / 2] = (uint8_t) (hi << 4 | lo);
+        }
+    }
+}
+
+void dequantize_row_q4_packed(
+    const uint8_t* nibbles, const uint16_t* scales, float* output, uint32_t length, uint32_t group
+) {
+    assert(nibbles != NULL);
+    assert(scales != NULL);
+    assert(output != NULL);
+    assert(length > 0 && length % 2 == 0);
+    assert(group > 0 && group % 2 == 0);
+
+    pthread_once(&block_dispatch_once, block_dispatch_init);
+
+    // Entry q is exactly what dequantize_row_q4 computes for code q
+    float table[16];
+    for (uint32_t start = 0, g = 0; start < length; start += group, ++g) {
+        const uint32_t end = length - start < group ? length : start + group;
+        const float step = dequantize_scalar_fp16(scales[g]);
+        for (int q = 0; q < 16; ++q) {
+            table[q] = (float) (Q4_SIGNED[q] * step);
+        }
+
+        uint32_t i = start;
+        for (; i + BLOCK_SIZE <= end; i += BLOCK_SIZE) {
+            q4_packed_decode(nibbles + i / 2, table, output + i);
+        }
+        for (; i < end; i += 2) {
+            output[i] = table[nibbles[i / 2] >> 4];
+            output[i + 1] = table[nibbles[i / 2] & 0x0F];
+        }
+    }
+}
+
+void q4_row_pack(const Q4Row input, uint8_t* nibbles, uint16_t* scales, uint32_t length) {
+    assert(input != NULL);
+    assert(nibbles != NULL);
+    assert(scales != NULL);
+    assert(length > 0 && length % 2 == 0);
+
+    for (uint32_t j = 0; j < length / 2; ++j) {
+        nibbles[j] = input[j].bits;
+        scales[j] = input[j].scalar;
     }
 }
@@ -6,6 +6,8 @@
  * @brief Functions for initializing model weights.
  */
 
+#include <float.h>
+
 #include "interface/random.h"
 
 void random_seed(uint32_t seed) {
@@ -47,7 +49,7 @@ float random_uniform(float min, float max) {
 
 // Box–Muller transform
 float random_gaussian(float mean, float stddev) {
-    float u1 = random_linear();
+    float u1 = fmaxf(random_linear(), FLT_MIN); // logf(0) would return -inf
     float u2 = random_linear();
     float z0 = sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float) M_PI * u2);
     return mean + z0 * stddev;
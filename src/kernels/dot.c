@@ -0,0 +1,392 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/kernels/dot.c
+ *
+ * @brief Fused dot products over quantized and half-precision operands.
+ *
+ * Each block of 32 int8 products is reduced in int32 and scaled once by the
+ * product of the two fp16 block scales. Products fit the int16 intermediates
+ * of vpmaddubsw because quantized values stay within [-127, 127].
+ * Hosts with VNNI fuse that reduction into vpdpbusd, in its AVX-512 or its
+ * VEX-encoded AVX-VNNI form.
+ *
+ * 4-bit codes are widened through a 16-entry signed table (vpshufb, tbl), and
+ * 8-bit float codes are decoded by gathering from their 256-entry float table.
+ */
+
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+#include "interface/cpu.h"
+
+#include "kernels/dot.h"
+
+// Function pointer signatures for the runtime selected kernels
+typedef float (*DotQ8Q8)(const BlockQ8* x, const BlockQ8* y, size_t blocks);
+typedef float (*DotQ4Q8)(const BlockQ4* x, const BlockQ8* y, size_t blocks);
+typedef float (*DotF16F32)(const uint16_t* x, const float* y, size_t length);
+typedef float (*DotLutF32)(const float* table, const uint8_t* x, const float* y, size_t length);
+
+// Signed value of each BlockQ4 code
+static const int8_t DOT_Q4_VALUES[16] = {-8, -7, -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Scalar kernels
+
+static inline int dot_q4_value(const BlockQ4* block, size_t j) {
+    const uint8_t byte = block->nibbles[j % Q4_NIBBLES];
+    return DOT_Q4_VALUES[j < Q4_NIBBLES ? byte & 0x0F : byte >> 4];
+}
+
+static float dot_q8_q8_scalar(const BlockQ8* x, const BlockQ8* y, size_t blocks) {
+    float sum = 0.0f;
+    for (size_t b = 0; b < blocks; ++b) {
+        int32_t acc = 0;
+        for (size_t j = 0; j < Q8_ELEMENTS; ++j) {
+            acc += (int32_t) x[b].quants[j] * y[b].quants[j];
+        }
+        sum += dequantize_scalar_fp16(x[b].scale) * dequantize_scalar_fp16(y[b].scale) * acc;
+    }
+    return sum;
+}
+
+static float dot_q4_q8_scalar(const BlockQ4* x, const BlockQ8* y, size_t blocks) {
+    float sum = 0.0f;
+    for (size_t b = 0; b < blocks; ++b) {
+        int32_t acc = 0;
+        for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+            acc += dot_q4_value(&x[b], j) * y[b].quants[j];
+        }
+        sum += dequantize_scalar_fp16(x[b].scale) * dequantize_scalar_fp16(y[b].scale) * acc;
+    }
+    return sum;
+}
+
+static float dot_f16_f32_scalar(const uint16_t* x, const float* y, size_t length) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < length; ++i) {
+        sum += dequantize_scalar_fp16(x[i]) * y[i];
+    }
+    return sum;
+}
+
+static float
+dot_lut_f32_scalar(const float* table, const uint8_t* x, const float* y, size_t length) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < length; ++i) {
+        sum += table[x[i]] * y[i];
+    }
+    return sum;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 kernels
+
+__attribute__((target("avx2,fma,f16c"))) static inline float dot_hsum_avx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+// Unpacks the 32 nibbles of a BlockQ4 into signed bytes in [-8, 7] with one table shuffle
+__attribute__((target("avx2,fma,f16c"))) static inline __m256i
+dot_unpack_q4_avx2(const BlockQ4* x) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i*) x->nibbles);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i lo = _mm_and_si128(bytes, mask);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    const __m256i values
+        = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) DOT_Q4_VALUES));
+    return _mm256_shuffle_epi8(values, _mm256_set_m128i(hi, lo));
+}
+
+// Sums the 32 int8 products as 8 int32 lanes; the sign of x moves onto y for vpmaddubsw
+__attribute__((target("avx2,fma,f16c"))) static inline __m256 dot_block_avx2(__m256i x, __m256i y) {
+    const __m256i products = _mm256_maddubs_epi16(_mm256_sign_epi8(x, x), _mm256_sign_epi8(y, x));
+    return _mm256_cvtepi32_ps(_mm256_madd_epi16(products, _mm256_set1_epi16(1)));
+}
+
+__attribute__((target("avx2,fma,f16c"))) static float
+dot_q8_q8_avx2(const BlockQ8* x, const BlockQ8* y, size_t blocks) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t b = 0; b < blocks; ++b) {
+        const __m256i qx = _mm256_loadu_si256((const __m256i*) x[b].quants);
+        const __m256i qy = _mm256_loadu_si256((const __m256i*) y[b].quants);
+        const __m256 d = _mm256_set1_ps(_cvtsh_ss(x[b].scale) * _cvtsh_ss(y[b].scale));
+        acc = _mm256_fmadd_ps(d, dot_block_avx2(qx, qy), acc);
+    }
+    return dot_hsum_avx2(acc);
+}
+
+__attribute__((target("avx2,fma,f16c"))) static float
+dot_q4_q8_avx2(const BlockQ4* x, const BlockQ8* y, size_t blocks) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t b = 0; b < blocks; ++b) {
+        const __m256i qx = dot_unpack_q4_avx2(&x[b]);
+        const __m256i qy = _mm256_loadu_si256((const __m256i*) y[b].quants);
+        const __m256 d = _mm256_set1_ps(_cvtsh_ss(x[b].scale) * _cvtsh_ss(y[b].scale));
+        acc = _mm256_fmadd_ps(d, dot_block_avx2(qx, qy), acc);
+    }
+    return dot_hsum_avx2(acc);
+}
+
+__attribute__((target("avx2,fma,f16c"))) static float
+dot_f16_f32_avx2(const uint16_t* x, const float* y, size_t length) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m256 x0 = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (x + i)));
+        const __m256 x1 = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (x + i + 8)));
+        s0 = _mm256_fmadd_ps(x0, _mm256_loadu_ps(y + i), s0);
+        s1 = _mm256_fmadd_ps(x1, _mm256_loadu_ps(y + i + 8), s1);
+    }
+
+    float sum = dot_hsum_avx2(_mm256_add_ps(s0, s1));
+    for (; i < length; ++i) {
+        sum += _cvtsh_ss(x[i]) * y[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma,f16c"))) static float
+dot_lut_f32_avx2(const float* table, const uint8_t* x, const float* y, size_t length) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i codes = _mm_loadu_si128((const __m128i*) (x + i));
+        const __m256i i0 = _mm256_cvtepu8_epi32(codes);
+        const __m256i i1 = _mm256_cvtepu8_epi32(_mm_srli_si128(codes, 8));
+        s0 = _mm256_fmadd_ps(_mm256_i32gather_ps(table, i0, 4), _mm256_loadu_ps(y + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_i32gather_ps(table, i1, 4), _mm256_loadu_ps(y + i + 8), s1);
+    }
+
+    float sum = dot_hsum_avx2(_mm256_add_ps(s0, s1));
+    for (; i < length; ++i) {
+        sum += table[x[i]] * y[i];
+    }
+    return sum;
+}
+
+// Generates the int8 block kernels around one form of vpdpbusd, which fuses the
+// multiply, pairwise add, and int32 accumulation
+#define DOT_DEFINE_VNNI(suffix, attr, dpbusd) \
+    attr static inline __m256 dot_block_##suffix(__m256i x, __m256i y) { \
+        const __m256i ux = _mm256_sign_epi8(x, x); \
+        const __m256i sy = _mm256_sign_epi8(y, x); \
+        return _mm256_cvtepi32_ps(dpbusd(_mm256_setzero_si256(), ux, sy)); \
+    } \
+\
+    attr static float dot_q8_q8_##suffix(const BlockQ8* x, const BlockQ8* y, size_t blocks) { \
+        __m256 acc = _mm256_setzero_ps(); \
+        for (size_t b = 0; b < blocks; ++b) { \
+            const __m256i qx = _mm256_loadu_si256((const __m256i*) x[b].quants); \
+            const __m256i qy = _mm256_loadu_si256((const __m256i*) y[b].quants); \
+            const __m256 d = _mm256_set1_ps(_cvtsh_ss(x[b].scale) * _cvtsh_ss(y[b].scale)); \
+            acc = _mm256_fmadd_ps(d, dot_block_##suffix(qx, qy), acc); \
+        } \
+        return dot_hsum_avx2(acc); \
+    } \
+\
+    attr static float dot_q4_q8_##suffix(const BlockQ4* x, const BlockQ8* y, size_t blocks) { \
+        __m256 acc = _mm256_setzero_ps(); \
+        for (size_t b = 0; b < blocks; ++b) { \
+            const __m256i qx = dot_unpack_q4_avx2(&x[b]); \
+            const __m256i qy = _mm256_loadu_si256((const __m256i*) y[b].quants); \
+            const __m256 d = _mm256_set1_ps(_cvtsh_ss(x[b].scale) * _cvtsh_ss(y[b].scale)); \
+            acc = _mm256_fmadd_ps(d, dot_block_##suffix(qx, qy), acc); \
+        } \
+        return dot_hsum_avx2(acc); \
+    }
+
+// VEX-encoded form for hosts with AVX-VNNI but without AVX-512 (e.g. Alder Lake)
+DOT_DEFINE_VNNI(
+    avxvnni,
+    __attribute__((target("avxvnni,avx2,fma,f16c"))),
+    _mm256_dpbusd_avx_epi32
+)
+
+// AVX-512 kernels
+
+DOT_DEFINE_VNNI(
+    vnni,
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni,avx2,fma,f16c"))),
+    _mm256_dpbusd_epi32
+)
+
+__attribute__((target("avx512f"))) static float
+dot_f16_f32_avx512(const uint16_t* x, const float* y, size_t length) {
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m512 x0 = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*) (x + i)));
+        const __m512 x1 = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*) (x + i + 16)));
+        s0 = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y + i), s0);
+        s1 = _mm512_fmadd_ps(x1, _mm512_loadu_ps(y + i + 16), s1);
+    }
+
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+    for (; i < length; ++i) {
+        sum += dequantize_scalar_fp16(x[i]) * y[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f"))) static float
+dot_lut_f32_avx512(const float* table, const uint8_t* x, const float* y, size_t length) {
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m512i i0 = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*) (x + i)));
+        const __m512i i1 = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*) (x + i + 16)));
+        s0 = _mm512_fmadd_ps(_mm512_i32gather_ps(i0, table, 4), _mm512_loadu_ps(y + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_i32gather_ps(i1, table, 4), _mm512_loadu_ps(y + i + 16), s1);
+    }
+
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+    for (; i < length; ++i) {
+        sum += table[x[i]] * y[i];
+    }
+    return sum;
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+// Sums the 32 int8 products of a block
+static inline int32_t dot_block_neon(int8x16_t x0, int8x16_t x1, int8x16_t y0, int8x16_t y1) {
+    #if defined(__ARM_FEATURE_DOTPROD)
+    return vaddvq_s32(vdotq_s32(vdotq_s32(vdupq_n_s32(0), x0, y0), x1, y1));
+    #else
+    int16x8_t p0 = vmull_s8(vget_low_s8(x0), vget_low_s8(y0));
+    int16x8_t p1 = vmull_s8(vget_low_s8(x1), vget_low_s8(y1));
+    p0 = vmlal_s8(p0, vget_high_s8(x0), vget_high_s8(y0));
+    p1 = vmlal_s8(p1, vget_high_s8(x1), vget_high_s8(y1));
+    return vaddvq_s32(vaddq_s32(vpaddlq_s16(p0), vpaddlq_s16(p1)));
+    #endif
+}
+
+static float dot_q8_q8_neon(const BlockQ8* x, const BlockQ8* y, size_t blocks) {
+    float sum = 0.0f;
+    for (size_t b = 0; b < blocks; ++b) {
+        const int32_t acc = dot_block_neon(
+            vld1q_s8(x[b].quants), vld1q_s8(x[b].quants + 16), vld1q_s8(y[b].quants),
+            vld1q_s8(y[b].quants + 16)
+        );
+        sum += dequantize_scalar_fp16(x[b].scale) * dequantize_scalar_fp16(y[b].scale) * acc;
+    }
+    return sum;
+}
+
+static float dot_q4_q8_neon(const BlockQ4* x, const BlockQ8* y, size_t blocks) {
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    const int8x16_t values = vld1q_s8(DOT_Q4_VALUES);
+
+    float sum = 0.0f;
+    for (size_t b = 0; b < blocks; ++b) {
+        const uint8x16_t bytes = vld1q_u8(x[b].nibbles);
+        const int8x16_t lo = vqtbl1q_s8(values, vandq_u8(bytes, mask));
+        const int8x16_t hi = vqtbl1q_s8(values, vshrq_n_u8(bytes, 4));
+        const int32_t acc
+            = dot_block_neon(lo, hi, vld1q_s8(y[b].quants), vld1q_s8(y[b].quants + 16));
+        sum += dequantize_scalar_fp16(x[b].scale) * dequantize_scalar_fp16(y[b].scale) * acc;
+    }
+    return sum;
+}
+
+static float dot_f16_f32_neon(const uint16_t* x, const float* y, size_t length) {
+    float32x4_t s0 = vdupq_n_f32(0.0f);
+    float32x4_t s1 = vdupq_n_f32(0.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        const float32x4_t x0 = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(x + i)));
+        const float32x4_t x1 = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(x + i + 4)));
+        s0 = vfmaq_f32(s0, x0, vld1q_f32(y + i));
+        s1 = vfmaq_f32(s1, x1, vld1q_f32(y + i + 4));
+    }
+
+    float sum = vaddvq_f32(vaddq_f32(s0, s1));
+    for (; i < length; ++i) {
+        sum += dequantize_scalar_fp16(x[i]) * y[i];
+    }
+    return sum;
+}
+
+#endif
+
+// Runtime dispatch
+
+static DotQ8Q8 dot_q8_q8_kernel = dot_q8_q8_scalar;
+static DotQ4Q8 dot_q4_q8_kernel = dot_q4_q8_scalar;
+static DotF16F32 dot_f16_f32_kernel = dot_f16_f32_scalar;
+static DotLutF32 dot_lut_f32_kernel = dot_lut_f32_scalar;
+static pthread_once_t dot_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void dot_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    const uint32_t avx2 = CPU_AVX2 | CPU_FMA | CPU_F16C;
+    if (cpu_has(avx2)) {
+        dot_q8_q8_kernel = dot_q8_q8_avx2;
+        dot_q4_q8_kernel = dot_q4_q8_avx2;
+        dot_f16_f32_kernel = dot_f16_f32_avx2;
+        dot_lut_f32_kernel = dot_lut_f32_avx2;
+    }
+    if (cpu_has(CPU_AVX512F)) {
+        dot_f16_f32_kernel = dot_f16_f32_avx512;
+        dot_lut_f32_kernel = dot_lut_f32_avx512;
+    }
+    if (cpu_has(avx2 | CPU_AVX512F | CPU_AVX512BW | CPU_AVX512VL | CPU_AVX512VNNI)) {
+        dot_q8_q8_kernel = dot_q8_q8_vnni;
+        dot_q4_q8_kernel = dot_q4_q8_vnni;
+    } else if (cpu_has(avx2 | CPU_AVXVNNI)) {
+        dot_q8_q8_kernel = dot_q8_q8_avxvnni;
+        dot_q4_q8_kernel = dot_q4_q8_avxvnni;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        dot_q8_q8_kernel = dot_q8_q8_neon;
+        dot_q4_q8_kernel = dot_q4_q8_neon;
+        dot_f16_f32_kernel = dot_f16_f32_neon;
+    }
+#endif
+}
+
+static inline void dot_dispatch(void) {
+    pthread_once(&dot_dispatch_once, dot_dispatch_init);
+}
+
+// Public API
+
+float dot_q8_q8(const BlockQ8* x, const BlockQ8* y, size_t blocks) {
+    dot_dispatch();
+    return dot_q8_q8_kernel(x, y, blocks);
+}
+
+float dot_q4_q8(const BlockQ4* x, const BlockQ8* y, size_t blocks) {
+    dot_dispatch();
+    return dot_q4_q8_kernel(x, y, blocks);
+}
+
+float dot_f16_f32(const uint16_t* x, const float* y, size_t length) {
+    dot_dispatch();
+    return dot_f16_f32_kernel(x, y, length);
+}
+
+float dot_lut_f32(const float* table, const uint8_t* x, const float* y, size_t length) {
+    dot_dispatch();
+    return dot_lut_f32_kernel(table, x, y, length);
+}
@@ -0,0 +1,547 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/kernels/elementwise.c
+ *
+ * @brief Broadcasting elementwise kernels for tensors.
+ *
+ * Every operation is expressed as a fused chain of steps:
+ * - Operand strides are aligned to the output shape, with zero strides for
+ *   broadcast dimensions.
+ * - Adjacent dimensions that are contiguous for every operand are collapsed,
+ *   so same-shape contiguous tensors become a single flat row.
+ * - Each row is processed in L1 resident chunks: x is loaded once, every step
+ *   is applied to the chunk, and the result is stored once.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "interface/activation.h"
+#include "interface/cpu.h"
+#include "interface/logger.h"
+
+#include "kernels/elementwise.h"
+
+// Operand slots: output, input, then one per step
+#define ELEMENTWISE_MAX_OPERANDS (ELEMENTWISE_MAX_STEPS + 2)
+
+typedef void (*ElementwiseBinary)(ElementwiseOp op, float* acc, const float* src, bool broadcast, size_t n);
+typedef void (*ElementwiseRelu)(float* acc, size_t n);
+
+typedef struct ElementwisePlan {
+    uint32_t rank; // Number of collapsed dimensions, innermost first
+    uint32_t operands; // Number of operand slots in use
+    bool buffered; // The output aliases a step operand, so rows are staged in a buffer
+    uint64_t shape[TENSOR_MAX_RANK];
+    uint64_t stride[ELEMENTWISE_MAX_OPERANDS][TENSOR_MAX_RANK]; // Element strides
+    float* data[ELEMENTWISE_MAX_OPERANDS];
+} ElementwisePlan;
+
+// Scalar kernels
+
+static void elementwise_binary_scalar(
+    ElementwiseOp op, float* acc, const float* src, bool broadcast, size_t n
+) {
+    const size_t step = broadcast ? 0 : 1;
+    switch (op) {
+        case ELEMENTWISE_ADD:
+            for (size_t i = 0; i < n; ++i) {
+                acc[i] += src[i * step];
+            }
+            break;
+        case ELEMENTWISE_SUB:
+            for (size_t i = 0; i < n; ++i) {
+                acc[i] -= src[i * step];
+            }
+            break;
+        case ELEMENTWISE_MUL:
+            for (size_t i = 0; i < n; ++i) {
+                acc[i] *= src[i * step];
+            }
+            break;
+        case ELEMENTWISE_DIV:
+            for (size_t i = 0; i < n; ++i) {
+                acc[i] /= src[i * step];
+            }
+            break;
+        default:
+            break; // Unary steps never reach the binary kernels
+    }
+}
+
+static void elementwise_relu_scalar(float* acc, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        acc[i] = acc[i] > 0.0f ? acc[i] : 0.0f;
+    }
+}
+
+// Vector kernels
+
+// Generates acc[i] = acc[i] <op> src[i] (or src[0] when broadcast) for one instruction set
+#define ELEMENTWISE_DEFINE_BINARY(name, attr, vec, width, load, store, set1, vadd, vsub, vmul, vdiv) \
+    attr static void name(ElementwiseOp op, float* acc, const float* src, bool broadcast, size_t n) { \
+        size_t i = 0; \
+        if (broadcast) { \
+            const vec v = set1(*src); \
+            switch (op) { \
+                case ELEMENTWISE_ADD: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vadd(load(acc + i), v)); \
+                    } \
+                    break; \
+                case ELEMENTWISE_SUB: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vsub(load(acc + i), v)); \
+                    } \
+                    break; \
+                case ELEMENTWISE_MUL: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vmul(load(acc + i), v)); \
+                    } \
+                    break; \
+                case ELEMENTWISE_DIV: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vdiv(load(acc + i), v)); \
+                    } \
+                    break; \
+                default: \
+                    break; \
+            } \
+        } else { \
+            switch (op) { \
+                case ELEMENTWISE_ADD: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vadd(load(acc + i), load(src + i))); \
+                    } \
+                    break; \
+                case ELEMENTWISE_SUB: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vsub(load(acc + i), load(src + i))); \
+                    } \
+                    break; \
+                case ELEMENTWISE_MUL: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vmul(load(acc + i), load(src + i))); \
+                    } \
+                    break; \
+                case ELEMENTWISE_DIV: \
+                    for (; i + (width) <= n; i += (width)) { \
+                        store(acc + i, vdiv(load(acc + i), load(src + i))); \
+                    } \
+                    break; \
+                default: \
+                    break; \
+            } \
+        } \
+        elementwise_binary_scalar(op, acc + i, broadcast ? src : src + i, broadcast, n - i); \
+    }
+
+// Generates acc[i] = max(acc[i], 0) for one instruction set
+#define ELEMENTWISE_DEFINE_RELU(name, attr, vec, width, load, store, zero, vmax) \
+    attr static void name(float* acc, size_t n) { \
+        const vec z = zero(); \
+        size_t i = 0; \
+        for (; i + (width) <= n; i += (width)) { \
+            store(acc + i, vmax(load(acc + i), z)); \
+        } \
+        elementwise_relu_scalar(acc + i, n - i); \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+ELEMENTWISE_DEFINE_BINARY(
+    elementwise_binary_avx2,
+    __attribute__((target("avx2"))),
+    __m256,
+    8,
+    _mm256_loadu_ps,
+    _mm256_storeu_ps,
+    _mm256_set1_ps,
+    _mm256_add_ps,
+    _mm256_sub_ps,
+    _mm256_mul_ps,
+    _mm256_div_ps
+)
+
+ELEMENTWISE_DEFINE_BINARY(
+    elementwise_binary_avx512,
+    __attribute__((target("avx512f"))),
+    __m512,
+    16,
+    _mm512_loadu_ps,
+    _mm512_storeu_ps,
+    _mm512_set1_ps,
+    _mm512_add_ps,
+    _mm512_sub_ps,
+    _mm512_mul_ps,
+    _mm512_div_ps
+)
+
+ELEMENTWISE_DEFINE_RELU(
+    elementwise_relu_avx2,
+    __attribute__((target("avx2"))),
+    __m256,
+    8,
+    _mm256_loadu_ps,
+    _mm256_storeu_ps,
+    _mm256_setzero_ps,
+    _mm256_max_ps
+)
+
+ELEMENTWISE_DEFINE_RELU(
+    elementwise_relu_avx512,
+    __attribute__((target("avx512f"))),
+    __m512,
+    16,
+    _mm512_loadu_ps,
+    _mm512_storeu_ps,
+    _mm512_setzero_ps,
+    _mm512_max_ps
+)
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static inline float32x4_t elementwise_zero_neon(void) {
+    return vdupq_n_f32(0.0f);
+}
+
+ELEMENTWISE_DEFINE_BINARY(
+    elementwise_binary_neon,
+    ,
+    float32x4_t,
+    4,
+    vld1q_f32,
+    vst1q_f32,
+    vdupq_n_f32,
+    vaddq_f32,
+    vsubq_f32,
+    vmulq_f32,
+    vdivq_f32
+)
+
+ELEMENTWISE_DEFINE_RELU(
+    elementwise_relu_neon,
+    ,
+    float32x4_t,
+    4,
+    vld1q_f32,
+    vst1q_f32,
+    elementwise_zero_neon,
+    vmaxq_f32
+)
+
+#endif
+
+// Runtime dispatch
+
+static ElementwiseBinary elementwise_binary = elementwise_binary_scalar;
+static ElementwiseRelu elementwise_relu = elementwise_relu_scalar;
+static pthread_once_t elementwise_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void elementwise_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX512F)) {
+        elementwise_binary = elementwise_binary_avx512;
+        elementwise_relu = elementwise_relu_avx512;
+    } else if (cpu_has(CPU_AVX2)) {
+        elementwise_binary = elementwise_binary_avx2;
+        elementwise_relu = elementwise_relu_avx2;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        elementwise_binary = elementwise_binary_neon;
+        elementwise_relu = elementwise_relu_neon;
+    }
+#endif
+}
+
+// Planning
+
+static bool elementwise_is_binary(ElementwiseOp op) {
+    return ELEMENTWISE_ADD == op || ELEMENTWISE_SUB == op || ELEMENTWISE_MUL == op
+           || ELEMENTWISE_DIV == op;
+}
+
+// Aligns the strides of a tensor to the output shape, using zero strides for broadcast dimensions
+static TensorState
+elementwise_broadcast(const Tensor* tensor, const Tensor* out, uint64_t* strides) {
+    if (!tensor || !tensor->data || TYPE_FLOAT32 != tensor->type->id
+        || TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        LOG_ERROR("%s: Operands must be row-major float32 tensors with data.\n", __func__);
+        return TENSOR_ERROR;
+    }
+    if (tensor->rank > out->rank) {
+        LOG_ERROR(
+            "%s: Operand rank %u exceeds output rank %u.\n", __func__, tensor->rank, out->rank
+        );
+        return TENSOR_INVALID_RANK;
+    }
+
+    const uint32_t* shape = tensor_shape_data(tensor);
+    const uint64_t* stride = tensor_stride_data(tensor);
+    const uint32_t* out_shape = tensor_shape_data(out);
+    const uint32_t lead = out->rank - tensor->rank;
+
+    for (uint32_t d = 0; d < out->rank; ++d) {
+        if (d < lead || 1 == out_shape[d]) {
+            strides[d] = 0;
+            continue;
+        }
+
+        uint32_t dim = shape[d - lead];
+        if (dim == out_shape[d]) {
+            strides[d] = stride[d - lead];
+        } else if (1 == dim) {
+            strides[d] = 0;
+        } else {
+            LOG_ERROR(
+                "%s: Cannot broadcast dimension %u of size %u to %u.\n",
+                __func__,
+                d,
+                dim,
+                out_shape[d]
+            );
+            return TENSOR_INVALID_SHAPE;
+        }
+    }
+
+    return TENSOR_SUCCESS;
+}
+
+static TensorState elementwise_plan(
+    const Tensor* x, const ElementwiseStep* steps, uint32_t count, Tensor* out, ElementwisePlan* plan
+) {
+    if (!x || !out || !out->data || (count > 0 && !steps) || count > ELEMENTWISE_MAX_STEPS) {
+        LOG_ERROR("%s: Invalid arguments provided.\n", __func__);
+        return TENSOR_ERROR;
+    }
+    if (TYPE_FLOAT32 != out->type->id || out->rank > TENSOR_MAX_RANK) {
+        LOG_ERROR("%s: Output must be a float32 tensor of rank <= %u.\n", __func__, TENSOR_MAX_RANK);
+        return TENSOR_ERROR;
+    }
+
+    const Tensor* tensors[ELEMENTWISE_MAX_OPERANDS] = {out, x};
+    uint32_t operands = 2;
+    plan->buffered = false;
+    for (uint32_t s = 0; s < count; ++s) {
+        if (elementwise_is_binary(steps[s].op)) {
+            tensors[operands++] = steps[s].operand;
+            if (steps[s].operand && steps[s].operand->data == out->data) {
+                plan->buffered = true;
+            }
+        } else if (ELEMENTWISE_ACTIVATE == steps[s].op && !steps[s].function) {
+            LOG_ERROR("%s: Activation step %u has no function.\n", __func__, s);
+            return TENSOR_ERROR;
+        } else if (ELEMENTWISE_SCALE != steps[s].op && ELEMENTWISE_ACTIVATE != steps[s].op) {
+            LOG_ERROR("%s: Invalid operation %d in step %u.\n", __func__, steps[s].op, s);
+            return TENSOR_ERROR;
+        }
+    }
+
+    // Full rank strides, outermost first
+    uint64_t strides[ELEMENTWISE_MAX_OPERANDS][TENSOR_MAX_RANK];
+    for (uint32_t o = 0; o < operands; ++o) {
+        TensorState state = elementwise_broadcast(tensors[o], out, strides[o]);
+        if (TENSOR_SUCCESS != state) {
+            return state;
+        }
+        plan->data[o] = (float*) tensors[o]->data;
+    }
+    plan->operands = operands;
+
+    // Collapse dimensions innermost first, skipping unit dimensions
+    const uint32_t* shape = tensor_shape_data(out);
+    uint32_t rank = 0;
+    for (uint32_t d = out->rank; d-- > 0;) {
+        if (1 == shape[d]) {
+            continue;
+        }
+
+        bool merge = rank > 0;
+        for (uint32_t o = 0; merge && o < operands; ++o) {
+            merge = strides[o][d] == plan->stride[o][rank - 1] * plan->shape[rank - 1];
+        }
+
+        if (merge) {
+            plan->shape[rank - 1] *= shape[d];
+        } else {
+            plan->shape[rank] = shape[d];
+            for (uint32_t o = 0; o < operands; ++o) {
+                plan->stride[o][rank] = strides[o][d];
+            }
+            rank++;
+        }
+    }
+
+    if (0 == rank) { // Every dimension is 1
+        plan->shape[0] = 1;
+        for (uint32_t o = 0; o < operands; ++o) {
+            plan->stride[o][0] = 0;
+        }
+        rank = 1;
+    }
+    plan->rank = rank;
+
+    return TENSOR_SUCCESS;
+}
+
+// Execution
+
+// Loads n values with the given stride into a contiguous buffer
+static void elementwise_gather(float* dst, const float* src, uint64_t stride, size_t n) {
+    if (1 == stride) {
+        if (dst != src) {
+            memcpy(dst, src, n * sizeof(float));
+        }
+    } else if (0 == stride) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = src[0];
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = src[i * stride];
+        }
+    }
+}
+
+static void elementwise_activate_chunk(ElementwiseFunction function, float* acc, size_t n) {
+    if (activate_relu == function) {
+        elementwise_relu(acc, n);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        acc[i] = function(acc[i]);
+    }
+}
+
+// Applies the chain to one collapsed row of plan->shape[0] elements
+static void elementwise_row(
+    const ElementwisePlan* plan, const ElementwiseStep* steps, uint32_t count, float** rows
+) {
+    float buffer[ELEMENTWISE_CHUNK];
+    float scratch[ELEMENTWISE_CHUNK];
+    const uint64_t length = plan->shape[0];
+    const uint64_t out_stride = plan->stride[0][0];
+
+    for (uint64_t offset = 0; offset < length; offset += ELEMENTWISE_CHUNK) {
+        const size_t n = (size_t) (length - offset < ELEMENTWISE_CHUNK ? length - offset : ELEMENTWISE_CHUNK);
+
+        // Work directly in the output when it is contiguous along the row and
+        // no step reads from it; otherwise gathering x would clobber the operand
+        float* acc = 1 == out_stride && !plan->buffered ? rows[0] + offset : buffer;
+        elementwise_gather(acc, rows[1] + offset * plan->stride[1][0], plan->stride[1][0], n);
+
+        for (uint32_t s = 0, o = 2; s < count; ++s) {
+            switch (steps[s].op) {
+                case ELEMENTWISE_SCALE:
+                    elementwise_binary(ELEMENTWISE_MUL, acc, &steps[s].scalar, true, n);
+                    break;
+                case ELEMENTWISE_ACTIVATE:
+                    elementwise_activate_chunk(steps[s].function, acc, n);
+                    break;
+                default: {
+                    const uint64_t stride = plan->stride[o][0];
+                    const float* src = rows[o] + offset * stride;
+                    if (stride > 1) {
+                        elementwise_gather(scratch, src, stride, n);
+                        src = scratch;
+                    }
+                    elementwise_binary(steps[s].op, acc, src, 0 == stride, n);
+                    o++;
+                    break;
+                }
+            }
+        }
+
+        if (acc == buffer) {
+            float* dst = rows[0] + offset * out_stride;
+            for (size_t i = 0; i < n; ++i) {
+                dst[i * out_stride] = buffer[i];
+            }
+        }
+    }
+}
+
+TensorState
+tensor_elementwise(const Tensor* x, const ElementwiseStep* steps, uint32_t count, Tensor* out) {
+    ElementwisePlan plan;
+    TensorState state = elementwise_plan(x, steps, count, out, &plan);
+    if (TENSOR_SUCCESS != state) {
+        return state;
+    }
+
+    pthread_once(&elementwise_dispatch_once, elementwise_dispatch_init);
+
+    // Odometer over the outer collapsed dimensions
+    uint64_t indices[TENSOR_MAX_RANK] = {0};
+    float* rows[ELEMENTWISE_MAX_OPERANDS];
+    for (;;) {
+        for (uint32_t o = 0; o < plan.operands; ++o) {
+            uint64_t offset = 0;
+            for (uint32_t d = 1; d < plan.rank; ++d) {
+                offset += indices[d] * plan.stride[o][d];
+            }
+            rows[o] = plan.data[o] + offset;
+        }
+
+        elementwise_row(&plan, steps, count, rows);
+
+        uint32_t d = 1;
+        for (; d < plan.rank; ++d) {
+            if (++indices[d] < plan.shape[d]) {
+                break;
+            }
+            indices[d] = 0;
+        }
+        if (d >= plan.rank) {
+            break;
+        }
+    }
+
+    return TENSOR_SUCCESS;
+}
+
+// Convenience wrappers
+
+static TensorState
+elementwise_binary_op(ElementwiseOp op, const Tensor* a, const Tensor* b, Tensor* out) {
+    ElementwiseStep step = {.op = op, .operand = b};
+    return tensor_elementwise(a, &step, 1, out);
+}
+
+TensorState tensor_add(const Tensor* a, const Tensor* b, Tensor* out) {
+    return elementwise_binary_op(ELEMENTWISE_ADD, a, b, out);
+}
+
+TensorState tensor_sub(const Tensor* a, const Tensor* b, Tensor* out) {
+    return elementwise_binary_op(ELEMENTWISE_SUB, a, b, out);
+}
+
+TensorState tensor_mul(const Tensor* a, const Tensor* b, Tensor* out) {
+    return elementwise_binary_op(ELEMENTWISE_MUL, a, b, out);
+}
+
+TensorState tensor_div(const Tensor* a, const Tensor* b, Tensor* out) {
+    return elementwise_binary_op(ELEMENTWISE_DIV, a, b, out);
+}
+
+TensorState tensor_scale(const Tensor* x, float alpha, Tensor* out) {
+    ElementwiseStep step = {.op = ELEMENTWISE_SCALE, .scalar = alpha};
+    return tensor_elementwise(x, &step, 1, out);
+}
+
+TensorState tensor_residual_add(Tensor* x, const Tensor* residual) {
+    return elementwise_binary_op(ELEMENTWISE_ADD, x, residual, x);
+}
+
+TensorState tensor_activate(const Tensor* x, ElementwiseFunction function, Tensor* out) {
+    ElementwiseStep step = {.op = ELEMENTWISE_ACTIVATE, .function = function};
+    return tensor_elementwise(x, &step, 1, out);
+}
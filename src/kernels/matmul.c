@@ -0,0 +1,723 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/kernels/matmul.c
+ *
+ * @brief Cache-blocked matrix multiplication for tensors.
+ *
+ * The driver follows the usual five loop GEMM structure:
+ * - B is packed into KC x NR column panels (decoding weights to float32 on the fly),
+ *   unless it was already repacked into panels at load time.
+ * - A is packed into MR x KC row panels.
+ * - An MR x NR register-blocked micro-kernel accumulates into C.
+ *
+ * Micro-kernels are compiled with per-function target attributes and selected
+ * once at runtime, so a single binary runs on any host.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "interface/allocator.h"
+#include "interface/cpu.h"
+#include "interface/logger.h"
+
+#include "kernels/dot.h"
+#include "kernels/matmul.h"
+
+// Function pointer signatures for the runtime selected kernels
+typedef void (*MatmulKernel)(size_t kc, const float* a, const float* b, float* c, size_t ldc);
+typedef float (*MatmulDot)(const float* x, const float* y, size_t length);
+
+// Tensor helpers
+
+static inline uint32_t matmul_dim(const Tensor* tensor, uint32_t axis) {
+    return ((uint32_t*) tensor->shape->data)[axis];
+}
+
+static inline uint64_t matmul_stride(const Tensor* tensor, uint32_t axis) {
+    return ((uint64_t*) tensor->stride->data)[axis];
+}
+
+// Number of logical values decoded from a single element
+static inline uint32_t matmul_values_per_element(DataTypeId id) {
+    return data_type_values(id);
+}
+
+static bool matmul_is_weight_type(DataTypeId id) {
+    switch (id) {
+        case TYPE_FLOAT32:
+        case TYPE_FLOAT16:
+        case TYPE_QUANT8:
+        case TYPE_QUANT4:
+        case TYPE_BLOCK_Q8:
+        case TYPE_BLOCK_Q4:
+        case TYPE_BLOCK_Q4_MIN:
+        case TYPE_BFLOAT16:
+        case TYPE_FP8_E4M3:
+        case TYPE_FP8_E5M2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Allocates an aligned float buffer for packed panels
+static float* matmul_alloc(size_t count) {
+    size_t bytes = count * sizeof(float);
+    float* buffer = (float*) allocator_alloc(bytes, MATMUL_ALIGNMENT, ALLOCATOR_NONE);
+    if (!buffer) {
+        LOG_ERROR("%s: Failed to allocate %zu bytes for packed panel.\n", __func__, bytes);
+    }
+    return buffer;
+}
+
+static BlockQ8* matmul_alloc_blocks(size_t count) {
+    size_t bytes = count * sizeof(BlockQ8);
+    BlockQ8* buffer = (BlockQ8*) allocator_alloc(bytes, MATMUL_ALIGNMENT, ALLOCATOR_NONE);
+    if (!buffer) {
+        LOG_ERROR("%s: Failed to allocate %zu bytes for quantized vector.\n", __func__, bytes);
+    }
+    return buffer;
+}
+
+// How tensor_gemv reads a weight row
+typedef enum MatmulGemvPath {
+    MATMUL_GEMV_DECODE, // Decode the row to float32, then dot
+    MATMUL_GEMV_F32, // Dot the float32 row in place
+    MATMUL_GEMV_F16, // Fused fp16 dot, converting in registers
+    MATMUL_GEMV_BLOCK, // Fused int8 dot against the quantized vector
+    MATMUL_GEMV_LUT, // Fused dot decoding 8-bit codes through their value table
+} MatmulGemvPath;
+
+static MatmulGemvPath matmul_gemv_path(const Tensor* w) {
+    if (1 != matmul_stride(w, 1)) {
+        return MATMUL_GEMV_DECODE;
+    }
+    switch (w->type->id) {
+        case TYPE_FLOAT32:
+            return MATMUL_GEMV_F32;
+        case TYPE_FLOAT16:
+            return MATMUL_GEMV_F16;
+        case TYPE_BLOCK_Q8:
+        case TYPE_BLOCK_Q4:
+            return MATMUL_GEMV_BLOCK;
+        case TYPE_FP8_E4M3:
+        case TYPE_FP8_E5M2:
+            return MATMUL_GEMV_LUT;
+        default:
+            return MATMUL_GEMV_DECODE;
+    }
+}
+
+// Decodes count logical values from contiguous weight elements into float32
+static void matmul_decode(DataTypeId id, const void* src, size_t count, float* out) {
+    switch (id) {
+        case TYPE_FLOAT32:
+            memcpy(out, src, count * sizeof(float));
+            break;
+        case TYPE_FLOAT16:
+            dequantize_row_fp16((const uint16_t*) src, out, count, 1);
+            break;
+        case TYPE_QUANT8:
+            dequantize_row_q8((const Q8*) src, out, count, 1);
+            break;
+        case TYPE_QUANT4:
+            dequantize_row_q4((const Q4*) src, out, count, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            dequantize_row_block_q8((const BlockQ8*) src, out, count);
+            break;
+        case TYPE_BLOCK_Q4:
+            dequantize_row_block_q4((const BlockQ4*) src, out, count);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            dequantize_row_block_q4_min((const BlockQ4Min*) src, out, count);
+            break;
+        case TYPE_BFLOAT16:
+            dequantize_row_bf16((const uint16_t*) src, out, count, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            dequantize_row_fp8_e4m3((const uint8_t*) src, out, count, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            dequantize_row_fp8_e5m2((const uint8_t*) src, out, count, 1);
+            break;
+        default:
+            memset(out, 0, count * sizeof(float)); // Rejected by the validators
+            break;
+    }
+}
+
+// Decodes count logical values of a weight row, starting at column, into float32
+static void matmul_decode_row(const Tensor* w, uint64_t row, size_t column, size_t count, float* out) {
+    const char* base = (const char*) w->data + row * matmul_stride(w, 0) * w->type->size;
+    const uint64_t step = matmul_stride(w, 1);
+
+    if (TYPE_FLOAT32 == w->type->id && 1 != step) {
+        const float* src = (const float*) base;
+        for (size_t j = 0; j < count; ++j) {
+            out[j] = src[(column + j) * step];
+        }
+        return;
+    }
+
+    const uint32_t values = matmul_values_per_element(w->type->id);
+    const char* src = base + column / values * w->type->size;
+
+    // A column inside a block starts with the tail of that block
+    const size_t skip = column % values;
+    if (skip) {
+        float block[BLOCK_SIZE];
+        const size_t head = values - skip < count ? values - skip : count;
+        matmul_decode(w->type->id, src, values, block);
+        memcpy(out, block + skip, head * sizeof(float));
+        src += w->type->size;
+        out += head;
+        count -= head;
+    }
+
+    if (count) {
+        matmul_decode(w->type->id, src, count, out);
+    }
+}
+
+// Micro-kernels: C[MR x NR] += A_panel[MR x kc] * B_panel[kc x NR]
+
+static void matmul_kernel_scalar(size_t kc, const float* a, const float* b, float* c, size_t ldc) {
+    float acc[MATMUL_MR][MATMUL_NR] = {{0}};
+    for (size_t p = 0; p < kc; ++p) {
+        for (size_t i = 0; i < MATMUL_MR; ++i) {
+            const float ai = a[p * MATMUL_MR + i];
+            for (size_t j = 0; j < MATMUL_NR; ++j) {
+                acc[i][j] += ai * b[p * MATMUL_NR + j];
+            }
+        }
+    }
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        for (size_t j = 0; j < MATMUL_NR; ++j) {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+static float matmul_dot_scalar(const float* x, const float* y, size_t length) {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        sum[0] += x[i + 0] * y[i + 0];
+        sum[1] += x[i + 1] * y[i + 1];
+        sum[2] += x[i + 2] * y[i + 2];
+        sum[3] += x[i + 3] * y[i + 3];
+    }
+    for (; i < length; ++i) {
+        sum[0] += x[i] * y[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2,fma"))) static void
+matmul_kernel_avx2(size_t kc, const float* a, const float* b, float* c, size_t ldc) {
+    __m256 acc[MATMUL_MR][2];
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+
+    for (size_t p = 0; p < kc; ++p) {
+        const __m256 b0 = _mm256_loadu_ps(b + p * MATMUL_NR);
+        const __m256 b1 = _mm256_loadu_ps(b + p * MATMUL_NR + 8);
+        for (size_t i = 0; i < MATMUL_MR; ++i) {
+            const __m256 ai = _mm256_broadcast_ss(a + p * MATMUL_MR + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        float* row = c + i * ldc;
+        _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), acc[i][0]));
+        _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), acc[i][1]));
+    }
+}
+
+__attribute__((target("avx2,fma"))) static float
+matmul_dot_avx2(const float* x, const float* y, size_t length) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps();
+    __m256 s3 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), s1);
+        s2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), s2);
+        s3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), s3);
+    }
+    for (; i + 8 <= length; i += 8) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+    }
+
+    __m256 s = _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3));
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_add_ss(h, _mm_movehdup_ps(h));
+
+    float sum = _mm_cvtss_f32(h);
+    for (; i < length; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f"))) static void
+matmul_kernel_avx512(size_t kc, const float* a, const float* b, float* c, size_t ldc) {
+    __m512 acc[MATMUL_MR];
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        acc[i] = _mm512_setzero_ps();
+    }
+
+    for (size_t p = 0; p < kc; ++p) {
+        const __m512 b0 = _mm512_loadu_ps(b + p * MATMUL_NR);
+        for (size_t i = 0; i < MATMUL_MR; ++i) {
+            acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(a[p * MATMUL_MR + i]), b0, acc[i]);
+        }
+    }
+
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        float* row = c + i * ldc;
+        _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), acc[i]));
+    }
+}
+
+__attribute__((target("avx512f"))) static float
+matmul_dot_avx512(const float* x, const float* y, size_t length) {
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), s1);
+    }
+    if (i + 16 <= length) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+        i += 16;
+    }
+    if (i < length) {
+        const __mmask16 mask = (__mmask16) ((1u << (length - i)) - 1);
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i), s1);
+    }
+
+    return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+#elif defined(__ARM_NEON)
+
+static void matmul_kernel_neon(size_t kc, const float* a, const float* b, float* c, size_t ldc) {
+    float32x4_t acc[MATMUL_MR][4];
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            acc[i][j] = vdupq_n_f32(0.0f);
+        }
+    }
+
+    for (size_t p = 0; p < kc; ++p) {
+        const float32x4_t b0 = vld1q_f32(b + p * MATMUL_NR);
+        const float32x4_t b1 = vld1q_f32(b + p * MATMUL_NR + 4);
+        const float32x4_t b2 = vld1q_f32(b + p * MATMUL_NR + 8);
+        const float32x4_t b3 = vld1q_f32(b + p * MATMUL_NR + 12);
+        for (size_t i = 0; i < MATMUL_MR; ++i) {
+            const float ai = a[p * MATMUL_MR + i];
+            acc[i][0] = vfmaq_n_f32(acc[i][0], b0, ai);
+            acc[i][1] = vfmaq_n_f32(acc[i][1], b1, ai);
+            acc[i][2] = vfmaq_n_f32(acc[i][2], b2, ai);
+            acc[i][3] = vfmaq_n_f32(acc[i][3], b3, ai);
+        }
+    }
+
+    for (size_t i = 0; i < MATMUL_MR; ++i) {
+        float* row = c + i * ldc;
+        for (size_t j = 0; j < 4; ++j) {
+            vst1q_f32(row + 4 * j, vaddq_f32(vld1q_f32(row + 4 * j), acc[i][j]));
+        }
+    }
+}
+
+static float matmul_dot_neon(const float* x, const float* y, size_t length) {
+    float32x4_t s0 = vdupq_n_f32(0.0f);
+    float32x4_t s1 = vdupq_n_f32(0.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        s0 = vfmaq_f32(s0, vld1q_f32(x + i), vld1q_f32(y + i));
+        s1 = vfmaq_f32(s1, vld1q_f32(x + i + 4), vld1q_f32(y + i + 4));
+    }
+
+    float sum = vaddvq_f32(vaddq_f32(s0, s1));
+    for (; i < length; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+#endif
+
+// Runtime dispatch
+
+static MatmulKernel matmul_kernel = matmul_kernel_scalar;
+static MatmulDot matmul_dot = matmul_dot_scalar;
+static pthread_once_t matmul_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void matmul_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX512F)) {
+        matmul_kernel = matmul_kernel_avx512;
+        matmul_dot = matmul_dot_avx512;
+    } else if (cpu_has(CPU_AVX2 | CPU_FMA)) {
+        matmul_kernel = matmul_kernel_avx2;
+        matmul_dot = matmul_dot_avx2;
+    }
+#elif defined(__ARM_NEON)
+    if (cpu_has(CPU_NEON)) {
+        matmul_kernel = matmul_kernel_neon;
+        matmul_dot = matmul_dot_neon;
+    }
+#endif
+}
+
+static inline void matmul_dispatch(void) {
+    pthread_once(&matmul_dispatch_once, matmul_dispatch_init);
+}
+
+float matmul_dot_f32(const float* x, const float* y, size_t length) {
+    matmul_dispatch();
+    return matmul_dot(x, y, length);
+}
+
+// Panel packing
+
+// Packs B[p0 : p0 + kc, j0 : j0 + nc] into NR wide column panels, zero padding the edge
+static void matmul_pack_b(
+    const Tensor* b, size_t p0, size_t kc, size_t j0, size_t nc, float* packed, float* row
+) {
+    for (size_t p = 0; p < kc; ++p) {
+        matmul_decode_row(b, p0 + p, j0, nc, row);
+        for (size_t jp = 0; jp < nc; jp += MATMUL_NR) {
+            float* dst = packed + (jp / MATMUL_NR) * kc * MATMUL_NR + p * MATMUL_NR;
+            size_t cols = nc - jp < MATMUL_NR ? nc - jp : MATMUL_NR;
+            memcpy(dst, row + jp, cols * sizeof(float));
+            memset(dst + cols, 0, (MATMUL_NR - cols) * sizeof(float));
+        }
+    }
+}
+
+// Tiled weights hold prepacked NR wide panels of every row (see tensor_repack)
+static bool matmul_is_paneled(const Tensor* b) {
+    return TENSOR_LAYOUT_TILED == b->layout && b->tile[0] == matmul_dim(b, 0)
+           && MATMUL_NR == b->tile[1] * matmul_values_per_element(b->type->id);
+}
+
+// Decodes the rows p0 : p0 + kc of the prepacked panels covering columns j0 : j0 + nc
+static void matmul_pack_b_paneled(
+    const Tensor* b, size_t p0, size_t kc, size_t j0, size_t nc, float* packed
+) {
+    const size_t k = matmul_dim(b, 0);
+    const size_t bytes = (size_t) b->tile[1] * b->type->size;
+    for (size_t jp = 0; jp < nc; jp += MATMUL_NR) {
+        const char* src = (const char*) b->data + (((j0 + jp) / MATMUL_NR) * k + p0) * bytes;
+        float* dst = packed + (jp / MATMUL_NR) * kc * MATMUL_NR;
+        for (size_t p = 0; p < kc; ++p) {
+            matmul_decode(b->type->id, src + p * bytes, MATMUL_NR, dst + p * MATMUL_NR);
+        }
+    }
+}
+
+// Packs A[i0 : i0 + mc, p0 : p0 + kc] into MR tall row panels, zero padding the edge
+static void matmul_pack_a(const Tensor* a, size_t i0, size_t mc, size_t p0, size_t kc, float* packed) {
+    const float* src = (const float*) a->data;
+    const uint64_t row_stride = matmul_stride(a, 0);
+    const uint64_t col_stride = matmul_stride(a, 1);
+
+    for (size_t ip = 0; ip < mc; ip += MATMUL_MR) {
+        float* dst = packed + (ip / MATMUL_MR) * kc * MATMUL_MR;
+        for (size_t r = 0; r < MATMUL_MR; ++r) {
+            if (ip + r >= mc) {
+                for (size_t p = 0; p < kc; ++p) {
+                    dst[p * MATMUL_MR + r] = 0.0f;
+                }
+                continue;
+            }
+            const float* row = src + (i0 + ip + r) * row_stride + p0 * col_stride;
+            for (size_t p = 0; p < kc; ++p) {
+                dst[p * MATMUL_MR + r] = row[p * col_stride];
+            }
+        }
+    }
+}
+
+// Validation
+
+static TensorState matmul_validate_f32(const Tensor* tensor, uint32_t rank, const char* label) {
+    if (!tensor || !tensor->shape || !tensor->stride || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor '%s' provided.\n", __func__, label);
+        return TENSOR_ERROR;
+    }
+    if (rank != tensor->rank) {
+        LOG_ERROR("%s: Tensor '%s' must have rank %u, got %u.\n", __func__, label, rank, tensor->rank);
+        return TENSOR_INVALID_RANK;
+    }
+    if (TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        LOG_ERROR("%s: Tensor '%s' must be row-major.\n", __func__, label);
+        return TENSOR_ERROR;
+    }
+    if (TYPE_FLOAT32 != tensor->type->id) {
+        LOG_ERROR("%s: Tensor '%s' must be float32, got %s.\n", __func__, label, tensor->type->name);
+        return TENSOR_ERROR;
+    }
+    return TENSOR_SUCCESS;
+}
+
+static TensorState matmul_validate_weight(const Tensor* w, const char* label, bool paneled) {
+    if (!w || !w->shape || !w->stride || !w->data) {
+        LOG_ERROR("%s: Invalid tensor '%s' provided.\n", __func__, label);
+        return TENSOR_ERROR;
+    }
+    if (2 != w->rank) {
+        LOG_ERROR("%s: Tensor '%s' must have rank 2, got %u.\n", __func__, label, w->rank);
+        return TENSOR_INVALID_RANK;
+    }
+    if (!matmul_is_weight_type(w->type->id)) {
+        LOG_ERROR("%s: Unsupported weight type %s.\n", __func__, w->type->name);
+        return TENSOR_ERROR;
+    }
+    if (TYPE_FLOAT32 != w->type->id && 1 != matmul_stride(w, 1)) {
+        LOG_ERROR("%s: Packed weight '%s' rows must be contiguous.\n", __func__, label);
+        return TENSOR_ERROR;
+    }
+    if (TENSOR_LAYOUT_ROW_MAJOR != w->layout && !(paneled && matmul_is_paneled(w))) {
+        LOG_ERROR(
+            "%s: Tiled weight '%s' must use full height panels of %u values.\n",
+            __func__,
+            label,
+            MATMUL_NR
+        );
+        return TENSOR_ERROR;
+    }
+    return TENSOR_SUCCESS;
+}
+
+// Zeroes a rank 2 float32 tensor respecting its strides
+static void matmul_zero(Tensor* c, size_t rows, size_t cols) {
+    if (tensor_is_contiguous(c)) {
+        memset(c->data, 0, rows * cols * sizeof(float));
+        return;
+    }
+    float* dst = (float*) c->data;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            dst[i * matmul_stride(c, 0) + j * matmul_stride(c, 1)] = 0.0f;
+        }
+    }
+}
+
+// Public API
+
+TensorState tensor_matmul(const Tensor* a, const Tensor* b, Tensor* c) {
+    TensorState state;
+    if (TENSOR_SUCCESS != (state = matmul_validate_f32(a, 2, "a"))
+        || TENSOR_SUCCESS != (state = matmul_validate_weight(b, "b", true))
+        || TENSOR_SUCCESS != (state = matmul_validate_f32(c, 2, "c"))) {
+        return state;
+    }
+
+    const size_t m = matmul_dim(a, 0);
+    const size_t k = matmul_dim(a, 1);
+    const size_t n = (size_t) matmul_dim(b, 1) * matmul_values_per_element(b->type->id);
+    if (matmul_dim(b, 0) != k || matmul_dim(c, 0) != m || matmul_dim(c, 1) != n) {
+        LOG_ERROR(
+            "%s: Shape mismatch: a=[%zu, %zu], b=[%u, %zu], c=[%u, %u].\n",
+            __func__,
+            m,
+            k,
+            matmul_dim(b, 0),
+            n,
+            matmul_dim(c, 0),
+            matmul_dim(c, 1)
+        );
+        return TENSOR_INVALID_SHAPE;
+    }
+
+    matmul_dispatch();
+
+    const size_t nc_max = n < MATMUL_NC ? n : MATMUL_NC;
+    const size_t kc_max = k < MATMUL_KC ? k : MATMUL_KC;
+    const size_t nc_panels = (nc_max + MATMUL_NR - 1) / MATMUL_NR;
+
+    // Float32 panels prepacked at load time are used in place
+    const bool paneled = TENSOR_LAYOUT_TILED == b->layout;
+    const bool direct_b = paneled && TYPE_FLOAT32 == b->type->id;
+    const float* panels = (const float*) b->data;
+
+    float* packed_a = matmul_alloc(MATMUL_MC * kc_max);
+    float* packed_b = matmul_alloc(nc_panels * MATMUL_NR * kc_max);
+    float* row = matmul_alloc(nc_max);
+    if (!packed_a || !packed_b || !row) {
+        allocator_free(packed_a);
+        allocator_free(packed_b);
+        allocator_free(row);
+        return TENSOR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    float* out = (float*) c->data;
+    const uint64_t c_row = matmul_stride(c, 0);
+    const uint64_t c_col = matmul_stride(c, 1);
+    float tile[MATMUL_MR * MATMUL_NR];
+
+    matmul_zero(c, m, n);
+
+    for (size_t jc = 0; jc < n; jc += MATMUL_NC) {
+        const size_t nc = n - jc < MATMUL_NC ? n - jc : MATMUL_NC;
+
+        for (size_t pc = 0; pc < k; pc += MATMUL_KC) {
+            const size_t kc = k - pc < MATMUL_KC ? k - pc : MATMUL_KC;
+            if (paneled && !direct_b) {
+                matmul_pack_b_paneled(b, pc, kc, jc, nc, packed_b);
+            } else if (!paneled) {
+                matmul_pack_b(b, pc, kc, jc, nc, packed_b, row);
+            }
+
+            for (size_t ic = 0; ic < m; ic += MATMUL_MC) {
+                const size_t mc = m - ic < MATMUL_MC ? m - ic : MATMUL_MC;
+                matmul_pack_a(a, ic, mc, pc, kc, packed_a);
+
+                for (size_t jr = 0; jr < nc; jr += MATMUL_NR) {
+                    const size_t cols = nc - jr < MATMUL_NR ? nc - jr : MATMUL_NR;
+                    const size_t panel = (jc + jr) / MATMUL_NR;
+                    const float* b_panel = direct_b
+                                               ? panels + (panel * k + pc) * MATMUL_NR
+                                               : packed_b + (jr / MATMUL_NR) * kc * MATMUL_NR;
+
+                    for (size_t ir = 0; ir < mc; ir += MATMUL_MR) {
+                        const size_t rows = mc - ir < MATMUL_MR ? mc - ir : MATMUL_MR;
+                        const float* a_panel = packed_a + (ir / MATMUL_MR) * kc * MATMUL_MR;
+                        float* dst = out + (ic + ir) * c_row + (jc + jr) * c_col;
+
+                        if (MATMUL_MR == rows && MATMUL_NR == cols && 1 == c_col) {
+                            matmul_kernel(kc, a_panel, b_panel, dst, c_row);
+                            continue;
+                        }
+
+                        // Edge tiles and strided outputs go through a scratch tile
+                        memset(tile, 0, sizeof(tile));
+                        matmul_kernel(kc, a_panel, b_panel, tile, MATMUL_NR);
+                        for (size_t i = 0; i < rows; ++i) {
+                            for (size_t j = 0; j < cols; ++j) {
+                                dst[i * c_row + j * c_col] += tile[i * MATMUL_NR + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    allocator_free(row);
+    allocator_free(packed_b);
+    allocator_free(packed_a);
+    return TENSOR_SUCCESS;
+}
+
+TensorState tensor_gemv(const Tensor* w, const Tensor* x, Tensor* y) {
+    TensorState state;
+    if (TENSOR_SUCCESS != (state = matmul_validate_weight(w, "w", false))
+        || TENSOR_SUCCESS != (state = matmul_validate_f32(x, 1, "x"))
+        || TENSOR_SUCCESS != (state = matmul_validate_f32(y, 1, "y"))) {
+        return state;
+    }
+
+    const size_t m = matmul_dim(w, 0);
+    const size_t k = (size_t) matmul_dim(w, 1) * matmul_values_per_element(w->type->id);
+    if (matmul_dim(x, 0) != k || matmul_dim(y, 0) != m) {
+        LOG_ERROR(
+            "%s: Shape mismatch: w=[%zu, %zu], x=[%u], y=[%u].\n",
+            __func__,
+            m,
+            k,
+            matmul_dim(x, 0),
+            matmul_dim(y, 0)
+        );
+        return TENSOR_INVALID_SHAPE;
+    }
+
+    matmul_dispatch();
+
+    // Contiguous copies of x and the decoded row let the dot kernel stream both operands
+    const MatmulGemvPath path = matmul_gemv_path(w);
+    const size_t blocks = k / BLOCK_SIZE;
+    float* vector = matmul_alloc(k);
+    float* row = MATMUL_GEMV_DECODE == path ? matmul_alloc(k) : NULL;
+    BlockQ8* quants = MATMUL_GEMV_BLOCK == path ? matmul_alloc_blocks(blocks) : NULL;
+    if (!vector || (MATMUL_GEMV_DECODE == path && !row) || (MATMUL_GEMV_BLOCK == path && !quants)) {
+        allocator_free(vector);
+        allocator_free(row);
+        allocator_free(quants);
+        return TENSOR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    const float* src = (const float*) x->data;
+    for (size_t j = 0; j < k; ++j) {
+        vector[j] = src[j * matmul_stride(x, 0)];
+    }
+
+    // Quantize x once so every block row is an int8 dot product
+    if (MATMUL_GEMV_BLOCK == path) {
+        quantize_row_block_q8(vector, quants, (uint32_t) k);
+    }
+
+    const float* table = MATMUL_GEMV_LUT == path ? data_type_decode_table(w->type->id) : NULL;
+    const char* weights = (const char*) w->data;
+    const size_t pitch = matmul_stride(w, 0) * w->type->size;
+    float* out = (float*) y->data;
+
+    for (size_t i = 0; i < m; ++i) {
+        const void* weight = weights + i * pitch;
+        float sum;
+        switch (path) {
+            case MATMUL_GEMV_F32:
+                sum = matmul_dot((const float*) weight, vector, k);
+                break;
+            case MATMUL_GEMV_F16:
+                sum = dot_f16_f32((const uint16_t*) weight, vector, k);
+                break;
+            case MATMUL_GEMV_BLOCK:
+                sum = TYPE_BLOCK_Q8 == w->type->id
+                          ? dot_q8_q8((const BlockQ8*) weight, quants, blocks)
+                          : dot_q4_q8((const BlockQ4*) weight, quants, blocks);
+                break;
+            case MATMUL_GEMV_LUT:
+                sum = dot_lut_f32(table, (const uint8_t*) weight, vector, k);
+                break;
+            default:
+                matmul_decode_row(w, i, 0, k, row);
+                sum = matmul_dot(row, vector, k);
+                break;
+        }
+        out[i * matmul_stride(y, 0)] = sum;
+    }
+
+    allocator_free(quants);
+    allocator_free(row);
+    allocator_free(vector);
+    return TENSOR_SUCCESS;
+}
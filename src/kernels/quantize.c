@@ -0,0 +1,633 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/kernels/quantize.c
+ *
+ * @brief Threaded bulk conversion of whole tensors between numeric types.
+ *
+ * Each partition of rows is converted independently: float32 sources are
+ * encoded in place, other sources are decoded into the partition's scratch
+ * row and then encoded. Nothing is shared between partitions.
+ *
+ * Calibrated conversions pass per-channel importance down to the weighted
+ * block encoders, which pick each block's scale and clipping to minimize the
+ * error of the layer's output rather than of the weights themselves.
+ */
+
+#include <inttypes.h>
+#include <time.h>
+
+#include "interface/allocator.h"
+#include "interface/logger.h"
+
+#include "kernels/quantize.h"
+#include "threads.h"
+
+#define QUANTIZE_ALIGNMENT 64
+
+typedef struct QuantizePlan {
+    DataTypeId source; // Type of the input rows
+    DataTypeId target; // Type of the output rows
+    const char* input; // First input row
+    char* output; // First output row
+    float* scratch; // One decoded row per partition, or NULL for float32 sources
+    const float* importance; // Per-value weights of a calibrated block encoding, or NULL
+    size_t input_pitch; // Bytes per input row
+    size_t output_pitch; // Bytes per output row
+    uint32_t values; // Logical values per row
+} QuantizePlan;
+
+bool quantize_is_supported(DataTypeId id) {
+    switch (id) {
+        case TYPE_FLOAT32:
+        case TYPE_FLOAT16:
+        case TYPE_QUANT8:
+        case TYPE_QUANT4:
+        case TYPE_BLOCK_Q8:
+        case TYPE_BLOCK_Q4:
+        case TYPE_BLOCK_Q4_MIN:
+        case TYPE_BFLOAT16:
+        case TYPE_FP8_E4M3:
+        case TYPE_FP8_E5M2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static double quantize_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// Derives the rates of a finished conversion, logs them, and copies them to report
+static void quantize_report(
+    const char* caller,
+    const char* from,
+    const char* to,
+    QuantizeReport* stats,
+    QuantizeReport* report
+) {
+    const double seconds = stats->seconds;
+    stats->values_per_second = seconds > 0.0 ? (double) stats->values / seconds : 0.0;
+    stats->gb_per_second = seconds > 0.0 ? (double) stats->bytes / seconds * 1e-9 : 0.0;
+
+    LOG_INFO(
+        "%s: Converted %" PRIu64 " values from %s to %s in %.3f s (%.1f M values/s, %.2f GB/s, %u "
+        "threads).\n",
+        caller,
+        stats->values,
+        from,
+        to,
+        stats->seconds,
+        stats->values_per_second * 1e-6,
+        stats->gb_per_second,
+        stats->threads
+    );
+
+    if (report) {
+        *report = *stats;
+    }
+}
+
+// Decodes a row of count logical values into float32
+static void quantize_decode_row(DataTypeId id, const void* src, float* out, uint32_t count) {
+    switch (id) {
+        case TYPE_FLOAT16:
+            dequantize_row_fp16((const uint16_t*) src, out, count, 1);
+            break;
+        case TYPE_QUANT8:
+            dequantize_row_q8((const Q8*) src, out, count, 1);
+            break;
+        case TYPE_QUANT4:
+            dequantize_row_q4((const Q4*) src, out, count, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            dequantize_row_block_q8((const BlockQ8*) src, out, count);
+            break;
+        case TYPE_BLOCK_Q4:
+            dequantize_row_block_q4((const BlockQ4*) src, out, count);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            dequantize_row_block_q4_min((const BlockQ4Min*) src, out, count);
+            break;
+        case TYPE_BFLOAT16:
+            dequantize_row_bf16((const uint16_t*) src, out, count, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            dequantize_row_fp8_e4m3((const uint8_t*) src, out, count, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            dequantize_row_fp8_e5m2((const uint8_t*) src, out, count, 1);
+            break;
+        default:
+            memcpy(out, src, count * sizeof(float));
+            break;
+    }
+}
+
+// Encodes a row of count float32 values
+static void quantize_encode_row(DataTypeId id, const float* src, void* out, uint32_t count) {
+    switch (id) {
+        case TYPE_FLOAT16:
+            quantize_row_fp16(src, (uint16_t*) out, count, 1);
+            break;
+        case TYPE_QUANT8:
+            quantize_row_q8(src, (Q8*) out, count, 1);
+            break;
+        case TYPE_QUANT4:
+            quantize_row_q4(src, (Q4*) out, count, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8(src, (BlockQ8*) out, count);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4(src, (BlockQ4*) out, count);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            quantize_row_block_q4_min(src, (BlockQ4Min*) out, count);
+            break;
+        case TYPE_BFLOAT16:
+            quantize_row_bf16(src, (uint16_t*) out, count, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            quantize_row_fp8_e4m3(src, (uint8_t*) out, count, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            quantize_row_fp8_e5m2(src, (uint8_t*) out, count, 1);
+            break;
+        default:
+            memcpy(out, src, count * sizeof(float));
+            break;
+    }
+}
+
+// Encodes a row of count float32 values into a block type, minimizing the weighted error
+static void quantize_encode_row_weighted(
+    DataTypeId id, const float* src, const float* importance, void* out, uint32_t count
+) {
+    switch (id) {
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8_weighted(src, importance, (BlockQ8*) out, count);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4_weighted(src, importance, (BlockQ4*) out, count);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            quantize_row_block_q4_min_weighted(src, importance, (BlockQ4Min*) out, count);
+            break;
+        default:
+            quantize_encode_row(id, src, out, count);
+            break;
+    }
+}
+
+static void quantize_rows_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    const QuantizePlan* plan = (const QuantizePlan*) context;
+
+    for (uint64_t row = start; row < end; ++row) {
+        const char* src = plan->input + row * plan->input_pitch;
+        char* dst = plan->output + row * plan->output_pitch;
+
+        const float* decoded = (const float*) src;
+        if (TYPE_FLOAT32 == plan->target) {
+            quantize_decode_row(plan->source, src, (float*) dst, plan->values);
+            continue;
+        }
+        if (TYPE_FLOAT32 != plan->source) {
+            float* scratch = plan->scratch + (size_t) partition * plan->values;
+            quantize_decode_row(plan->source, src, scratch, plan->values);
+            decoded = scratch;
+        }
+
+        if (plan->importance) {
+            quantize_encode_row_weighted(
+                plan->target, decoded, plan->importance, dst, plan->values
+            );
+        } else {
+            quantize_encode_row(plan->target, decoded, dst, plan->values);
+        }
+    }
+}
+
+static Tensor* quantize_tensor_rows(
+    const Tensor* tensor, DataTypeId target, const float* importance, QuantizeReport* report
+) {
+    if (!tensor || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor.\n", __func__);
+        return NULL;
+    }
+
+    const DataTypeId source = tensor->type->id;
+    if (!quantize_is_supported(source) || !quantize_is_supported(target)) {
+        LOG_ERROR(
+            "%s: Unsupported conversion from %s to %s.\n",
+            __func__,
+            tensor->type->name,
+            data_type_name(target)
+        );
+        return NULL;
+    }
+
+    if (!tensor_is_contiguous(tensor)) {
+        LOG_ERROR("%s: Tensor must be contiguous and row-major.\n", __func__);
+        return NULL;
+    }
+
+    const uint32_t rank = tensor->rank;
+    const uint32_t* shape = tensor_shape_data(tensor);
+    const uint64_t values = (uint64_t) shape[rank - 1] * data_type_values(source);
+    const uint32_t per_element = data_type_values(target);
+    if (values > UINT32_MAX || 0 != values % per_element) {
+        LOG_ERROR(
+            "%s: Row of %" PRIu64 " values does not fit whole %s elements.\n",
+            __func__,
+            values,
+            data_type_name(target)
+        );
+        return NULL;
+    }
+
+    uint32_t dimensions[rank];
+    memcpy(dimensions, shape, rank * sizeof(uint32_t));
+    dimensions[rank - 1] = (uint32_t) (values / per_element);
+
+    Tensor* output = tensor_create_uninitialized(target, rank, dimensions);
+    if (!output) {
+        LOG_ERROR("%s: Failed to create %s tensor.\n", __func__, data_type_name(target));
+        return NULL;
+    }
+
+    const uint64_t rows = tensor->size / shape[rank - 1];
+    const uint64_t grain = values >= QUANTIZE_GRAIN ? 1 : QUANTIZE_GRAIN / values;
+    const uint32_t partitions = thread_partitions(rows, grain);
+
+    QuantizePlan plan = {
+        .source = source,
+        .target = target,
+        .input = (const char*) tensor->data,
+        .output = (char*) output->data,
+        .scratch = NULL,
+        .importance = importance,
+        .input_pitch = (size_t) shape[rank - 1] * tensor->type->size,
+        .output_pitch = (size_t) dimensions[rank - 1] * output->type->size,
+        .values = (uint32_t) values,
+    };
+
+    if (TYPE_FLOAT32 != source && TYPE_FLOAT32 != target) {
+        size_t bytes = (size_t) partitions * values * sizeof(float);
+        plan.scratch = (float*) allocator_alloc(bytes, QUANTIZE_ALIGNMENT, ALLOCATOR_NONE);
+        if (!plan.scratch) {
+            LOG_ERROR("%s: Failed to allocate %zu bytes for scratch rows.\n", __func__, bytes);
+            tensor_free(output);
+            return NULL;
+        }
+    }
+
+    const double start = quantize_now();
+    const uint32_t used = thread_parallel_for(rows, grain, quantize_rows_task, &plan);
+    const double seconds = quantize_now() - start;
+    allocator_free(plan.scratch);
+
+    QuantizeReport stats = {
+        .values = rows * values,
+        .bytes = tensor_byte_size(tensor) + tensor_byte_size(output),
+        .threads = used,
+        .seconds = seconds,
+    };
+    quantize_report(__func__, tensor->type->name, output->type->name, &stats, report);
+    return output;
+}
+
+Tensor* quantize_tensor(const Tensor* tensor, DataTypeId target, QuantizeReport* report) {
+    return quantize_tensor_rows(tensor, target, NULL, report);
+}
+
+// ---------------------- Calibration ----------------------
+
+QuantizeCalibration* quantize_calibration_create(uint32_t channels) {
+    if (0 == channels) {
+        LOG_ERROR("%s: Calibration needs at least one channel.\n", __func__);
+        return NULL;
+    }
+
+    QuantizeCalibration* calibration = malloc(sizeof(QuantizeCalibration));
+    if (!calibration) {
+        LOG_ERROR("%s: Failed to allocate calibration.\n", __func__);
+        return NULL;
+    }
+
+    calibration->sums = calloc(channels, sizeof(double));
+    if (!calibration->sums) {
+        LOG_ERROR("%s: Failed to allocate %u channel sums.\n", __func__, channels);
+        free(calibration);
+        return NULL;
+    }
+    calibration->channels = channels;
+    calibration->samples = 0;
+    return calibration;
+}
+
+void quantize_calibration_free(QuantizeCalibration* calibration) {
+    if (calibration) {
+        free(calibration->sums);
+        free(calibration);
+    }
+}
+
+TensorState
+quantize_calibration_observe(QuantizeCalibration* calibration, const Tensor* activations) {
+    if (!calibration || !activations || !activations->data) {
+        LOG_ERROR("%s: Invalid arguments.\n", __func__);
+        return TENSOR_ERROR;
+    }
+
+    const uint32_t* shape = tensor_shape_data(activations);
+    if (TYPE_FLOAT32 != activations->type->id || !tensor_is_contiguous(activations)
+        || shape[activations->rank - 1] != calibration->channels) {
+        LOG_ERROR(
+            "%s: Expected contiguous float32 activations with %u channels.\n",
+            __func__,
+            calibration->channels
+        );
+        return TENSOR_ERROR;
+    }
+
+    const float* x = (const float*) activations->data;
+    const uint64_t rows = activations->size / calibration->channels;
+    for (uint64_t r = 0; r < rows; ++r) {
+        const float* row = x + r * calibration->channels;
+        for (uint32_t c = 0; c < calibration->channels; ++c) {
+            calibration->sums[c] += (double) row[c] * (double) row[c];
+        }
+    }
+    calibration->samples += rows;
+    return TENSOR_SUCCESS;
+}
+
+TensorState
+quantize_calibration_importance(const QuantizeCalibration* calibration, float* importance) {
+    if (!calibration || !importance) {
+        LOG_ERROR("%s: Invalid arguments.\n", __func__);
+        return TENSOR_ERROR;
+    }
+
+    double total = 0.0;
+    for (uint32_t c = 0; c < calibration->channels; ++c) {
+        total += calibration->sums[c];
+    }
+
+    // Without signal every channel matters equally
+    const double mean = total / (double) calibration->channels;
+    for (uint32_t c = 0; c < calibration->channels; ++c) {
+        const double weight = mean > 0.0 ? calibration->sums[c] / mean : 1.0;
+        const double least = QUANTIZE_IMPORTANCE_FLOOR;
+        importance[c] = (float) (weight > least ? weight : least);
+    }
+    return TENSOR_SUCCESS;
+}
+
+Tensor* quantize_tensor_calibrated(
+    const Tensor* weights,
+    DataTypeId target,
+    const QuantizeCalibration* calibration,
+    QuantizeReport* report
+) {
+    if (TYPE_BLOCK_Q8 != target && TYPE_BLOCK_Q4 != target && TYPE_BLOCK_Q4_MIN != target) {
+        LOG_ERROR(
+            "%s: Calibration targets block types, not %s.\n", __func__, data_type_name(target)
+        );
+        return NULL;
+    }
+
+    if (!weights || !weights->data) {
+        LOG_ERROR("%s: Invalid tensor.\n", __func__);
+        return NULL;
+    }
+
+    // Rows are output channels; their values pair with the observed input channels
+    const uint32_t* shape = tensor_shape_data(weights);
+    const uint32_t per_element = data_type_values(weights->type->id);
+    const uint64_t values = (uint64_t) shape[weights->rank - 1] * per_element;
+    if (calibration && calibration->channels != values) {
+        LOG_ERROR(
+            "%s: Rows of %" PRIu64 " values do not match %u calibrated channels.\n",
+            __func__,
+            values,
+            calibration->channels
+        );
+        return NULL;
+    }
+
+    float* importance = malloc(sizeof(float) * values);
+    if (!importance) {
+        LOG_ERROR("%s: Failed to allocate %" PRIu64 " channel weights.\n", __func__, values);
+        return NULL;
+    }
+    for (uint64_t c = 0; c < values; ++c) {
+        importance[c] = 1.0f;
+    }
+    if (calibration) {
+        quantize_calibration_importance(calibration, importance);
+    }
+
+    Tensor* output = quantize_tensor_rows(weights, target, importance, report);
+    free(importance);
+    return output;
+}
+
+// ---------------------- Packed 4-bit Storage ----------------------
+
+typedef struct QuantizePackedPlan {
+    DataTypeId source; // Type of the unpacked input rows
+    const char* input; // First input row when packing
+    float* output; // First float32 output row when unpacking
+    float* scratch; // One decoded row per partition, or NULL for float32 sources
+    size_t input_pitch; // Bytes per input row
+    uint8_t* nibbles; // Packed codes
+    uint16_t* scales; // Packed scales
+    uint32_t values; // Values per row
+    uint32_t group; // Values per scale
+    uint32_t groups; // Scales per row
+} QuantizePackedPlan;
+
+static void quantize_pack_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    const QuantizePackedPlan* plan = (const QuantizePackedPlan*) context;
+
+    for (uint64_t row = start; row < end; ++row) {
+        const char* src = plan->input + row * plan->input_pitch;
+        const float* decoded = (const float*) src;
+        if (TYPE_FLOAT32 != plan->source) {
+            float* scratch = plan->scratch + (size_t) partition * plan->values;
+            quantize_decode_row(plan->source, src, scratch, plan->values);
+            decoded = scratch;
+        }
+        quantize_row_q4_packed(
+            decoded,
+            plan->nibbles + row * (plan->values / 2),
+            plan->scales + row * plan->groups,
+            plan->values,
+            plan->group
+        );
+    }
+}
+
+static void quantize_unpack_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    const QuantizePackedPlan* plan = (const QuantizePackedPlan*) context;
+    (void) partition;
+
+    for (uint64_t row = start; row < end; ++row) {
+        dequantize_row_q4_packed(
+            plan->nibbles + row * (plan->values / 2),
+            plan->scales + row * plan->groups,
+            plan->output + row * plan->values,
+            plan->values,
+            plan->group
+        );
+    }
+}
+
+QuantizeQ4Packed* quantize_tensor_q4_packed(
+    const Tensor* tensor, uint32_t group, QuantizeReport* report
+) {
+    if (!tensor || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor.\n", __func__);
+        return NULL;
+    }
+
+    const DataTypeId source = tensor->type->id;
+    if (!quantize_is_supported(source) || !tensor_is_contiguous(tensor)) {
+        LOG_ERROR("%s: Expected a contiguous floating-point or quantized tensor.\n", __func__);
+        return NULL;
+    }
+
+    const uint32_t rank = tensor->rank;
+    const uint32_t* shape = tensor_shape_data(tensor);
+    const uint64_t values = (uint64_t) shape[rank - 1] * data_type_values(source);
+    if (rank > TENSOR_MAX_RANK || values > UINT32_MAX || 0 != values % 2 || 0 == group
+        || 0 != group % 2) {
+        LOG_ERROR(
+            "%s: Rows of %" PRIu64 " values cannot be packed in groups of %u.\n",
+            __func__,
+            values,
+            group
+        );
+        return NULL;
+    }
+
+    QuantizeQ4Packed* packed = calloc(1, sizeof(QuantizeQ4Packed));
+    if (!packed) {
+        LOG_ERROR("%s: Failed to allocate packed storage.\n", __func__);
+        return NULL;
+    }
+    packed->rank = rank;
+    memcpy(packed->shape, shape, rank * sizeof(uint32_t));
+    packed->shape[rank - 1] = (uint32_t) values;
+    packed->rows = tensor->size / shape[rank - 1];
+    packed->values = (uint32_t) values;
+    packed->group = group;
+    packed->groups = (uint32_t) ((values + group - 1) / group);
+
+    const size_t nibble_bytes = quantize_q4_packed_nibble_bytes(packed);
+    const size_t scale_bytes = quantize_q4_packed_scale_bytes(packed);
+    packed->nibbles = allocator_alloc(nibble_bytes, QUANTIZE_ALIGNMENT, ALLOCATOR_NONE);
+    packed->scales = allocator_alloc(scale_bytes, QUANTIZE_ALIGNMENT, ALLOCATOR_NONE);
+    if (!packed->nibbles || !packed->scales) {
+        LOG_ERROR("%s: Failed to allocate %zu bytes.\n", __func__, nibble_bytes + scale_bytes);
+        quantize_q4_packed_free(packed);
+        return NULL;
+    }
+
+    const uint64_t grain = values >= QUANTIZE_GRAIN ? 1 : QUANTIZE_GRAIN / values;
+    const uint32_t partitions = thread_partitions(packed->rows, grain);
+    QuantizePackedPlan plan = {
+        .source = source,
+        .input = (const char*) tensor->data,
+        .input_pitch = (size_t) shape[rank - 1] * tensor->type->size,
+        .nibbles = packed->nibbles,
+        .scales = packed->scales,
+        .values = packed->values,
+        .group = group,
+        .groups = packed->groups,
+    };
+
+    if (TYPE_FLOAT32 != source) {
+        size_t bytes = (size_t) partitions * values * sizeof(float);
+        plan.scratch = (float*) allocator_alloc(bytes, QUANTIZE_ALIGNMENT, ALLOCATOR_NONE);
+        if (!plan.scratch) {
+            LOG_ERROR("%s: Failed to allocate %zu bytes for scratch rows.\n", __func__, bytes);
+            quantize_q4_packed_free(packed);
+            return NULL;
+        }
+    }
+
+    const double start = quantize_now();
+    const uint32_t used = thread_parallel_for(packed->rows, grain, quantize_pack_task, &plan);
+    const double seconds = quantize_now() - start;
+    allocator_free(plan.scratch);
+
+    QuantizeReport stats = {
+        .values = packed->rows * values,
+        .bytes = tensor_byte_size(tensor) + nibble_bytes + scale_bytes,
+        .threads = used,
+        .seconds = seconds,
+    };
+    quantize_report(__func__, tensor->type->name, "packed qint4", &stats, report);
+    return packed;
+}
+
+Tensor* dequantize_tensor_q4_packed(const QuantizeQ4Packed* packed, QuantizeReport* report) {
+    if (!packed || !packed->nibbles || !packed->scales) {
+        LOG_ERROR("%s: Invalid packed storage.\n", __func__);
+        return NULL;
+    }
+
+    uint32_t dimensions[TENSOR_MAX_RANK];
+    memcpy(dimensions, packed->shape, packed->rank * sizeof(uint32_t));
+    Tensor* output = tensor_create_uninitialized(TYPE_FLOAT32, packed->rank, dimensions);
+    if (!output) {
+        LOG_ERROR("%s: Failed to create float32 tensor.\n", __func__);
+        return NULL;
+    }
+
+    const uint64_t grain = packed->values >= QUANTIZE_GRAIN ? 1 : QUANTIZE_GRAIN / packed->values;
+    QuantizePackedPlan plan = {
+        .output = (float*) output->data,
+        .nibbles = packed->nibbles,
+        .scales = packed->scales,
+        .values = packed->values,
+        .group = packed->group,
+        .groups = packed->groups,
+    };
+
+    const double start = quantize_now();
+    const uint32_t used = thread_parallel_for(packed->rows, grain, quantize_unpack_task, &plan);
+    const double seconds = quantize_now() - start;
+
+    QuantizeReport stats = {
+        .values = packed->rows * packed->values,
+        .bytes = quantize_q4_packed_nibble_bytes(packed) + quantize_q4_packed_scale_bytes(packed)
+                 + tensor_byte_size(output),
+        .threads = used,
+        .seconds = seconds,
+    };
+    quantize_report(__func__, "packed qint4", output->type->name, &stats, report);
+    return output;
+}
+
+size_t quantize_q4_packed_nibble_bytes(const QuantizeQ4Packed* packed) {
+    return (size_t) (packed->rows * (packed->values / 2));
+}
+
+size_t quantize_q4_packed_scale_bytes(const QuantizeQ4Packed* packed) {
+    return (size_t) (packed->rows * packed->groups * sizeof(uint16_t));
+}
+
+void quantize_q4_packed_free(QuantizeQ4Packed* packed) {
+    if (packed) {
+        allocator_free(packed->nibbles);
+        allocator_free(packed->scales);
+        free(packed);
+    }
+}
@@ -0,0 +1,745 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/kernels/reduce.c
+ *
+ * @brief Vectorized and threaded reductions over tensor axes.
+ *
+ * Two layouts are handled:
+ * - Lines: the reduced axis is walked for every output element. Unit stride
+ *   lines are reduced in place with pairwise summation; strided lines are
+ *   gathered one chunk at a time.
+ * - Columns: for contiguous inputs reduced along an outer axis, whole rows are
+ *   accumulated into a block of outputs with Kahan compensation, so the inner
+ *   dimension stays vectorized and memory is streamed in order.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "interface/cpu.h"
+#include "interface/logger.h"
+
+#include "kernels/reduce.h"
+#include "threads.h"
+
+#define REDUCE_ARGMAX_WINDOW (1u << 30) // Lane indices are 32-bit
+
+typedef float (*ReduceBlockFn)(const float* x, size_t n, bool squares);
+typedef float (*ReduceMaxFn)(const float* x, size_t n);
+typedef uint32_t (*ReduceArgmaxFn)(const float* x, uint32_t n);
+typedef void (*ReduceColumnsFn)(ReduceOp op, float* acc, float* comp, const float* row, size_t n);
+
+typedef struct ReduceKernels {
+    ReduceBlockFn block;
+    ReduceMaxFn max;
+    ReduceArgmaxFn argmax;
+    ReduceColumnsFn columns;
+} ReduceKernels;
+
+// Partial result of a line (or part of a line)
+typedef struct ReducePartial {
+    float value; // Sum, sum of squares, or maximum
+    uint64_t index; // Position of the maximum for argmax
+} ReducePartial;
+
+// Scalar kernels
+
+static float reduce_block_scalar(const float* x, size_t n, bool squares) {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t l = 0; l < 4; ++l) {
+            sum[l] += squares ? x[i + l] * x[i + l] : x[i + l];
+        }
+    }
+    for (; i < n; ++i) {
+        sum[0] += squares ? x[i] * x[i] : x[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+static float reduce_max_scalar(const float* x, size_t n) {
+    float best = -INFINITY;
+    for (size_t i = 0; i < n; ++i) {
+        best = x[i] > best ? x[i] : best;
+    }
+    return best;
+}
+
+static uint32_t reduce_argmax_scalar(const float* x, uint32_t n) {
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < n; ++i) {
+        if (x[i] > x[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void reduce_columns_scalar(ReduceOp op, float* acc, float* comp, const float* row, size_t n) {
+    if (REDUCE_MAX == op) {
+        for (size_t j = 0; j < n; ++j) {
+            acc[j] = row[j] > acc[j] ? row[j] : acc[j];
+        }
+        return;
+    }
+
+    // Kahan compensated accumulation of row (or row^2)
+    for (size_t j = 0; j < n; ++j) {
+        float y = (REDUCE_L2 == op ? row[j] * row[j] : row[j]) - comp[j];
+        float t = acc[j] + y;
+        comp[j] = (t - acc[j]) - y;
+        acc[j] = t;
+    }
+}
+
+// Resolves ties between lanes in favor of the lowest index
+static uint32_t reduce_argmax_lanes(const float* values, const uint32_t* indices, size_t lanes) {
+    size_t best = 0;
+    for (size_t l = 1; l < lanes; ++l) {
+        if (values[l] > values[best] || (values[l] == values[best] && indices[l] < indices[best])) {
+            best = l;
+        }
+    }
+    return indices[best];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 kernels
+
+__attribute__((target("avx2"))) static inline float reduce_hsum_avx2(__m256 v) {
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2"))) static inline float reduce_hmax_avx2(__m256 v) {
+    __m128 lo = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2,fma"))) static float
+reduce_block_avx2(const float* x, size_t n, bool squares) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+    size_t i = 0;
+    if (squares) {
+        for (; i + 32 <= n; i += 32) {
+            __m256 a = _mm256_loadu_ps(x + i), b = _mm256_loadu_ps(x + i + 8);
+            __m256 c = _mm256_loadu_ps(x + i + 16), d = _mm256_loadu_ps(x + i + 24);
+            s0 = _mm256_fmadd_ps(a, a, s0);
+            s1 = _mm256_fmadd_ps(b, b, s1);
+            s2 = _mm256_fmadd_ps(c, c, s2);
+            s3 = _mm256_fmadd_ps(d, d, s3);
+        }
+    } else {
+        for (; i + 32 <= n; i += 32) {
+            s0 = _mm256_add_ps(s0, _mm256_loadu_ps(x + i));
+            s1 = _mm256_add_ps(s1, _mm256_loadu_ps(x + i + 8));
+            s2 = _mm256_add_ps(s2, _mm256_loadu_ps(x + i + 16));
+            s3 = _mm256_add_ps(s3, _mm256_loadu_ps(x + i + 24));
+        }
+    }
+    float sum = reduce_hsum_avx2(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+    return sum + reduce_block_scalar(x + i, n - i, squares);
+}
+
+__attribute__((target("avx2"))) static float reduce_max_avx2(const float* x, size_t n) {
+    __m256 m0 = _mm256_set1_ps(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        m0 = _mm256_max_ps(_mm256_loadu_ps(x + i), m0);
+        m1 = _mm256_max_ps(_mm256_loadu_ps(x + i + 8), m1);
+    }
+    float best = reduce_hmax_avx2(_mm256_max_ps(m0, m1));
+    float tail = reduce_max_scalar(x + i, n - i);
+    return tail > best ? tail : best;
+}
+
+__attribute__((target("avx2"))) static uint32_t reduce_argmax_avx2(const float* x, uint32_t n) {
+    __m256 best = _mm256_set1_ps(-INFINITY);
+    __m256i best_index = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 mask = _mm256_cmp_ps(v, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, v, mask);
+        best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(mask));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    float values[8];
+    uint32_t indices[8];
+    _mm256_storeu_ps(values, best);
+    _mm256_storeu_si256((__m256i*) indices, best_index);
+    uint32_t result = reduce_argmax_lanes(values, indices, 8);
+    for (; i < n; ++i) {
+        if (x[i] > x[result]) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+__attribute__((target("avx2"))) static void
+reduce_columns_avx2(ReduceOp op, float* acc, float* comp, const float* row, size_t n) {
+    size_t j = 0;
+    if (REDUCE_MAX == op) {
+        for (; j + 8 <= n; j += 8) {
+            _mm256_storeu_ps(acc + j, _mm256_max_ps(_mm256_loadu_ps(row + j), _mm256_loadu_ps(acc + j)));
+        }
+    } else {
+        for (; j + 8 <= n; j += 8) {
+            __m256 r = _mm256_loadu_ps(row + j);
+            __m256 a = _mm256_loadu_ps(acc + j);
+            __m256 y = _mm256_sub_ps(REDUCE_L2 == op ? _mm256_mul_ps(r, r) : r, _mm256_loadu_ps(comp + j));
+            __m256 t = _mm256_add_ps(a, y);
+            _mm256_storeu_ps(comp + j, _mm256_sub_ps(_mm256_sub_ps(t, a), y));
+            _mm256_storeu_ps(acc + j, t);
+        }
+    }
+    reduce_columns_scalar(op, acc + j, comp + j, row + j, n - j);
+}
+
+// AVX-512 kernels
+
+__attribute__((target("avx512f"))) static float
+reduce_block_avx512(const float* x, size_t n, bool squares) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    size_t i = 0;
+    if (squares) {
+        for (; i + 32 <= n; i += 32) {
+            __m512 a = _mm512_loadu_ps(x + i), b = _mm512_loadu_ps(x + i + 16);
+            s0 = _mm512_fmadd_ps(a, a, s0);
+            s1 = _mm512_fmadd_ps(b, b, s1);
+        }
+    } else {
+        for (; i + 32 <= n; i += 32) {
+            s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+            s1 = _mm512_add_ps(s1, _mm512_loadu_ps(x + i + 16));
+        }
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1)) + reduce_block_scalar(x + i, n - i, squares);
+}
+
+__attribute__((target("avx512f"))) static float reduce_max_avx512(const float* x, size_t n) {
+    __m512 m0 = _mm512_set1_ps(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm512_max_ps(_mm512_loadu_ps(x + i), m0);
+        m1 = _mm512_max_ps(_mm512_loadu_ps(x + i + 16), m1);
+    }
+    float best = _mm512_reduce_max_ps(_mm512_max_ps(m0, m1));
+    float tail = reduce_max_scalar(x + i, n - i);
+    return tail > best ? tail : best;
+}
+
+__attribute__((target("avx512f"))) static uint32_t reduce_argmax_avx512(const float* x, uint32_t n) {
+    __m512 best = _mm512_set1_ps(-INFINITY);
+    __m512i best_index = _mm512_setzero_si512();
+    __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step = _mm512_set1_epi32(16);
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __mmask16 mask = _mm512_cmp_ps_mask(v, best, _CMP_GT_OQ);
+        best = _mm512_mask_blend_ps(mask, best, v);
+        best_index = _mm512_mask_blend_epi32(mask, best_index, index);
+        index = _mm512_add_epi32(index, step);
+    }
+
+    float values[16];
+    uint32_t indices[16];
+    _mm512_storeu_ps(values, best);
+    _mm512_storeu_si512(indices, best_index);
+    uint32_t result = reduce_argmax_lanes(values, indices, 16);
+    for (; i < n; ++i) {
+        if (x[i] > x[result]) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+__attribute__((target("avx512f"))) static void
+reduce_columns_avx512(ReduceOp op, float* acc, float* comp, const float* row, size_t n) {
+    size_t j = 0;
+    if (REDUCE_MAX == op) {
+        for (; j + 16 <= n; j += 16) {
+            _mm512_storeu_ps(acc + j, _mm512_max_ps(_mm512_loadu_ps(row + j), _mm512_loadu_ps(acc + j)));
+        }
+    } else {
+        for (; j + 16 <= n; j += 16) {
+            __m512 r = _mm512_loadu_ps(row + j);
+            __m512 a = _mm512_loadu_ps(acc + j);
+            __m512 y = _mm512_sub_ps(REDUCE_L2 == op ? _mm512_mul_ps(r, r) : r, _mm512_loadu_ps(comp + j));
+            __m512 t = _mm512_add_ps(a, y);
+            _mm512_storeu_ps(comp + j, _mm512_sub_ps(_mm512_sub_ps(t, a), y));
+            _mm512_storeu_ps(acc + j, t);
+        }
+    }
+    reduce_columns_scalar(op, acc + j, comp + j, row + j, n - j);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+// NEON kernels
+
+static float reduce_block_neon(const float* x, size_t n, bool squares) {
+    float32x4_t s0 = vdupq_n_f32(0.0f), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    if (squares) {
+        for (; i + 16 <= n; i += 16) {
+            float32x4_t a = vld1q_f32(x + i), b = vld1q_f32(x + i + 4);
+            float32x4_t c = vld1q_f32(x + i + 8), d = vld1q_f32(x + i + 12);
+            s0 = vfmaq_f32(s0, a, a);
+            s1 = vfmaq_f32(s1, b, b);
+            s2 = vfmaq_f32(s2, c, c);
+            s3 = vfmaq_f32(s3, d, d);
+        }
+    } else {
+        for (; i + 16 <= n; i += 16) {
+            s0 = vaddq_f32(s0, vld1q_f32(x + i));
+            s1 = vaddq_f32(s1, vld1q_f32(x + i + 4));
+            s2 = vaddq_f32(s2, vld1q_f32(x + i + 8));
+            s3 = vaddq_f32(s3, vld1q_f32(x + i + 12));
+        }
+    }
+    float sum = vaddvq_f32(vaddq_f32(vaddq_f32(s0, s1), vaddq_f32(s2, s3)));
+    return sum + reduce_block_scalar(x + i, n - i, squares);
+}
+
+static float reduce_max_neon(const float* x, size_t n) {
+    float32x4_t m0 = vdupq_n_f32(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        m0 = vmaxq_f32(vld1q_f32(x + i), m0);
+        m1 = vmaxq_f32(vld1q_f32(x + i + 4), m1);
+    }
+    float best = vmaxvq_f32(vmaxq_f32(m0, m1));
+    float tail = reduce_max_scalar(x + i, n - i);
+    return tail > best ? tail : best;
+}
+
+static uint32_t reduce_argmax_neon(const float* x, uint32_t n) {
+    float32x4_t best = vdupq_n_f32(-INFINITY);
+    uint32x4_t best_index = vdupq_n_u32(0);
+    uint32x4_t index = {0, 1, 2, 3};
+    const uint32x4_t step = vdupq_n_u32(4);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        uint32x4_t mask = vcgtq_f32(v, best);
+        best = vbslq_f32(mask, v, best);
+        best_index = vbslq_u32(mask, index, best_index);
+        index = vaddq_u32(index, step);
+    }
+
+    float values[4];
+    uint32_t indices[4];
+    vst1q_f32(values, best);
+    vst1q_u32(indices, best_index);
+    uint32_t result = reduce_argmax_lanes(values, indices, 4);
+    for (; i < n; ++i) {
+        if (x[i] > x[result]) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+static void reduce_columns_neon(ReduceOp op, float* acc, float* comp, const float* row, size_t n) {
+    size_t j = 0;
+    if (REDUCE_MAX == op) {
+        for (; j + 4 <= n; j += 4) {
+            vst1q_f32(acc + j, vmaxq_f32(vld1q_f32(row + j), vld1q_f32(acc + j)));
+        }
+    } else {
+        for (; j + 4 <= n; j += 4) {
+            float32x4_t r = vld1q_f32(row + j);
+            float32x4_t a = vld1q_f32(acc + j);
+            float32x4_t y = vsubq_f32(REDUCE_L2 == op ? vmulq_f32(r, r) : r, vld1q_f32(comp + j));
+            float32x4_t t = vaddq_f32(a, y);
+            vst1q_f32(comp + j, vsubq_f32(vsubq_f32(t, a), y));
+            vst1q_f32(acc + j, t);
+        }
+    }
+    reduce_columns_scalar(op, acc + j, comp + j, row + j, n - j);
+}
+
+#endif
+
+// Runtime dispatch
+
+static ReduceKernels reduce_kernels = {
+    reduce_block_scalar,
+    reduce_max_scalar,
+    reduce_argmax_scalar,
+    reduce_columns_scalar,
+};
+static pthread_once_t reduce_dispatch_once = PTHREAD_ONCE_INIT;
+
+static void reduce_dispatch_init(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_AVX512F)) {
+        reduce_kernels = (ReduceKernels) {
+            reduce_block_avx512,
+            reduce_max_avx512,
+            reduce_argmax_avx512,
+            reduce_columns_avx512,
+        };
+    } else if (cpu_has(CPU_AVX2 | CPU_FMA)) {
+        reduce_kernels = (ReduceKernels) {
+            reduce_block_avx2,
+            reduce_max_avx2,
+            reduce_argmax_avx2,
+            reduce_columns_avx2,
+        };
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (cpu_has(CPU_NEON)) {
+        reduce_kernels = (ReduceKernels) {
+            reduce_block_neon,
+            reduce_max_neon,
+            reduce_argmax_neon,
+            reduce_columns_neon,
+        };
+    }
+#endif
+}
+
+static inline const ReduceKernels* reduce_dispatch(void) {
+    pthread_once(&reduce_dispatch_once, reduce_dispatch_init);
+    return &reduce_kernels;
+}
+
+// Contiguous vectors
+
+// Splits the vector in halves until the leaves fit a block, bounding error by O(log n)
+static float reduce_pairwise(const ReduceKernels* kernels, const float* x, size_t n, bool squares) {
+    if (n <= REDUCE_BLOCK) {
+        return kernels->block(x, n, squares);
+    }
+    size_t half = (n / 2) & ~((size_t) 31); // Keep leaves vector aligned
+    return reduce_pairwise(kernels, x, half, squares)
+           + reduce_pairwise(kernels, x + half, n - half, squares);
+}
+
+static uint64_t reduce_argmax_windows(const ReduceKernels* kernels, const float* x, size_t n) {
+    uint64_t best = 0;
+    for (size_t start = 0; start < n; start += REDUCE_ARGMAX_WINDOW) {
+        size_t count = n - start < REDUCE_ARGMAX_WINDOW ? n - start : REDUCE_ARGMAX_WINDOW;
+        uint64_t index = start + kernels->argmax(x + start, (uint32_t) count);
+        if (x[index] > x[best]) {
+            best = index;
+        }
+    }
+    return best;
+}
+
+float reduce_sum_f32(const float* x, size_t length) {
+    return reduce_pairwise(reduce_dispatch(), x, length, false);
+}
+
+float reduce_sum_squares_f32(const float* x, size_t length) {
+    return reduce_pairwise(reduce_dispatch(), x, length, true);
+}
+
+float reduce_max_f32(const float* x, size_t length) {
+    return reduce_dispatch()->max(x, length);
+}
+
+uint64_t reduce_argmax_f32(const float* x, size_t length, float* value) {
+    uint64_t index = length ? reduce_argmax_windows(reduce_dispatch(), x, length) : 0;
+    if (value) {
+        *value = length ? x[index] : -INFINITY;
+    }
+    return index;
+}
+
+// Planning
+
+typedef struct ReducePlan {
+    const ReduceKernels* kernels;
+    ReduceOp op;
+    const float* data; // Input data
+    void* out; // Contiguous output data
+    uint32_t rank;
+    uint32_t axis;
+    const uint32_t* shape;
+    const uint64_t* stride;
+    uint64_t length; // Elements along the axis
+    uint64_t count; // Output elements
+    uint64_t inner; // Output elements per outer index in the column layout
+    ReducePartial partials[THREAD_MAX_COUNT]; // Per partition results for a split line
+} ReducePlan;
+
+static TensorState reduce_validate(const Tensor* x, uint32_t axis, ReduceOp op, const Tensor* out) {
+    if (!x || !out || !x->data || !out->data || TYPE_FLOAT32 != x->type->id
+        || TENSOR_LAYOUT_ROW_MAJOR != x->layout) {
+        LOG_ERROR("%s: Input must be a row-major float32 tensor with data.\n", __func__);
+        return TENSOR_ERROR;
+    }
+    if (op > REDUCE_L2) {
+        LOG_ERROR("%s: Invalid reduction %d.\n", __func__, op);
+        return TENSOR_ERROR;
+    }
+    if (axis >= x->rank) {
+        LOG_ERROR("%s: Axis %u out of range for rank %u.\n", __func__, axis, x->rank);
+        return TENSOR_INVALID_RANK;
+    }
+
+    DataTypeId expected = REDUCE_ARGMAX == op ? TYPE_UINT32 : TYPE_FLOAT32;
+    if (expected != out->type->id || !tensor_is_contiguous(out)) {
+        LOG_ERROR(
+            "%s: Output must be a contiguous %s tensor.\n", __func__, data_type_name(expected)
+        );
+        return TENSOR_ERROR;
+    }
+
+    // Accept the shape with the axis removed, or kept as 1
+    const uint32_t* shape = tensor_shape_data(x);
+    const uint32_t* out_shape = tensor_shape_data(out);
+    bool valid = false;
+    if (out->rank == x->rank) {
+        valid = 1 == out_shape[axis];
+        for (uint32_t d = 0; valid && d < x->rank; ++d) {
+            valid = d == axis || out_shape[d] == shape[d];
+        }
+    } else if (out->rank + 1 == x->rank) {
+        valid = true;
+        for (uint32_t d = 0, o = 0; valid && d < x->rank; ++d) {
+            if (d != axis) {
+                valid = out_shape[o++] == shape[d];
+            }
+        }
+    } else if (1 == x->rank && 1 == out->rank) {
+        valid = 1 == out_shape[0];
+    }
+
+    if (!valid) {
+        LOG_ERROR("%s: Output shape does not match the reduced input shape.\n", __func__);
+        return TENSOR_INVALID_SHAPE;
+    }
+
+    return TENSOR_SUCCESS;
+}
+
+// Returns the element offset of the start of line index within the input
+static uint64_t reduce_line_offset(const ReducePlan* plan, uint64_t line) {
+    uint64_t offset = 0;
+    for (uint32_t d = plan->rank; d-- > 0;) {
+        if (d == plan->axis) {
+            continue;
+        }
+        offset += (line % plan->shape[d]) * plan->stride[d];
+        line /= plan->shape[d];
+    }
+    return offset;
+}
+
+// Reduces elements [start, end) of a line into a partial result
+static ReducePartial
+reduce_line(const ReducePlan* plan, const float* line, uint64_t start, uint64_t end) {
+    const uint64_t step = plan->stride[plan->axis];
+    const bool squares = REDUCE_L2 == plan->op;
+    ReducePartial partial = {.value = 0.0f, .index = start};
+
+    if (1 == step) {
+        const float* x = line + start;
+        const size_t n = (size_t) (end - start);
+        switch (plan->op) {
+            case REDUCE_MAX:
+                partial.value = plan->kernels->max(x, n);
+                break;
+            case REDUCE_ARGMAX:
+                partial.index = start + reduce_argmax_windows(plan->kernels, x, n);
+                partial.value = line[partial.index];
+                break;
+            default:
+                partial.value = reduce_pairwise(plan->kernels, x, n, squares);
+                break;
+        }
+        return partial;
+    }
+
+    // Strided lines are gathered chunk by chunk, and chunk results are combined
+    float buffer[REDUCE_CHUNK];
+    float compensation = 0.0f;
+    partial.value = REDUCE_MAX == plan->op || REDUCE_ARGMAX == plan->op ? -INFINITY : 0.0f;
+    for (uint64_t offset = start; offset < end; offset += REDUCE_CHUNK) {
+        const size_t n = (size_t) (end - offset < REDUCE_CHUNK ? end - offset : REDUCE_CHUNK);
+        for (size_t i = 0; i < n; ++i) {
+            buffer[i] = line[(offset + i) * step];
+        }
+
+        switch (plan->op) {
+            case REDUCE_MAX: {
+                float value = plan->kernels->max(buffer, n);
+                partial.value = value > partial.value ? value : partial.value;
+                break;
+            }
+            case REDUCE_ARGMAX: {
+                uint32_t index = plan->kernels->argmax(buffer, (uint32_t) n);
+                if (buffer[index] > partial.value || offset == start) {
+                    partial.value = buffer[index];
+                    partial.index = offset + index;
+                }
+                break;
+            }
+            default: {
+                float y = reduce_pairwise(plan->kernels, buffer, n, squares) - compensation;
+                float t = partial.value + y;
+                compensation = (t - partial.value) - y;
+                partial.value = t;
+                break;
+            }
+        }
+    }
+    return partial;
+}
+
+// Writes the final value of a reduction into the output
+static void reduce_store(const ReducePlan* plan, uint64_t index, ReducePartial partial) {
+    switch (plan->op) {
+        case REDUCE_ARGMAX:
+            ((uint32_t*) plan->out)[index] = (uint32_t) partial.index;
+            break;
+        case REDUCE_MEAN:
+            ((float*) plan->out)[index] = partial.value / (float) plan->length;
+            break;
+        case REDUCE_L2:
+            ((float*) plan->out)[index] = sqrtf(partial.value);
+            break;
+        default:
+            ((float*) plan->out)[index] = partial.value;
+            break;
+    }
+}
+
+// Combines per partition results of a split line in partition order
+static ReducePartial reduce_combine(const ReducePlan* plan, uint32_t partitions) {
+    ReducePartial result = plan->partials[0];
+    float compensation = 0.0f;
+    for (uint32_t p = 1; p < partitions; ++p) {
+        const ReducePartial* partial = &plan->partials[p];
+        switch (plan->op) {
+            case REDUCE_MAX:
+            case REDUCE_ARGMAX:
+                if (partial->value > result.value) {
+                    result = *partial;
+                }
+                break;
+            default: {
+                float y = partial->value - compensation;
+                float t = result.value + y;
+                compensation = (t - result.value) - y;
+                result.value = t;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+// Thread tasks
+
+// Reduces whole lines [start, end)
+static void reduce_lines_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    (void) partition;
+    const ReducePlan* plan = (const ReducePlan*) context;
+    for (uint64_t line = start; line < end; ++line) {
+        const float* base = plan->data + reduce_line_offset(plan, line);
+        reduce_store(plan, line, reduce_line(plan, base, 0, plan->length));
+    }
+}
+
+// Reduces part [start, end) of the only line
+static void reduce_split_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    ReducePlan* plan = (ReducePlan*) context;
+    plan->partials[partition] = reduce_line(plan, plan->data, start, end);
+}
+
+// Reduces blocks of REDUCE_BLOCK columns, indexed as outer * blocks + block
+static void reduce_columns_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    (void) partition;
+    const ReducePlan* plan = (const ReducePlan*) context;
+    const uint64_t blocks = (plan->inner + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    float acc[REDUCE_BLOCK];
+    float comp[REDUCE_BLOCK];
+
+    for (uint64_t task = start; task < end; ++task) {
+        const uint64_t outer = task / blocks;
+        const uint64_t column = (task % blocks) * REDUCE_BLOCK;
+        const size_t n = (size_t) (plan->inner - column < REDUCE_BLOCK ? plan->inner - column : REDUCE_BLOCK);
+        const float* rows = plan->data + outer * plan->length * plan->inner + column;
+
+        for (size_t j = 0; j < n; ++j) {
+            acc[j] = REDUCE_MAX == plan->op ? -INFINITY : 0.0f;
+            comp[j] = 0.0f;
+        }
+        for (uint64_t k = 0; k < plan->length; ++k) {
+            plan->kernels->columns(plan->op, acc, comp, rows + k * plan->inner, n);
+        }
+        for (size_t j = 0; j < n; ++j) {
+            ReducePartial partial = {.value = acc[j]};
+            reduce_store(plan, outer * plan->inner + column + j, partial);
+        }
+    }
+}
+
+TensorState tensor_reduce(const Tensor* x, uint32_t axis, ReduceOp op, Tensor* out) {
+    TensorState state = reduce_validate(x, axis, op, out);
+    if (TENSOR_SUCCESS != state) {
+        return state;
+    }
+
+    ReducePlan plan = {
+        .kernels = reduce_dispatch(),
+        .op = op,
+        .data = (const float*) x->data,
+        .out = out->data,
+        .rank = x->rank,
+        .axis = axis,
+        .shape = tensor_shape_data(x),
+        .stride = tensor_stride_data(x),
+    };
+    plan.length = plan.shape[axis];
+    plan.count = x->size / plan.length;
+
+    // Contiguous inputs reduced along an outer axis accumulate whole rows
+    if (REDUCE_ARGMAX != op && axis + 1 < x->rank && tensor_is_contiguous(x)) {
+        plan.inner = plan.stride[axis];
+        const uint64_t outer = plan.count / plan.inner;
+        const uint64_t tasks = outer * ((plan.inner + REDUCE_BLOCK - 1) / REDUCE_BLOCK);
+        const uint64_t per_task = plan.length * REDUCE_BLOCK;
+        const uint64_t grain = per_task >= REDUCE_GRAIN ? 1 : REDUCE_GRAIN / per_task;
+        thread_parallel_for(tasks, grain, reduce_columns_task, &plan);
+        return TENSOR_SUCCESS;
+    }
+
+    // A single long line is split across threads and combined afterwards
+    if (1 == plan.count) {
+        uint32_t partitions = thread_parallel_for(plan.length, REDUCE_GRAIN, reduce_split_task, &plan);
+        reduce_store(&plan, 0, reduce_combine(&plan, partitions));
+        return TENSOR_SUCCESS;
+    }
+
+    const uint64_t grain = plan.length >= REDUCE_GRAIN ? 1 : REDUCE_GRAIN / plan.length;
+    thread_parallel_for(plan.count, grain, reduce_lines_task, &plan);
+    return TENSOR_SUCCESS;
+}
@@ -0,0 +1,501 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/model/loader.c
+ *
+ * @brief Parallel loading of the Tensor Section into runtime tensors.
+ *
+ * The metadata is read serially first; it is small, and it fixes the offset
+ * and size of every tensor. Workers then claim tensors from a shared counter in
+ * file order. Claiming tensor i asks the kernel for tensor i + lookahead, so the
+ * page cache fills ahead of the workers while they convert what has arrived.
+ *
+ * Verification claims index entries the same way, and the background verifier
+ * walks them on its own thread so it never holds the pool.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "interface/crc32c.h"
+#include "interface/logger.h"
+
+#include "kernels/quantize.h"
+#include "model/loader.h"
+#include "threads.h"
+
+typedef struct LoaderPlan {
+    LoaderTensors* loaded; // Metadata in, tensors out
+    const LoaderOptions* options; // Conversion and layout, or NULL
+    const MagicIndex* index; // Checksums of the stored tensors, or NULL to skip them
+    MagicFile* magic_file; // Source of mapped data
+    int fd; // Source of read data, if the file is not mapped
+    int64_t lookahead; // Distance between the tensor read and the tensor hinted
+    int64_t next; // Next tensor to claim
+    int failed; // Set once any tensor fails
+} LoaderPlan;
+
+static double loader_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// Asks the kernel to start reading a tensor's data into the page cache
+static void loader_prefetch(const LoaderPlan* plan, const MagicTensorInfo* info) {
+    if (plan->magic_file->map) {
+        const uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+        const uintptr_t begin = (uintptr_t) plan->magic_file->map + (uintptr_t) info->offset;
+        const uintptr_t first = begin & ~(page - 1);
+        madvise((void*) first, begin + (uintptr_t) info->size - first, MADV_WILLNEED);
+    } else {
+        posix_fadvise(plan->fd, info->offset, info->size, POSIX_FADV_WILLNEED);
+    }
+}
+
+// Reads size bytes at offset, resuming after short reads; sets errno on failure
+static bool loader_pread(int fd, void* data, size_t size, int64_t offset) {
+    uint8_t* bytes = (uint8_t*) data;
+    while (size > 0) {
+        ssize_t got = pread(fd, bytes, size, (off_t) offset);
+        if (got < 0 && EINTR == errno) {
+            continue;
+        }
+        if (got <= 0) {
+            if (0 == got) {
+                errno = EIO; // End of file before the tensor ends
+            }
+            return false;
+        }
+        bytes += got;
+        size -= (size_t) got;
+        offset += got;
+    }
+    return true;
+}
+
+// Whether the options convert a tensor: both types convert and its rows fit whole target elements
+static bool loader_converts(const LoaderOptions* options, const Tensor* tensor) {
+    if (!options || LOADER_KEEP_TYPE == options->target || options->target == tensor->type->id
+        || !quantize_is_supported(tensor->type->id) || !quantize_is_supported(options->target)) {
+        return false;
+    }
+    const uint32_t cols = tensor_shape_data(tensor)[tensor->rank - 1];
+    const uint64_t values = (uint64_t) cols * data_type_values(tensor->type->id);
+    return 0 == values % data_type_values(options->target);
+}
+
+// Whether the stored data of tensor i matches its checksum, if it is checked
+static bool loader_check_tensor(const LoaderPlan* plan, int64_t i, const void* data) {
+    if (!plan->index) {
+        return true;
+    }
+    const MagicTensorInfo* info = &plan->loaded->infos[i];
+    const uint32_t crc = crc32c_update(0, data, (size_t) info->size);
+    if (crc != (uint32_t) plan->index->tensors[i].checksum) {
+        LOG_ERROR(
+            "%s: Tensor '%s' is corrupt: checksum 0x%08x, expected 0x%08x.\n",
+            __func__,
+            info->name,
+            crc,
+            (uint32_t) plan->index->tensors[i].checksum
+        );
+        return false;
+    }
+    return true;
+}
+
+// Reads tensor i, checks it, then converts and repacks it as the options ask
+static Tensor* loader_read_tensor(const LoaderPlan* plan, int64_t i) {
+    const MagicTensorInfo* info = &plan->loaded->infos[i];
+    const DataTypeId stored = (DataTypeId) info->data_type;
+    uint32_t dimensions[MAGIC_MAX_DIMS];
+    for (int32_t d = 0; d < info->n_dims; ++d) {
+        dimensions[d] = (uint32_t) info->shape[d];
+    }
+
+    Tensor* tensor = NULL;
+    if (plan->magic_file->map) {
+        void* data = (void*) magic_file_tensor_data(plan->magic_file, info);
+        tensor = data ? tensor_create_from_data(stored, info->n_dims, dimensions, data) : NULL;
+    } else {
+        tensor = tensor_create_uninitialized(stored, info->n_dims, dimensions);
+        if (tensor && !loader_pread(plan->fd, tensor->data, (size_t) info->size, info->offset)) {
+            LOG_ERROR(
+                "%s: Failed to read tensor '%s': %s\n", __func__, info->name, strerror(errno)
+            );
+            tensor_free(tensor);
+            tensor = NULL;
+        }
+    }
+    if (!tensor || !loader_check_tensor(plan, i, tensor->data)) {
+        tensor_free(tensor);
+        return NULL;
+    }
+
+    const LoaderOptions* options = plan->options;
+    if (loader_converts(options, tensor)) {
+        Tensor* converted = quantize_tensor(tensor, options->target, NULL);
+        tensor_free(tensor);
+        tensor = converted;
+    }
+    if (tensor && options && options->tile_cols > 0 && 2 == tensor->rank) {
+        Tensor* tiled = tensor_repack(tensor, options->tile_rows, options->tile_cols);
+        tensor_free(tensor);
+        tensor = tiled;
+    }
+
+    if (!tensor) {
+        LOG_ERROR("%s: Failed to prepare tensor '%s'.\n", __func__, info->name);
+    }
+    return tensor;
+}
+
+// Each partition claims tensors until none are left, so uneven sizes still balance
+static void loader_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    (void) start;
+    (void) end;
+    (void) partition;
+
+    LoaderPlan* plan = (LoaderPlan*) context;
+    LoaderTensors* loaded = plan->loaded;
+    while (!__atomic_load_n(&plan->failed, __ATOMIC_RELAXED)) {
+        const int64_t i = __atomic_fetch_add(&plan->next, 1, __ATOMIC_RELAXED);
+        if (i >= loaded->count) {
+            break;
+        }
+        if (i + plan->lookahead < loaded->count) {
+            loader_prefetch(plan, &loaded->infos[i + plan->lookahead]);
+        }
+
+        loaded->tensors[i] = loader_read_tensor(plan, i);
+        if (!loaded->tensors[i]) {
+            __atomic_store_n(&plan->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Reads the metadata of every tensor, through the index or one pass over the section
+static MagicState
+loader_read_infos(MagicFile* magic_file, const MagicIndex* index, LoaderTensors* loaded) {
+    int64_t count = 0;
+    if (index) {
+        count = index->tensor_count;
+    } else {
+        int32_t version = 0, alignment = 0;
+        int64_t size = 0;
+        MagicTensorSection section = {0};
+        if (0 != fseek(magic_file->data, 0, SEEK_SET)
+            || MAGIC_SUCCESS != magic_file_read_start_marker(magic_file, &version, &alignment)
+            || MAGIC_SUCCESS != magic_file_seek_section(magic_file, MAGIC_TENSORS, &size)
+            || MAGIC_SUCCESS != magic_file_read_tensor_section(magic_file, &section)
+            || section.tensor_count < 0) {
+            LOG_ERROR("%s: %s has no readable Tensor Section.\n", __func__, magic_file->filepath);
+            return MAGIC_FILE_ERROR;
+        }
+        count = section.tensor_count;
+    }
+
+    loaded->infos = (MagicTensorInfo*) calloc(count + 1, sizeof(MagicTensorInfo));
+    loaded->tensors = (Tensor**) calloc(count + 1, sizeof(Tensor*));
+    if (!loaded->infos || !loaded->tensors) {
+        LOG_ERROR("%s: Failed to allocate %" PRId64 " tensors.\n", __func__, count);
+        return MAGIC_ERROR;
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        MagicTensorInfo* info = &loaded->infos[i];
+        MagicState state = index
+                               ? magic_file_read_tensor_entry(magic_file, &index->tensors[i], info)
+                               : magic_file_read_tensor_info(magic_file, info);
+        if (MAGIC_SUCCESS != state) {
+            return state;
+        }
+        loaded->count = i + 1;
+        loaded->bytes += (uint64_t) info->size;
+
+        // Without an index, the next metadata follows the data
+        if (!index && 0 != fseek(magic_file->data, info->offset + info->size, SEEK_SET)) {
+            LOG_ERROR("%s: Failed to skip the data of tensor '%s'.\n", __func__, info->name);
+            return MAGIC_FILE_ERROR;
+        }
+    }
+    return MAGIC_SUCCESS;
+}
+
+LoaderTensors*
+loader_read_tensors(MagicFile* magic_file, const MagicIndex* index, const LoaderOptions* options) {
+    if (MAGIC_SUCCESS != magic_file_guard(magic_file)) {
+        return NULL;
+    }
+
+    LoaderTensors* loaded = (LoaderTensors*) calloc(1, sizeof(LoaderTensors));
+    if (!loaded) {
+        LOG_ERROR("%s: Failed to allocate loaded tensors.\n", __func__);
+        return NULL;
+    }
+
+    const double start = loader_now();
+    if (MAGIC_SUCCESS != loader_read_infos(magic_file, index, loaded)) {
+        loader_free(loaded);
+        return NULL;
+    }
+
+    const bool checksums = index && MAGIC_CHECKSUM_CRC32C == index->checksum;
+    if (options && options->verify && !checksums) {
+        LOG_WARN("%s: %s records no tensor checksums to verify.\n", __func__, magic_file->filepath);
+    }
+
+    const uint32_t threads = thread_get_count();
+    const uint32_t workers = loaded->count < threads ? (uint32_t) loaded->count : threads;
+    LoaderPlan plan = {
+        .loaded = loaded,
+        .options = options,
+        .index = options && options->verify && checksums ? index : NULL,
+        .magic_file = magic_file,
+        .fd = magic_file->map ? -1 : fileno(magic_file->data),
+        .lookahead = options && options->lookahead ? options->lookahead : workers,
+        .next = 0,
+        .failed = 0,
+    };
+
+    // The data is read front to back; hint the first tensors before any worker starts
+    if (loaded->count > 0 && !magic_file->map) {
+        const MagicTensorInfo* last = &loaded->infos[loaded->count - 1];
+        const int64_t first = loaded->infos[0].offset;
+        posix_fadvise(plan.fd, first, last->offset + last->size - first, POSIX_FADV_SEQUENTIAL);
+    }
+    for (int64_t i = 0; i < plan.lookahead && i < loaded->count; ++i) {
+        loader_prefetch(&plan, &loaded->infos[i]);
+    }
+
+    if (loaded->count > 0) {
+        thread_parallel_for(workers, 1, loader_task, &plan);
+    }
+    if (plan.failed) {
+        loader_free(loaded);
+        return NULL;
+    }
+
+    loaded->seconds = loader_now() - start;
+    LOG_INFO(
+        "%s: Loaded %" PRId64 " tensors (%.2f GB) in %.3f s (%.2f GB/s, %u threads).\n",
+        __func__,
+        loaded->count,
+        (double) loaded->bytes * 1e-9,
+        loaded->seconds,
+        loaded->seconds > 0.0 ? (double) loaded->bytes / loaded->seconds * 1e-9 : 0.0,
+        workers
+    );
+    return loaded;
+}
+
+Tensor* loader_find(const LoaderTensors* loaded, const char* name) {
+    for (int64_t i = 0; i < loaded->count; ++i) {
+        if (0 == strcmp(name, loaded->infos[i].name)) {
+            return loaded->tensors[i];
+        }
+    }
+    return NULL;
+}
+
+void loader_free(LoaderTensors* loaded) {
+    if (loaded) {
+        for (int64_t i = 0; i < loaded->count; ++i) {
+            tensor_free(loaded->tensors[i]);
+            magic_tensor_info_free(&loaded->infos[i]);
+        }
+        free(loaded->tensors);
+        free(loaded->infos);
+        free(loaded);
+    }
+}
+
+// Verification
+
+// Checks index entry i: the sections, then the tensors
+static MagicState loader_verify_entry(MagicFile* magic_file, const MagicIndex* index, int64_t i) {
+    uint64_t checksum = 0;
+    uint64_t expected = 0;
+    MagicState state = MAGIC_SUCCESS;
+    if (i < index->section_count) {
+        const MagicIndexEntry* entry = &index->sections[i];
+        state = magic_file_checksum_section(magic_file, index, entry, &checksum);
+        expected = entry->checksum;
+    } else {
+        const MagicTensorEntry* entry = &index->tensors[i - index->section_count];
+        state = magic_file_checksum_tensor(magic_file, entry, &checksum);
+        expected = entry->checksum;
+    }
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    if (checksum != expected) {
+        if (i < index->section_count) {
+            LOG_ERROR(
+                "%s: Section 0x%" PRIx64 " is corrupt.\n", __func__, index->sections[i].marker
+            );
+        } else {
+            const MagicTensorEntry* entry = &index->tensors[i - index->section_count];
+            LOG_ERROR(
+                "%s: Tensor %" PRId64 " at offset %" PRId64 " is corrupt.\n",
+                __func__,
+                i - index->section_count,
+                entry->offset
+            );
+        }
+        return MAGIC_CHECKSUM_ERROR;
+    }
+    return MAGIC_SUCCESS;
+}
+
+// Records the outcome of one entry
+static void loader_verify_count(MagicState state, int64_t* corrupt, int* failed) {
+    if (MAGIC_CHECKSUM_ERROR == state) {
+        __atomic_fetch_add(corrupt, 1, __ATOMIC_RELAXED);
+    } else if (MAGIC_SUCCESS != state) {
+        __atomic_store_n(failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+typedef struct LoaderVerifyPlan {
+    MagicFile* magic_file;
+    const MagicIndex* index;
+    int64_t total; // Sections and tensors
+    int64_t next; // Next entry to claim
+    int64_t corrupt; // Entries that differ from their checksum
+    int failed; // Set once an entry cannot be read
+} LoaderVerifyPlan;
+
+static void loader_verify_task(void* context, uint64_t start, uint64_t end, uint32_t partition) {
+    (void) start;
+    (void) end;
+    (void) partition;
+
+    LoaderVerifyPlan* plan = (LoaderVerifyPlan*) context;
+    for (;;) {
+        const int64_t i = __atomic_fetch_add(&plan->next, 1, __ATOMIC_RELAXED);
+        if (i >= plan->total) {
+            break;
+        }
+        MagicState state = loader_verify_entry(plan->magic_file, plan->index, i);
+        loader_verify_count(state, &plan->corrupt, &plan->failed);
+    }
+}
+
+// Whether the index records checksums this build can verify
+static bool loader_verify_supported(const MagicFile* magic_file, const MagicIndex* index) {
+    if (MAGIC_CHECKSUM_CRC32C != index->checksum) {
+        LOG_ERROR("%s: %s records no checksums.\n", __func__, magic_file->filepath);
+        return false;
+    }
+    return true;
+}
+
+int64_t loader_verify(MagicFile* magic_file, const MagicIndex* index) {
+    if (MAGIC_SUCCESS != magic_file_guard(magic_file)
+        || !loader_verify_supported(magic_file, index)) {
+        return -1;
+    }
+
+    LoaderVerifyPlan plan = {
+        .magic_file = magic_file,
+        .index = index,
+        .total = index->section_count + index->tensor_count,
+    };
+    uint64_t bytes = 0;
+    for (int64_t i = 0; i < index->section_count; ++i) {
+        bytes += (uint64_t) index->sections[i].size;
+    }
+
+    const double start = loader_now();
+    const uint32_t threads = thread_get_count();
+    const uint32_t workers = plan.total < threads ? (uint32_t) plan.total : threads;
+    if (plan.total > 0) {
+        thread_parallel_for(workers, 1, loader_verify_task, &plan);
+    }
+    if (plan.failed) {
+        return -1;
+    }
+
+    const double seconds = loader_now() - start;
+    LOG_INFO(
+        "%s: Verified %" PRId64 " entries (%.2f GB) in %.3f s (%.2f GB/s): %" PRId64 " corrupt.\n",
+        __func__,
+        plan.total,
+        (double) bytes * 1e-9,
+        seconds,
+        seconds > 0.0 ? (double) bytes / seconds * 1e-9 : 0.0,
+        plan.corrupt
+    );
+    return plan.corrupt;
+}
+
+static void* loader_verify_thread(void* context) {
+    LoaderVerifier* verifier = (LoaderVerifier*) context;
+    for (int64_t i = 0; i < verifier->total; ++i) {
+        if (__atomic_load_n(&verifier->stop, __ATOMIC_RELAXED)) {
+            break;
+        }
+        MagicState state = loader_verify_entry(verifier->magic_file, verifier->index, i);
+        loader_verify_count(state, &verifier->corrupt, &verifier->failed);
+        __atomic_store_n(&verifier->checked, i + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+LoaderVerifier* loader_verify_start(MagicFile* magic_file, const MagicIndex* index) {
+    if (MAGIC_SUCCESS != magic_file_guard(magic_file)
+        || !loader_verify_supported(magic_file, index)) {
+        return NULL;
+    }
+
+    LoaderVerifier* verifier = (LoaderVerifier*) calloc(1, sizeof(LoaderVerifier));
+    if (!verifier) {
+        LOG_ERROR("%s: Failed to allocate the verifier.\n", __func__);
+        return NULL;
+    }
+    verifier->magic_file = magic_file;
+    verifier->index = index;
+    verifier->total = index->section_count + index->tensor_count;
+
+    if (0 != pthread_create(&verifier->thread, NULL, loader_verify_thread, verifier)) {
+        LOG_ERROR("%s: Failed to start the verifying thread.\n", __func__);
+        free(verifier);
+        return NULL;
+    }
+    return verifier;
+}
+
+int64_t loader_verify_progress(const LoaderVerifier* verifier) {
+    return __atomic_load_n(&verifier->checked, __ATOMIC_ACQUIRE);
+}
+
+int64_t loader_verify_finish(LoaderVerifier* verifier, bool cancel) {
+    if (!verifier) {
+        return -1;
+    }
+    if (cancel) {
+        __atomic_store_n(&verifier->stop, 1, __ATOMIC_RELAXED);
+    }
+    pthread_join(verifier->thread, NULL);
+
+    const bool complete = verifier->checked == verifier->total && !verifier->failed;
+    const int64_t corrupt = complete ? verifier->corrupt : -1;
+    if (complete) {
+        LOG_DEBUG(
+            "%s: Verified %" PRId64 " entries: %" PRId64 " corrupt.\n",
+            __func__,
+            verifier->total,
+            corrupt
+        );
+    }
+    free(verifier);
+    return corrupt;
+}
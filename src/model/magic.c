@@ -13,6 +13,16 @@
  * the content of the file.
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "interface/crc32c.h"
+#include "interface/data_types.h"
 #include "interface/logger.h"
 
 #include "model/magic.h"
@@ -31,6 +41,8 @@ MagicFile* magic_file_open(const char* filepath, const char* mode) {
     // Add member variables
     magic_file->filepath = filepath;
     magic_file->mode = mode;
+    magic_file->map = NULL;
+    magic_file->map_size = 0;
     magic_file->data = fopen(magic_file->filepath, magic_file->mode);
     if (!magic_file->data) {
         LOG_ERROR("%s: Unable to open file %s\n", __func__, magic_file->filepath);
@@ -42,6 +54,57 @@ MagicFile* magic_file_open(const char* filepath, const char* mode) {
     return magic_file;
 }
 
+/**
+ * @brief Maps the model file read-only and opens a stream over the mapping.
+ */
+MagicFile* magic_file_map(const char* filepath) {
+    int fd = open(filepath, O_RDONLY);
+    if (-1 == fd) {
+        LOG_ERROR("%s: Unable to open file %s\n", __func__, filepath);
+        return NULL;
+    }
+
+    struct stat info;
+    if (0 != fstat(fd, &info) || info.st_size <= 0) {
+        LOG_ERROR("%s: Unable to size file %s\n", __func__, filepath);
+        close(fd);
+        return NULL;
+    }
+
+    // The mapping keeps its own reference to the file
+    size_t size = (size_t) info.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+        LOG_ERROR("%s: Unable to map file %s\n", __func__, filepath);
+        return NULL;
+    }
+
+    MagicFile* magic_file = (MagicFile*) malloc(sizeof(MagicFile));
+    if (!magic_file) {
+        LOG_ERROR("%s: Failed to allocate memory to MagicFile.\n", __func__);
+        munmap(map, size);
+        return NULL;
+    }
+
+    magic_file->filepath = filepath;
+    magic_file->mode = "rb";
+    magic_file->map = map;
+    magic_file->map_size = size;
+    magic_file->data = fmemopen(map, size, magic_file->mode);
+    if (!magic_file->data) {
+        LOG_ERROR("%s: Unable to open a stream over %s\n", __func__, filepath);
+        munmap(map, size);
+        free(magic_file);
+        return NULL;
+    }
+    // Reads copy straight from the mapping instead of through a stream buffer
+    setvbuf(magic_file->data, NULL, _IONBF, 0);
+
+    LOG_DEBUG("%s: MagicFile mapped %zu bytes of %s.\n", __func__, size, filepath);
+    return magic_file;
+}
+
 /**
  * @brief Closes the model file.
  */
@@ -58,6 +121,12 @@ MagicState magic_file_close(MagicFile* magic_file) {
         }
     }
 
+    if (magic_file->map && 0 != munmap(magic_file->map, magic_file->map_size)) {
+        LOG_ERROR("%s: Failed to unmap %s.\n", __func__, magic_file->filepath);
+        free(magic_file);
+        return MAGIC_FILE_ERROR;
+    }
+
     free(magic_file);
     LOG_DEBUG("%s: MagicFile closed stream successfully.\n", __func__);
     return MAGIC_SUCCESS;
@@ -128,7 +197,7 @@ MagicState magic_file_pad(MagicFile* magic_file) {
     }
 
     size_t offset = (MAGIC_ALIGNMENT - (position % MAGIC_ALIGNMENT)) % MAGIC_ALIGNMENT;
-    if (0 == strcmp(magic_file->mode, "wb")) {
+    if ('w' == magic_file->mode[0] || 'a' == magic_file->mode[0]) {
         // Writing mode: Pad with `0x00` bytes
         if (offset > 0) {
             char padding[MAGIC_ALIGNMENT] = {0};
@@ -136,15 +205,15 @@ MagicState magic_file_pad(MagicFile* magic_file) {
                 LOG_ERROR("%s: Failed to write padding bytes.\n", __func__);
                 return MAGIC_ALIGNMENT_ERROR;
             }
-            LOG_DEBUG("%s: Wrote %ld padding bytes.\n", __func__, offset);
+            LOG_DEBUG("%s: Wrote %zu padding bytes.\n", __func__, offset);
         }
-    } else if (0 == strcmp(magic_file->mode, "rb")) {
-        // Reading mode: Skip padding bytes
+    } else if ('r' == magic_file->mode[0]) {
+        // Reading or update mode: Skip padding bytes
         if (0 != fseek(magic_file->data, offset, SEEK_CUR)) {
             LOG_ERROR("%s: Failed to skip padding bytes.\n", __func__);
             return MAGIC_ALIGNMENT_ERROR;
         }
-        LOG_DEBUG("%s: Skipped %ld padding bytes.\n", __func__, offset);
+        LOG_DEBUG("%s: Skipped %zu padding bytes.\n", __func__, offset);
     } else {
         LOG_ERROR("%s: Invalid file stream mode %s", __func__, magic_file->mode);
         return MAGIC_ALIGNMENT_ERROR;
@@ -161,7 +230,7 @@ MagicState magic_file_write_start_marker(MagicFile* magic_file, int32_t version,
 
     // Define the fields for the magic header
     int64_t marker = MAGIC_ALT;
-    int64_t size = sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(int32_t);
+    int64_t size = sizeof(int32_t) + sizeof(int32_t); // Version and alignment, as read back
 
     // Write the magic header fields
     if (1 != fwrite(&marker, sizeof(int64_t), 1, magic_file->data)
@@ -173,11 +242,15 @@ MagicState magic_file_write_start_marker(MagicFile* magic_file, int32_t version,
     }
 
     // Write alignment padding to end of header
-    magic_file_pad(magic_file);
+    state = magic_file_pad(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        LOG_ERROR("%s: Failed to pad the magic header.\n", __func__);
+        return state;
+    }
 
     LOG_DEBUG(
         "%s: Magic header written successfully. "
-        "Marker: 0x%lx, Size: %ld, Version: %d, Alignment: %d.\n",
+        "Marker: 0x%" PRIx64 ", Size: %" PRId64 ", Version: %d, Alignment: %d.\n",
         __func__,
         marker,
         size,
@@ -208,7 +281,10 @@ MagicState magic_file_read_start_marker(MagicFile* magic_file, int32_t* version,
     // Validate the magic marker
     if (MAGIC_ALT != marker) {
         LOG_ERROR(
-            "%s: Invalid magic header. Expected 0x%lx, got 0x%lx.\n", __func__, MAGIC_ALT, marker
+            "%s: Invalid magic header. Expected 0x%" PRIx64 ", got 0x%" PRIx64 ".\n",
+            __func__,
+            (int64_t) MAGIC_ALT,
+            marker
         );
         return MAGIC_INVALID_MARKER;
     }
@@ -217,7 +293,10 @@ MagicState magic_file_read_start_marker(MagicFile* magic_file, int32_t* version,
     const int64_t expected = sizeof(int32_t) + sizeof(int32_t);
     if (expected != size) {
         LOG_ERROR(
-            "%s: Invalid magic header size. Expected %ld, got %ld.\n", __func__, expected, size
+            "%s: Invalid magic header size. Expected %" PRId64 ", got %" PRId64 ".\n",
+            __func__,
+            expected,
+            size
         );
         return MAGIC_ERROR;
     }
@@ -227,7 +306,7 @@ MagicState magic_file_read_start_marker(MagicFile* magic_file, int32_t* version,
 
     LOG_DEBUG(
         "%s: Magic header read successfully. "
-        "Marker: 0x%lx, Size: %ld, Version: %d, Alignment: %d.\n",
+        "Marker: 0x%" PRIx64 ", Size: %" PRId64 ", Version: %d, Alignment: %d.\n",
         __func__,
         marker,
         size,
@@ -249,11 +328,18 @@ MagicState magic_file_write_section_marker(MagicFile* magic_file, int64_t marker
 
     if (1 != fwrite(&marker, sizeof(int64_t), 1, magic_file->data)
         || 1 != fwrite(&size, sizeof(int64_t), 1, magic_file->data)) {
-        LOG_ERROR("%s: Failed to write magic marker %ld or size %ld.\n", __func__, marker, size);
+        LOG_ERROR(
+            "%s: Failed to write magic marker %" PRId64 " or size %" PRId64 ".\n",
+            __func__,
+            marker,
+            size
+        );
         return MAGIC_FILE_ERROR;
     }
 
-    LOG_DEBUG("%s: Wrote section marker 0x%lx with size %ld.\n", __func__, marker, size);
+    LOG_DEBUG(
+        "%s: Wrote section marker 0x%" PRIx64 " with size %" PRId64 ".\n", __func__, marker, size
+    );
     return MAGIC_SUCCESS;
 }
 
@@ -272,49 +358,1256 @@ MagicState magic_file_read_section_marker(MagicFile* magic_file, int64_t* marker
         return MAGIC_ERROR;
     }
 
-    LOG_DEBUG("%s: Read section marker 0x%lx with size %ld.\n", __func__, *marker, *size);
+    LOG_DEBUG(
+        "%s: Read section marker 0x%" PRIx64 " with size %" PRId64 ".\n", __func__, *marker, *size
+    );
     return MAGIC_SUCCESS;
 }
 
 /**
- * @brief Writes the end marker (MAGIC_END) to the model file.
+ * @brief Finds a section by skipping over the sections before it.
  */
-MagicState magic_file_write_end_marker(MagicFile* magic_file) {
+MagicState magic_file_seek_section(MagicFile* magic_file, int64_t marker, int64_t* size) {
     MagicState state = magic_file_guard(magic_file);
     if (MAGIC_SUCCESS != state) {
         return state;
     }
 
-    int32_t marker = MAGIC_END;
-    if (1 != fwrite(&marker, sizeof(int32_t), 1, magic_file->data)) {
-        LOG_ERROR("%s: Failed to write end marker.\n", __func__);
+    for (;;) {
+        int64_t current = 0;
+        int64_t length = 0;
+        // The end marker has no size field, so it may be the last thing in the file
+        if (1 != fread(&current, sizeof(int64_t), 1, magic_file->data)
+            || MAGIC_END == (int32_t) current) {
+            LOG_ERROR("%s: Section 0x%" PRIx64 " not found.\n", __func__, marker);
+            return MAGIC_INVALID_MARKER;
+        }
+        if (1 != fread(&length, sizeof(int64_t), 1, magic_file->data) || length < 0) {
+            LOG_ERROR("%s: Failed to read the size of section 0x%" PRIx64 ".\n", __func__, current);
+            return MAGIC_FILE_ERROR;
+        }
+
+        if (marker == current) {
+            *size = length;
+            LOG_DEBUG(
+                "%s: Found section 0x%" PRIx64 " with size %" PRId64 ".\n", __func__, marker, length
+            );
+            return MAGIC_SUCCESS;
+        }
+
+        if (0 != fseek(magic_file->data, length, SEEK_CUR)
+            || MAGIC_SUCCESS != magic_file_pad(magic_file)) {
+            LOG_ERROR("%s: Failed to skip section 0x%" PRIx64 ".\n", __func__, current);
+            return MAGIC_FILE_ERROR;
+        }
+        LOG_DEBUG(
+            "%s: Skipped section 0x%" PRIx64 " with size %" PRId64 ".\n", __func__, current, length
+        );
+    }
+}
+
+/**
+ * @brief Writes the configuration and metadata fields of the Tensor Section.
+ */
+MagicState
+magic_file_write_tensor_section(MagicFile* magic_file, const MagicTensorSection* section) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    if (1 != fwrite(&section->data_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&section->quant_profile, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&section->context_len, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&section->tensor_count, sizeof(int64_t), 1, magic_file->data)
+        || 1 != fwrite(&section->shape_count, sizeof(int64_t), 1, magic_file->data)
+        || 1 != fwrite(&section->block_count, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&section->unique_count, sizeof(int32_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to write tensor section fields.\n", __func__);
         return MAGIC_FILE_ERROR;
     }
 
-    LOG_DEBUG("%s: Wrote end marker.\n", __func__);
     return MAGIC_SUCCESS;
 }
 
 /**
- * @brief Reads and validates the end marker (MAGIC_END) from the model file.
+ * @brief Reads the configuration and metadata fields of the Tensor Section.
  */
-MagicState magic_file_read_end_marker(MagicFile* magic_file) {
+MagicState magic_file_read_tensor_section(MagicFile* magic_file, MagicTensorSection* section) {
     MagicState state = magic_file_guard(magic_file);
     if (MAGIC_SUCCESS != state) {
         return state;
     }
 
-    int32_t marker;
-    if (1 != fread(&marker, sizeof(int32_t), 1, magic_file->data)) {
-        LOG_ERROR("%s: Failed to read end of file.\n", __func__);
+    if (1 != fread(&section->data_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&section->quant_profile, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&section->context_len, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&section->tensor_count, sizeof(int64_t), 1, magic_file->data)
+        || 1 != fread(&section->shape_count, sizeof(int64_t), 1, magic_file->data)
+        || 1 != fread(&section->block_count, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&section->unique_count, sizeof(int32_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to read tensor section fields.\n", __func__);
         return MAGIC_FILE_ERROR;
     }
-    if (MAGIC_END != marker) {
-        LOG_ERROR("%s: Invalid end marker.\n", __func__);
+
+    LOG_DEBUG(
+        "%s: Tensor section has %" PRId64 " tensors (data type %d, profile %d).\n",
+        __func__,
+        section->tensor_count,
+        section->data_type,
+        section->quant_profile
+    );
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Rewrites the quant_profile field of an existing Tensor Section in place.
+ */
+MagicState magic_file_write_quant_profile(MagicFile* magic_file, int32_t profile) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    int32_t version = 0;
+    int32_t alignment = 0;
+    int64_t size = 0;
+    if (0 != fseek(magic_file->data, 0, SEEK_SET)) {
+        LOG_ERROR("%s: Failed to rewind file stream.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    state = magic_file_read_start_marker(magic_file, &version, &alignment);
+    if (MAGIC_SUCCESS == state) {
+        state = magic_file_seek_section(magic_file, MAGIC_TENSORS, &size);
+    }
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    // quant_profile follows data_type; a seek is required between reading and writing
+    if (0 != fseek(magic_file->data, sizeof(int32_t), SEEK_CUR)
+        || 1 != fwrite(&profile, sizeof(int32_t), 1, magic_file->data)
+        || 0 != fflush(magic_file->data)) {
+        LOG_ERROR("%s: Failed to write the quantization profile.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    LOG_DEBUG("%s: Set the quantization profile to %d.\n", __func__, profile);
+    return magic_file_update_checksum(magic_file, MAGIC_TENSORS);
+}
+
+/**
+ * @brief Writes the metadata of one tensor and pads to the start of its data.
+ */
+MagicState magic_file_write_tensor_info(MagicFile* magic_file, const MagicTensorInfo* info) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    if (!info->name || info->n_dims < 1 || info->n_dims > MAGIC_MAX_DIMS) {
+        LOG_ERROR("%s: Invalid tensor metadata.\n", __func__);
         return MAGIC_ERROR;
     }
 
-    LOG_DEBUG("%s: Read and validated end of file.\n", __func__);
+    int32_t name_len = (int32_t) strlen(info->name);
+    if (1 != fwrite(&info->component_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&info->block_index, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&info->layer_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&info->projection_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&info->n_dims, sizeof(int32_t), 1, magic_file->data)
+        || (size_t) info->n_dims
+               != fwrite(info->shape, sizeof(int32_t), info->n_dims, magic_file->data)
+        || 1 != fwrite(&name_len, sizeof(int32_t), 1, magic_file->data)
+        || (size_t) name_len != fwrite(info->name, sizeof(char), name_len, magic_file->data)
+        || 1 != fwrite(&info->data_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fwrite(&info->delta, sizeof(float), 1, magic_file->data)
+        || 1 != fwrite(&info->min, sizeof(float), 1, magic_file->data)
+        || 1 != fwrite(&info->max, sizeof(float), 1, magic_file->data)
+        || 1 != fwrite(&info->packing_flag, sizeof(int8_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to write metadata of tensor '%s'.\n", __func__, info->name);
+        return MAGIC_FILE_ERROR;
+    }
+
+    // Tensor data starts on an alignment boundary
+    return magic_file_pad(magic_file);
+}
+
+// Byte size of the data described by the metadata, or -1 for an invalid type or shape,
+// including shapes whose size overflows
+static int64_t magic_tensor_data_size(const MagicTensorInfo* info) {
+    if (info->n_dims < 1 || info->n_dims > MAGIC_MAX_DIMS || info->data_type < 0
+        || info->data_type >= TYPE_COUNT) {
+        return -1;
+    }
+
+    int64_t size = (int64_t) data_type_size((DataTypeId) info->data_type);
+    for (int32_t i = 0; i < info->n_dims; ++i) {
+        if (info->shape[i] <= 0 || __builtin_mul_overflow(size, (int64_t) info->shape[i], &size)) {
+            return -1;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Reads the metadata of one tensor and locates its data.
+ */
+MagicState magic_file_read_tensor_info(MagicFile* magic_file, MagicTensorInfo* info) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    memset(info, 0, sizeof(MagicTensorInfo));
+    if (1 != fread(&info->component_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&info->block_index, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&info->layer_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&info->projection_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&info->n_dims, sizeof(int32_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to read tensor metadata.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    if (info->n_dims < 1 || info->n_dims > MAGIC_MAX_DIMS) {
+        LOG_ERROR("%s: Invalid tensor rank %d.\n", __func__, info->n_dims);
+        return MAGIC_ERROR;
+    }
+
+    if ((size_t) info->n_dims != fread(info->shape, sizeof(int32_t), info->n_dims, magic_file->data)
+        || MAGIC_SUCCESS != magic_file_read_string_field(magic_file, &info->name)) {
+        LOG_ERROR("%s: Failed to read tensor shape or name.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    if (1 != fread(&info->data_type, sizeof(int32_t), 1, magic_file->data)
+        || 1 != fread(&info->delta, sizeof(float), 1, magic_file->data)
+        || 1 != fread(&info->min, sizeof(float), 1, magic_file->data)
+        || 1 != fread(&info->max, sizeof(float), 1, magic_file->data)
+        || 1 != fread(&info->packing_flag, sizeof(int8_t), 1, magic_file->data)
+        || MAGIC_SUCCESS != magic_file_pad(magic_file)) {
+        LOG_ERROR("%s: Failed to read metadata of tensor '%s'.\n", __func__, info->name);
+        magic_tensor_info_free(info);
+        return MAGIC_FILE_ERROR;
+    }
+
+    if (info->data_type < 0 || info->data_type >= TYPE_COUNT) {
+        LOG_ERROR("%s: Tensor '%s' has invalid type %d.\n", __func__, info->name, info->data_type);
+        magic_tensor_info_free(info);
+        return MAGIC_ERROR;
+    }
+
+    info->size = magic_tensor_data_size(info);
+    if (info->size < 0) {
+        LOG_ERROR("%s: Tensor '%s' has an empty or oversized shape.\n", __func__, info->name);
+        magic_tensor_info_free(info);
+        return MAGIC_ERROR;
+    }
+
+    info->offset = ftell(magic_file->data);
+    LOG_DEBUG(
+        "%s: Tensor '%s' has %" PRId64 " bytes at offset %" PRId64 ".\n",
+        __func__,
+        info->name,
+        info->size,
+        info->offset
+    );
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Returns the data of a tensor inside a mapped file.
+ */
+const void* magic_file_tensor_data(MagicFile* magic_file, const MagicTensorInfo* info) {
+    if (MAGIC_SUCCESS != magic_file_guard(magic_file)) {
+        return NULL;
+    }
+    if (!magic_file->map) {
+        LOG_ERROR("%s: %s is not mapped.\n", __func__, magic_file->filepath);
+        return NULL;
+    }
+
+    if (info->offset < 0 || info->size < 0 || (uint64_t) info->offset > magic_file->map_size
+        || (uint64_t) info->size > magic_file->map_size - (uint64_t) info->offset) {
+        LOG_ERROR(
+            "%s: Tensor '%s' lies outside the %zu mapped bytes.\n",
+            __func__,
+            info->name,
+            magic_file->map_size
+        );
+        return NULL;
+    }
+
+    return (const uint8_t*) magic_file->map + info->offset;
+}
+
+/**
+ * @brief Releases the name owned by a MagicTensorInfo.
+ */
+void magic_tensor_info_free(MagicTensorInfo* info) {
+    if (info) {
+        free(info->name);
+        info->name = NULL;
+    }
+}
+
+// Index Section
+
+#define MAGIC_INDEX_HEADER_BYTES (3 * sizeof(int64_t)) /**< Counts and checksum type */
+#define MAGIC_INDEX_SECTION_BYTES (4 * sizeof(int64_t)) /**< Stored size of a section entry */
+#define MAGIC_INDEX_TENSOR_BYTES (4 * sizeof(int32_t) + 4 * sizeof(int64_t)) /**< Tensor entry */
+
+// Size of the Index Section, with the zero padding that aligns the end of its trailing offset
+static int64_t magic_index_section_size(const MagicIndex* index, int64_t* padding) {
+    const int64_t fields = MAGIC_INDEX_HEADER_BYTES
+                           + index->section_count * MAGIC_INDEX_SECTION_BYTES
+                           + index->tensor_count * MAGIC_INDEX_TENSOR_BYTES;
+    const int64_t used = 2 * sizeof(int64_t) + fields + sizeof(int64_t);
+    *padding = (MAGIC_ALIGNMENT - used % MAGIC_ALIGNMENT) % MAGIC_ALIGNMENT;
+    return fields + *padding + sizeof(int64_t);
+}
+
+/**
+ * @brief Records the location of a section being written.
+ */
+MagicState
+magic_index_add_section(MagicIndex* index, int64_t marker, int64_t offset, int64_t size) {
+    MagicIndexEntry* sections = (MagicIndexEntry*) realloc(
+        index->sections, (index->section_count + 1) * sizeof(MagicIndexEntry)
+    );
+    if (!sections) {
+        LOG_ERROR("%s: Failed to grow the section index.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    sections[index->section_count++] = (MagicIndexEntry) {marker, offset, size, 0};
+    index->sections = sections;
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Records the location of a tensor being written.
+ */
+MagicState magic_index_add_tensor(
+    MagicIndex* index, const MagicTensorInfo* info, int64_t info_offset, int64_t data_offset
+) {
+    const int64_t size = magic_tensor_data_size(info);
+    if (size < 0) {
+        LOG_ERROR("%s: Invalid metadata for tensor '%s'.\n", __func__, info->name);
+        return MAGIC_ERROR;
+    }
+
+    // Tensors outnumber sections by far, so the capacity doubles from 16 entries
+    const int64_t count = index->tensor_count;
+    if (0 == count || (count >= 16 && 0 == (count & (count - 1)))) {
+        const int64_t capacity = count ? 2 * count : 16;
+        MagicTensorEntry* tensors
+            = (MagicTensorEntry*) realloc(index->tensors, capacity * sizeof(MagicTensorEntry));
+        if (!tensors) {
+            LOG_ERROR("%s: Failed to grow the tensor index.\n", __func__);
+            return MAGIC_ERROR;
+        }
+        index->tensors = tensors;
+    }
+
+    index->tensors[index->tensor_count++] = (MagicTensorEntry) {
+        .component_type = info->component_type,
+        .block_index = info->block_index,
+        .layer_type = info->layer_type,
+        .projection_type = info->projection_type,
+        .info = info_offset,
+        .offset = data_offset,
+        .size = size,
+    };
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Finds the entry of a section, or NULL if it is not indexed.
+ */
+const MagicIndexEntry* magic_index_find_section(const MagicIndex* index, int64_t marker) {
+    for (int64_t i = 0; i < index->section_count; ++i) {
+        if (marker == index->sections[i].marker) {
+            return &index->sections[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the first tensor with the given identity, or NULL if there is none.
+ */
+const MagicTensorEntry* magic_index_find_tensor(
+    const MagicIndex* index,
+    int32_t component_type,
+    int32_t block_index,
+    int32_t layer_type,
+    int32_t projection_type
+) {
+    for (int64_t i = 0; i < index->tensor_count; ++i) {
+        const MagicTensorEntry* entry = &index->tensors[i];
+        if (component_type == entry->component_type && block_index == entry->block_index
+            && layer_type == entry->layer_type && projection_type == entry->projection_type) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Releases the entries owned by a MagicIndex.
+ */
+void magic_index_free(MagicIndex* index) {
+    if (index) {
+        free(index->sections);
+        free(index->tensors);
+        memset(index, 0, sizeof(MagicIndex));
+    }
+}
+
+/**
+ * @brief Writes the Index Section.
+ */
+MagicState magic_file_write_index(MagicFile* magic_file, const MagicIndex* index) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    const int64_t offset = ftell(magic_file->data);
+    if (offset < 0 || 0 != offset % MAGIC_ALIGNMENT) {
+        LOG_ERROR("%s: The index must start on an alignment boundary.\n", __func__);
+        return MAGIC_ALIGNMENT_ERROR;
+    }
+
+    // Zero padding before the trailing offset lets the end marker follow it directly
+    int64_t padding = 0;
+    const int64_t size = magic_index_section_size(index, &padding);
+
+    FILE* data = magic_file->data;
+    if (MAGIC_SUCCESS != magic_file_write_section_marker(magic_file, MAGIC_INDEX, size)
+        || 1 != fwrite(&index->section_count, sizeof(int64_t), 1, data)
+        || 1 != fwrite(&index->tensor_count, sizeof(int64_t), 1, data)
+        || 1 != fwrite(&index->checksum, sizeof(int64_t), 1, data)) {
+        LOG_ERROR("%s: Failed to write the index header.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    for (int64_t i = 0; i < index->section_count; ++i) {
+        const MagicIndexEntry* entry = &index->sections[i];
+        if (1 != fwrite(&entry->marker, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->offset, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->size, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->checksum, sizeof(uint64_t), 1, data)) {
+            LOG_ERROR("%s: Failed to write section entry %" PRId64 ".\n", __func__, i);
+            return MAGIC_FILE_ERROR;
+        }
+    }
+
+    for (int64_t i = 0; i < index->tensor_count; ++i) {
+        const MagicTensorEntry* entry = &index->tensors[i];
+        if (1 != fwrite(&entry->component_type, sizeof(int32_t), 1, data)
+            || 1 != fwrite(&entry->block_index, sizeof(int32_t), 1, data)
+            || 1 != fwrite(&entry->layer_type, sizeof(int32_t), 1, data)
+            || 1 != fwrite(&entry->projection_type, sizeof(int32_t), 1, data)
+            || 1 != fwrite(&entry->info, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->offset, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->size, sizeof(int64_t), 1, data)
+            || 1 != fwrite(&entry->checksum, sizeof(uint64_t), 1, data)) {
+            LOG_ERROR("%s: Failed to write tensor entry %" PRId64 ".\n", __func__, i);
+            return MAGIC_FILE_ERROR;
+        }
+    }
+
+    const char zeros[MAGIC_ALIGNMENT] = {0};
+    if ((size_t) padding != fwrite(zeros, 1, padding, data)
+        || 1 != fwrite(&offset, sizeof(int64_t), 1, data)) {
+        LOG_ERROR("%s: Failed to write the index trailer.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    LOG_DEBUG(
+        "%s: Indexed %" PRId64 " sections and %" PRId64 " tensors at offset %" PRId64 ".\n",
+        __func__,
+        index->section_count,
+        index->tensor_count,
+        offset
+    );
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Reads the Index Section without parsing any other section.
+ */
+MagicState magic_file_read_index(MagicFile* magic_file, MagicIndex* index) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+    memset(index, 0, sizeof(MagicIndex));
+
+    // The end marker closes the file, and the index offset closes the section before it
+    FILE* data = magic_file->data;
+    int64_t offset = 0;
+    if (0 != fseek(data, 0, SEEK_END)) {
+        LOG_ERROR("%s: Failed to seek to the end of the file.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    const int64_t end = ftell(data) - (int64_t) sizeof(int32_t);
+    if (end < 4 * (int64_t) sizeof(int64_t) || 0 != fseek(data, end - sizeof(int64_t), SEEK_SET)
+        || 1 != fread(&offset, sizeof(int64_t), 1, data)) {
+        LOG_ERROR("%s: Failed to read the index offset.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    int64_t marker = 0;
+    int64_t size = 0;
+    if (offset <= 0 || offset > end - 3 * (int64_t) sizeof(int64_t) || 0 != offset % MAGIC_ALIGNMENT
+        || 0 != fseek(data, offset, SEEK_SET) || 1 != fread(&marker, sizeof(int64_t), 1, data)
+        || 1 != fread(&size, sizeof(int64_t), 1, data) || MAGIC_INDEX != marker
+        || offset + 2 * (int64_t) sizeof(int64_t) + size != end) {
+        LOG_DEBUG("%s: %s has no index.\n", __func__, magic_file->filepath);
+        return MAGIC_INVALID_MARKER;
+    }
+
+    int64_t sections = 0;
+    int64_t tensors = 0;
+    int64_t checksum = 0;
+    if (1 != fread(&sections, sizeof(int64_t), 1, data)
+        || 1 != fread(&tensors, sizeof(int64_t), 1, data)
+        || 1 != fread(&checksum, sizeof(int64_t), 1, data)) {
+        LOG_ERROR("%s: Failed to read the index header.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    if (sections < 0 || tensors < 0
+        || sections > size / (int64_t) MAGIC_INDEX_SECTION_BYTES
+        || tensors > size / (int64_t) MAGIC_INDEX_TENSOR_BYTES
+        || (int64_t) (MAGIC_INDEX_HEADER_BYTES + sizeof(int64_t))
+                   + sections * (int64_t) MAGIC_INDEX_SECTION_BYTES
+                   + tensors * (int64_t) MAGIC_INDEX_TENSOR_BYTES
+               > size) {
+        LOG_ERROR(
+            "%s: Invalid index of %" PRId64 " sections and %" PRId64 " tensors.\n",
+            __func__,
+            sections,
+            tensors
+        );
+        return MAGIC_ERROR;
+    }
+
+    // Keep the capacity magic_index_add_tensor expects, so the index can be extended
+    int64_t capacity = 16;
+    while (capacity < tensors) {
+        capacity *= 2;
+    }
+    index->sections = (MagicIndexEntry*) calloc(sections + 1, sizeof(MagicIndexEntry));
+    index->tensors = (MagicTensorEntry*) calloc(capacity, sizeof(MagicTensorEntry));
+    if (!index->sections || !index->tensors) {
+        LOG_ERROR("%s: Failed to allocate the index.\n", __func__);
+        magic_index_free(index);
+        return MAGIC_ERROR;
+    }
+    index->checksum = checksum;
+
+    for (int64_t i = 0; i < sections; ++i) {
+        MagicIndexEntry* entry = &index->sections[i];
+        if (1 != fread(&entry->marker, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->offset, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->size, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->checksum, sizeof(uint64_t), 1, data)) {
+            LOG_ERROR("%s: Failed to read section entry %" PRId64 ".\n", __func__, i);
+            magic_index_free(index);
+            return MAGIC_FILE_ERROR;
+        }
+        index->section_count++;
+    }
+
+    for (int64_t i = 0; i < tensors; ++i) {
+        MagicTensorEntry* entry = &index->tensors[i];
+        if (1 != fread(&entry->component_type, sizeof(int32_t), 1, data)
+            || 1 != fread(&entry->block_index, sizeof(int32_t), 1, data)
+            || 1 != fread(&entry->layer_type, sizeof(int32_t), 1, data)
+            || 1 != fread(&entry->projection_type, sizeof(int32_t), 1, data)
+            || 1 != fread(&entry->info, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->offset, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->size, sizeof(int64_t), 1, data)
+            || 1 != fread(&entry->checksum, sizeof(uint64_t), 1, data)) {
+            LOG_ERROR("%s: Failed to read tensor entry %" PRId64 ".\n", __func__, i);
+            magic_index_free(index);
+            return MAGIC_FILE_ERROR;
+        }
+        index->tensor_count++;
+    }
+
+    LOG_DEBUG(
+        "%s: Read the index of %" PRId64 " sections and %" PRId64 " tensors.\n",
+        __func__,
+        sections,
+        tensors
+    );
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Jumps to an indexed section.
+ */
+MagicState
+magic_file_seek_entry(MagicFile* magic_file, const MagicIndexEntry* entry, int64_t* size) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    int64_t marker = 0;
+    if (0 != fseek(magic_file->data, entry->offset, SEEK_SET)
+        || MAGIC_SUCCESS != magic_file_read_section_marker(magic_file, &marker, size)) {
+        LOG_ERROR("%s: Failed to read section 0x%" PRIx64 ".\n", __func__, entry->marker);
+        return MAGIC_FILE_ERROR;
+    }
+    if (entry->marker != marker || entry->size != *size) {
+        LOG_ERROR(
+            "%s: Expected section 0x%" PRIx64 " at offset %" PRId64 ", found 0x%" PRIx64 ".\n",
+            __func__,
+            entry->marker,
+            entry->offset,
+            marker
+        );
+        return MAGIC_INVALID_MARKER;
+    }
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Jumps to an indexed tensor and reads its metadata.
+ */
+MagicState magic_file_read_tensor_entry(
+    MagicFile* magic_file, const MagicTensorEntry* entry, MagicTensorInfo* info
+) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    if (0 != fseek(magic_file->data, entry->info, SEEK_SET)) {
+        LOG_ERROR("%s: Failed to seek to tensor metadata at %" PRId64 ".\n", __func__, entry->info);
+        return MAGIC_FILE_ERROR;
+    }
+    state = magic_file_read_tensor_info(magic_file, info);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    if (entry->offset != info->offset || entry->size != info->size
+        || entry->block_index != info->block_index
+        || entry->component_type != info->component_type) {
+        LOG_ERROR("%s: Tensor '%s' does not match its index entry.\n", __func__, info->name);
+        magic_tensor_info_free(info);
+        return MAGIC_ERROR;
+    }
+    return MAGIC_SUCCESS;
+}
+
+// Extends a checksum with a byte range of the file, from the mapping or with pread
+static MagicState
+magic_file_crc32c(MagicFile* magic_file, int64_t offset, int64_t size, uint32_t* crc) {
+    if (offset < 0 || size < 0) {
+        LOG_ERROR(
+            "%s: Invalid range of %" PRId64 " bytes at offset %" PRId64 ".\n",
+            __func__,
+            size,
+            offset
+        );
+        return MAGIC_FILE_ERROR;
+    }
+
+    if (magic_file->map) {
+        if ((uint64_t) offset > magic_file->map_size
+            || (uint64_t) size > magic_file->map_size - (uint64_t) offset) {
+            LOG_ERROR(
+                "%s: %" PRId64 " bytes at offset %" PRId64 " overrun the file.\n",
+                __func__,
+                size,
+                offset
+            );
+            return MAGIC_FILE_ERROR;
+        }
+        *crc = crc32c_update(*crc, (const uint8_t*) magic_file->map + offset, (size_t) size);
+        return MAGIC_SUCCESS;
+    }
+
+    const size_t chunk = 1u << 20;
+    uint8_t* buffer = (uint8_t*) malloc(chunk);
+    if (!buffer) {
+        LOG_ERROR("%s: Failed to allocate the read buffer.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    const int fd = fileno(magic_file->data);
+    while (size > 0) {
+        const size_t wanted = (uint64_t) size < chunk ? (size_t) size : chunk;
+        ssize_t got = pread(fd, buffer, wanted, (off_t) offset);
+        if (got < 0 && EINTR == errno) {
+            continue;
+        }
+        if (got <= 0) {
+            LOG_ERROR(
+                "%s: Failed to read %" PRId64 " bytes at offset %" PRId64 ".\n",
+                __func__,
+                size,
+                offset
+            );
+            free(buffer);
+            return MAGIC_FILE_ERROR;
+        }
+        *crc = crc32c_update(*crc, buffer, (size_t) got);
+        offset += got;
+        size -= got;
+    }
+
+    free(buffer);
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Computes the CRC-32C of an indexed tensor's data.
+ */
+MagicState magic_file_checksum_tensor(
+    MagicFile* magic_file, const MagicTensorEntry* entry, uint64_t* checksum
+) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    uint32_t crc = 0;
+    state = magic_file_crc32c(magic_file, entry->offset, entry->size, &crc);
+    *checksum = crc;
+    return state;
+}
+
+/**
+ * @brief Computes the CRC-32C of an indexed section's fields.
+ */
+MagicState magic_file_checksum_section(
+    MagicFile* magic_file, const MagicIndex* index, const MagicIndexEntry* entry, uint64_t* checksum
+) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    // Hash the gaps between the tensors inside the section, which are in file order
+    const int64_t start = entry->offset + 2 * (int64_t) sizeof(int64_t);
+    const int64_t end = start + entry->size;
+    int64_t cursor = start;
+    uint32_t crc = 0;
+    for (int64_t i = 0; i < index->tensor_count && MAGIC_SUCCESS == state; ++i) {
+        const MagicTensorEntry* tensor = &index->tensors[i];
+        if (tensor->offset >= end || tensor->offset + tensor->size <= start) {
+            continue; // In another section
+        }
+        if (tensor->offset < cursor || tensor->offset + tensor->size > end) {
+            LOG_ERROR(
+                "%s: Tensor %" PRId64 " overlaps section 0x%" PRIx64 ".\n",
+                __func__,
+                i,
+                entry->marker
+            );
+            return MAGIC_ERROR;
+        }
+        state = magic_file_crc32c(magic_file, cursor, tensor->offset - cursor, &crc);
+        cursor = tensor->offset + tensor->size;
+    }
+    if (MAGIC_SUCCESS == state) {
+        state = magic_file_crc32c(magic_file, cursor, end - cursor, &crc);
+    }
+    *checksum = crc;
+    return state;
+}
+
+/**
+ * @brief Rewrites the recorded checksum of a section edited in place.
+ */
+MagicState magic_file_update_checksum(MagicFile* magic_file, int64_t marker) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    // The checksums read through the file descriptor, so pending writes must reach it first
+    if (0 != fflush(magic_file->data)) {
+        LOG_ERROR("%s: Failed to flush the file stream.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    MagicIndex index = {0};
+    state = magic_file_read_index(magic_file, &index);
+    if (MAGIC_SUCCESS != state) {
+        return MAGIC_INVALID_MARKER == state ? MAGIC_SUCCESS : state; // No index, no checksum
+    }
+
+    int64_t slot = 0;
+    while (slot < index.section_count && marker != index.sections[slot].marker) {
+        slot++;
+    }
+    if (MAGIC_CHECKSUM_CRC32C != index.checksum || slot == index.section_count) {
+        magic_index_free(&index);
+        return MAGIC_SUCCESS;
+    }
+
+    // The entry's checksum is its last field; the index offset precedes the end marker
+    const MagicIndexEntry* entry = &index.sections[slot];
+    const int64_t field = 2 * (int64_t) sizeof(int64_t) + (int64_t) MAGIC_INDEX_HEADER_BYTES
+                          + slot * (int64_t) MAGIC_INDEX_SECTION_BYTES
+                          + 3 * (int64_t) sizeof(int64_t);
+    FILE* data = magic_file->data;
+    int64_t offset = 0;
+    uint64_t checksum = 0;
+    state = magic_file_checksum_section(magic_file, &index, entry, &checksum);
+    magic_index_free(&index);
+    if (MAGIC_SUCCESS == state
+        && (0 != fseek(data, -(long) (sizeof(int64_t) + sizeof(int32_t)), SEEK_END)
+            || 1 != fread(&offset, sizeof(int64_t), 1, data)
+            || 0 != fseek(data, offset + field, SEEK_SET)
+            || 1 != fwrite(&checksum, sizeof(uint64_t), 1, data) || 0 != fflush(data))) {
+        LOG_ERROR(
+            "%s: Failed to update the checksum of section 0x%" PRIx64 ".\n", __func__, marker
+        );
+        state = MAGIC_FILE_ERROR;
+    }
+    return state;
+}
+
+/**
+ * @brief Records the CRC-32C of every section and tensor of an index.
+ */
+MagicState magic_file_checksum_index(MagicFile* magic_file, MagicIndex* index) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+    if (!index) {
+        LOG_ERROR("%s: MagicIndex is NULL.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    // The checksums read through the file descriptor, so pending writes must reach it first
+    if (0 != fflush(magic_file->data)) {
+        LOG_ERROR("%s: Failed to flush the file stream.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    for (int64_t i = 0; i < index->tensor_count && MAGIC_SUCCESS == state; ++i) {
+        MagicTensorEntry* entry = &index->tensors[i];
+        state = magic_file_checksum_tensor(magic_file, entry, &entry->checksum);
+    }
+    for (int64_t i = 0; i < index->section_count && MAGIC_SUCCESS == state; ++i) {
+        MagicIndexEntry* entry = &index->sections[i];
+        state = magic_file_checksum_section(magic_file, index, entry, &entry->checksum);
+    }
+    if (MAGIC_SUCCESS == state) {
+        index->checksum = MAGIC_CHECKSUM_CRC32C;
+    }
+    return state;
+}
+
+/**
+ * @brief Writes the end marker (MAGIC_END) to the model file.
+ */
+MagicState magic_file_write_end_marker(MagicFile* magic_file) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    int32_t marker = MAGIC_END;
+    if (1 != fwrite(&marker, sizeof(int32_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to write end marker.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    LOG_DEBUG("%s: Wrote end marker.\n", __func__);
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Reads and validates the end marker (MAGIC_END) from the model file.
+ */
+MagicState magic_file_read_end_marker(MagicFile* magic_file) {
+    MagicState state = magic_file_guard(magic_file);
+    if (MAGIC_SUCCESS != state) {
+        return state;
+    }
+
+    int32_t marker;
+    if (1 != fread(&marker, sizeof(int32_t), 1, magic_file->data)) {
+        LOG_ERROR("%s: Failed to read end of file.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    if (MAGIC_END != marker) {
+        LOG_ERROR("%s: Invalid end marker.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    LOG_DEBUG("%s: Read and validated end of file.\n", __func__);
+    return MAGIC_SUCCESS;
+}
+
+// MagicWriter
+
+// The writer stores index entries as they are laid out in memory
+_Static_assert(sizeof(MagicIndexEntry) == MAGIC_INDEX_SECTION_BYTES, "Padded section entry");
+_Static_assert(sizeof(MagicTensorEntry) == MAGIC_INDEX_TENSOR_BYTES, "Padded tensor entry");
+
+/**
+ * @brief Creates or truncates a model file for sequential writing.
+ */
+MagicWriter* magic_writer_open(const char* filepath, size_t capacity) {
+    MagicWriter* writer = (MagicWriter*) calloc(1, sizeof(MagicWriter));
+    if (!writer) {
+        LOG_ERROR("%s: Failed to allocate memory to MagicWriter.\n", __func__);
+        return NULL;
+    }
+
+    writer->filepath = filepath;
+    writer->capacity = capacity ? capacity : MAGIC_WRITER_BUFFER;
+    writer->section = -1;
+    writer->index.checksum = MAGIC_CHECKSUM_CRC32C;
+    writer->buffer = (uint8_t*) malloc(writer->capacity);
+    if (!writer->buffer) {
+        LOG_ERROR("%s: Failed to allocate a %zu byte buffer.\n", __func__, writer->capacity);
+        free(writer);
+        return NULL;
+    }
+
+    writer->fd = open(filepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (-1 == writer->fd) {
+        LOG_ERROR("%s: Unable to open file %s\n", __func__, filepath);
+        free(writer->buffer);
+        free(writer);
+        return NULL;
+    }
+
+    LOG_DEBUG(
+        "%s: MagicWriter opened %s with %zu buffered bytes.\n",
+        __func__,
+        filepath,
+        writer->capacity
+    );
+    return writer;
+}
+
+// Writes the vectors in full at the end of the file, resuming after partial writes
+static MagicState magic_writer_writev(MagicWriter* writer, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(writer->fd, iov, count);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            LOG_ERROR("%s: Failed to write %s: %s\n", __func__, writer->filepath, strerror(errno));
+            return MAGIC_FILE_ERROR;
+        }
+
+        writer->flushed += written;
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= (ssize_t) iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*) iov->iov_base + written;
+            iov->iov_len -= (size_t) written;
+        }
+    }
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Flushes the pending bytes, closes the file, and frees the writer.
+ */
+MagicState magic_writer_close(MagicWriter* writer) {
+    if (!writer) {
+        LOG_ERROR("%s: MagicWriter is NULL.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    MagicState state = magic_writer_flush(writer);
+    if (0 != close(writer->fd)) {
+        LOG_ERROR("%s: Failed to close %s.\n", __func__, writer->filepath);
+        state = MAGIC_FILE_ERROR;
+    }
+
+    magic_index_free(&writer->index);
+    free(writer->buffer);
+    free(writer);
+    LOG_DEBUG("%s: MagicWriter closed.\n", __func__);
+    return state;
+}
+
+/**
+ * @brief Returns the file offset of the next byte written.
+ */
+int64_t magic_writer_tell(const MagicWriter* writer) {
+    return writer->flushed + (int64_t) writer->length;
+}
+
+// Appends bytes to the file without adding them to the section checksum
+static MagicState magic_writer_append(MagicWriter* writer, const void* data, size_t size) {
+    if (size <= writer->capacity - writer->length) {
+        memcpy(writer->buffer + writer->length, data, size);
+        writer->length += size;
+        return MAGIC_SUCCESS;
+    }
+
+    // Large blobs follow the pending bytes in the same call, without a copy
+    struct iovec iov[2] = {
+        {.iov_base = writer->buffer, .iov_len = writer->length},
+        {.iov_base = (void*) data, .iov_len = size},
+    };
+    MagicState state = magic_writer_writev(writer, iov, 2);
+    if (MAGIC_SUCCESS == state) {
+        writer->length = 0;
+    }
+    return state;
+}
+
+/**
+ * @brief Appends bytes to the file.
+ */
+MagicState magic_writer_write(MagicWriter* writer, const void* data, size_t size) {
+    if (writer->section >= 0) {
+        writer->checksum = crc32c_update(writer->checksum, data, size);
+    }
+    return magic_writer_append(writer, data, size);
+}
+
+/**
+ * @brief Appends zero bytes up to the next MAGIC_ALIGNMENT boundary.
+ */
+MagicState magic_writer_pad(MagicWriter* writer) {
+    const char padding[MAGIC_ALIGNMENT] = {0};
+    const int64_t position = magic_writer_tell(writer);
+    return magic_writer_write(
+        writer, padding, (MAGIC_ALIGNMENT - position % MAGIC_ALIGNMENT) % MAGIC_ALIGNMENT
+    );
+}
+
+/**
+ * @brief Writes the pending bytes to the file.
+ */
+MagicState magic_writer_flush(MagicWriter* writer) {
+    struct iovec iov = {.iov_base = writer->buffer, .iov_len = writer->length};
+    MagicState state = magic_writer_writev(writer, &iov, 1);
+    if (MAGIC_SUCCESS == state) {
+        writer->length = 0;
+    }
+    return state;
+}
+
+/**
+ * @brief Writes the Start Marker and its padding.
+ */
+MagicState
+magic_writer_write_start_marker(MagicWriter* writer, int32_t version, int32_t alignment) {
+    const int64_t marker = MAGIC_ALT;
+    const int64_t size = sizeof(int32_t) + sizeof(int32_t); // Version and alignment
+    if (MAGIC_SUCCESS != magic_writer_write(writer, &marker, sizeof(int64_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &size, sizeof(int64_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &version, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &alignment, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_pad(writer)) {
+        LOG_ERROR("%s: Failed to write magic header.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Opens a section by writing its marker and a placeholder size.
+ */
+MagicState magic_writer_begin_section(MagicWriter* writer, int64_t marker) {
+    if (writer->section >= 0) {
+        LOG_ERROR("%s: Section 0x%" PRIx64 " is still open.\n", __func__, writer->marker);
+        return MAGIC_ERROR;
+    }
+
+    const int64_t size = 0;
+    const int64_t offset = magic_writer_tell(writer);
+    if (MAGIC_SUCCESS != magic_writer_write(writer, &marker, sizeof(int64_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &size, sizeof(int64_t))) {
+        LOG_ERROR("%s: Failed to write section marker 0x%" PRIx64 ".\n", __func__, marker);
+        return MAGIC_FILE_ERROR;
+    }
+
+    writer->section = offset;
+    writer->marker = marker;
+    writer->checksum = 0;
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Closes the open section: back-patches its size, pads, and indexes it.
+ */
+MagicState magic_writer_end_section(MagicWriter* writer) {
+    if (writer->section < 0) {
+        LOG_ERROR("%s: No section is open.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    const int64_t at = writer->section + (int64_t) sizeof(int64_t);
+    const int64_t size = magic_writer_tell(writer) - at - (int64_t) sizeof(int64_t);
+
+    // The size field is still pending, or already in the file
+    MagicState state = MAGIC_SUCCESS;
+    if (at >= writer->flushed) {
+        memcpy(writer->buffer + (at - writer->flushed), &size, sizeof(int64_t));
+    } else if (at + (int64_t) sizeof(int64_t) > writer->flushed) {
+        state = magic_writer_flush(writer);
+    }
+    if (MAGIC_SUCCESS == state && at < writer->flushed
+        && sizeof(int64_t) != pwrite(writer->fd, &size, sizeof(int64_t), at)) {
+        LOG_ERROR(
+            "%s: Failed to patch the size of section 0x%" PRIx64 ".\n", __func__, writer->marker
+        );
+        state = MAGIC_FILE_ERROR;
+    }
+
+    if (MAGIC_SUCCESS == state) {
+        state = magic_index_add_section(&writer->index, writer->marker, writer->section, size);
+    }
+    if (MAGIC_SUCCESS == state) {
+        writer->index.sections[writer->index.section_count - 1].checksum = writer->checksum;
+    }
+    if (MAGIC_SUCCESS == state && MAGIC_SUCCESS != magic_writer_pad(writer)) {
+        state = MAGIC_FILE_ERROR;
+    }
+    if (MAGIC_SUCCESS == state) {
+        LOG_DEBUG(
+            "%s: Wrote section 0x%" PRIx64 " with size %" PRId64 ".\n",
+            __func__,
+            writer->marker,
+            size
+        );
+        writer->section = -1;
+    }
+    return state;
+}
+
+/**
+ * @brief Writes the configuration and metadata fields of an open Tensor Section.
+ */
+MagicState
+magic_writer_write_tensor_section(MagicWriter* writer, const MagicTensorSection* section) {
+    if (writer->section < 0 || MAGIC_TENSORS != writer->marker) {
+        LOG_ERROR("%s: No Tensor Section is open.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    if (MAGIC_SUCCESS != magic_writer_write(writer, &section->data_type, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->quant_profile, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->context_len, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->tensor_count, sizeof(int64_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->shape_count, sizeof(int64_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->block_count, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &section->unique_count, sizeof(int32_t))) {
+        LOG_ERROR("%s: Failed to write tensor section fields.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+    return MAGIC_SUCCESS;
+}
+
+/**
+ * @brief Writes the metadata and data of one tensor into an open Tensor Section.
+ */
+MagicState
+magic_writer_write_tensor(MagicWriter* writer, const MagicTensorInfo* info, const void* data) {
+    if (writer->section < 0 || MAGIC_TENSORS != writer->marker) {
+        LOG_ERROR("%s: No Tensor Section is open.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    const int64_t size = magic_tensor_data_size(info);
+    if (!info->name || size < 0) {
+        LOG_ERROR("%s: Invalid tensor metadata.\n", __func__);
+        return MAGIC_ERROR;
+    }
+
+    const int64_t info_offset = magic_writer_tell(writer);
+    const int32_t name_len = (int32_t) strlen(info->name);
+    if (MAGIC_SUCCESS != magic_writer_write(writer, &info->component_type, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->block_index, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->layer_type, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->projection_type, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->n_dims, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, info->shape, info->n_dims * sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &name_len, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, info->name, name_len)
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->data_type, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->delta, sizeof(float))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->min, sizeof(float))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->max, sizeof(float))
+        || MAGIC_SUCCESS != magic_writer_write(writer, &info->packing_flag, sizeof(int8_t))
+        || MAGIC_SUCCESS != magic_writer_pad(writer)) {
+        LOG_ERROR("%s: Failed to write metadata of tensor '%s'.\n", __func__, info->name);
+        return MAGIC_FILE_ERROR;
+    }
+
+    // The tensor's own entry covers its data, so the section checksum skips it
+    const int64_t data_offset = magic_writer_tell(writer);
+    if (MAGIC_SUCCESS != magic_writer_append(writer, data, (size_t) size)) {
+        LOG_ERROR("%s: Failed to write data of tensor '%s'.\n", __func__, info->name);
+        return MAGIC_FILE_ERROR;
+    }
+
+    MagicState state = magic_index_add_tensor(&writer->index, info, info_offset, data_offset);
+    if (MAGIC_SUCCESS == state) {
+        writer->index.tensors[writer->index.tensor_count - 1].checksum
+            = crc32c_update(0, data, (size_t) size);
+    }
+    return state;
+}
+
+/**
+ * @brief Completes the file with an optional Index Section and the end marker.
+ */
+MagicState magic_writer_finish(MagicWriter* writer, bool index) {
+    if (writer->section >= 0) {
+        LOG_ERROR("%s: Section 0x%" PRIx64 " is still open.\n", __func__, writer->marker);
+        return MAGIC_ERROR;
+    }
+
+    if (index) {
+        const MagicIndex* entries = &writer->index;
+        const int64_t marker = MAGIC_INDEX;
+        const int64_t offset = magic_writer_tell(writer);
+        const char zeros[MAGIC_ALIGNMENT] = {0};
+        int64_t padding = 0;
+        const int64_t size = magic_index_section_size(entries, &padding);
+        const size_t sections = entries->section_count * sizeof(MagicIndexEntry);
+        const size_t tensors = entries->tensor_count * sizeof(MagicTensorEntry);
+        if (MAGIC_SUCCESS != magic_writer_write(writer, &marker, sizeof(int64_t))
+            || MAGIC_SUCCESS != magic_writer_write(writer, &size, sizeof(int64_t))
+            || MAGIC_SUCCESS != magic_writer_write(writer, &entries->section_count, sizeof(int64_t))
+            || MAGIC_SUCCESS != magic_writer_write(writer, &entries->tensor_count, sizeof(int64_t))
+            || MAGIC_SUCCESS != magic_writer_write(writer, &entries->checksum, sizeof(int64_t))
+            || MAGIC_SUCCESS != magic_writer_write(writer, entries->sections, sections)
+            || MAGIC_SUCCESS != magic_writer_write(writer, entries->tensors, tensors)
+            || MAGIC_SUCCESS != magic_writer_write(writer, zeros, (size_t) padding)
+            || MAGIC_SUCCESS != magic_writer_write(writer, &offset, sizeof(int64_t))) {
+            LOG_ERROR("%s: Failed to write the index.\n", __func__);
+            return MAGIC_FILE_ERROR;
+        }
+    }
+
+    const int32_t end = MAGIC_END;
+    if (MAGIC_SUCCESS != magic_writer_write(writer, &end, sizeof(int32_t))
+        || MAGIC_SUCCESS != magic_writer_flush(writer)) {
+        LOG_ERROR("%s: Failed to write end marker.\n", __func__);
+        return MAGIC_FILE_ERROR;
+    }
+
+    LOG_DEBUG("%s: Wrote %" PRId64 " bytes to %s.\n", __func__, writer->flushed, writer->filepath);
     return MAGIC_SUCCESS;
 }
 
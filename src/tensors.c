@@ -9,16 +9,22 @@
  */
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "interface/allocator.h"
 #include "interface/logger.h"
 
 #include "tensors.h"
 
-Tensor* tensor_create(DataTypeId id, uint32_t rank, uint32_t* dimensions) {
+// Shared constructor; flags select zero-fill and huge page backing, and data borrows storage
+static Tensor* tensor_create_with_flags(
+    DataTypeId id, uint32_t rank, uint32_t* dimensions, uint32_t flags, void* data
+) {
     if (rank == 0) {
         LOG_ERROR("Rank must be greater than 0.\n");
         return NULL;
@@ -48,32 +54,77 @@ Tensor* tensor_create(DataTypeId id, uint32_t rank, uint32_t* dimensions) {
     tensor->rank = rank;
     tensor->shape = shape;
     tensor->type = type;
+    tensor->size = 0;
+    tensor->data = NULL;
+    tensor->base = NULL; // Tensor owns its data
+    tensor->layout = TENSOR_LAYOUT_ROW_MAJOR;
+    tensor->tile[0] = tensor->tile[1] = 0;
+
+    tensor->stride = tensor_create_stride(rank, dimensions);
+    if (!tensor->stride) {
+        LOG_ERROR("%s: Failed to create stride using rank=%u.\n", __func__, rank);
+        tensor_free(tensor); // Use centralized cleanup
+        return NULL;
+    }
 
-    uint32_t size;
-    if (tensor_compute_shape(tensor, &size) != TENSOR_SUCCESS) {
+    if (tensor_compute_shape(tensor, &tensor->size) != TENSOR_SUCCESS) {
         LOG_ERROR("%s: Failed to compute tensor shape.\n", __func__);
         tensor_free(tensor); // Use centralized cleanup
         return NULL;
     }
 
-    tensor->data = malloc(size * tensor->type->size);
+    // Check the byte size once so element offsets never overflow afterwards
+    size_t bytes = 0;
+    if (tensor->size > SIZE_MAX || __builtin_mul_overflow((size_t) tensor->size, type->size, &bytes)) {
+        LOG_ERROR(
+            "%s: Tensor byte size overflow detected: size=%" PRIu64 ".\n", __func__, tensor->size
+        );
+        tensor_free(tensor); // Use centralized cleanup
+        return NULL;
+    }
+
+    if (data) {
+        tensor->data = data;
+        tensor->base = tensor; // Borrowed storage is never freed by the tensor
+        return tensor;
+    }
+
+    tensor->data = allocator_alloc(bytes, ALLOCATOR_ALIGNMENT, flags | ALLOCATOR_HUGE_PAGES);
     if (!tensor->data) {
         LOG_ERROR("%s: Failed to allocate memory for Tensor data.\n", __func__);
         tensor_free(tensor); // Use centralized cleanup
         return NULL;
     }
 
-    memset(tensor->data, 0, size * tensor->type->size); // Zero-initialize data
     return tensor;
 }
 
+Tensor* tensor_create(DataTypeId id, uint32_t rank, uint32_t* dimensions) {
+    return tensor_create_with_flags(id, rank, dimensions, ALLOCATOR_ZERO, NULL);
+}
+
+Tensor* tensor_create_uninitialized(DataTypeId id, uint32_t rank, uint32_t* dimensions) {
+    return tensor_create_with_flags(id, rank, dimensions, ALLOCATOR_NONE, NULL);
+}
+
+Tensor* tensor_create_from_data(DataTypeId id, uint32_t rank, uint32_t* dimensions, void* data) {
+    if (!data) {
+        LOG_ERROR("%s: Invalid data pointer provided.\n", __func__);
+        return NULL;
+    }
+    return tensor_create_with_flags(id, rank, dimensions, ALLOCATOR_NONE, data);
+}
+
 void tensor_free(Tensor* tensor) {
     if (tensor) {
         if (tensor->shape) {
             flex_array_free(tensor->shape); // Free the shape
         }
-        if (tensor->data) {
-            free(tensor->data); // Free the tensor data
+        if (tensor->stride) {
+            flex_array_free(tensor->stride); // Free the stride
+        }
+        if (tensor->data && !tensor->base) {
+            allocator_free(tensor->data); // Recycle the tensor data (views do not own it)
         }
         free(tensor); // Free the tensor structure
     }
@@ -109,6 +160,35 @@ FlexArray* tensor_create_shape(uint32_t rank, uint32_t* dimensions) {
     return shape;
 }
 
+FlexArray* tensor_create_stride(uint32_t rank, uint32_t* dimensions) {
+    if (rank == 0 || !dimensions) {
+        LOG_ERROR("%s: Rank must be greater than 0.\n", __func__);
+        return NULL;
+    }
+
+    FlexArray* stride = flex_array_create(rank, TYPE_UINT64);
+    if (!stride) {
+        LOG_ERROR("%s: Failed to allocate FlexArray for stride with rank=%u.\n", __func__, rank);
+        return NULL;
+    }
+
+    // Row-major: the last dimension is the fastest moving
+    uint64_t steps[rank];
+    uint64_t step = 1;
+    for (int i = rank - 1; i >= 0; --i) {
+        steps[i] = step;
+        step *= dimensions[i];
+    }
+
+    if (flex_array_set_bulk(stride, steps, rank) != FLEX_ARRAY_SUCCESS) {
+        LOG_ERROR("%s: Failed to initialize FlexArray with strides.\n", __func__);
+        flex_array_free(stride);
+        return NULL;
+    }
+
+    return stride;
+}
+
 FlexArray* tensor_create_indices(uint32_t rank, uint32_t* dimensions) {
     if (rank == 0) {
         LOG_ERROR("Rank must be greater than 0.\n");
@@ -130,7 +210,7 @@ FlexArray* tensor_create_indices(uint32_t rank, uint32_t* dimensions) {
     return indices;
 }
 
-TensorState tensor_compute_shape(const Tensor* tensor, uint32_t* size) {
+TensorState tensor_compute_shape(const Tensor* tensor, uint64_t* size) {
     // Validate inputs
     if (!tensor || !tensor->shape || !tensor->shape->data || !size) {
         LOG_ERROR("Invalid tensor, shape, or size provided.\n");
@@ -144,24 +224,55 @@ TensorState tensor_compute_shape(const Tensor* tensor, uint32_t* size) {
     uint32_t dimensions;
     for (uint32_t i = 0; i < tensor->rank; ++i) {
         flex_array_get(tensor->shape, i, &dimensions);
-        LOG_DEBUG("%s: size=%u dimensions=%u\n", __func__, *size, dimensions);
+        LOG_DEBUG("%s: size=%" PRIu64 " dimensions=%u\n", __func__, *size, dimensions);
         if (dimensions == 0) {
             LOG_ERROR("%s: Zero dimension detected in tensor shape at dimension %u.\n", __func__, i);
             return TENSOR_INVALID_SHAPE; // Reject zero dimension
         }
-        if (*size > (uint32_t)(UINT32_MAX / 2)) { // Respect the upper boundary
-            LOG_ERROR("Index overflow detected during computation.\n");
+        if (__builtin_mul_overflow(*size, (uint64_t) dimensions, size)) {
+            LOG_ERROR("%s: Size overflow detected during computation.\n", __func__);
             return TENSOR_ERROR; // Overflow prevention
         }
-        *size *= dimensions;
     }
 
     return TENSOR_SUCCESS;
 }
 
-TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices, uint32_t* index) {
+size_t tensor_byte_size(const Tensor* tensor) {
+    if (!tensor || !tensor->type) {
+        return 0;
+    }
+    if (TENSOR_LAYOUT_TILED == tensor->layout) {
+        // Padded to whole tiles; validated by tensor_repack
+        const uint32_t* shape = (const uint32_t*) tensor->shape->data;
+        const size_t rows = (shape[0] + tensor->tile[0] - 1) / tensor->tile[0] * tensor->tile[0];
+        const size_t cols = (shape[1] + tensor->tile[1] - 1) / tensor->tile[1] * tensor->tile[1];
+        return rows * cols * tensor->type->size;
+    }
+    return (size_t) tensor->size * tensor->type->size; // Validated at creation
+}
+
+bool tensor_is_contiguous(const Tensor* tensor) {
+    if (!tensor || !tensor->shape || !tensor->stride || TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        return false;
+    }
+
+    uint64_t expected = 1;
+    for (int i = tensor->rank - 1; i >= 0; --i) {
+        uint32_t dimensions = ((uint32_t*) tensor->shape->data)[i];
+        uint64_t stride = ((uint64_t*) tensor->stride->data)[i];
+        if (dimensions != 1 && stride != expected) {
+            return false; // Unit dimensions never move, so their stride is irrelevant
+        }
+        expected *= dimensions;
+    }
+
+    return true;
+}
+
+TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices, uint64_t* index) {
     // Validate inputs
-    if (!tensor || !tensor->shape || !tensor->shape->data) {
+    if (!tensor || !tensor->shape || !tensor->shape->data || !tensor->stride) {
         LOG_ERROR("Invalid tensor or shape provided.\n");
         return TENSOR_INVALID_SHAPE;
     }
@@ -176,10 +287,23 @@ TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices,
         return TENSOR_INVALID_RANK;
     }
 
-    uint32_t flat_index = 0, stride = 1;
+    if (TENSOR_LAYOUT_TILED == tensor->layout) {
+        const uint32_t* coords = (const uint32_t*) indices->data;
+        const uint32_t* shape = tensor_shape_data(tensor);
+        if (coords[0] >= shape[0] || coords[1] >= shape[1]) {
+            LOG_ERROR("Index out of bounds: (%u, %u).\n", coords[0], coords[1]);
+            return TENSOR_OUT_OF_BOUNDS;
+        }
+        *index = tensor_tiled_offset(tensor, coords[0], coords[1]);
+        return TENSOR_SUCCESS;
+    }
+
+    // Bounded offsets cannot exceed the size validated at creation, so no overflow checks here
+    uint64_t flat_index = 0;
     for (int i = tensor->rank - 1; i >= 0; --i) {
         uint32_t offset = ((uint32_t*) indices->data)[i];
         uint32_t dimensions = ((uint32_t*) tensor->shape->data)[i];
+        uint64_t stride = ((uint64_t*) tensor->stride->data)[i];
 
         if (dimensions == 0) {
             LOG_ERROR("Zero dimension detected in tensor shape at dimension %u.", i);
@@ -189,20 +313,14 @@ TensorState tensor_compute_index(const Tensor* tensor, const FlexArray* indices,
             LOG_WARN("Index out of bounds in dimension %u: offset=%u, dim=%u.", i, offset, dimensions);
             return TENSOR_OUT_OF_BOUNDS;
         }
-        if (flat_index > UINT32_MAX - (offset * stride)) {
-            LOG_ERROR("Index overflow detected during computation.");
-            return TENSOR_ERROR; // Prevent overflow
-        }
-
         flat_index += offset * stride;
-        stride *= dimensions;
     }
 
     *index = flat_index;
     return TENSOR_SUCCESS;
 }
 
-TensorState tensor_compute_array(const Tensor* tensor, FlexArray* indices, const uint32_t index) {
+TensorState tensor_compute_array(const Tensor* tensor, FlexArray* indices, const uint64_t index) {
     // Validate inputs
     if (!tensor || !tensor->shape || !tensor->shape->data) {
         LOG_ERROR("Invalid tensor or shape provided.\n");
@@ -219,20 +337,17 @@ TensorState tensor_compute_array(const Tensor* tensor, FlexArray* indices, const
         return TENSOR_INVALID_RANK;
     }
 
-    // Compute the total size of the tensor (max index)
-    uint32_t max_index = 0;
-    TensorState state = tensor_compute_shape(tensor, &max_index);
-    if (state != TENSOR_SUCCESS) {
-        return state; // Propagate error from tensor_compute_shape
-    }
-
+    // The total size of the tensor (max index) is computed at creation
+    uint64_t max_index = tensor->size;
     if (index >= max_index) {
-        LOG_WARN("Flat index out of bounds: index=%u, max_index=%u.", index, max_index);
+        LOG_WARN(
+            "Flat index out of bounds: index=%" PRIu64 ", max_index=%" PRIu64 ".", index, max_index
+        );
         return TENSOR_OUT_OF_BOUNDS;
     }
 
     // Compute multi-dimensional indices
-    uint32_t flat_index_remaining = index;
+    uint64_t flat_index_remaining = index;
     for (int i = tensor->rank - 1; i >= 0; --i) {
         uint32_t dimensions = ((uint32_t*)tensor->shape->data)[i];
         ((uint32_t*)indices->data)[i] = flat_index_remaining % dimensions;
@@ -248,7 +363,7 @@ TensorState tensor_get_element(Tensor* tensor, const FlexArray* indices, void* v
         return TENSOR_ERROR;
     }
 
-    uint32_t flat_index;
+    uint64_t flat_index;
     TensorState state = tensor_compute_index(tensor, indices, &flat_index);
     if (state != TENSOR_SUCCESS) {
         return state;
@@ -264,7 +379,7 @@ TensorState tensor_set_element(Tensor* tensor, const FlexArray* indices, void* v
         return TENSOR_ERROR;
     }
 
-    uint32_t flat_index;
+    uint64_t flat_index;
     TensorState state = tensor_compute_index(tensor, indices, &flat_index);
     if (state != TENSOR_SUCCESS) {
         return state;
@@ -280,12 +395,314 @@ TensorState tensor_set_bulk(Tensor* tensor, const void* data) {
         return TENSOR_ERROR;
     }
 
-    uint32_t size;
-    TensorState state = tensor_compute_shape(tensor, &size);
+    uint64_t size = tensor->size;
+    if (size == 0) {
+        LOG_ERROR("%s: Tensor has no elements.\n", __func__);
+        return TENSOR_INVALID_SHAPE;
+    }
+
+    if (tensor_is_contiguous(tensor)) {
+        memcpy(tensor->data, data, size * tensor->type->size);
+        return TENSOR_SUCCESS;
+    }
+
+    // Strided views: walk the logical indices with a cursor
+    TensorCursor cursor;
+    TensorState state = tensor_cursor_init(&cursor, tensor);
     if (state != TENSOR_SUCCESS) {
         return state;
     }
 
-    memcpy(tensor->data, data, size * tensor->type->size);
+    const char* src = (const char*) data;
+    for (; tensor_cursor_valid(&cursor); tensor_cursor_next(&cursor)) {
+        memcpy(tensor_cursor_get(&cursor), src, cursor.element_size);
+        src += cursor.element_size;
+    }
+
+    return TENSOR_SUCCESS;
+}
+
+// Tensor Cursor
+
+TensorState tensor_cursor_init(TensorCursor* cursor, const Tensor* tensor) {
+    if (!cursor || !tensor || !tensor->shape || !tensor->stride || !tensor->data) {
+        LOG_ERROR("%s: Invalid cursor or tensor provided.\n", __func__);
+        return TENSOR_ERROR;
+    }
+    if (tensor->rank == 0 || tensor->rank > TENSOR_MAX_RANK) {
+        LOG_ERROR("%s: Unsupported rank=%u (max %u).\n", __func__, tensor->rank, TENSOR_MAX_RANK);
+        return TENSOR_INVALID_RANK;
+    }
+    if (TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        LOG_ERROR("%s: Cursors require the row-major layout.\n", __func__);
+        return TENSOR_ERROR;
+    }
+
+    cursor->data = (char*) tensor->data;
+    cursor->index = 0;
+    cursor->size = tensor->size;
+    cursor->element_size = tensor->type->size;
+    cursor->rank = tensor->rank;
+    cursor->contiguous = tensor_is_contiguous(tensor);
+
+    const uint32_t* shape = tensor_shape_data(tensor);
+    const uint64_t* stride = tensor_stride_data(tensor);
+    for (uint32_t i = 0; i < tensor->rank; ++i) {
+        cursor->shape[i] = shape[i];
+        cursor->stride[i] = stride[i] * tensor->type->size; // Byte strides
+        cursor->indices[i] = 0;
+    }
+
     return TENSOR_SUCCESS;
 }
+
+// Tensor Views
+
+// Allocates a view header sharing the storage of the given tensor
+static Tensor* tensor_view_create(const Tensor* tensor, uint32_t rank, uint32_t* dimensions, uint64_t* strides) {
+    if (TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        LOG_ERROR("%s: Views require the row-major layout.\n", __func__);
+        return NULL;
+    }
+
+    Tensor* view = (Tensor*) malloc(sizeof(Tensor));
+    if (!view) {
+        LOG_ERROR("%s: Failed to allocate memory for Tensor view.\n", __func__);
+        return NULL;
+    }
+
+    view->rank = rank;
+    view->type = tensor->type;
+    view->data = tensor->data;
+    view->base = tensor->base ? tensor->base : tensor; // Always reference the owner
+    view->layout = TENSOR_LAYOUT_ROW_MAJOR;
+    view->tile[0] = view->tile[1] = 0;
+    view->stride = NULL;
+    view->size = 1;
+    for (uint32_t i = 0; i < rank; ++i) {
+        view->size *= dimensions[i]; // Never exceeds the size of the base tensor
+    }
+
+    view->shape = tensor_create_shape(rank, dimensions);
+    if (!view->shape) {
+        LOG_ERROR("%s: Failed to create view shape using rank=%u.\n", __func__, rank);
+        tensor_free(view);
+        return NULL;
+    }
+
+    view->stride = flex_array_create(rank, TYPE_UINT64);
+    if (!view->stride || flex_array_set_bulk(view->stride, strides, rank) != FLEX_ARRAY_SUCCESS) {
+        LOG_ERROR("%s: Failed to create view stride using rank=%u.\n", __func__, rank);
+        tensor_free(view);
+        return NULL;
+    }
+
+    return view;
+}
+
+Tensor* tensor_view_slice(const Tensor* tensor, uint32_t axis, uint32_t start, uint32_t length) {
+    if (!tensor || !tensor->shape || !tensor->stride || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor provided.\n", __func__);
+        return NULL;
+    }
+    if (axis >= tensor->rank) {
+        LOG_ERROR("%s: Invalid axis=%u for rank=%u.\n", __func__, axis, tensor->rank);
+        return NULL;
+    }
+
+    uint32_t dimensions[tensor->rank];
+    uint64_t strides[tensor->rank];
+    memcpy(dimensions, tensor->shape->data, sizeof(dimensions));
+    memcpy(strides, tensor->stride->data, sizeof(strides));
+
+    if (length == 0 || start >= dimensions[axis] || length > dimensions[axis] - start) {
+        LOG_ERROR(
+            "%s: Slice out of bounds: start=%u, length=%u, dim=%u.\n",
+            __func__,
+            start,
+            length,
+            dimensions[axis]
+        );
+        return NULL;
+    }
+
+    dimensions[axis] = length;
+    Tensor* view = tensor_view_create(tensor, tensor->rank, dimensions, strides);
+    if (!view) {
+        return NULL;
+    }
+
+    // Advance the shared data pointer to the first element of the slice
+    view->data = (char*) tensor->data + (size_t) start * strides[axis] * tensor->type->size;
+    return view;
+}
+
+Tensor* tensor_view_transpose(const Tensor* tensor, uint32_t axis_a, uint32_t axis_b) {
+    if (!tensor || !tensor->shape || !tensor->stride || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor provided.\n", __func__);
+        return NULL;
+    }
+    if (axis_a >= tensor->rank || axis_b >= tensor->rank) {
+        LOG_ERROR(
+            "%s: Invalid axes=(%u, %u) for rank=%u.\n", __func__, axis_a, axis_b, tensor->rank
+        );
+        return NULL;
+    }
+
+    uint32_t dimensions[tensor->rank];
+    uint64_t strides[tensor->rank];
+    memcpy(dimensions, tensor->shape->data, sizeof(dimensions));
+    memcpy(strides, tensor->stride->data, sizeof(strides));
+
+    uint32_t temp = dimensions[axis_a];
+    dimensions[axis_a] = dimensions[axis_b];
+    dimensions[axis_b] = temp;
+
+    uint64_t step = strides[axis_a];
+    strides[axis_a] = strides[axis_b];
+    strides[axis_b] = step;
+
+    return tensor_view_create(tensor, tensor->rank, dimensions, strides);
+}
+
+Tensor* tensor_view_reshape(const Tensor* tensor, uint32_t rank, uint32_t* dimensions) {
+    if (!tensor || !tensor->shape || !tensor->stride || !tensor->data || !dimensions) {
+        LOG_ERROR("%s: Invalid tensor or dimensions provided.\n", __func__);
+        return NULL;
+    }
+    if (rank == 0) {
+        LOG_ERROR("%s: Rank must be greater than 0.\n", __func__);
+        return NULL;
+    }
+    if (!tensor_is_contiguous(tensor)) {
+        LOG_ERROR("%s: Cannot reshape a non-contiguous view without a copy.\n", __func__);
+        return NULL;
+    }
+
+    uint64_t reshaped = 1;
+    for (uint32_t i = 0; i < rank; ++i) {
+        if (__builtin_mul_overflow(reshaped, (uint64_t) dimensions[i], &reshaped)) {
+            LOG_ERROR("%s: Size overflow detected in reshaped dimensions.\n", __func__);
+            return NULL;
+        }
+    }
+    if (reshaped != tensor->size) {
+        LOG_ERROR(
+            "%s: Element count mismatch: tensor=%" PRIu64 ", reshaped=%" PRIu64 ".\n",
+            __func__,
+            tensor->size,
+            reshaped
+        );
+        return NULL;
+    }
+
+    uint64_t strides[rank];
+    uint64_t step = 1;
+    for (int i = rank - 1; i >= 0; --i) {
+        strides[i] = step;
+        step *= dimensions[i];
+    }
+
+    return tensor_view_create(tensor, rank, dimensions, strides);
+}
+
+// Tiled Layouts
+
+Tensor* tensor_repack(const Tensor* tensor, uint32_t tile_rows, uint32_t tile_cols) {
+    if (!tensor || !tensor->shape || !tensor->stride || !tensor->data) {
+        LOG_ERROR("%s: Invalid tensor provided.\n", __func__);
+        return NULL;
+    }
+    if (2 != tensor->rank || TENSOR_LAYOUT_ROW_MAJOR != tensor->layout) {
+        LOG_ERROR("%s: Expected a row-major rank 2 tensor, got rank=%u.\n", __func__, tensor->rank);
+        return NULL;
+    }
+
+    uint32_t shape[2];
+    uint64_t stride[2];
+    memcpy(shape, tensor->shape->data, sizeof(shape));
+    memcpy(stride, tensor->stride->data, sizeof(stride));
+
+    if (TENSOR_TILE_PANEL == tile_rows) {
+        tile_rows = shape[0];
+    }
+    if (0 == tile_cols) {
+        LOG_ERROR("%s: Tile columns must be greater than 0.\n", __func__);
+        return NULL;
+    }
+
+    // Zero padded storage for whole tiles
+    const uint64_t padded_rows = ((uint64_t) shape[0] + tile_rows - 1) / tile_rows * tile_rows;
+    const uint64_t padded_cols = ((uint64_t) shape[1] + tile_cols - 1) / tile_cols * tile_cols;
+    const size_t element = tensor->type->size;
+    size_t bytes = 0;
+    if (padded_rows > SIZE_MAX || padded_cols > SIZE_MAX
+        || __builtin_mul_overflow((size_t) padded_rows, (size_t) padded_cols, &bytes)
+        || __builtin_mul_overflow(bytes, element, &bytes)) {
+        LOG_ERROR("%s: Tiled byte size overflow detected.\n", __func__);
+        return NULL;
+    }
+
+    void* data = allocator_alloc(bytes, ALLOCATOR_ALIGNMENT, ALLOCATOR_ZERO | ALLOCATOR_HUGE_PAGES);
+    if (!data) {
+        LOG_ERROR("%s: Failed to allocate %zu bytes for tiled storage.\n", __func__, bytes);
+        return NULL;
+    }
+
+    Tensor* tiled = tensor_create_with_flags(tensor->type->id, 2, shape, ALLOCATOR_NONE, data);
+    if (!tiled) {
+        allocator_free(data);
+        return NULL;
+    }
+    tiled->base = NULL; // Take ownership of the padded storage
+    tiled->layout = TENSOR_LAYOUT_TILED;
+    tiled->tile[0] = tile_rows;
+    tiled->tile[1] = tile_cols;
+
+    // Copy each row in tile wide runs
+    for (uint32_t i = 0; i < shape[0]; ++i) {
+        const char* src = (const char*) tensor->data + i * stride[0] * element;
+        for (uint32_t j = 0; j < shape[1]; j += tile_cols) {
+            const uint32_t run = shape[1] - j < tile_cols ? shape[1] - j : tile_cols;
+            char* dst = (char*) data + tensor_tiled_offset(tiled, i, j) * element;
+            if (1 == stride[1]) {
+                memcpy(dst, src + (size_t) j * element, run * element);
+                continue;
+            }
+            for (uint32_t r = 0; r < run; ++r) {
+                memcpy(dst + r * element, src + (j + r) * stride[1] * element, element);
+            }
+        }
+    }
+
+    return tiled;
+}
+
+Tensor* tensor_unpack(const Tensor* tensor) {
+    if (!tensor || !tensor->shape || !tensor->data || TENSOR_LAYOUT_TILED != tensor->layout) {
+        LOG_ERROR("%s: Invalid or non-tiled tensor provided.\n", __func__);
+        return NULL;
+    }
+
+    uint32_t shape[2];
+    memcpy(shape, tensor->shape->data, sizeof(shape));
+
+    Tensor* dense = tensor_create_uninitialized(tensor->type->id, 2, shape);
+    if (!dense) {
+        return NULL;
+    }
+
+    const size_t element = tensor->type->size;
+    const uint32_t tile_cols = tensor->tile[1];
+    for (uint32_t i = 0; i < shape[0]; ++i) {
+        char* dst = (char*) dense->data + (size_t) i * shape[1] * element;
+        for (uint32_t j = 0; j < shape[1]; j += tile_cols) {
+            const uint32_t run = shape[1] - j < tile_cols ? shape[1] - j : tile_cols;
+            const char* src = (const char*) tensor->data;
+            src += tensor_tiled_offset(tensor, i, j) * element;
+            memcpy(dst + (size_t) j * element, src, run * element);
+        }
+    }
+
+    return dense;
+}
@@ -1,5 +1,194 @@
 /**
+ * Copyright © 2024 Austin Berrio
+ *
  * @file src/threads.c
+ *
+ * @brief Persistent worker pool with a blocking parallel-for.
+ *
+ * Worker w always runs partition w of the current job. Jobs are published by
+ * bumping a generation counter under the pool mutex, and the caller waits on
+ * a pending counter that each worker decrements when it finishes.
  */
 
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "interface/logger.h"
+
 #include "threads.h"
+
+typedef struct ThreadPool {
+    pthread_mutex_t submit; // Serializes jobs
+    pthread_mutex_t mutex; // Guards the fields below
+    pthread_cond_t start; // Signals a new generation
+    pthread_cond_t done; // Signals pending reached zero
+    pthread_t workers[THREAD_MAX_COUNT];
+    uint32_t started; // Workers created (worker w has partition w, starting at 1)
+    uint32_t pending; // Workers still running the current job
+    uint64_t generation; // Incremented for every job
+    bool shutdown;
+
+    // Current job
+    ThreadTask task;
+    void* context;
+    uint64_t length;
+    uint32_t partitions;
+} ThreadPool;
+
+static ThreadPool thread_pool = {
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static uint32_t thread_count = 0; // 0 selects the default
+static _Thread_local bool thread_in_task = false;
+
+static void thread_run_partition(
+    ThreadTask task, void* context, uint64_t length, uint32_t partitions, uint32_t partition
+) {
+    // The first length % partitions partitions take one extra index
+    const uint64_t base = length / partitions, extra = length % partitions;
+    uint64_t start = base * partition + (partition < extra ? partition : extra);
+    uint64_t end = start + base + (partition < extra ? 1 : 0);
+    thread_in_task = true;
+    task(context, start, end, partition);
+    thread_in_task = false;
+}
+
+static void* thread_worker(void* arg) {
+    const uint32_t partition = (uint32_t) (uintptr_t) arg;
+    uint64_t seen = 0;
+
+    // Workers are created under the mutex right before a job is published,
+    // so the first generation seen here is always the job this worker joins
+    pthread_mutex_lock(&thread_pool.mutex);
+    seen = thread_pool.generation - 1;
+    for (;;) {
+        while (thread_pool.generation == seen && !thread_pool.shutdown) {
+            pthread_cond_wait(&thread_pool.start, &thread_pool.mutex);
+        }
+        if (thread_pool.shutdown) {
+            break;
+        }
+        seen = thread_pool.generation;
+        if (partition >= thread_pool.partitions) {
+            continue; // Not part of this job
+        }
+
+        ThreadTask task = thread_pool.task;
+        void* context = thread_pool.context;
+        uint64_t length = thread_pool.length;
+        uint32_t partitions = thread_pool.partitions;
+        pthread_mutex_unlock(&thread_pool.mutex);
+
+        thread_run_partition(task, context, length, partitions, partition);
+
+        pthread_mutex_lock(&thread_pool.mutex);
+        if (0 == --thread_pool.pending) {
+            pthread_cond_signal(&thread_pool.done);
+        }
+    }
+    pthread_mutex_unlock(&thread_pool.mutex);
+    return NULL;
+}
+
+uint32_t thread_get_count(void) {
+    uint32_t count = __atomic_load_n(&thread_count, __ATOMIC_RELAXED);
+    if (count) {
+        return count;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) {
+        return 1;
+    }
+    return online > THREAD_MAX_COUNT ? THREAD_MAX_COUNT : (uint32_t) online;
+}
+
+void thread_set_count(uint32_t count) {
+    if (count > THREAD_MAX_COUNT) {
+        count = THREAD_MAX_COUNT;
+    }
+    __atomic_store_n(&thread_count, count, __ATOMIC_RELAXED);
+}
+
+uint32_t thread_partitions(uint64_t length, uint64_t grain) {
+    if (0 == grain) {
+        grain = 1;
+    }
+    uint64_t chunks = length / grain;
+    uint32_t count = thread_get_count();
+    if (chunks < count) {
+        return chunks > 1 ? (uint32_t) chunks : 1;
+    }
+    return count;
+}
+
+uint32_t thread_parallel_for(uint64_t length, uint64_t grain, ThreadTask task, void* context) {
+    if (!task || 0 == length) {
+        return 0;
+    }
+
+    uint32_t partitions = thread_in_task ? 1 : thread_partitions(length, grain);
+    if (1 == partitions) {
+        task(context, 0, length, 0);
+        return 1;
+    }
+
+    pthread_mutex_lock(&thread_pool.submit);
+
+    // Create any missing workers for this job
+    pthread_mutex_lock(&thread_pool.mutex);
+    thread_pool.shutdown = false;
+    while (thread_pool.started + 1 < partitions) {
+        uint32_t partition = thread_pool.started + 1;
+        void* arg = (void*) (uintptr_t) partition;
+        if (0 != pthread_create(&thread_pool.workers[thread_pool.started], NULL, thread_worker, arg)) {
+            LOG_ERROR("%s: Failed to create worker %u.\n", __func__, partition);
+            break;
+        }
+        thread_pool.started++;
+    }
+    if (thread_pool.started + 1 < partitions) {
+        partitions = thread_pool.started + 1; // Run with the workers we have
+    }
+
+    thread_pool.task = task;
+    thread_pool.context = context;
+    thread_pool.length = length;
+    thread_pool.partitions = partitions;
+    thread_pool.pending = partitions - 1;
+    thread_pool.generation++;
+    pthread_cond_broadcast(&thread_pool.start);
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    thread_run_partition(task, context, length, partitions, 0);
+
+    pthread_mutex_lock(&thread_pool.mutex);
+    while (thread_pool.pending > 0) {
+        pthread_cond_wait(&thread_pool.done, &thread_pool.mutex);
+    }
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    pthread_mutex_unlock(&thread_pool.submit);
+    return partitions;
+}
+
+void thread_pool_shutdown(void) {
+    pthread_mutex_lock(&thread_pool.submit);
+
+    pthread_mutex_lock(&thread_pool.mutex);
+    thread_pool.shutdown = true;
+    pthread_cond_broadcast(&thread_pool.start);
+    uint32_t started = thread_pool.started;
+    thread_pool.started = 0;
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(thread_pool.workers[i], NULL);
+    }
+
+    pthread_mutex_unlock(&thread_pool.submit);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file tests/test_allocator.c
+ * @brief Tests for the pooled storage allocator.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <stdio.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/allocator.h"
+#include "interface/logger.h"
+#include "interface/unit_test.h"
+
+// ---------------------- Alignment and Capacity ----------------------
+
+typedef struct TestUnitAllocator {
+    size_t size; // Requested bytes
+    size_t alignment; // Requested alignment
+    size_t expected_alignment; // Alignment the pointer must satisfy
+} TestUnitAllocator;
+
+int test_allocator_logic(TestCase* test) {
+    TestUnitAllocator* unit = (TestUnitAllocator*) test->unit;
+
+    unsigned char* buffer = allocator_alloc(unit->size, unit->alignment, ALLOCATOR_ZERO);
+    ASSERT(buffer != NULL, "Failed to allocate %zu bytes in test case %zu", unit->size, test->index);
+
+    int result = 0;
+    size_t capacity = allocator_capacity(buffer);
+    if ((uintptr_t) buffer % unit->expected_alignment != 0) {
+        LOG_ERROR("%s: Misaligned buffer %p in test case %zu.\n", __func__, buffer, test->index);
+        result = 1;
+    } else if (capacity < unit->size || capacity > unit->size + unit->size / 4 + ALLOCATOR_ALIGNMENT) {
+        LOG_ERROR(
+            "%s: Invalid capacity %zu for %zu bytes in test case %zu.\n",
+            __func__,
+            capacity,
+            unit->size,
+            test->index
+        );
+        result = 1;
+    } else {
+        for (size_t i = 0; i < unit->size; i++) {
+            if (buffer[i] != 0) {
+                LOG_ERROR("%s: Buffer not zeroed at byte %zu.\n", __func__, i);
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    memset(buffer, 0xff, unit->size); // Dirty the block before it is recycled
+    allocator_free(buffer);
+    return result;
+}
+
+int test_allocator_alignment(void) {
+    TestUnitAllocator units[] = {
+        {.size = 0, .alignment = 0, .expected_alignment = ALLOCATOR_ALIGNMENT},
+        {.size = 1, .alignment = 16, .expected_alignment = ALLOCATOR_ALIGNMENT},
+        {.size = 65, .alignment = 64, .expected_alignment = 64},
+        {.size = 1000, .alignment = 128, .expected_alignment = 128},
+        {.size = 1000, .alignment = 64, .expected_alignment = 64}, // Reuses the 128 block
+        {.size = 4097, .alignment = 4096, .expected_alignment = 4096},
+        {.size = 5u << 20, .alignment = 64, .expected_alignment = 64}, // Large buffer path
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Allocator Alignment", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_allocator_logic, NULL);
+}
+
+// ---------------------- Recycling ----------------------
+
+int test_allocator_recycle(void) {
+    allocator_trim();
+
+    AllocatorStats before;
+    allocator_get_stats(&before);
+
+    void* first = allocator_alloc(3000, ALLOCATOR_ALIGNMENT, ALLOCATOR_NONE);
+    allocator_free(first);
+    void* second = allocator_alloc(2900, ALLOCATOR_ALIGNMENT, ALLOCATOR_NONE); // Same size class
+
+    AllocatorStats after;
+    allocator_get_stats(&after);
+
+    int result = 0;
+    if (!first || first != second || after.reuses != before.reuses + 1) {
+        LOG_ERROR("%s: Freed block was not recycled.\n", __func__);
+        result = 1;
+    }
+    allocator_free(second);
+
+    // Without a pool, freed blocks go straight back to the system
+    allocator_set_cache_limit(0);
+    allocator_get_stats(&after);
+    if (after.cached_bytes != 0) {
+        LOG_ERROR("%s: Cache limit did not trim the pools.\n", __func__);
+        result = 1;
+    }
+    allocator_set_cache_limit(ALLOCATOR_CACHE_LIMIT);
+
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_allocator_alignment", test_allocator_alignment},
+        {"test_allocator_recycle", test_allocator_recycle},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
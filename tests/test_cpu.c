@@ -0,0 +1,106 @@
+/**
+ * @file tests/test_cpu.c
+ * @brief Tests for host CPU feature detection.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/cpu.h"
+#include "interface/logger.h"
+#include "interface/unit_test.h"
+
+// ---------------------- Feature Names ----------------------
+
+int test_cpu_feature_names(void) {
+    for (uint32_t i = 0; i < CPU_FEATURE_COUNT; i++) {
+        const char* name = cpu_feature_name((CpuFeature) (1u << i));
+        ASSERT(name != NULL, "feature bit %u has no name", i);
+        for (uint32_t j = 0; j < i; j++) {
+            const char* other = cpu_feature_name((CpuFeature) (1u << j));
+            ASSERT(0 != strcmp(name, other), "features %u and %u share the name %s", i, j, name);
+        }
+    }
+
+    ASSERT(NULL == cpu_feature_name((CpuFeature) 0), "no feature has a name");
+    ASSERT(
+        NULL == cpu_feature_name((CpuFeature) (CPU_AVX2 | CPU_FMA)), "a mask is not one feature"
+    );
+    ASSERT(
+        NULL == cpu_feature_name((CpuFeature) (1u << CPU_FEATURE_COUNT)),
+        "bits past CPU_FEATURE_COUNT have no name"
+    );
+    return 0;
+}
+
+// ---------------------- Probing ----------------------
+
+int test_cpu_probe(void) {
+    const uint32_t host = cpu_probe(NULL);
+    const uint32_t all = (1u << CPU_FEATURE_COUNT) - 1;
+    ASSERT(0 == (host & ~all), "unknown feature bits 0x%x", host & ~all);
+    ASSERT(0 == cpu_probe("all"), "'all' should leave no features");
+    ASSERT(host == cpu_probe("bogus,,"), "unknown names should be ignored");
+
+    // Masking one feature leaves the others alone, whatever the case of its name
+    for (uint32_t i = 0; i < CPU_FEATURE_COUNT; i++) {
+        const uint32_t feature = 1u << i;
+        char upper[16] = {0};
+        const char* name = cpu_feature_name((CpuFeature) feature);
+        for (size_t c = 0; name[c] && c < sizeof(upper) - 1; c++) {
+            upper[c] = (char) (name[c] >= 'a' && name[c] <= 'z' ? name[c] - 32 : name[c]);
+        }
+        ASSERT((host & ~feature) == cpu_probe(name), "masking %s changed other features", name);
+        ASSERT((host & ~feature) == cpu_probe(upper), "masking %s is case sensitive", upper);
+    }
+    ASSERT(
+        (host & ~(CPU_AVX2 | CPU_FMA)) == cpu_probe("avx2,fma"),
+        "failed to mask a list of features"
+    );
+
+#if defined(__x86_64__) || defined(__i386__)
+    // The compiler's own detection also accounts for the OS register state
+    __builtin_cpu_init();
+    ASSERT(
+        !!(host & CPU_SSE42) == !!__builtin_cpu_supports("sse4.2"), "SSE4.2 detection differs"
+    );
+    ASSERT(!!(host & CPU_AVX2) == !!__builtin_cpu_supports("avx2"), "AVX2 detection differs");
+    ASSERT(!!(host & CPU_FMA) == !!__builtin_cpu_supports("fma"), "FMA detection differs");
+    ASSERT(!!(host & CPU_F16C) == !!__builtin_cpu_supports("f16c"), "F16C detection differs");
+    ASSERT(
+        !!(host & CPU_AVX512F) == !!__builtin_cpu_supports("avx512f"), "AVX-512F detection differs"
+    );
+    ASSERT(
+        0 == (host & (CPU_NEON | CPU_DOTPROD | CPU_CRC32)), "reported AArch64 features on x86"
+    );
+#elif defined(__aarch64__)
+    ASSERT(host & CPU_NEON, "Advanced SIMD is mandatory on AArch64");
+#endif
+
+    // The cached set applies the environment once
+    ASSERT(cpu_features() == cpu_probe(getenv(CPU_DISABLE_ENV)), "cached features differ");
+    ASSERT(cpu_has(0), "the empty mask is always supported");
+    ASSERT(cpu_has(cpu_features()), "the host should support its own features");
+    ASSERT(!cpu_has(1u << CPU_FEATURE_COUNT), "reported an unknown feature");
+    return 0;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_cpu_feature_names", test_cpu_feature_names},
+        {"test_cpu_probe", test_cpu_probe},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,105 @@
+/**
+ * @file tests/test_crc32c.c
+ * @brief Tests for CRC-32C checksums.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/crc32c.h"
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+
+// Bit-at-a-time definition of the checksum
+uint32_t test_crc32c_reference(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+// ---------------------- Known Values ----------------------
+
+int test_crc32c_vectors(void) {
+    uint8_t zeros[32] = {0};
+    uint8_t ones[32];
+    uint8_t ascending[32];
+    memset(ones, 0xFF, sizeof(ones));
+    for (uint8_t i = 0; i < 32; i++) {
+        ascending[i] = i;
+    }
+
+    // RFC 3720, B.4
+    ASSERT(0xE3069283u == crc32c_update(0, "123456789", 9), "wrong check value");
+    ASSERT(0x8A9136AAu == crc32c_update(0, zeros, 32), "wrong checksum of 32 zero bytes");
+    ASSERT(0x62A8AB43u == crc32c_update(0, ones, 32), "wrong checksum of 32 0xFF bytes");
+    ASSERT(0x46DD794Eu == crc32c_update(0, ascending, 32), "wrong checksum of 0 to 31");
+    ASSERT(0 == crc32c_update(0, NULL, 0), "the empty range should hash to 0");
+    return 0;
+}
+
+// ---------------------- Chaining ----------------------
+
+int test_crc32c_chain(void) {
+    enum { SIZE = 1021 };
+    uint8_t* data = (uint8_t*) malloc(SIZE + 8);
+    ASSERT(data != NULL, "failed to allocate the sample");
+    random_seed(7);
+    for (size_t i = 0; i < SIZE + 8; i++) {
+        data[i] = (uint8_t) (random_linear() * 255.0f);
+    }
+
+    // Every misalignment and tail length of the word loops
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size <= 64; size++) {
+            const uint32_t expected = test_crc32c_reference(data + offset, size);
+            const uint32_t actual = crc32c_update(0, data + offset, size);
+            if (expected != actual) {
+                free(data);
+            }
+            ASSERT(
+                expected == actual,
+                "offset %zu, size %zu: 0x%08x != 0x%08x",
+                offset,
+                size,
+                expected,
+                actual
+            );
+        }
+    }
+
+    // Pieces chain into the checksum of the whole
+    const uint32_t whole = crc32c_update(0, data, SIZE);
+    int same = whole == test_crc32c_reference(data, SIZE);
+    for (size_t split = 0; same && split <= SIZE; split += 37) {
+        same = whole == crc32c_update(crc32c_update(0, data, split), data + split, SIZE - split);
+    }
+    free(data);
+    ASSERT(same, "chained checksums differ from the whole");
+    return 0;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_crc32c_vectors", test_crc32c_vectors},
+        {"test_crc32c_chain", test_crc32c_chain},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
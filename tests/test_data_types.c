@@ -0,0 +1,678 @@
+/**
+ * @file tests/test_data_types.c
+ * @brief Tests for the numeric data types and conversions.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/data_types.h"
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+
+#define TEST_BLOCK_LENGTH 100 /**< Three full blocks and a partial one */
+#define TEST_FP16_LENGTH 1003 /**< Odd length so every vector path has a tail */
+
+// ---------------------- Helpers ----------------------
+
+// Fills a float buffer with deterministic values in [-scale, scale]
+void test_data_types_fill(float* data, size_t length, uint32_t seed, float scale) {
+    random_seed(seed);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = scale * random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// ---------------------- Block Quantization ----------------------
+
+typedef struct TestUnitBlock {
+    DataTypeId type; // Block type under test
+    float scale; // Magnitude of the input values
+    float offset; // Shift applied to every value
+    double bits; // Expected bits per weight
+} TestUnitBlock;
+
+// Quantizes and dequantizes a row of the given block type
+void test_block_round_trip(DataTypeId type, const float* input, void* blocks, float* output) {
+    switch (type) {
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8(input, (BlockQ8*) blocks, TEST_BLOCK_LENGTH);
+            dequantize_row_block_q8((BlockQ8*) blocks, output, TEST_BLOCK_LENGTH);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4(input, (BlockQ4*) blocks, TEST_BLOCK_LENGTH);
+            dequantize_row_block_q4((BlockQ4*) blocks, output, TEST_BLOCK_LENGTH);
+            break;
+        default:
+            quantize_row_block_q4_min(input, (BlockQ4Min*) blocks, TEST_BLOCK_LENGTH);
+            dequantize_row_block_q4_min((BlockQ4Min*) blocks, output, TEST_BLOCK_LENGTH);
+            break;
+    }
+}
+
+// Largest error allowed for a block: half a step, or a full step on the short side of q4
+float test_block_bound(DataTypeId type, const float* block, uint32_t count) {
+    float lo = block[0], hi = block[0], amax = 0.0f;
+    for (uint32_t j = 0; j < count; j++) {
+        lo = fminf(lo, block[j]);
+        hi = fmaxf(hi, block[j]);
+        amax = fmaxf(amax, fabsf(block[j]));
+    }
+
+    switch (type) {
+        case TYPE_BLOCK_Q8:
+            return amax / 127.0f * 0.51f;
+        case TYPE_BLOCK_Q4:
+            return amax / 8.0f * 1.01f;
+        default:
+            return (hi - lo) / 15.0f * 0.51f + fmaxf(fabsf(lo), fabsf(hi)) * 1e-3f;
+    }
+}
+
+int test_block_logic(TestCase* test) {
+    TestUnitBlock* unit = (TestUnitBlock*) test->unit;
+
+    float input[TEST_BLOCK_LENGTH];
+    float output[TEST_BLOCK_LENGTH];
+    BlockQ4Min blocks[4 * sizeof(BlockQ8) / sizeof(BlockQ4Min) + 1]; // Fits any block type
+
+    test_data_types_fill(input, TEST_BLOCK_LENGTH, 42 + (uint32_t) test->index, unit->scale);
+    for (uint32_t i = 0; i < TEST_BLOCK_LENGTH; i++) {
+        input[i] += unit->offset;
+    }
+    test_block_round_trip(unit->type, input, blocks, output);
+
+    double bits = 8.0 * data_type_size(unit->type) / data_type_values(unit->type);
+    ASSERT(
+        bits == unit->bits,
+        "%s uses %.2f bits per weight, expected %.2f",
+        data_type_name(unit->type),
+        bits,
+        unit->bits
+    );
+
+    for (uint32_t i = 0; i < TEST_BLOCK_LENGTH; i += BLOCK_SIZE) {
+        uint32_t count = TEST_BLOCK_LENGTH - i < BLOCK_SIZE ? TEST_BLOCK_LENGTH - i : BLOCK_SIZE;
+        float bound = test_block_bound(unit->type, input + i, count);
+        for (uint32_t j = i; j < i + count; j++) {
+            float error = fabsf(output[j] - input[j]);
+            ASSERT(
+                error <= bound,
+                "%s value %u: |%f - %f| = %g exceeds %g",
+                data_type_name(unit->type),
+                j,
+                (double) output[j],
+                (double) input[j],
+                (double) error,
+                (double) bound
+            );
+        }
+    }
+
+    return 0;
+}
+
+int test_block_quantization(void) {
+    TestUnitBlock units[] = {
+        {.type = TYPE_BLOCK_Q8, .scale = 1.0f, .bits = 8.5},
+        {.type = TYPE_BLOCK_Q8, .scale = 300.0f, .bits = 8.5},
+        {.type = TYPE_BLOCK_Q4, .scale = 1.0f, .bits = 4.5},
+        {.type = TYPE_BLOCK_Q4, .scale = 0.01f, .bits = 4.5},
+        {.type = TYPE_BLOCK_Q4_MIN, .scale = 1.0f, .bits = 5.0},
+        {.type = TYPE_BLOCK_Q4_MIN, .scale = 0.5f, .offset = 3.0f, .bits = 5.0},
+        {.type = TYPE_BLOCK_Q8, .scale = 0.0f, .bits = 8.5},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Block Quantization", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_block_logic, NULL);
+}
+
+// Ties must round away from zero on every path, like roundf
+int test_block_rounding(void) {
+    float input[2 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 2 * BLOCK_SIZE; i++) {
+        input[i] = (float) ((int) i % 15 - 7) + (i % 2 ? 0.5f : 0.0f);
+    }
+    input[3] = 127.0f; // q8 scale of exactly 1 in the first block
+    input[BLOCK_SIZE + 5] = -8.0f; // q4 scale of exactly 1 in the second block
+
+    BlockQ8 q8[2];
+    BlockQ4 q4[2];
+    quantize_row_block_q8(input, q8, 2 * BLOCK_SIZE);
+    quantize_row_block_q4(input, q4, 2 * BLOCK_SIZE);
+
+    for (uint32_t j = 0; j < BLOCK_SIZE; j++) {
+        int expected = (int) roundf(input[j]);
+        ASSERT(
+            q8[0].quants[j] == expected,
+            "block_q8 value %u of %f is %d, expected %d",
+            j,
+            (double) input[j],
+            q8[0].quants[j],
+            expected
+        );
+
+        const float x = input[BLOCK_SIZE + j];
+        const uint8_t byte = q4[1].nibbles[j % Q4_NIBBLES];
+        int actual = j < Q4_NIBBLES ? byte & 0x0F : byte >> 4;
+        expected = (int) fminf(15.0f, roundf(x + 8.0f));
+        ASSERT(
+            actual == expected,
+            "block_q4 value %u of %f is %d, expected %d",
+            j,
+            (double) x,
+            actual,
+            expected
+        );
+    }
+
+    return 0;
+}
+
+// Reads code j of a block of packed nibbles, low nibbles first
+int test_block_nibble(const uint8_t* nibbles, uint32_t j) {
+    const uint8_t byte = nibbles[j % Q4_NIBBLES];
+    return j < Q4_NIBBLES ? byte & 0x0F : byte >> 4;
+}
+
+// Blocks with NaN or infinite values or importance have NaN errors on every candidate, so the
+// weighted encoders must fall back to the unclipped fit, which is the plain encoding. Only the
+// codes of the non-finite values themselves may differ between the vector and scalar paths.
+int test_block_weighted_nonfinite(void) {
+    enum { BLOCKS = 3, LENGTH = BLOCKS * BLOCK_SIZE };
+    float input[LENGTH], importance[LENGTH];
+    test_data_types_fill(input, LENGTH, 1337, 2.0f);
+    input[5] = NAN; // NaN in the first block
+    input[BLOCK_SIZE + 9] = INFINITY; // Infinity in the second block
+    for (uint32_t i = 0; i < LENGTH; i++) {
+        importance[i] = 1.0f;
+    }
+    importance[2 * BLOCK_SIZE + 3] = NAN; // NaN importance in the finite third block
+
+    BlockQ8 q8[BLOCKS], q8_plain[BLOCKS];
+    BlockQ4 q4[BLOCKS], q4_plain[BLOCKS];
+    BlockQ4Min q4_min[BLOCKS], q4_min_plain[BLOCKS];
+    quantize_row_block_q8_weighted(input, importance, q8, LENGTH);
+    quantize_row_block_q4_weighted(input, importance, q4, LENGTH);
+    quantize_row_block_q4_min_weighted(input, importance, q4_min, LENGTH);
+    quantize_row_block_q8(input, q8_plain, LENGTH);
+    quantize_row_block_q4(input, q4_plain, LENGTH);
+    quantize_row_block_q4_min(input, q4_min_plain, LENGTH);
+
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        ASSERT(q8[b].scale == q8_plain[b].scale, "block_q8 block %u scale differs", b);
+        ASSERT(q4[b].scale == q4_plain[b].scale, "block_q4 block %u scale differs", b);
+        ASSERT(
+            q4_min[b].scale == q4_min_plain[b].scale && q4_min[b].min == q4_min_plain[b].min,
+            "block_q4_min block %u scale or min differs",
+            b
+        );
+
+        for (uint32_t j = 0; j < BLOCK_SIZE; j++) {
+            if (!isfinite(input[b * BLOCK_SIZE + j])) {
+                continue;
+            }
+            ASSERT(
+                q8[b].quants[j] == q8_plain[b].quants[j],
+                "block_q8 block %u code %u differs",
+                b,
+                j
+            );
+            ASSERT(
+                test_block_nibble(q4[b].nibbles, j) == test_block_nibble(q4_plain[b].nibbles, j),
+                "block_q4 block %u code %u differs",
+                b,
+                j
+            );
+            ASSERT(
+                test_block_nibble(q4_min[b].nibbles, j)
+                    == test_block_nibble(q4_min_plain[b].nibbles, j),
+                "block_q4_min block %u code %u differs",
+                b,
+                j
+            );
+        }
+    }
+
+    return 0;
+}
+
+// The table decoders must reproduce the per-value formulas bit for bit, partial blocks included
+int test_block_decoding(void) {
+    enum { BLOCKS = 3, LENGTH = BLOCKS * BLOCK_SIZE - 5 };
+    BlockQ4 q4[BLOCKS];
+    BlockQ4Min q4_min[BLOCKS];
+    float output[BLOCKS * BLOCK_SIZE];
+
+    // Every code appears in both nibble positions; the last block has a negative scale
+    const float scales[BLOCKS] = {0.37f, 1e-3f, -2.5f};
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        q4[b].scale = quantize_scalar_fp16(scales[b]);
+        q4_min[b].scale = quantize_scalar_fp16(fabsf(scales[b]));
+        q4_min[b].min = quantize_scalar_fp16(-scales[b] * 3.0f);
+        for (uint32_t j = 0; j < Q4_NIBBLES; j++) {
+            const uint8_t byte = (uint8_t) ((j + 5 * b) % 16 | ((j * 7 + b) % 16) << 4);
+            q4[b].nibbles[j] = byte;
+            q4_min[b].nibbles[j] = byte;
+        }
+    }
+
+    dequantize_row_block_q4(q4, output, LENGTH);
+    for (uint32_t i = 0; i < LENGTH; i++) {
+        const BlockQ4* block = &q4[i / BLOCK_SIZE];
+        const uint32_t j = i % BLOCK_SIZE;
+        const uint8_t byte = block->nibbles[j % Q4_NIBBLES];
+        const int q = j < Q4_NIBBLES ? byte & 0x0F : byte >> 4;
+        const float expected = dequantize_scalar_fp16(block->scale) * (float) (q - 8);
+        ASSERT(
+            0 == memcmp(&output[i], &expected, sizeof(float)),
+            "block_q4 value %u is %f, expected %f",
+            i,
+            (double) output[i],
+            (double) expected
+        );
+    }
+
+    dequantize_row_block_q4_min(q4_min, output, LENGTH);
+    for (uint32_t i = 0; i < LENGTH; i++) {
+        const BlockQ4Min* block = &q4_min[i / BLOCK_SIZE];
+        const uint32_t j = i % BLOCK_SIZE;
+        const uint8_t byte = block->nibbles[j % Q4_NIBBLES];
+        const int q = j < Q4_NIBBLES ? byte & 0x0F : byte >> 4;
+        const float expected = dequantize_scalar_fp16(block->scale) * (float) q
+                               + dequantize_scalar_fp16(block->min);
+        ASSERT(
+            0 == memcmp(&output[i], &expected, sizeof(float)),
+            "block_q4_min value %u is %f, expected %f",
+            i,
+            (double) output[i],
+            (double) expected
+        );
+    }
+
+    // qint4 rows hold two values per element, high nibble first
+    Q4 row[16];
+    for (uint32_t j = 0; j < 16; j++) {
+        row[j].bits = (uint8_t) (j | (15 - j) << 4);
+        row[j].scalar = quantize_scalar_fp16(0.25f * (float) (j + 1));
+    }
+    dequantize_row_q4(row, output, 32, 1);
+    for (uint32_t i = 0; i < 32; i++) {
+        const float expected = dequantize_scalar_q4_index(row[i / 2], i % 2);
+        ASSERT(
+            output[i] == expected,
+            "qint4 value %u is %f, expected %f",
+            i,
+            (double) output[i],
+            (double) expected
+        );
+    }
+
+    return 0;
+}
+
+// ---------------------- Packed 4-bit Rows ----------------------
+
+int test_q4_packed(void) {
+    enum { LENGTH = 3 * BLOCK_SIZE + 6 };
+    float input[LENGTH], expected[LENGTH], output[LENGTH];
+    uint8_t nibbles[LENGTH / 2], packed[LENGTH / 2];
+    uint16_t scales[LENGTH / 2], pair_scales[LENGTH / 2];
+    Q4 row[LENGTH / 2];
+
+    test_data_types_fill(input, LENGTH, 17, 3.0f);
+    memset(input + BLOCK_SIZE, 0, BLOCK_SIZE * sizeof(float)); // One all-zero group
+
+    // A group of 2 is exactly qint4, and qint4 rows pack losslessly
+    quantize_row_q4(input, row, LENGTH, 1);
+    dequantize_row_q4(row, expected, LENGTH, 1);
+    quantize_row_q4_packed(input, nibbles, scales, LENGTH, 2);
+    q4_row_pack(row, packed, pair_scales, LENGTH);
+    ASSERT(0 == memcmp(nibbles, packed, sizeof(nibbles)), "group of 2 differs from qint4 codes");
+    ASSERT(
+        0 == memcmp(scales, pair_scales, sizeof(scales)), "group of 2 differs from qint4 scales"
+    );
+    dequantize_row_q4_packed(nibbles, scales, output, LENGTH, 2);
+    ASSERT(0 == memcmp(output, expected, sizeof(output)), "group of 2 decodes unlike qint4");
+
+    // Default groups: contiguous nibbles, one scale per 32 values, partial last group
+    quantize_row_q4_packed(input, nibbles, scales, LENGTH, Q4_PACKED_GROUP);
+    dequantize_row_q4_packed(nibbles, scales, output, LENGTH, Q4_PACKED_GROUP);
+    for (uint32_t i = 0; i < LENGTH; i++) {
+        const uint32_t g = i / Q4_PACKED_GROUP;
+        const uint8_t code = i % 2 ? nibbles[i / 2] & 0x0F : nibbles[i / 2] >> 4;
+        const int q = code & 0x08 ? (int) code - 16 : (int) code;
+        const float step = dequantize_scalar_fp16(scales[g]);
+        const float value = (float) (q * step);
+        ASSERT(
+            0 == memcmp(&output[i], &value, sizeof(float)),
+            "packed value %u is %f, expected %f",
+            i,
+            (double) output[i],
+            (double) value
+        );
+
+        float max_abs = 0.0f;
+        for (uint32_t j = g * Q4_PACKED_GROUP; j < LENGTH && j < (g + 1) * Q4_PACKED_GROUP; j++) {
+            max_abs = fmaxf(max_abs, fabsf(input[j]));
+        }
+        ASSERT(
+            fabsf(output[i] - input[i]) <= max_abs / 7.0f * 0.51f,
+            "packed value %u is off by %f",
+            i,
+            (double) fabsf(output[i] - input[i])
+        );
+    }
+
+    // NaN encodes as 0 and leaves the rest of its group as if it were 0
+    input[3] = 0.0f;
+    quantize_row_q4_packed(input, packed, pair_scales, LENGTH, Q4_PACKED_GROUP);
+    input[3] = NAN;
+    quantize_row_q4_packed(input, nibbles, scales, LENGTH, Q4_PACKED_GROUP);
+    ASSERT(0 == memcmp(nibbles, packed, sizeof(nibbles)), "NaN encodes unlike 0");
+    ASSERT(0 == memcmp(scales, pair_scales, sizeof(scales)), "NaN changes the group scale");
+    return 0;
+}
+
+// ---------------------- Half Precision Rows ----------------------
+
+typedef struct TestUnitFp16 {
+    uint32_t step; // Stride of the float side
+} TestUnitFp16;
+
+int test_fp16_logic(TestCase* test) {
+    TestUnitFp16* unit = (TestUnitFp16*) test->unit;
+    const uint32_t length = TEST_FP16_LENGTH * unit->step;
+    const uint32_t count = TEST_FP16_LENGTH;
+
+    static float input[TEST_FP16_LENGTH * 4];
+    static float output[TEST_FP16_LENGTH * 4];
+    static uint16_t half[TEST_FP16_LENGTH];
+
+    // Normal, subnormal, overflowing, and signed zero values
+    test_data_types_fill(input, length, 7 + unit->step, 1000.0f);
+    for (uint32_t i = 0; i < length; i += 7) {
+        input[i] *= 1e-9f;
+    }
+    input[unit->step] = 1e6f;
+    input[2 * unit->step] = -0.0f;
+    input[3 * unit->step] = -INFINITY;
+
+    quantize_row_fp16(input, half, length, unit->step);
+    for (uint32_t j = 0; j < count; j++) {
+        uint16_t expected = quantize_scalar_fp16(input[j * unit->step]);
+        ASSERT(
+            half[j] == expected,
+            "Encoded value %u of %f is 0x%04x, expected 0x%04x",
+            j,
+            (double) input[j * unit->step],
+            half[j],
+            expected
+        );
+    }
+
+    // Gaps between strided outputs must stay untouched
+    for (uint32_t i = 0; i < length; i++) {
+        output[i] = 42.0f;
+    }
+    dequantize_row_fp16(half, output, length, unit->step);
+    for (uint32_t i = 0; i < length; i++) {
+        float expected = 0 == i % unit->step ? dequantize_scalar_fp16(half[i / unit->step]) : 42.0f;
+        ASSERT(
+            memcmp(&output[i], &expected, sizeof(float)) == 0,
+            "Decoded value %u is %f, expected %f",
+            i,
+            (double) output[i],
+            (double) expected
+        );
+    }
+
+    return 0;
+}
+
+int test_fp16_rows(void) {
+    TestUnitFp16 units[] = {{.step = 1}, {.step = 2}, {.step = 3}};
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Half Rows", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_fp16_logic, NULL);
+}
+
+// ---------------------- Brain and 8-bit Floating Point ----------------------
+
+typedef struct TestUnitFp8 {
+    DataTypeId type; // TYPE_FP8_E4M3 or TYPE_FP8_E5M2
+    float max; // Largest finite value
+    float min; // Smallest subnormal value
+    bool inf; // Whether the format encodes infinity
+} TestUnitFp8;
+
+uint8_t test_fp8_encode(DataTypeId type, float value) {
+    return TYPE_FP8_E4M3 == type ? quantize_scalar_fp8_e4m3(value)
+                                 : quantize_scalar_fp8_e5m2(value);
+}
+
+float test_fp8_decode(DataTypeId type, uint8_t bits) {
+    return TYPE_FP8_E4M3 == type ? dequantize_scalar_fp8_e4m3(bits)
+                                 : dequantize_scalar_fp8_e5m2(bits);
+}
+
+float test_fp8_round_trip(DataTypeId type, float value) {
+    return test_fp8_decode(type, test_fp8_encode(type, value));
+}
+
+int test_fp8_logic(TestCase* test) {
+    TestUnitFp8* unit = (TestUnitFp8*) test->unit;
+    const char* name = data_type_name(unit->type);
+
+    // Every non-NaN code decodes to a value that encodes back to the same code
+    for (uint32_t code = 0; code < 256; code++) {
+        float value = test_fp8_decode(unit->type, (uint8_t) code);
+        if (isnan(value)) {
+            continue;
+        }
+        uint8_t bits = test_fp8_encode(unit->type, value);
+        ASSERT(
+            bits == code,
+            "%s code 0x%02x decodes to %f, encoded as 0x%02x",
+            name,
+            code,
+            (double) value,
+            bits
+        );
+    }
+
+    ASSERT(test_fp8_round_trip(unit->type, 1.0f) == 1.0f, "%s 1.0", name);
+    ASSERT(test_fp8_round_trip(unit->type, unit->min) == unit->min, "%s smallest subnormal", name);
+    ASSERT(test_fp8_round_trip(unit->type, unit->min * 0.5f) == 0.0f, "%s tie to zero", name);
+    ASSERT(test_fp8_round_trip(unit->type, -1e9f) == -unit->max, "%s saturates", name);
+    ASSERT(isnan(test_fp8_round_trip(unit->type, NAN)), "%s NaN", name);
+
+    float inf = test_fp8_round_trip(unit->type, INFINITY);
+    ASSERT(inf == (unit->inf ? INFINITY : unit->max), "%s infinity is %f", name, (double) inf);
+
+    // The midpoint between 1 and the next value rounds to the even code, which is 1
+    float next = test_fp8_decode(unit->type, test_fp8_encode(unit->type, 1.0f) + 1);
+    float tie = test_fp8_round_trip(unit->type, (1.0f + next) * 0.5f);
+    ASSERT(tie == 1.0f, "%s midpoint of 1 and %f rounds to %f", name, (double) next, (double) tie);
+
+    return 0;
+}
+
+int test_fp8_codes(void) {
+    TestUnitFp8 units[] = {
+        {.type = TYPE_FP8_E4M3, .max = 448.0f, .min = 0x1.0p-9f, .inf = false},
+        {.type = TYPE_FP8_E5M2, .max = 57344.0f, .min = 0x1.0p-16f, .inf = true},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "FP8 Codes", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_fp8_logic, NULL);
+}
+
+typedef struct TestUnitNarrow {
+    DataTypeId type; // TYPE_BFLOAT16, TYPE_FP8_E4M3, or TYPE_FP8_E5M2
+    uint32_t step; // Stride of the float side
+} TestUnitNarrow;
+
+// Rows must match the scalar converters bit for bit on every path
+int test_narrow_logic(TestCase* test) {
+    TestUnitNarrow* unit = (TestUnitNarrow*) test->unit;
+    const uint32_t length = TEST_FP16_LENGTH * unit->step;
+
+    static float input[TEST_FP16_LENGTH * 4];
+    static float output[TEST_FP16_LENGTH * 4];
+    static uint16_t codes[TEST_FP16_LENGTH];
+    static uint8_t bytes[TEST_FP16_LENGTH];
+
+    // Wide range with ties, subnormals, overflow, infinities, and NaN
+    test_data_types_fill(input, length, 3 + unit->step, 1000.0f);
+    for (uint32_t i = 0; i < length; i += 5) {
+        input[i] *= 1e-5f;
+    }
+    for (uint32_t i = 2; i < length; i += 11) {
+        input[i] = 1.0f + 0x1.0p-4f; // Tie for E4M3 and bfloat16 rounding
+    }
+    input[unit->step] = 1e6f;
+    input[2 * unit->step] = -INFINITY;
+    input[3 * unit->step] = NAN;
+    input[4 * unit->step] = -0.0f;
+
+    for (uint32_t i = 0; i < length; i++) {
+        output[i] = 42.0f;
+    }
+
+    for (uint32_t j = 0; j < TEST_FP16_LENGTH; j++) {
+        const float x = input[j * unit->step];
+        uint32_t actual, expected;
+        switch (unit->type) {
+            case TYPE_BFLOAT16:
+                if (0 == j) {
+                    quantize_row_bf16(input, codes, length, unit->step);
+                    dequantize_row_bf16(codes, output, length, unit->step);
+                }
+                actual = codes[j];
+                expected = quantize_scalar_bf16(x);
+                break;
+            case TYPE_FP8_E4M3:
+                if (0 == j) {
+                    quantize_row_fp8_e4m3(input, bytes, length, unit->step);
+                    dequantize_row_fp8_e4m3(bytes, output, length, unit->step);
+                }
+                actual = bytes[j];
+                expected = quantize_scalar_fp8_e4m3(x);
+                break;
+            default:
+                if (0 == j) {
+                    quantize_row_fp8_e5m2(input, bytes, length, unit->step);
+                    dequantize_row_fp8_e5m2(bytes, output, length, unit->step);
+                }
+                actual = bytes[j];
+                expected = quantize_scalar_fp8_e5m2(x);
+                break;
+        }
+        ASSERT(
+            actual == expected,
+            "%s value %u of %f is 0x%x, expected 0x%x",
+            data_type_name(unit->type),
+            j,
+            (double) x,
+            actual,
+            expected
+        );
+
+        float decoded = TYPE_BFLOAT16 == unit->type
+                            ? dequantize_scalar_bf16((uint16_t) expected)
+                            : test_fp8_decode(unit->type, (uint8_t) expected);
+        ASSERT(
+            memcmp(&output[j * unit->step], &decoded, sizeof(float)) == 0,
+            "%s decoded value %u is %f, expected %f",
+            data_type_name(unit->type),
+            j,
+            (double) output[j * unit->step],
+            (double) decoded
+        );
+    }
+
+    // Gaps between strided outputs must stay untouched
+    for (uint32_t i = 0; i < length; i++) {
+        ASSERT(0 == i % unit->step || 42.0f == output[i], "Gap %u was overwritten", i);
+    }
+
+    return 0;
+}
+
+int test_narrow_rows(void) {
+    TestUnitNarrow units[] = {
+        {TYPE_BFLOAT16, 1},
+        {TYPE_BFLOAT16, 3},
+        {TYPE_FP8_E4M3, 1},
+        {TYPE_FP8_E4M3, 2},
+        {TYPE_FP8_E5M2, 1},
+        {TYPE_FP8_E5M2, 3},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Narrow Float Rows", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_narrow_logic, NULL);
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_block_quantization", test_block_quantization},
+        {"test_block_rounding", test_block_rounding},
+        {"test_block_weighted_nonfinite", test_block_weighted_nonfinite},
+        {"test_block_decoding", test_block_decoding},
+        {"test_q4_packed", test_q4_packed},
+        {"test_fp16_rows", test_fp16_rows},
+        {"test_fp8_codes", test_fp8_codes},
+        {"test_narrow_rows", test_narrow_rows},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
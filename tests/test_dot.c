@@ -0,0 +1,169 @@
+/**
+ * @file tests/test_dot.c
+ * @brief Tests for the fused dot product kernels.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ALT libraries
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+#include "kernels/dot.h"
+
+#define TEST_DOT_TOLERANCE 1e-5 /**< Relative to the sum of absolute products */
+
+// ---------------------- Helpers ----------------------
+
+// Fills a float buffer with deterministic values in [-scale, scale]
+void test_dot_fill(float* data, size_t length, uint32_t seed, float scale) {
+    random_seed(seed);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = scale * random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// ---------------------- Dot Products ----------------------
+
+typedef struct TestUnitDot {
+    DataTypeId type; // Type of x: block_q8, block_q4, float16, or an fp8 type
+    uint32_t length; // Values in each row
+    float scale; // Magnitude of the input values
+} TestUnitDot;
+
+int test_dot_logic(TestCase* test) {
+    TestUnitDot* unit = (TestUnitDot*) test->unit;
+    const uint32_t length = unit->length;
+    const size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    float* x = malloc(sizeof(float) * length);
+    float* y = malloc(sizeof(float) * length);
+    float* x_ref = malloc(sizeof(float) * length);
+    float* y_ref = malloc(sizeof(float) * length);
+    void* x_enc = malloc(sizeof(BlockQ8) * blocks + sizeof(uint16_t) * length);
+    BlockQ8* y_enc = malloc(sizeof(BlockQ8) * blocks);
+
+    int result = 0;
+    if (!x || !y || !x_ref || !y_ref || !x_enc || !y_enc) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_dot_fill(x, length, 17 + (uint32_t) test->index, unit->scale);
+    test_dot_fill(y, length, 71 + (uint32_t) test->index, unit->scale);
+
+    // The reference multiplies the decoded operands, so only accumulation order differs
+    float actual;
+    memcpy(y_ref, y, sizeof(float) * length);
+    switch (unit->type) {
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8(x, (BlockQ8*) x_enc, length);
+            dequantize_row_block_q8((BlockQ8*) x_enc, x_ref, length);
+            quantize_row_block_q8(y, y_enc, length);
+            dequantize_row_block_q8(y_enc, y_ref, length);
+            actual = dot_q8_q8((BlockQ8*) x_enc, y_enc, blocks);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4(x, (BlockQ4*) x_enc, length);
+            dequantize_row_block_q4((BlockQ4*) x_enc, x_ref, length);
+            quantize_row_block_q8(y, y_enc, length);
+            dequantize_row_block_q8(y_enc, y_ref, length);
+            actual = dot_q4_q8((BlockQ4*) x_enc, y_enc, blocks);
+            break;
+        case TYPE_FP8_E4M3:
+            quantize_row_fp8_e4m3(x, (uint8_t*) x_enc, length, 1);
+            dequantize_row_fp8_e4m3((uint8_t*) x_enc, x_ref, length, 1);
+            actual = dot_lut_f32(data_type_decode_table(unit->type), (uint8_t*) x_enc, y, length);
+            break;
+        case TYPE_FP8_E5M2:
+            quantize_row_fp8_e5m2(x, (uint8_t*) x_enc, length, 1);
+            dequantize_row_fp8_e5m2((uint8_t*) x_enc, x_ref, length, 1);
+            actual = dot_lut_f32(data_type_decode_table(unit->type), (uint8_t*) x_enc, y, length);
+            break;
+        default:
+            quantize_row_fp16(x, (uint16_t*) x_enc, length, 1);
+            dequantize_row_fp16((uint16_t*) x_enc, x_ref, length, 1);
+            actual = dot_f16_f32((uint16_t*) x_enc, y, length);
+            break;
+    }
+
+    double expected = 0.0, magnitude = 0.0;
+    for (uint32_t i = 0; i < length; i++) {
+        expected += (double) x_ref[i] * (double) y_ref[i];
+        magnitude += fabs((double) x_ref[i] * (double) y_ref[i]);
+    }
+
+    double error = fabs((double) actual - expected);
+    if (error > TEST_DOT_TOLERANCE * magnitude + 1e-30) {
+        LOG_ERROR(
+            "%s: %s length %u: got %f, expected %f (error %g).\n",
+            __func__,
+            data_type_name(unit->type),
+            length,
+            (double) actual,
+            expected,
+            error
+        );
+        result = 1;
+    }
+
+cleanup:
+    free(x);
+    free(y);
+    free(x_ref);
+    free(y_ref);
+    free(x_enc);
+    free(y_enc);
+    return result;
+}
+
+int test_dot_products(void) {
+    TestUnitDot units[] = {
+        {.type = TYPE_BLOCK_Q8, .length = 32, .scale = 1.0f},
+        {.type = TYPE_BLOCK_Q8, .length = 224, .scale = 100.0f},
+        {.type = TYPE_BLOCK_Q8, .length = 4096, .scale = 0.01f},
+        {.type = TYPE_BLOCK_Q4, .length = 32, .scale = 1.0f},
+        {.type = TYPE_BLOCK_Q4, .length = 224, .scale = 100.0f},
+        {.type = TYPE_BLOCK_Q4, .length = 4096, .scale = 0.01f},
+        {.type = TYPE_FLOAT16, .length = 1, .scale = 1.0f},
+        {.type = TYPE_FLOAT16, .length = 47, .scale = 10.0f},
+        {.type = TYPE_FLOAT16, .length = 4099, .scale = 1.0f},
+        {.type = TYPE_BLOCK_Q8, .length = 64, .scale = 0.0f},
+        {.type = TYPE_FP8_E4M3, .length = 5, .scale = 1.0f},
+        {.type = TYPE_FP8_E4M3, .length = 4133, .scale = 300.0f},
+        {.type = TYPE_FP8_E5M2, .length = 47, .scale = 0.01f},
+        {.type = TYPE_FP8_E5M2, .length = 1024, .scale = 1000.0f},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Dot Products", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_dot_logic, NULL);
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_dot_products", test_dot_products},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
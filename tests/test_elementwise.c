@@ -0,0 +1,334 @@
+/**
+ * @file tests/test_elementwise.c
+ * @brief Tests for the broadcasting elementwise kernels.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+
+// ALT libraries
+#include "interface/activation.h"
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+#include "kernels/elementwise.h"
+
+#define TEST_ELEMENTWISE_TOLERANCE 1e-6f
+
+// ---------------------- Helpers ----------------------
+
+// Fills a tensor through a cursor with deterministic values in [0.5, 1.5]
+void test_elementwise_fill(Tensor* tensor, uint32_t seed) {
+    TensorCursor cursor;
+    if (tensor_cursor_init(&cursor, tensor) != TENSOR_SUCCESS) {
+        return;
+    }
+    random_seed(seed);
+    for (; tensor_cursor_valid(&cursor); tensor_cursor_next(&cursor)) {
+        *(float*) tensor_cursor_get(&cursor) = random_uniform(0.5f, 1.5f);
+    }
+}
+
+// Reads element (i, j) of a rank 1 or 2 tensor broadcast to two dimensions
+float test_elementwise_get(const Tensor* tensor, uint32_t i, uint32_t j) {
+    const uint32_t* shape = tensor_shape_data(tensor);
+    const uint64_t* stride = tensor_stride_data(tensor);
+    const float* data = (const float*) tensor->data;
+    if (1 == tensor->rank) {
+        return data[(1 == shape[0] ? 0 : j) * stride[0]];
+    }
+    return data[(1 == shape[0] ? 0 : i) * stride[0] + (1 == shape[1] ? 0 : j) * stride[1]];
+}
+
+// ---------------------- Fused Chains ----------------------
+
+typedef struct TestUnitElementwise {
+    const char* label; // Description of the chain
+    uint32_t rows; // Output rows
+    uint32_t cols; // Output columns
+    uint32_t operand_rank; // Rank of the second operand (0 for none)
+    uint32_t operand_shape[2]; // Shape of the second operand
+    bool transpose_x; // Pass x as a transposed view
+    bool in_place; // Write the result into x
+    ElementwiseStep steps[3]; // Chain under test (operands filled in at runtime)
+    uint32_t count; // Number of steps
+} TestUnitElementwise;
+
+// Reference evaluation of a chain for a single element
+float test_elementwise_reference(
+    const TestUnitElementwise* unit, float value, const Tensor* operand, uint32_t i, uint32_t j
+) {
+    for (uint32_t s = 0; s < unit->count; s++) {
+        const ElementwiseStep* step = &unit->steps[s];
+        float other = operand ? test_elementwise_get(operand, i, j) : 0.0f;
+        switch (step->op) {
+            case ELEMENTWISE_ADD:
+                value += other;
+                break;
+            case ELEMENTWISE_SUB:
+                value -= other;
+                break;
+            case ELEMENTWISE_MUL:
+                value *= other;
+                break;
+            case ELEMENTWISE_DIV:
+                value /= other;
+                break;
+            case ELEMENTWISE_SCALE:
+                value *= step->scalar;
+                break;
+            case ELEMENTWISE_ACTIVATE:
+                value = step->function(value);
+                break;
+        }
+    }
+    return value;
+}
+
+int test_elementwise_logic(TestCase* test) {
+    TestUnitElementwise* unit = (TestUnitElementwise*) test->unit;
+    const uint32_t m = unit->rows, n = unit->cols;
+
+    Tensor* x_store = unit->transpose_x ? tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){n, m})
+                                        : tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    Tensor* x = unit->transpose_x ? tensor_view_transpose(x_store, 0, 1) : x_store;
+    Tensor* expected = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    Tensor* operand = unit->operand_rank
+                          ? tensor_create(TYPE_FLOAT32, unit->operand_rank, unit->operand_shape)
+                          : NULL;
+    Tensor* out = unit->in_place ? x : tensor_create_uninitialized(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+
+    int result = 0;
+    if (!x || !expected || !out || (unit->operand_rank && !operand)) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_elementwise_fill(x, 1337);
+    if (operand) {
+        test_elementwise_fill(operand, 7331);
+    }
+
+    float* reference = (float*) expected->data;
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            float value = test_elementwise_get(x, i, j);
+            reference[(size_t) i * n + j] = test_elementwise_reference(unit, value, operand, i, j);
+        }
+    }
+
+    ElementwiseStep steps[3];
+    for (uint32_t s = 0; s < unit->count; s++) {
+        steps[s] = unit->steps[s];
+        steps[s].operand = operand;
+    }
+
+    TensorState state = tensor_elementwise(x, steps, unit->count, out);
+
+    float error = 0.0f;
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            float actual = test_elementwise_get(out, i, j);
+            error = fmaxf(error, fabsf(actual - reference[(size_t) i * n + j]));
+        }
+    }
+
+    if (TENSOR_SUCCESS != state || error > TEST_ELEMENTWISE_TOLERANCE) {
+        LOG_ERROR(
+            "%s: Test case %zu (%s) failed (state=%d, error=%g).\n",
+            __func__,
+            test->index,
+            unit->label,
+            state,
+            (double) error
+        );
+        result = 1;
+    }
+
+cleanup:
+    if (out != x) {
+        tensor_free(out);
+    }
+    if (x != x_store) {
+        tensor_free(x);
+    }
+    tensor_free(x_store);
+    tensor_free(operand);
+    tensor_free(expected);
+    return result;
+}
+
+int test_tensor_elementwise(void) {
+    TestUnitElementwise units[] = {
+        {
+            .label = "add",
+            .rows = 3,
+            .cols = 37,
+            .operand_rank = 2,
+            .operand_shape = {3, 37},
+            .steps = {{.op = ELEMENTWISE_ADD}},
+            .count = 1,
+        },
+        {
+            .label = "div row broadcast",
+            .rows = 5,
+            .cols = 2100,
+            .operand_rank = 1,
+            .operand_shape = {2100},
+            .steps = {{.op = ELEMENTWISE_DIV}},
+            .count = 1,
+        },
+        {
+            .label = "sub column broadcast",
+            .rows = 9,
+            .cols = 21,
+            .operand_rank = 2,
+            .operand_shape = {9, 1},
+            .steps = {{.op = ELEMENTWISE_SUB}},
+            .count = 1,
+        },
+        {
+            .label = "scale transposed",
+            .rows = 17,
+            .cols = 6,
+            .transpose_x = true,
+            .steps = {{.op = ELEMENTWISE_SCALE, .scalar = -2.5f}},
+            .count = 1,
+        },
+        {
+            .label = "(x + residual) * gamma in place",
+            .rows = 4,
+            .cols = 100,
+            .operand_rank = 1,
+            .operand_shape = {100},
+            .in_place = true,
+            .steps = {{.op = ELEMENTWISE_ADD}, {.op = ELEMENTWISE_MUL}},
+            .count = 2,
+        },
+        {
+            .label = "relu(scale(x) * w)",
+            .rows = 2,
+            .cols = 53,
+            .operand_rank = 2,
+            .operand_shape = {2, 53},
+            .steps = {
+                {.op = ELEMENTWISE_SCALE, .scalar = -1.0f},
+                {.op = ELEMENTWISE_MUL},
+                {.op = ELEMENTWISE_ACTIVATE, .function = activate_relu},
+            },
+            .count = 3,
+        },
+        {
+            .label = "silu",
+            .rows = 3,
+            .cols = 11,
+            .steps = {{.op = ELEMENTWISE_ACTIVATE, .function = activate_silu}},
+            .count = 1,
+        },
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Tensor Elementwise", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_elementwise_logic, NULL);
+}
+
+// ---------------------- Aliasing ----------------------
+
+// The output aliases the operand b rather than the input a
+int test_tensor_elementwise_aliased(void) {
+    const uint32_t m = 3, n = 1500; // Rows span more than one chunk
+    Tensor* a = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    Tensor* b = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+
+    int result = 0;
+    if (!a || !b) {
+        LOG_ERROR("%s: Failed to create tensors.\n", __func__);
+        tensor_free(a);
+        tensor_free(b);
+        return 1;
+    }
+
+    const ElementwiseOp ops[] = {ELEMENTWISE_ADD, ELEMENTWISE_SUB};
+    for (size_t k = 0; k < sizeof(ops) / sizeof(ops[0]) && 0 == result; k++) {
+        test_elementwise_fill(a, 1337);
+        test_elementwise_fill(b, 7331);
+
+        float expected[m * n];
+        const float* x = (const float*) a->data;
+        float* y = (float*) b->data;
+        for (size_t i = 0; i < (size_t) m * n; i++) {
+            expected[i] = ELEMENTWISE_ADD == ops[k] ? x[i] + y[i] : x[i] - y[i];
+        }
+
+        TensorState state = ELEMENTWISE_ADD == ops[k] ? tensor_add(a, b, b) : tensor_sub(a, b, b);
+
+        float error = 0.0f;
+        for (size_t i = 0; i < (size_t) m * n; i++) {
+            error = fmaxf(error, fabsf(y[i] - expected[i]));
+        }
+        if (TENSOR_SUCCESS != state || error > TEST_ELEMENTWISE_TOLERANCE) {
+            LOG_ERROR(
+                "%s: Operation %d into b failed (state=%d, error=%g).\n",
+                __func__,
+                ops[k],
+                state,
+                (double) error
+            );
+            result = 1;
+        }
+    }
+
+    tensor_free(a);
+    tensor_free(b);
+    return result;
+}
+
+// ---------------------- Shape Validation ----------------------
+
+int test_tensor_elementwise_invalid(void) {
+    Tensor* a = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){4, 3});
+    Tensor* b = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){4});
+    Tensor* out = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){4, 3});
+
+    int result = 0;
+    if (!a || !b || !out) {
+        LOG_ERROR("%s: Failed to create tensors.\n", __func__);
+        result = 1;
+    } else if (tensor_add(a, b, out) != TENSOR_INVALID_SHAPE) {
+        LOG_ERROR("%s: Broadcast [4] against [4, 3] was not rejected.\n", __func__);
+        result = 1;
+    }
+
+    tensor_free(a);
+    tensor_free(b);
+    tensor_free(out);
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_tensor_elementwise", test_tensor_elementwise},
+        {"test_tensor_elementwise_aliased", test_tensor_elementwise_aliased},
+        {"test_tensor_elementwise_invalid", test_tensor_elementwise_invalid},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
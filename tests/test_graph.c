@@ -0,0 +1,261 @@
+/**
+ * @file tests/test_graph.c
+ * @brief Tests for the lazy expression graph.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+
+// ALT libraries
+#include "graph.h"
+#include "interface/activation.h"
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+
+#define TEST_GRAPH_TOLERANCE 1e-4f
+
+// ---------------------- Helpers ----------------------
+
+// Fills a contiguous float tensor with deterministic values in [-1, 1]
+void test_graph_fill(Tensor* tensor, uint32_t seed) {
+    float* data = (float*) tensor->data;
+    random_seed(seed);
+    for (uint64_t i = 0; i < tensor->size; i++) {
+        data[i] = random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// Returns the number of nodes that execute a kernel
+uint32_t test_graph_kernels(const Graph* graph) {
+    uint32_t kernels = 0;
+    for (uint32_t i = 0; i < graph->count; i++) {
+        if (GRAPH_INPUT != graph->nodes[i]->op && !graph->nodes[i]->absorbed) {
+            kernels++;
+        }
+    }
+    return kernels;
+}
+
+// ---------------------- Feed-Forward Block ----------------------
+
+int test_graph_feed_forward(void) {
+    const uint32_t m = 5, k = 32, n = 24;
+
+    Tensor* x = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, k});
+    Tensor* w1 = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){k, n});
+    Tensor* w2 = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){n, k});
+    Tensor* bias = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+    Tensor* gamma = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){k});
+    Tensor* hidden = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    Tensor* expected = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, k});
+    Tensor* norms = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){m});
+    Graph* graph = graph_create();
+
+    int result = 0;
+    if (!x || !w1 || !w2 || !bias || !gamma || !hidden || !expected || !norms || !graph) {
+        LOG_ERROR("%s: Failed to create tensors.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_graph_fill(x, 1);
+    test_graph_fill(w1, 2);
+    test_graph_fill(w2, 3);
+    test_graph_fill(bias, 4);
+    test_graph_fill(gamma, 5);
+
+    // Eager reference: out = (relu(x @ w1 + bias) @ w2 + x) * gamma, norms = L2(out, axis 1)
+    ElementwiseStep up[] = {
+        {.op = ELEMENTWISE_ADD, .operand = bias},
+        {.op = ELEMENTWISE_ACTIVATE, .function = activate_relu},
+    };
+    ElementwiseStep down[] = {
+        {.op = ELEMENTWISE_ADD, .operand = x},
+        {.op = ELEMENTWISE_MUL, .operand = gamma},
+    };
+    tensor_matmul(x, w1, hidden);
+    tensor_elementwise(hidden, up, 2, hidden);
+    tensor_matmul(hidden, w2, expected);
+    tensor_elementwise(expected, down, 2, expected);
+    tensor_reduce(expected, 1, REDUCE_L2, norms);
+
+    // Recorded graph: the residual is added as x + h to exercise operand swapping
+    GraphNode* in = graph_input(graph, x);
+    GraphNode* h = graph_matmul(graph, in, graph_input(graph, w1));
+    h = graph_binary(graph, ELEMENTWISE_ADD, h, graph_input(graph, bias));
+    h = graph_activate(graph, h, activate_relu);
+    GraphNode* y = graph_matmul(graph, h, graph_input(graph, w2));
+    y = graph_binary(graph, ELEMENTWISE_ADD, in, y);
+    y = graph_binary(graph, ELEMENTWISE_MUL, y, graph_input(graph, gamma));
+    GraphNode* norm = graph_reduce(graph, y, 1, REDUCE_L2);
+    graph_mark_output(y);
+    graph_mark_output(norm);
+
+    if (!norm || graph_plan(graph) != TENSOR_SUCCESS || graph_execute(graph) != TENSOR_SUCCESS) {
+        LOG_ERROR("%s: Failed to record, plan, or execute the graph.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    // Two matmuls with fused epilogues plus the reduction
+    if (test_graph_kernels(graph) != 3) {
+        LOG_ERROR("%s: Expected 3 fused kernels, got %u.\n", __func__, test_graph_kernels(graph));
+        result = 1;
+    }
+
+    float error = 0.0f;
+    for (uint64_t i = 0; i < expected->size; i++) {
+        error = fmaxf(error, fabsf(((float*) expected->data)[i] - ((float*) y->tensor->data)[i]));
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        error = fmaxf(error, fabsf(((float*) norms->data)[i] - ((float*) norm->tensor->data)[i]));
+    }
+    if (error > TEST_GRAPH_TOLERANCE) {
+        LOG_ERROR("%s: Graph differs from eager result (error=%g).\n", __func__, (double) error);
+        result = 1;
+    }
+
+cleanup:
+    graph_free(graph);
+    tensor_free(x);
+    tensor_free(w1);
+    tensor_free(w2);
+    tensor_free(bias);
+    tensor_free(gamma);
+    tensor_free(hidden);
+    tensor_free(expected);
+    tensor_free(norms);
+    return result;
+}
+
+// ---------------------- Memory Planning ----------------------
+
+int test_graph_memory_plan(void) {
+    const uint32_t n = 1024;
+    Tensor* x = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+    Graph* graph = graph_create();
+
+    int result = 0;
+    if (!x || !graph) {
+        LOG_ERROR("%s: Failed to create tensors.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+    test_graph_fill(x, 9);
+
+    // Each square reads its source twice, so squares materialize and scales fuse into them
+    GraphNode* in = graph_input(graph, x);
+    GraphNode* value = in;
+    for (uint32_t i = 0; i < 6; i++) {
+        value = graph_binary(graph, ELEMENTWISE_MUL, value, value);
+        value = graph_scale(graph, value, 0.5f);
+    }
+    graph_mark_output(value);
+
+    if (!value || graph_plan(graph) != TENSOR_SUCCESS || graph_execute(graph) != TENSOR_SUCCESS) {
+        LOG_ERROR("%s: Failed to plan or execute the graph.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    // Dead values are recycled, so two alternating buffers suffice instead of twelve
+    if (test_graph_kernels(graph) != 6 || graph->arena_size > 2 * n * sizeof(float)) {
+        LOG_ERROR(
+            "%s: Expected 6 kernels in 2 buffers, got %u kernels in %zu bytes.\n",
+            __func__,
+            test_graph_kernels(graph),
+            graph->arena_size
+        );
+        result = 1;
+    }
+
+    float expected = ((float*) x->data)[7];
+    for (uint32_t i = 0; i < 6; i++) {
+        expected = expected * expected * 0.5f;
+    }
+    float actual = ((float*) value->tensor->data)[7];
+    if (fabsf(expected - actual) > TEST_GRAPH_TOLERANCE) {
+        LOG_ERROR("%s: Expected %f, got %f.\n", __func__, (double) expected, (double) actual);
+        result = 1;
+    }
+
+cleanup:
+    graph_free(graph);
+    tensor_free(x);
+    return result;
+}
+
+// ---------------------- Planning Again ----------------------
+
+// Recording on a node fused by an earlier plan materializes it in the next plan
+int test_graph_replan(void) {
+    const uint32_t n = 64;
+    Tensor* x = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){n});
+    Graph* graph = graph_create();
+
+    int result = 0;
+    if (!x || !graph) {
+        LOG_ERROR("%s: Failed to create tensors.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+    test_graph_fill(x, 11);
+
+    GraphNode* scaled = graph_scale(graph, graph_input(graph, x), 2.0f);
+    GraphNode* relu = graph_activate(graph, scaled, activate_relu);
+    graph_mark_output(relu);
+    if (!relu || graph_plan(graph) != TENSOR_SUCCESS || graph_execute(graph) != TENSOR_SUCCESS
+        || !scaled->absorbed || test_graph_kernels(graph) != 1) {
+        LOG_ERROR("%s: Failed to fuse scale into relu.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    GraphNode* tripled = graph_scale(graph, scaled, 3.0f);
+    graph_mark_output(tripled);
+    if (!tripled || graph_plan(graph) != TENSOR_SUCCESS || graph_execute(graph) != TENSOR_SUCCESS
+        || scaled->absorbed || !scaled->tensor || test_graph_kernels(graph) != 3) {
+        LOG_ERROR("%s: Failed to plan again after recording on a fused node.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const float value = ((float*) x->data)[i];
+        const float r = ((float*) relu->tensor->data)[i];
+        const float t = ((float*) tripled->tensor->data)[i];
+        if (fabsf(r - fmaxf(2.0f * value, 0.0f)) > TEST_GRAPH_TOLERANCE
+            || fabsf(t - 6.0f * value) > TEST_GRAPH_TOLERANCE) {
+            LOG_ERROR(
+                "%s: Element %u: relu %f, tripled %f.\n", __func__, i, (double) r, (double) t
+            );
+            result = 1;
+            break;
+        }
+    }
+
+cleanup:
+    graph_free(graph);
+    tensor_free(x);
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_graph_feed_forward", test_graph_feed_forward},
+        {"test_graph_memory_plan", test_graph_memory_plan},
+        {"test_graph_replan", test_graph_replan},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,300 @@
+/**
+ * @file tests/test_loader.c
+ * @brief Tests for parallel loading of the Tensor Section.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/data_types.h"
+#include "interface/logger.h"
+#include "interface/unit_test.h"
+#include "kernels/quantize.h"
+#include "model/loader.h"
+#include "threads.h"
+
+#define TEST_LOADER_PATH "test_loader.alt" /**< Scratch file in the working directory */
+#define TEST_LOADER_ROWS 8 /**< Rows of the dense and quantized tensors */
+#define TEST_LOADER_COLS (2 * BLOCK_SIZE) /**< Values per row of the same */
+
+// ---------------------- Helpers ----------------------
+
+/**
+ * @struct TestLoaderData
+ * @brief Stored data of the scratch file's tensors.
+ */
+typedef struct TestLoaderData {
+    float dense[TEST_LOADER_ROWS * TEST_LOADER_COLS];
+    BlockQ8 blocks[TEST_LOADER_ROWS * TEST_LOADER_COLS / BLOCK_SIZE];
+    float bias[3 * 5];
+} TestLoaderData;
+
+// Fills the stored data of the three tensors
+void test_loader_data(TestLoaderData* data) {
+    float values[TEST_LOADER_ROWS * TEST_LOADER_COLS];
+    for (uint32_t i = 0; i < TEST_LOADER_ROWS * TEST_LOADER_COLS; i++) {
+        data->dense[i] = (float) (i % 23) * 0.125f - 1.0f;
+        values[i] = (float) (i % 19) - 9.0f;
+    }
+    for (uint32_t i = 0; i < 3 * 5; i++) {
+        data->bias[i] = (float) i * 0.5f;
+    }
+    quantize_row_block_q8(values, data->blocks, TEST_LOADER_ROWS * TEST_LOADER_COLS);
+}
+
+// Writes a Tensor Section of a dense, a quantized, and a small tensor, and an Index Section
+int test_loader_write(const TestLoaderData* data) {
+    MagicWriter* writer = magic_writer_open(TEST_LOADER_PATH, 0);
+    if (!writer) {
+        return 1;
+    }
+
+    MagicTensorSection section = {
+        .data_type = TYPE_FLOAT32,
+        .tensor_count = 3,
+        .shape_count = 6,
+        .block_count = 1,
+        .unique_count = 2,
+    };
+    MagicTensorInfo infos[] = {
+        {
+            .component_type = 1,
+            .block_index = -1,
+            .n_dims = 2,
+            .shape = {TEST_LOADER_ROWS, TEST_LOADER_COLS},
+            .name = "embed_tokens.weight",
+            .data_type = TYPE_FLOAT32,
+        },
+        {
+            .block_index = 0,
+            .layer_type = 2,
+            .projection_type = 3,
+            .n_dims = 2,
+            .shape = {TEST_LOADER_ROWS, TEST_LOADER_COLS / BLOCK_SIZE},
+            .name = "layers.0.mlp.up_proj.weight",
+            .data_type = TYPE_BLOCK_Q8,
+            .packing_flag = 1,
+        },
+        {
+            .component_type = 2,
+            .block_index = -1,
+            .n_dims = 2,
+            .shape = {3, 5},
+            .name = "norm.weight",
+            .data_type = TYPE_FLOAT32,
+        },
+    };
+    const void* stored[] = {data->dense, data->blocks, data->bias};
+
+    int result = MAGIC_SUCCESS
+                 != magic_writer_write_start_marker(writer, MAGIC_VERSION, MAGIC_ALIGNMENT);
+    result = result || MAGIC_SUCCESS != magic_writer_begin_section(writer, MAGIC_TENSORS);
+    result = result || MAGIC_SUCCESS != magic_writer_write_tensor_section(writer, &section);
+    for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); i++) {
+        result = result || MAGIC_SUCCESS != magic_writer_write_tensor(writer, &infos[i], stored[i]);
+    }
+    result = result || MAGIC_SUCCESS != magic_writer_end_section(writer);
+    result = result || MAGIC_SUCCESS != magic_writer_finish(writer, true);
+    return (MAGIC_SUCCESS != magic_writer_close(writer)) || result;
+}
+
+// Whether a tensor has the type, shape, and row-major data given
+int test_loader_same(
+    const Tensor* tensor, DataTypeId id, uint32_t rows, uint32_t cols, const void* data
+) {
+    return tensor && id == tensor->type->id && 2 == tensor->rank
+           && rows == tensor_shape_data(tensor)[0] && cols == tensor_shape_data(tensor)[1]
+           && 0 == memcmp(tensor->data, data, tensor_byte_size(tensor));
+}
+
+// ---------------------- Loading ----------------------
+
+int test_loader_stored(void) {
+    TestLoaderData data;
+    test_loader_data(&data);
+    ASSERT(0 == test_loader_write(&data), "failed to write %s", TEST_LOADER_PATH);
+
+    MagicFile* magic = magic_file_open(TEST_LOADER_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_LOADER_PATH);
+    MagicIndex index = {0};
+    ASSERT(MAGIC_SUCCESS == magic_file_read_index(magic, &index), "failed to read the index");
+
+    // Read through the index, without conversion
+    LoaderTensors* loaded = loader_read_tensors(magic, &index, NULL);
+    magic_index_free(&index);
+    ASSERT(loaded != NULL, "failed to load %s", TEST_LOADER_PATH);
+    ASSERT(3 == loaded->count, "expected 3 tensors, got %" PRId64, loaded->count);
+    ASSERT(
+        sizeof(data) == loaded->bytes,
+        "expected %zu bytes, got %" PRIu64,
+        sizeof(data),
+        loaded->bytes
+    );
+
+    const Tensor* dense = loader_find(loaded, "embed_tokens.weight");
+    const Tensor* blocks = loader_find(loaded, "layers.0.mlp.up_proj.weight");
+    const Tensor* bias = loader_find(loaded, "norm.weight");
+    int same = test_loader_same(dense, TYPE_FLOAT32, TEST_LOADER_ROWS, TEST_LOADER_COLS, data.dense)
+               && test_loader_same(blocks, TYPE_BLOCK_Q8, TEST_LOADER_ROWS, 2, data.blocks)
+               && test_loader_same(bias, TYPE_FLOAT32, 3, 5, data.bias)
+               && NULL == loader_find(loaded, "missing.weight");
+    loader_free(loaded);
+    magic_file_close(magic);
+    remove(TEST_LOADER_PATH);
+    ASSERT(same, "loaded tensors differ from the stored tensors");
+    return 0;
+}
+
+int test_loader_convert(void) {
+    TestLoaderData data;
+    test_loader_data(&data);
+    ASSERT(0 == test_loader_write(&data), "failed to write %s", TEST_LOADER_PATH);
+
+    uint32_t dimensions[] = {TEST_LOADER_ROWS, TEST_LOADER_COLS / BLOCK_SIZE};
+    Tensor* stored = tensor_create_from_data(TYPE_BLOCK_Q8, 2, dimensions, data.blocks);
+    Tensor* expected = stored ? quantize_tensor(stored, TYPE_FLOAT32, NULL) : NULL;
+    tensor_free(stored);
+    ASSERT(expected != NULL, "failed to dequantize the stored blocks");
+
+    // Locate the tensors through their metadata, and dequantize them from the mapping
+    MagicFile* magic = magic_file_map(TEST_LOADER_PATH);
+    LoaderOptions options = {.target = TYPE_FLOAT32};
+    LoaderTensors* loaded = magic ? loader_read_tensors(magic, NULL, &options) : NULL;
+    const uint32_t rows = TEST_LOADER_ROWS, cols = TEST_LOADER_COLS;
+    int same = loaded && 3 == loaded->count
+               && test_loader_same(loaded->tensors[0], TYPE_FLOAT32, rows, cols, data.dense)
+               && test_loader_same(loaded->tensors[1], TYPE_FLOAT32, rows, cols, expected->data)
+               && test_loader_same(loaded->tensors[2], TYPE_FLOAT32, 3, 5, data.bias);
+    loader_free(loaded);
+    tensor_free(expected);
+    ASSERT(same, "dequantized tensors differ");
+
+    // Rows of 5 values fill no block, so that tensor keeps its type
+    options.target = TYPE_BLOCK_Q8;
+    loaded = loader_read_tensors(magic, NULL, &options);
+    same = loaded && test_loader_same(loaded->tensors[1], TYPE_BLOCK_Q8, rows, 2, data.blocks)
+           && TYPE_BLOCK_Q8 == loaded->tensors[0]->type->id
+           && test_loader_same(loaded->tensors[2], TYPE_FLOAT32, 3, 5, data.bias);
+    loader_free(loaded);
+    magic_file_close(magic);
+    remove(TEST_LOADER_PATH);
+    ASSERT(same, "quantized load converted the wrong tensors");
+    return 0;
+}
+
+int test_loader_repack(void) {
+    TestLoaderData data;
+    test_loader_data(&data);
+    ASSERT(0 == test_loader_write(&data), "failed to write %s", TEST_LOADER_PATH);
+
+    // One worker with no lookahead beyond itself still loads every tensor
+    MagicFile* magic = magic_file_open(TEST_LOADER_PATH, "rb");
+    LoaderOptions options = {
+        .target = TYPE_FLOAT32,
+        .tile_rows = TENSOR_TILE_PANEL,
+        .tile_cols = 16,
+        .lookahead = 1,
+    };
+    thread_set_count(1);
+    LoaderTensors* loaded = magic ? loader_read_tensors(magic, NULL, &options) : NULL;
+    thread_set_count(4);
+    magic_file_close(magic);
+    remove(TEST_LOADER_PATH);
+    ASSERT(loaded != NULL, "failed to load %s", TEST_LOADER_PATH);
+
+    Tensor* dense = tensor_unpack(loaded->tensors[0]);
+    Tensor* bias = tensor_unpack(loaded->tensors[2]);
+    int same = test_loader_same(dense, TYPE_FLOAT32, TEST_LOADER_ROWS, TEST_LOADER_COLS, data.dense)
+               && test_loader_same(bias, TYPE_FLOAT32, 3, 5, data.bias);
+    tensor_free(dense);
+    tensor_free(bias);
+    loader_free(loaded);
+    ASSERT(same, "unpacked tensors differ from the stored tensors");
+    return 0;
+}
+
+// ---------------------- Verification ----------------------
+
+int test_loader_verify(void) {
+    TestLoaderData data;
+    test_loader_data(&data);
+    ASSERT(0 == test_loader_write(&data), "failed to write %s", TEST_LOADER_PATH);
+
+    MagicFile* magic = magic_file_map(TEST_LOADER_PATH);
+    ASSERT(magic != NULL, "failed to map %s", TEST_LOADER_PATH);
+    MagicIndex index = {0};
+    ASSERT(MAGIC_SUCCESS == magic_file_read_index(magic, &index), "failed to read the index");
+
+    // An intact file passes in parallel, in the background, and while loading
+    LoaderOptions options = {.target = LOADER_KEEP_TYPE, .verify = true};
+    LoaderVerifier* verifier = loader_verify_start(magic, &index);
+    ASSERT(verifier != NULL, "failed to start the verifier");
+    while (loader_verify_progress(verifier) < index.section_count + index.tensor_count) {
+        sched_yield(); // The thread checks every entry, then stops
+    }
+    const int64_t background = loader_verify_finish(verifier, false);
+    LoaderTensors* loaded = loader_read_tensors(magic, &index, &options);
+    int ok = 0 == loader_verify(magic, &index) && 0 == background && loaded != NULL;
+    loader_free(loaded);
+
+    // Flip one bit of the quantized tensor through the shared mapping's file
+    FILE* file = fopen(TEST_LOADER_PATH, "r+b");
+    uint8_t byte = 0;
+    const long offset = (long) index.tensors[1].offset + 3;
+    ok = ok && file && 0 == fseek(file, offset, SEEK_SET) && 1 == fread(&byte, 1, 1, file);
+    byte ^= 0x01;
+    ok = ok && 0 == fseek(file, offset, SEEK_SET) && 1 == fwrite(&byte, 1, 1, file);
+    if (file) {
+        fclose(file);
+    }
+
+    verifier = loader_verify_start(magic, &index);
+    const int64_t corrupt = loader_verify_finish(verifier, false);
+    ok = ok && 1 == loader_verify(magic, &index) && 1 == corrupt
+         && NULL == loader_read_tensors(magic, &index, &options);
+
+    // A stopped verifier reports no verdict unless it already finished
+    verifier = loader_verify_start(magic, &index);
+    const int64_t stopped = loader_verify_finish(verifier, true);
+    ok = ok && (-1 == stopped || 1 == stopped);
+
+    // Without checksums there is nothing to verify
+    index.checksum = MAGIC_CHECKSUM_NONE;
+    ok = ok && -1 == loader_verify(magic, &index) && NULL == loader_verify_start(magic, &index);
+
+    magic_index_free(&index);
+    magic_file_close(magic);
+    remove(TEST_LOADER_PATH);
+    ASSERT(ok, "verification missed or invented corruption");
+    return 0;
+}
+
+int main(void) {
+    global_logger.log_level = LOG_LEVEL_WARN; // Each load and conversion logs at info level
+
+    TestRegister test_registry[] = {
+        {"test_loader_stored", test_loader_stored},
+        {"test_loader_convert", test_loader_convert},
+        {"test_loader_repack", test_loader_repack},
+        {"test_loader_verify", test_loader_verify},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    // Several workers, so tensors load concurrently even on a single core
+    thread_set_count(4);
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+    thread_set_count(0);
+    thread_pool_shutdown();
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,631 @@
+/**
+ * @file tests/test_magic.c
+ * @brief Tests for the ALT model file sections.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ALT libraries
+#include "interface/crc32c.h"
+#include "interface/data_types.h"
+#include "interface/logger.h"
+#include "interface/unit_test.h"
+#include "model/magic.h"
+
+#define TEST_MAGIC_PATH "test_magic.alt" /**< Scratch file in the working directory */
+#define TEST_MAGIC_WRITER_PATH "test_magic_writer.alt" /**< Second scratch file */
+
+// ---------------------- Helpers ----------------------
+
+// Rewrites the size field of the section whose marker starts at offset, and indexes it
+int test_magic_patch_size(MagicFile* magic, long offset, int64_t marker, MagicIndex* index) {
+    long end = ftell(magic->data);
+    int64_t size = end - offset - 2 * (long) sizeof(int64_t);
+    if (0 != fseek(magic->data, offset + (long) sizeof(int64_t), SEEK_SET)
+        || 1 != fwrite(&size, sizeof(int64_t), 1, magic->data)
+        || 0 != fseek(magic->data, end, SEEK_SET)) {
+        return 1;
+    }
+    return index && MAGIC_SUCCESS != magic_index_add_section(index, marker, offset, size);
+}
+
+// Writes the metadata of a tensor, and indexes it
+int test_magic_write_info(MagicFile* magic, const MagicTensorInfo* info, MagicIndex* index) {
+    long at = ftell(magic->data);
+    if (MAGIC_SUCCESS != magic_file_write_tensor_info(magic, info)) {
+        return 1;
+    }
+    return index && MAGIC_SUCCESS != magic_index_add_tensor(index, info, at, ftell(magic->data));
+}
+
+// Writes a file with an opaque general section and a tensor section of two tensors,
+// followed by an Index Section if index is not NULL
+int test_magic_write(const float* weights, const BlockQ8* blocks, MagicIndex* index) {
+    MagicFile* magic = magic_file_open(TEST_MAGIC_PATH, "w+b"); // Readable for the checksums
+    if (!magic) {
+        return 1;
+    }
+
+    MagicTensorSection section = {
+        .data_type = TYPE_FLOAT32,
+        .quant_profile = 0,
+        .context_len = 128,
+        .tensor_count = 2,
+        .shape_count = 4,
+        .block_count = 1,
+        .unique_count = 1,
+    };
+    MagicTensorInfo dense = {
+        .component_type = 1,
+        .block_index = -1,
+        .n_dims = 2,
+        .shape = {3, 5},
+        .name = "embed_tokens.weight",
+        .data_type = TYPE_FLOAT32,
+    };
+    MagicTensorInfo quantized = {
+        .component_type = 0,
+        .block_index = 0,
+        .layer_type = 2,
+        .projection_type = 3,
+        .n_dims = 2,
+        .shape = {2, 2},
+        .name = "layers.0.mlp.up_proj.weight",
+        .data_type = TYPE_BLOCK_Q8,
+        .packing_flag = 1,
+    };
+
+    const char general[] = "opaque";
+    int result = MAGIC_SUCCESS
+                 != magic_file_write_start_marker(magic, MAGIC_VERSION, MAGIC_ALIGNMENT);
+    result = result || MAGIC_SUCCESS != magic_file_write_section_marker(magic, MAGIC_GENERAL, 0);
+    result = result || 1 != fwrite(general, sizeof(general), 1, magic->data);
+    result = result || test_magic_patch_size(magic, MAGIC_ALIGNMENT, MAGIC_GENERAL, index);
+    result = result || MAGIC_SUCCESS != magic_file_pad(magic);
+
+    long start = ftell(magic->data);
+    result = result || MAGIC_SUCCESS != magic_file_write_section_marker(magic, MAGIC_TENSORS, 0);
+    result = result || MAGIC_SUCCESS != magic_file_write_tensor_section(magic, &section);
+    result = result || test_magic_write_info(magic, &dense, index);
+    result = result || 1 != fwrite(weights, sizeof(float) * 15, 1, magic->data);
+    result = result || test_magic_write_info(magic, &quantized, index);
+    result = result || 1 != fwrite(blocks, sizeof(BlockQ8) * 4, 1, magic->data);
+    result = result || test_magic_patch_size(magic, start, MAGIC_TENSORS, index);
+    result = result || MAGIC_SUCCESS != magic_file_pad(magic);
+    result = result || (index && MAGIC_SUCCESS != magic_file_checksum_index(magic, index));
+    result = result || (index && MAGIC_SUCCESS != magic_file_write_index(magic, index));
+    result = result || MAGIC_SUCCESS != magic_file_write_end_marker(magic);
+
+    return MAGIC_SUCCESS != magic_file_close(magic) || result;
+}
+
+// ---------------------- Tensor Section ----------------------
+
+int test_magic_tensor_section(void) {
+    float weights[15];
+    BlockQ8 blocks[4];
+    float values[4 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 15; i++) {
+        weights[i] = (float) i * 0.25f - 1.0f;
+    }
+    for (uint32_t i = 0; i < 4 * BLOCK_SIZE; i++) {
+        values[i] = (float) (i % 17) - 8.0f;
+    }
+    quantize_row_block_q8(values, blocks, 4 * BLOCK_SIZE);
+
+    ASSERT(0 == test_magic_write(weights, blocks, NULL), "failed to write %s", TEST_MAGIC_PATH);
+
+    MagicFile* magic = magic_file_open(TEST_MAGIC_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_MAGIC_PATH);
+
+    int32_t version = 0, alignment = 0;
+    int64_t size = 0;
+    MagicTensorSection section = {0};
+    ASSERT(MAGIC_SUCCESS == magic_file_validate(magic), "validation failed");
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_read_start_marker(magic, &version, &alignment),
+        "failed to read the start marker"
+    );
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_seek_section(magic, MAGIC_TENSORS, &size),
+        "failed to find the tensor section"
+    );
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_read_tensor_section(magic, &section),
+        "failed to read the tensor section"
+    );
+    ASSERT(
+        2 == section.tensor_count && 128 == section.context_len && 1 == section.unique_count,
+        "unexpected section fields"
+    );
+
+    MagicTensorInfo info;
+    ASSERT(MAGIC_SUCCESS == magic_file_read_tensor_info(magic, &info), "failed to read tensor 0");
+    int ok = 0 == strcmp(info.name, "embed_tokens.weight") && -1 == info.block_index
+             && 2 == info.n_dims && 3 == info.shape[0] && 5 == info.shape[1]
+             && TYPE_FLOAT32 == info.data_type && 15 * (int64_t) sizeof(float) == info.size
+             && 0 == info.offset % MAGIC_ALIGNMENT;
+    magic_tensor_info_free(&info);
+    ASSERT(ok, "unexpected metadata for tensor 0");
+
+    float read_weights[15];
+    ASSERT(1 == fread(read_weights, sizeof(read_weights), 1, magic->data), "failed to read data");
+    ASSERT(0 == memcmp(weights, read_weights, sizeof(weights)), "tensor 0 data differs");
+
+    ASSERT(MAGIC_SUCCESS == magic_file_read_tensor_info(magic, &info), "failed to read tensor 1");
+    ok = 0 == strcmp(info.name, "layers.0.mlp.up_proj.weight") && 3 == info.projection_type
+         && TYPE_BLOCK_Q8 == info.data_type && 1 == info.packing_flag
+         && 4 * (int64_t) sizeof(BlockQ8) == info.size && 0 == info.offset % MAGIC_ALIGNMENT;
+    magic_tensor_info_free(&info);
+    ASSERT(ok, "unexpected metadata for tensor 1");
+
+    BlockQ8 read_blocks[4];
+    ASSERT(1 == fread(read_blocks, sizeof(read_blocks), 1, magic->data), "failed to read blocks");
+    ASSERT(0 == memcmp(blocks, read_blocks, sizeof(blocks)), "tensor 1 data differs");
+
+    ASSERT(MAGIC_SUCCESS == magic_file_pad(magic), "failed to skip the section padding");
+    ASSERT(MAGIC_SUCCESS == magic_file_read_end_marker(magic), "missing end marker");
+
+    // Sections that are absent are reported once the end marker is reached
+    ASSERT(0 == fseek(magic->data, MAGIC_ALIGNMENT, SEEK_SET), "failed to rewind");
+    ASSERT(
+        MAGIC_INVALID_MARKER == magic_file_seek_section(magic, MAGIC_TOKENIZER, &size),
+        "found a section that was never written"
+    );
+
+    magic_file_close(magic);
+    remove(TEST_MAGIC_PATH);
+    return 0;
+}
+
+// ---------------------- Mapped Files ----------------------
+
+int test_magic_mapped(void) {
+    float weights[15];
+    BlockQ8 blocks[4];
+    float values[4 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 15; i++) {
+        weights[i] = (float) i * 0.5f - 3.0f;
+    }
+    for (uint32_t i = 0; i < 4 * BLOCK_SIZE; i++) {
+        values[i] = (float) (i % 11) - 5.0f;
+    }
+    quantize_row_block_q8(values, blocks, 4 * BLOCK_SIZE);
+
+    ASSERT(0 == test_magic_write(weights, blocks, NULL), "failed to write %s", TEST_MAGIC_PATH);
+    ASSERT(NULL == magic_file_map("missing_" TEST_MAGIC_PATH), "mapped a missing file");
+
+    MagicFile* magic = magic_file_map(TEST_MAGIC_PATH);
+    ASSERT(magic != NULL, "failed to map %s", TEST_MAGIC_PATH);
+
+    // The stream readers parse the mapping like a file
+    int32_t version = 0, alignment = 0;
+    int64_t size = 0;
+    MagicTensorSection section = {0};
+    ASSERT(MAGIC_SUCCESS == magic_file_validate(magic), "validation failed");
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_read_start_marker(magic, &version, &alignment)
+            && MAGIC_SUCCESS == magic_file_seek_section(magic, MAGIC_TENSORS, &size)
+            && MAGIC_SUCCESS == magic_file_read_tensor_section(magic, &section),
+        "failed to read the tensor section"
+    );
+    ASSERT(2 == section.tensor_count, "expected 2 tensors, got %" PRId64, section.tensor_count);
+
+    // Tensor data is returned in place, aligned, without reading it
+    const void* expected[2] = {weights, blocks};
+    const char* names[2] = {"embed_tokens.weight", "layers.0.mlp.up_proj.weight"};
+    for (int64_t i = 0; i < section.tensor_count; i++) {
+        MagicTensorInfo info;
+        ASSERT(MAGIC_SUCCESS == magic_file_read_tensor_info(magic, &info), "tensor %" PRId64, i);
+        const void* data = magic_file_tensor_data(magic, &info);
+        int ok = data != NULL && 0 == strcmp(names[i], info.name)
+                 && 0 == (uintptr_t) data % MAGIC_ALIGNMENT
+                 && (const uint8_t*) magic->map + info.offset == (const uint8_t*) data
+                 && 0 == memcmp(expected[i], data, info.size);
+
+        // Data reaching past the end of the file is rejected
+        MagicTensorInfo past = info;
+        past.size = (int64_t) magic->map_size - info.offset + 1;
+        ok = ok && NULL == magic_file_tensor_data(magic, &past);
+        past.offset = -1;
+        ok = ok && NULL == magic_file_tensor_data(magic, &past);
+
+        ok = ok && 0 == fseek(magic->data, info.offset + info.size, SEEK_SET);
+        magic_tensor_info_free(&info);
+        ASSERT(ok, "unexpected mapped data for tensor %" PRId64, i);
+    }
+
+    ASSERT(MAGIC_SUCCESS == magic_file_pad(magic), "failed to skip the section padding");
+    ASSERT(MAGIC_SUCCESS == magic_file_read_end_marker(magic), "missing end marker");
+    ASSERT(MAGIC_SUCCESS == magic_file_close(magic), "failed to unmap %s", TEST_MAGIC_PATH);
+
+    // Plain streams have no mapping to point into
+    magic = magic_file_open(TEST_MAGIC_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_MAGIC_PATH);
+    MagicTensorInfo info = {.offset = MAGIC_ALIGNMENT, .size = 1};
+    const void* data = magic_file_tensor_data(magic, &info);
+    magic_file_close(magic);
+    remove(TEST_MAGIC_PATH);
+    ASSERT(NULL == data, "returned data for an unmapped file");
+    return 0;
+}
+
+// ---------------------- Index Section ----------------------
+
+int test_magic_index(void) {
+    float weights[15];
+    BlockQ8 blocks[4];
+    float values[4 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 15; i++) {
+        weights[i] = (float) i - 7.0f;
+    }
+    for (uint32_t i = 0; i < 4 * BLOCK_SIZE; i++) {
+        values[i] = (float) (i % 7) - 3.0f;
+    }
+    quantize_row_block_q8(values, blocks, 4 * BLOCK_SIZE);
+
+    MagicIndex written = {0};
+    int failed = test_magic_write(weights, blocks, &written);
+    magic_index_free(&written);
+    ASSERT(0 == failed, "failed to write %s", TEST_MAGIC_PATH);
+
+    MagicFile* magic = magic_file_open(TEST_MAGIC_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_MAGIC_PATH);
+
+    MagicIndex index = {0};
+    ASSERT(MAGIC_SUCCESS == magic_file_read_index(magic, &index), "failed to read the index");
+    ASSERT(
+        2 == index.section_count && 2 == index.tensor_count,
+        "expected 2 sections and 2 tensors, got %" PRId64 " and %" PRId64,
+        index.section_count,
+        index.tensor_count
+    );
+    ASSERT(NULL == magic_index_find_section(&index, MAGIC_TOKENIZER), "indexed a missing section");
+    ASSERT(NULL == magic_index_find_tensor(&index, 0, 1, 2, 3), "indexed a missing tensor");
+
+    // Jump straight to the second tensor
+    MagicTensorInfo info;
+    const MagicTensorEntry* tensor = magic_index_find_tensor(&index, 0, 0, 2, 3);
+    ASSERT(tensor != NULL, "tensor of block 0 not indexed");
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_read_tensor_entry(magic, tensor, &info),
+        "failed to read the indexed tensor"
+    );
+    BlockQ8 read_blocks[4];
+    int ok = 0 == strcmp(info.name, "layers.0.mlp.up_proj.weight")
+             && 1 == fread(read_blocks, sizeof(read_blocks), 1, magic->data)
+             && 0 == memcmp(blocks, read_blocks, sizeof(blocks));
+    magic_tensor_info_free(&info);
+    ASSERT(ok, "indexed tensor data differs");
+
+    // Jump to the Tensor Section as magic_file_seek_section would find it
+    int64_t size = 0;
+    MagicTensorSection section = {0};
+    const MagicIndexEntry* entry = magic_index_find_section(&index, MAGIC_TENSORS);
+    ASSERT(entry != NULL, "tensor section not indexed");
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_seek_entry(magic, entry, &size)
+            && MAGIC_SUCCESS == magic_file_read_tensor_section(magic, &section)
+            && 2 == section.tensor_count,
+        "failed to read the indexed tensor section"
+    );
+
+    // Stale entries are detected rather than followed
+    MagicIndexEntry stale = *entry;
+    stale.offset += MAGIC_ALIGNMENT;
+    ASSERT(
+        MAGIC_SUCCESS != magic_file_seek_entry(magic, &stale, &size), "followed a stale section"
+    );
+    MagicTensorEntry moved = *tensor;
+    moved.info = index.tensors[0].info;
+    ASSERT(
+        MAGIC_ERROR == magic_file_read_tensor_entry(magic, &moved, &info),
+        "followed a stale tensor"
+    );
+
+    // Sequential readers skip the index like any other section
+    int32_t version = 0, alignment = 0;
+    ASSERT(
+        0 == fseek(magic->data, 0, SEEK_SET)
+            && MAGIC_SUCCESS == magic_file_read_start_marker(magic, &version, &alignment)
+            && MAGIC_INVALID_MARKER == magic_file_seek_section(magic, MAGIC_TOKENIZER, &size),
+        "the index disturbed sequential reads"
+    );
+    magic_index_free(&index);
+    magic_file_close(magic);
+
+    // Files written without an index report that it is absent
+    ASSERT(0 == test_magic_write(weights, blocks, NULL), "failed to write %s", TEST_MAGIC_PATH);
+    magic = magic_file_open(TEST_MAGIC_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_MAGIC_PATH);
+    MagicState state = magic_file_read_index(magic, &index);
+    magic_file_close(magic);
+    remove(TEST_MAGIC_PATH);
+    ASSERT(MAGIC_INVALID_MARKER == state, "found an index that was never written");
+    return 0;
+}
+
+// Shapes whose byte size overflows are rejected rather than wrapped to a small size
+int test_magic_oversized_shape(void) {
+    MagicTensorInfo info = {
+        .n_dims = MAGIC_MAX_DIMS,
+        .shape = {1 << 16, 1 << 16, 1 << 16, 1 << 16, 1 << 16, 1 << 16, 1 << 16, 1 << 16},
+        .name = "oversized.weight",
+        .data_type = TYPE_FLOAT32,
+    };
+    MagicIndex index = {0};
+    MagicState state = magic_index_add_tensor(&index, &info, 0, 0);
+    magic_index_free(&index);
+    ASSERT(MAGIC_ERROR == state, "a shape of 2^128 elements was accepted");
+
+    // Large shapes that fit are still accepted
+    info.n_dims = 2;
+    info.shape[0] = INT32_MAX;
+    info.shape[1] = 1 << 20;
+    state = magic_index_add_tensor(&index, &info, 0, 0);
+    const int64_t size = MAGIC_SUCCESS == state ? index.tensors[0].size : -1;
+    magic_index_free(&index);
+    ASSERT((int64_t) INT32_MAX * (1 << 20) * 4 == size, "wrong size %" PRId64, size);
+    return 0;
+}
+
+// ---------------------- Streaming Writer ----------------------
+
+// Reads a whole file into memory
+uint8_t* test_magic_read_file(const char* path, long* size) {
+    FILE* file = fopen(path, "rb");
+    uint8_t* data = NULL;
+    if (file && 0 == fseek(file, 0, SEEK_END) && (*size = ftell(file)) > 0
+        && 0 == fseek(file, 0, SEEK_SET) && (data = (uint8_t*) malloc(*size))
+        && 1 != fread(data, *size, 1, file)) {
+        free(data);
+        data = NULL;
+    }
+    if (file) {
+        fclose(file);
+    }
+    return data;
+}
+
+// Writes the file of test_magic_write through a MagicWriter
+int test_magic_stream(const float* weights, const BlockQ8* blocks, size_t capacity) {
+    MagicWriter* writer = magic_writer_open(TEST_MAGIC_WRITER_PATH, capacity);
+    if (!writer) {
+        return 1;
+    }
+
+    MagicTensorSection section = {
+        .data_type = TYPE_FLOAT32,
+        .context_len = 128,
+        .tensor_count = 2,
+        .shape_count = 4,
+        .block_count = 1,
+        .unique_count = 1,
+    };
+    MagicTensorInfo dense = {
+        .component_type = 1,
+        .block_index = -1,
+        .n_dims = 2,
+        .shape = {3, 5},
+        .name = "embed_tokens.weight",
+        .data_type = TYPE_FLOAT32,
+    };
+    MagicTensorInfo quantized = {
+        .block_index = 0,
+        .layer_type = 2,
+        .projection_type = 3,
+        .n_dims = 2,
+        .shape = {2, 2},
+        .name = "layers.0.mlp.up_proj.weight",
+        .data_type = TYPE_BLOCK_Q8,
+        .packing_flag = 1,
+    };
+
+    const char general[] = "opaque";
+    int result = MAGIC_SUCCESS
+                 != magic_writer_write_start_marker(writer, MAGIC_VERSION, MAGIC_ALIGNMENT);
+    result = result || MAGIC_SUCCESS != magic_writer_begin_section(writer, MAGIC_GENERAL);
+    result = result || MAGIC_SUCCESS != magic_writer_write(writer, general, sizeof(general));
+    result = result || MAGIC_SUCCESS != magic_writer_end_section(writer);
+    result = result || MAGIC_SUCCESS != magic_writer_begin_section(writer, MAGIC_TENSORS);
+    result = result || MAGIC_SUCCESS != magic_writer_write_tensor_section(writer, &section);
+    result = result || MAGIC_SUCCESS != magic_writer_write_tensor(writer, &dense, weights);
+    result = result || MAGIC_SUCCESS != magic_writer_write_tensor(writer, &quantized, blocks);
+    result = result || MAGIC_SUCCESS != magic_writer_end_section(writer);
+    result = result || MAGIC_SUCCESS != magic_writer_finish(writer, true);
+
+    return MAGIC_SUCCESS != magic_writer_close(writer) || result;
+}
+
+int test_magic_writer(void) {
+    float weights[15];
+    BlockQ8 blocks[4];
+    float values[4 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 15; i++) {
+        weights[i] = (float) i * 0.125f;
+    }
+    for (uint32_t i = 0; i < 4 * BLOCK_SIZE; i++) {
+        values[i] = (float) (i % 13) - 6.0f;
+    }
+    quantize_row_block_q8(values, blocks, 4 * BLOCK_SIZE);
+
+    MagicIndex index = {0};
+    int failed = test_magic_write(weights, blocks, &index);
+    magic_index_free(&index);
+    ASSERT(0 == failed, "failed to write %s", TEST_MAGIC_PATH);
+    long expected_size = 0;
+    uint8_t* expected = test_magic_read_file(TEST_MAGIC_PATH, &expected_size);
+    remove(TEST_MAGIC_PATH);
+    ASSERT(expected != NULL, "failed to read %s", TEST_MAGIC_PATH);
+
+    // A tiny buffer sends blobs straight to the file and patches flushed sizes in place
+    const size_t capacities[] = {64, 0};
+    for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++) {
+        long size = 0;
+        uint8_t* written = NULL;
+        if (0 == test_magic_stream(weights, blocks, capacities[i])) {
+            written = test_magic_read_file(TEST_MAGIC_WRITER_PATH, &size);
+        }
+        int same = written && size == expected_size && 0 == memcmp(expected, written, size);
+        free(written);
+        remove(TEST_MAGIC_WRITER_PATH);
+        if (!same) {
+            free(expected);
+        }
+        ASSERT(same, "streamed file differs with a %zu byte buffer", capacities[i]);
+    }
+    free(expected);
+
+    // Sections nest nowhere, and tensors only go into a Tensor Section
+    MagicWriter* writer = magic_writer_open(TEST_MAGIC_WRITER_PATH, 0);
+    ASSERT(writer != NULL, "failed to open %s", TEST_MAGIC_WRITER_PATH);
+    MagicTensorInfo info = {.n_dims = 1, .shape = {1}, .name = "x", .data_type = TYPE_FLOAT32};
+    const float value = 1.0f;
+    int ok = MAGIC_ERROR == magic_writer_end_section(writer)
+             && MAGIC_SUCCESS == magic_writer_begin_section(writer, MAGIC_GENERAL)
+             && MAGIC_ERROR == magic_writer_begin_section(writer, MAGIC_TENSORS)
+             && MAGIC_ERROR == magic_writer_write_tensor(writer, &info, &value)
+             && MAGIC_ERROR == magic_writer_finish(writer, false);
+    ASSERT(MAGIC_SUCCESS == magic_writer_close(writer), "failed to close the writer");
+    remove(TEST_MAGIC_WRITER_PATH);
+    ASSERT(ok, "accepted an out of order write");
+    return 0;
+}
+
+// ---------------------- Checksums ----------------------
+
+// Flips one bit of the file in place
+int test_magic_corrupt(MagicFile* magic, int64_t offset) {
+    uint8_t byte = 0;
+    if (0 != fseek(magic->data, offset, SEEK_SET) || 1 != fread(&byte, 1, 1, magic->data)) {
+        return 1;
+    }
+    byte ^= 0x10;
+    return 0 != fseek(magic->data, offset, SEEK_SET) || 1 != fwrite(&byte, 1, 1, magic->data)
+           || 0 != fflush(magic->data);
+}
+
+int test_magic_checksums(void) {
+    float weights[15];
+    BlockQ8 blocks[4];
+    float values[4 * BLOCK_SIZE];
+    for (uint32_t i = 0; i < 15; i++) {
+        weights[i] = (float) i * 0.5f;
+    }
+    for (uint32_t i = 0; i < 4 * BLOCK_SIZE; i++) {
+        values[i] = (float) (i % 11) - 5.0f;
+    }
+    quantize_row_block_q8(values, blocks, 4 * BLOCK_SIZE);
+
+    MagicIndex index = {0};
+    int failed = test_magic_write(weights, blocks, &index);
+    magic_index_free(&index);
+    ASSERT(0 == failed, "failed to write %s", TEST_MAGIC_PATH);
+
+    MagicFile* magic = magic_file_open(TEST_MAGIC_PATH, "r+b");
+    ASSERT(magic != NULL, "failed to open %s for update", TEST_MAGIC_PATH);
+    ASSERT(MAGIC_SUCCESS == magic_file_read_index(magic, &index), "failed to read the index");
+    ASSERT(MAGIC_CHECKSUM_CRC32C == index.checksum, "the index records no checksums");
+
+    // Tensor entries cover the data; section entries cover the rest
+    const MagicIndexEntry* section = magic_index_find_section(&index, MAGIC_TENSORS);
+    const MagicTensorEntry* tensor = &index.tensors[1];
+    uint64_t fields = 0, data = 0, other = 0;
+    int ok = MAGIC_SUCCESS == magic_file_checksum_section(magic, &index, section, &fields)
+             && MAGIC_SUCCESS == magic_file_checksum_tensor(magic, tensor, &data)
+             && fields == section->checksum && data == tensor->checksum
+             && crc32c_update(0, blocks, sizeof(blocks)) == tensor->checksum;
+    if (!ok) {
+        magic_index_free(&index);
+    }
+    ASSERT(ok, "recorded checksums differ from the file");
+
+    // A flipped bit of tensor data shows in that tensor's checksum only
+    ok = 0 == test_magic_corrupt(magic, tensor->offset + 5)
+         && MAGIC_SUCCESS == magic_file_checksum_tensor(magic, tensor, &data)
+         && MAGIC_SUCCESS == magic_file_checksum_tensor(magic, &index.tensors[0], &other)
+         && MAGIC_SUCCESS == magic_file_checksum_section(magic, &index, section, &fields)
+         && data != tensor->checksum && other == index.tensors[0].checksum
+         && fields == section->checksum;
+
+    // A field rewritten in place keeps its section checksum current
+    const uint64_t before = section->checksum;
+    magic_index_free(&index);
+    ok = ok && MAGIC_SUCCESS == magic_file_write_quant_profile(magic, MAGIC_PROFILE_CALIBRATED)
+         && MAGIC_SUCCESS == magic_file_read_index(magic, &index)
+         && (section = magic_index_find_section(&index, MAGIC_TENSORS))
+         && MAGIC_SUCCESS == magic_file_checksum_section(magic, &index, section, &fields)
+         && fields == section->checksum && before != section->checksum;
+    magic_index_free(&index);
+    magic_file_close(magic);
+    remove(TEST_MAGIC_PATH);
+    ASSERT(ok, "checksums missed a change");
+    return 0;
+}
+
+// ---------------------- Quantization Profile ----------------------
+
+int test_magic_quant_profile(void) {
+    float weights[15] = {0};
+    BlockQ8 blocks[4] = {0};
+    ASSERT(0 == test_magic_write(weights, blocks, NULL), "failed to write %s", TEST_MAGIC_PATH);
+
+    MagicFile* magic = magic_file_open(TEST_MAGIC_PATH, "r+b");
+    ASSERT(magic != NULL, "failed to open %s for update", TEST_MAGIC_PATH);
+    ASSERT(
+        MAGIC_SUCCESS == magic_file_write_quant_profile(magic, MAGIC_PROFILE_CALIBRATED),
+        "failed to update the profile"
+    );
+    ASSERT(MAGIC_SUCCESS == magic_file_close(magic), "failed to close %s", TEST_MAGIC_PATH);
+
+    magic = magic_file_open(TEST_MAGIC_PATH, "rb");
+    ASSERT(magic != NULL, "failed to open %s", TEST_MAGIC_PATH);
+
+    int32_t version = 0, alignment = 0;
+    int64_t size = 0;
+    MagicTensorSection section = {0};
+    int ok = MAGIC_SUCCESS == magic_file_read_start_marker(magic, &version, &alignment)
+             && MAGIC_SUCCESS == magic_file_seek_section(magic, MAGIC_TENSORS, &size)
+             && MAGIC_SUCCESS == magic_file_read_tensor_section(magic, &section);
+    magic_file_close(magic);
+    remove(TEST_MAGIC_PATH);
+
+    ASSERT(ok, "failed to read the tensor section");
+    ASSERT(
+        MAGIC_PROFILE_CALIBRATED == section.quant_profile,
+        "expected profile %d, got %d",
+        MAGIC_PROFILE_CALIBRATED,
+        section.quant_profile
+    );
+    ASSERT(
+        TYPE_FLOAT32 == section.data_type && 128 == section.context_len
+            && 2 == section.tensor_count,
+        "neighbouring fields changed"
+    );
+    return 0;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_magic_tensor_section", test_magic_tensor_section},
+        {"test_magic_mapped", test_magic_mapped},
+        {"test_magic_index", test_magic_index},
+        {"test_magic_oversized_shape", test_magic_oversized_shape},
+        {"test_magic_writer", test_magic_writer},
+        {"test_magic_checksums", test_magic_checksums},
+        {"test_magic_quant_profile", test_magic_quant_profile},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,323 @@
+/**
+ * @file tests/test_matmul.c
+ * @brief Tests for the matmul kernels.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ALT libraries
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+#include "kernels/matmul.h"
+
+#define TEST_MATMUL_TOLERANCE 1e-3f
+
+// ---------------------- Helpers ----------------------
+
+// Fills a float buffer with deterministic values in [-1, 1]
+void test_matmul_fill(float* data, size_t length, uint32_t seed) {
+    random_seed(seed);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// Returns the largest relative error between two buffers
+float test_matmul_error(const float* expected, const float* actual, size_t length) {
+    float error = 0.0f;
+    for (size_t i = 0; i < length; i++) {
+        float scale = fmaxf(1.0f, fabsf(expected[i]));
+        error = fmaxf(error, fabsf(expected[i] - actual[i]) / scale);
+    }
+    return error;
+}
+
+// Encodes a row of n values, then decodes it back in place so references see the same rounding
+void test_matmul_encode_row(DataTypeId type, float* src, void* row, uint32_t n) {
+    switch (type) {
+        case TYPE_FLOAT16:
+            quantize_row_fp16(src, (uint16_t*) row, n, 1);
+            dequantize_row_fp16((uint16_t*) row, src, n, 1);
+            break;
+        case TYPE_QUANT8:
+            quantize_row_q8(src, (Q8*) row, n, 1);
+            dequantize_row_q8((Q8*) row, src, n, 1);
+            break;
+        case TYPE_QUANT4:
+            quantize_row_q4(src, (Q4*) row, n, 1);
+            dequantize_row_q4((Q4*) row, src, n, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8(src, (BlockQ8*) row, n);
+            dequantize_row_block_q8((BlockQ8*) row, src, n);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4(src, (BlockQ4*) row, n);
+            dequantize_row_block_q4((BlockQ4*) row, src, n);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            quantize_row_block_q4_min(src, (BlockQ4Min*) row, n);
+            dequantize_row_block_q4_min((BlockQ4Min*) row, src, n);
+            break;
+        case TYPE_BFLOAT16:
+            quantize_row_bf16(src, (uint16_t*) row, n, 1);
+            dequantize_row_bf16((uint16_t*) row, src, n, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            quantize_row_fp8_e4m3(src, (uint8_t*) row, n, 1);
+            dequantize_row_fp8_e4m3((uint8_t*) row, src, n, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            quantize_row_fp8_e5m2(src, (uint8_t*) row, n, 1);
+            dequantize_row_fp8_e5m2((uint8_t*) row, src, n, 1);
+            break;
+        default:
+            memcpy(row, src, sizeof(float) * n);
+            break;
+    }
+}
+
+// ---------------------- Matrix Multiplication ----------------------
+
+typedef struct TestUnitMatmul {
+    uint32_t m; // Rows of A and C
+    uint32_t k; // Shared dimension
+    uint32_t n; // Columns of B and C
+    DataTypeId weight; // Data type of B
+    bool transpose_a; // Pass A as a transposed view
+    bool repack_b; // Repack B into column panels before multiplying
+} TestUnitMatmul;
+
+int test_matmul_logic(TestCase* test) {
+    TestUnitMatmul* unit = (TestUnitMatmul*) test->unit;
+    const uint32_t m = unit->m, k = unit->k, n = unit->n;
+
+    float* a_data = malloc(sizeof(float) * m * k);
+    float* b_data = malloc(sizeof(float) * k * n);
+    float* expected = calloc((size_t) m * n, sizeof(float));
+
+    // A is stored transposed when testing strided views
+    Tensor* a_store = unit->transpose_a ? tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){k, m})
+                                        : tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, k});
+    Tensor* a = unit->transpose_a ? tensor_view_transpose(a_store, 0, 1) : a_store;
+    uint32_t b_cols = n / data_type_values(unit->weight);
+    Tensor* b = tensor_create(unit->weight, 2, (uint32_t[]){k, b_cols});
+    Tensor* c = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+
+    int result = 0;
+    if (!a_data || !b_data || !expected || !a || !b || !c) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_matmul_fill(a_data, (size_t) m * k, 1337);
+    test_matmul_fill(b_data, (size_t) k * n, 7331);
+    tensor_set_bulk(a, a_data);
+
+    // Encode B, then decode it back so the reference sees the same rounding
+    for (uint32_t p = 0; p < k; p++) {
+        float* src = b_data + (size_t) p * n;
+        char* row = (char*) b->data + (size_t) p * b_cols * b->type->size;
+        test_matmul_encode_row(unit->weight, src, row, n);
+    }
+
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t p = 0; p < k; p++) {
+            for (uint32_t j = 0; j < n; j++) {
+                expected[(size_t) i * n + j] += a_data[(size_t) i * k + p] * b_data[(size_t) p * n + j];
+            }
+        }
+    }
+
+    if (unit->repack_b) {
+        Tensor* panels = tensor_repack(b, TENSOR_TILE_PANEL, MATMUL_NR * b_cols / n);
+        tensor_free(b);
+        b = panels;
+    }
+
+    TensorState state = b ? tensor_matmul(a, b, c) : TENSOR_ERROR;
+    float error = test_matmul_error(expected, (float*) c->data, (size_t) m * n);
+    if (TENSOR_SUCCESS != state || error > TEST_MATMUL_TOLERANCE) {
+        LOG_ERROR(
+            "%s: Test case %zu failed (m=%u, k=%u, n=%u, type=%s, state=%d, error=%f).\n",
+            __func__,
+            test->index,
+            m,
+            k,
+            n,
+            data_type_name(unit->weight),
+            state,
+            (double) error
+        );
+        result = 1;
+    }
+
+cleanup:
+    if (a != a_store) {
+        tensor_free(a);
+    }
+    tensor_free(a_store);
+    tensor_free(b);
+    tensor_free(c);
+    free(expected);
+    free(b_data);
+    free(a_data);
+    return result;
+}
+
+int test_tensor_matmul(void) {
+    TestUnitMatmul units[] = {
+        {.m = 1, .k = 1, .n = 1, .weight = TYPE_FLOAT32},
+        {.m = 6, .k = 16, .n = 16, .weight = TYPE_FLOAT32},
+        {.m = 7, .k = 300, .n = 37, .weight = TYPE_FLOAT32},
+        {.m = 80, .k = 513, .n = 33, .weight = TYPE_FLOAT32, .transpose_a = true},
+        {.m = 13, .k = 64, .n = 48, .weight = TYPE_FLOAT16},
+        {.m = 9, .k = 96, .n = 40, .weight = TYPE_QUANT8},
+        {.m = 5, .k = 40, .n = 34, .weight = TYPE_QUANT4},
+        {.m = 80, .k = 513, .n = 33, .weight = TYPE_FLOAT32, .repack_b = true},
+        {.m = 9, .k = 96, .n = 40, .weight = TYPE_QUANT8, .repack_b = true},
+        {.m = 5, .k = 300, .n = 34, .weight = TYPE_QUANT4, .repack_b = true},
+        {.m = 9, .k = 96, .n = 64, .weight = TYPE_BLOCK_Q8},
+        {.m = 3, .k = 40, .n = 4160, .weight = TYPE_BLOCK_Q4},
+        {.m = 7, .k = 33, .n = 96, .weight = TYPE_BLOCK_Q4_MIN},
+        {.m = 6, .k = 70, .n = 45, .weight = TYPE_BFLOAT16},
+        {.m = 5, .k = 64, .n = 33, .weight = TYPE_FP8_E4M3, .repack_b = true},
+        {.m = 9, .k = 31, .n = 20, .weight = TYPE_FP8_E5M2},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Tensor Matmul", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_matmul_logic, NULL);
+}
+
+// ---------------------- Matrix-Vector Multiplication ----------------------
+
+typedef struct TestUnitGemv {
+    uint32_t m; // Rows of W
+    uint32_t k; // Columns of W and length of x
+    DataTypeId weight; // Data type of W
+} TestUnitGemv;
+
+int test_gemv_logic(TestCase* test) {
+    TestUnitGemv* unit = (TestUnitGemv*) test->unit;
+    const uint32_t m = unit->m, k = unit->k;
+    const uint32_t w_cols = k / data_type_values(unit->weight);
+
+    float* w_data = malloc(sizeof(float) * m * k);
+    float* x_data = malloc(sizeof(float) * k);
+    BlockQ8* x_blocks = malloc(sizeof(BlockQ8) * (k / BLOCK_SIZE + 1));
+    float* expected = malloc(sizeof(float) * m);
+    Tensor* w = tensor_create(unit->weight, 2, (uint32_t[]){m, w_cols});
+    Tensor* x = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){k});
+    Tensor* y = tensor_create(TYPE_FLOAT32, 1, (uint32_t[]){m});
+
+    int result = 0;
+    if (!w_data || !x_data || !x_blocks || !expected || !w || !x || !y) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_matmul_fill(w_data, (size_t) m * k, 42);
+    test_matmul_fill(x_data, k, 24);
+    tensor_set_bulk(x, x_data);
+    for (uint32_t i = 0; i < m; i++) {
+        char* row = (char*) w->data + (size_t) i * w_cols * w->type->size;
+        test_matmul_encode_row(unit->weight, w_data + (size_t) i * k, row, k);
+    }
+
+    // Block weights are reduced against x quantized to block_q8
+    if (TYPE_BLOCK_Q8 == unit->weight || TYPE_BLOCK_Q4 == unit->weight) {
+        test_matmul_encode_row(TYPE_BLOCK_Q8, x_data, x_blocks, k);
+    }
+
+    for (uint32_t i = 0; i < m; i++) {
+        double sum = 0.0;
+        for (uint32_t j = 0; j < k; j++) {
+            sum += (double) w_data[(size_t) i * k + j] * (double) x_data[j];
+        }
+        expected[i] = (float) sum;
+    }
+
+    TensorState state = tensor_gemv(w, x, y);
+    float error = test_matmul_error(expected, (float*) y->data, m);
+    if (TENSOR_SUCCESS != state || error > TEST_MATMUL_TOLERANCE) {
+        LOG_ERROR(
+            "%s: Test case %zu failed (m=%u, k=%u, type=%s, state=%d, error=%f).\n",
+            __func__,
+            test->index,
+            m,
+            k,
+            data_type_name(unit->weight),
+            state,
+            (double) error
+        );
+        result = 1;
+    }
+
+cleanup:
+    tensor_free(w);
+    tensor_free(x);
+    tensor_free(y);
+    free(expected);
+    free(x_blocks);
+    free(x_data);
+    free(w_data);
+    return result;
+}
+
+int test_tensor_gemv(void) {
+    TestUnitGemv units[] = {
+        {.m = 19, .k = 4099, .weight = TYPE_FLOAT32},
+        {.m = 19, .k = 4099, .weight = TYPE_FLOAT16},
+        {.m = 11, .k = 300, .weight = TYPE_QUANT8},
+        {.m = 17, .k = 4096, .weight = TYPE_BLOCK_Q8},
+        {.m = 5, .k = 1024, .weight = TYPE_BLOCK_Q4},
+        {.m = 7, .k = 96, .weight = TYPE_BLOCK_Q4_MIN},
+        {.m = 13, .k = 1001, .weight = TYPE_BFLOAT16},
+        {.m = 13, .k = 1001, .weight = TYPE_FP8_E4M3},
+        {.m = 4, .k = 77, .weight = TYPE_FP8_E5M2},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Tensor Gemv", .total_tests = total_tests, .test_cases = test_cases};
+
+    return run_unit_tests(&context, test_gemv_logic, NULL);
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_tensor_matmul", test_tensor_matmul},
+        {"test_tensor_gemv", test_tensor_gemv},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,510 @@
+/**
+ * @file tests/test_quantize.c
+ * @brief Tests for threaded tensor quantization.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ALT libraries
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+#include "kernels/quantize.h"
+#include "threads.h"
+
+// ---------------------- Helpers ----------------------
+
+// Fills a float buffer with deterministic values in [-scale, scale]
+void test_quantize_fill(float* data, size_t length, uint32_t seed, float scale) {
+    random_seed(seed);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = scale * random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// Rows are whole elements, so converting the flattened buffer in one call matches row by row
+void test_quantize_encode(DataTypeId id, const float* src, void* dst, uint32_t length) {
+    switch (id) {
+        case TYPE_FLOAT16:
+            quantize_row_fp16(src, (uint16_t*) dst, length, 1);
+            break;
+        case TYPE_QUANT8:
+            quantize_row_q8(src, (Q8*) dst, length, 1);
+            break;
+        case TYPE_QUANT4:
+            quantize_row_q4(src, (Q4*) dst, length, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            quantize_row_block_q8(src, (BlockQ8*) dst, length);
+            break;
+        case TYPE_BLOCK_Q4:
+            quantize_row_block_q4(src, (BlockQ4*) dst, length);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            quantize_row_block_q4_min(src, (BlockQ4Min*) dst, length);
+            break;
+        case TYPE_BFLOAT16:
+            quantize_row_bf16(src, (uint16_t*) dst, length, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            quantize_row_fp8_e4m3(src, (uint8_t*) dst, length, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            quantize_row_fp8_e5m2(src, (uint8_t*) dst, length, 1);
+            break;
+        default:
+            memcpy(dst, src, length * sizeof(float));
+            break;
+    }
+}
+
+void test_quantize_decode(DataTypeId id, const void* src, float* dst, uint32_t length) {
+    switch (id) {
+        case TYPE_FLOAT16:
+            dequantize_row_fp16((const uint16_t*) src, dst, length, 1);
+            break;
+        case TYPE_QUANT8:
+            dequantize_row_q8((const Q8*) src, dst, length, 1);
+            break;
+        case TYPE_QUANT4:
+            dequantize_row_q4((const Q4*) src, dst, length, 1);
+            break;
+        case TYPE_BLOCK_Q8:
+            dequantize_row_block_q8((const BlockQ8*) src, dst, length);
+            break;
+        case TYPE_BLOCK_Q4:
+            dequantize_row_block_q4((const BlockQ4*) src, dst, length);
+            break;
+        case TYPE_BLOCK_Q4_MIN:
+            dequantize_row_block_q4_min((const BlockQ4Min*) src, dst, length);
+            break;
+        case TYPE_BFLOAT16:
+            dequantize_row_bf16((const uint16_t*) src, dst, length, 1);
+            break;
+        case TYPE_FP8_E4M3:
+            dequantize_row_fp8_e4m3((const uint8_t*) src, dst, length, 1);
+            break;
+        case TYPE_FP8_E5M2:
+            dequantize_row_fp8_e5m2((const uint8_t*) src, dst, length, 1);
+            break;
+        default:
+            memcpy(dst, src, length * sizeof(float));
+            break;
+    }
+}
+
+// ---------------------- Tensor Quantization ----------------------
+
+typedef struct TestUnitQuantize {
+    DataTypeId source; // Type of the input tensor
+    DataTypeId target; // Type of the output tensor
+    uint32_t rank; // Rank of the input tensor
+    uint32_t shape[3]; // Logical shape; the last dimension counts values
+    bool valid; // Whether the conversion should succeed
+} TestUnitQuantize;
+
+int test_quantize_logic(TestCase* test) {
+    TestUnitQuantize* unit = (TestUnitQuantize*) test->unit;
+
+    uint64_t length = 1;
+    for (uint32_t i = 0; i < unit->rank; i++) {
+        length *= unit->shape[i];
+    }
+
+    // The source tensor is built from float data encoded to its type
+    uint32_t dimensions[3];
+    memcpy(dimensions, unit->shape, sizeof(dimensions));
+    dimensions[unit->rank - 1] /= data_type_values(unit->source);
+
+    float* data = malloc(sizeof(float) * length);
+    float* decoded = malloc(sizeof(float) * length);
+    float* actual = malloc(sizeof(float) * length);
+    Tensor* input = tensor_create(unit->source, unit->rank, dimensions);
+    Tensor* expected = NULL;
+    Tensor* output = NULL;
+
+    int result = 0;
+    if (!data || !decoded || !actual || !input) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_quantize_fill(data, length, 99 + (uint32_t) test->index, 4.0f);
+    test_quantize_encode(unit->source, data, input->data, (uint32_t) length);
+
+    QuantizeReport report = {0};
+    output = quantize_tensor(input, unit->target, &report);
+    if (!unit->valid) {
+        if (output) {
+            LOG_ERROR("%s: Test case %zu should have been rejected.\n", __func__, test->index);
+            result = 1;
+        }
+        goto cleanup;
+    }
+
+    dimensions[unit->rank - 1] = unit->shape[unit->rank - 1] / data_type_values(unit->target);
+    expected = tensor_create(unit->target, unit->rank, dimensions);
+    if (!output || !expected) {
+        LOG_ERROR("%s: Test case %zu failed to convert.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_quantize_decode(unit->source, input->data, decoded, (uint32_t) length);
+    test_quantize_encode(unit->target, decoded, expected->data, (uint32_t) length);
+
+    // qint8 and qint4 elements have padding bytes, so compare decoded values
+    size_t bytes = tensor_byte_size(expected);
+    test_quantize_decode(unit->target, expected->data, decoded, (uint32_t) length);
+    test_quantize_decode(unit->target, output->data, actual, (uint32_t) length);
+    if (tensor_byte_size(output) != bytes || 0 != memcmp(actual, decoded, length * sizeof(float))) {
+        LOG_ERROR(
+            "%s: Test case %zu: %s to %s differs from the row encoders.\n",
+            __func__,
+            test->index,
+            data_type_name(unit->source),
+            data_type_name(unit->target)
+        );
+        result = 1;
+    }
+
+    if (report.values != length || 0 == report.threads
+        || report.bytes != tensor_byte_size(input) + bytes) {
+        LOG_ERROR(
+            "%s: Test case %zu: bad report (values=%" PRIu64 ", bytes=%" PRIu64 ", threads=%u).\n",
+            __func__,
+            test->index,
+            report.values,
+            report.bytes,
+            report.threads
+        );
+        result = 1;
+    }
+
+cleanup:
+    tensor_free(output);
+    tensor_free(expected);
+    tensor_free(input);
+    free(actual);
+    free(decoded);
+    free(data);
+    return result;
+}
+
+int test_quantize_tensor(void) {
+    TestUnitQuantize units[] = {
+        {TYPE_FLOAT32, TYPE_BLOCK_Q8, 2, {96, 4096}, true},
+        {TYPE_FLOAT32, TYPE_BLOCK_Q4, 3, {3, 5, 96}, true},
+        {TYPE_FLOAT32, TYPE_BLOCK_Q4_MIN, 2, {17, 64}, true},
+        {TYPE_FLOAT32, TYPE_FLOAT16, 2, {33, 1003}, true},
+        {TYPE_FLOAT32, TYPE_QUANT8, 2, {7, 10}, true},
+        {TYPE_FLOAT32, TYPE_QUANT4, 2, {7, 10}, true},
+        {TYPE_FLOAT16, TYPE_BLOCK_Q4, 2, {40, 2048}, true},
+        {TYPE_BLOCK_Q8, TYPE_FLOAT32, 2, {9, 256}, true},
+        {TYPE_BLOCK_Q8, TYPE_BLOCK_Q4, 1, {320}, true},
+        {TYPE_BFLOAT16, TYPE_FP8_E4M3, 2, {50, 1500}, true},
+        {TYPE_FLOAT32, TYPE_FP8_E5M2, 2, {3, 77}, true},
+        {TYPE_FLOAT32, TYPE_BLOCK_Q8, 2, {4, 100}, false},
+        {TYPE_FLOAT32, TYPE_QUANT4, 1, {9}, false},
+        {TYPE_FLOAT32, TYPE_UINT8, 1, {16}, false},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Quantize Tensor", .total_tests = total_tests, .test_cases = test_cases};
+
+    // Force several partitions so the split paths run even on a single core
+    thread_set_count(4);
+    int result = run_unit_tests(&context, test_quantize_logic, NULL);
+    thread_set_count(0);
+    thread_pool_shutdown();
+    return result;
+}
+
+// ---------------------- Calibrated Quantization ----------------------
+
+#define TEST_CALIBRATED_ROWS 48 /**< Output channels */
+#define TEST_CALIBRATED_COLS 256 /**< Input channels */
+#define TEST_CALIBRATED_TOKENS 96 /**< Activation vectors observed */
+
+// Returns the weighted weight error and the mean squared error of W x over the tokens
+void test_calibrated_error(
+    const float* weights,
+    const Tensor* quantized,
+    const float* activations,
+    const float* importance,
+    double* weighted,
+    double* output
+) {
+    const uint32_t length = TEST_CALIBRATED_ROWS * TEST_CALIBRATED_COLS;
+    float* decoded = malloc(sizeof(float) * length);
+    test_quantize_decode(quantized->type->id, quantized->data, decoded, length);
+
+    *weighted = 0.0;
+    *output = 0.0;
+    for (uint32_t i = 0; i < TEST_CALIBRATED_ROWS; i++) {
+        const float* w = weights + i * TEST_CALIBRATED_COLS;
+        const float* q = decoded + i * TEST_CALIBRATED_COLS;
+        for (uint32_t j = 0; j < TEST_CALIBRATED_COLS; j++) {
+            const double error = (double) w[j] - (double) q[j];
+            *weighted += (double) importance[j] * error * error;
+        }
+        for (uint32_t t = 0; t < TEST_CALIBRATED_TOKENS; t++) {
+            const float* x = activations + t * TEST_CALIBRATED_COLS;
+            double delta = 0.0;
+            for (uint32_t j = 0; j < TEST_CALIBRATED_COLS; j++) {
+                delta += ((double) w[j] - (double) q[j]) * (double) x[j];
+            }
+            *output += delta * delta / (TEST_CALIBRATED_ROWS * TEST_CALIBRATED_TOKENS);
+        }
+    }
+    free(decoded);
+}
+
+int test_quantize_calibrated(void) {
+    Tensor* weights
+        = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){TEST_CALIBRATED_ROWS, TEST_CALIBRATED_COLS});
+    Tensor* activations = tensor_create(
+        TYPE_FLOAT32, 2, (uint32_t[]){TEST_CALIBRATED_TOKENS, TEST_CALIBRATED_COLS}
+    );
+    Tensor* narrow = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){4, 64});
+    QuantizeCalibration* calibration = quantize_calibration_create(TEST_CALIBRATED_COLS);
+    float importance[TEST_CALIBRATED_COLS];
+    ASSERT(weights && activations && narrow && calibration, "failed to allocate the layer");
+
+    // A few input channels carry most of the activation energy
+    float* x = (float*) activations->data;
+    test_quantize_fill((float*) weights->data, weights->size, 7, 0.05f);
+    test_quantize_fill(x, activations->size, 11, 1.0f);
+    for (uint64_t i = 0; i < activations->size; i++) {
+        x[i] *= 0 == i % TEST_CALIBRATED_COLS % 13 ? 20.0f : 1.0f;
+    }
+
+    // Observe the tokens in two batches
+    const uint32_t half = TEST_CALIBRATED_TOKENS / 2;
+    Tensor* first = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){half, TEST_CALIBRATED_COLS});
+    Tensor* second = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){half, TEST_CALIBRATED_COLS});
+    ASSERT(first && second, "failed to allocate the batches");
+    memcpy(first->data, x, tensor_byte_size(first));
+    memcpy(second->data, x + half * TEST_CALIBRATED_COLS, tensor_byte_size(second));
+    ASSERT(TENSOR_SUCCESS == quantize_calibration_observe(calibration, first), "observe failed");
+    ASSERT(TENSOR_SUCCESS == quantize_calibration_observe(calibration, second), "observe failed");
+    ASSERT(
+        TENSOR_ERROR == quantize_calibration_observe(calibration, narrow),
+        "accepted activations of the wrong width"
+    );
+    ASSERT(
+        TEST_CALIBRATED_TOKENS == calibration->samples,
+        "counted %" PRIu64 " samples",
+        calibration->samples
+    );
+    tensor_free(first);
+    tensor_free(second);
+
+    ASSERT(
+        TENSOR_SUCCESS == quantize_calibration_importance(calibration, importance),
+        "failed to compute importance"
+    );
+    ASSERT(importance[13] > 100.0f * importance[1], "outlier channel is not weighted up");
+
+    const DataTypeId targets[] = {TYPE_BLOCK_Q8, TYPE_BLOCK_Q4, TYPE_BLOCK_Q4_MIN};
+    int result = 0;
+    thread_set_count(4);
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        Tensor* plain = quantize_tensor(weights, targets[i], NULL);
+        Tensor* calibrated = quantize_tensor_calibrated(weights, targets[i], calibration, NULL);
+        if (!plain || !calibrated) {
+            LOG_ERROR("%s: Failed to quantize to %s.\n", __func__, data_type_name(targets[i]));
+            result = 1;
+        } else {
+            double plain_weighted, plain_output, weighted, output;
+            test_calibrated_error(
+                weights->data, plain, x, importance, &plain_weighted, &plain_output
+            );
+            test_calibrated_error(weights->data, calibrated, x, importance, &weighted, &output);
+
+            // The weighted search can only improve on the plain encoding it starts from
+            if (weighted > plain_weighted || output >= plain_output) {
+                LOG_ERROR(
+                    "%s: %s: weighted error %.4e (plain %.4e), output error %.4e (plain %.4e).\n",
+                    __func__,
+                    data_type_name(targets[i]),
+                    weighted,
+                    plain_weighted,
+                    output,
+                    plain_output
+                );
+                result = 1;
+            }
+        }
+        tensor_free(plain);
+        tensor_free(calibrated);
+    }
+    thread_set_count(0);
+    thread_pool_shutdown();
+
+    // Only block types are calibrated, and rows must match the observed channels
+    Tensor* rejected = quantize_tensor_calibrated(weights, TYPE_QUANT8, calibration, NULL);
+    Tensor* mismatched = quantize_tensor_calibrated(narrow, TYPE_BLOCK_Q8, calibration, NULL);
+    result = result || rejected || mismatched;
+    tensor_free(rejected);
+    tensor_free(mismatched);
+    tensor_free(narrow);
+
+    quantize_calibration_free(calibration);
+    tensor_free(activations);
+    tensor_free(weights);
+    return result;
+}
+
+// ---------------------- Packed 4-bit Storage ----------------------
+
+typedef struct TestUnitPacked {
+    DataTypeId source; // Type of the input tensor
+    uint32_t rank; // Rank of the input tensor
+    uint32_t shape[3]; // Logical shape; the last dimension counts values
+    uint32_t group; // Values per scale
+    bool valid; // Whether packing should succeed
+} TestUnitPacked;
+
+int test_quantize_packed_logic(TestCase* test) {
+    TestUnitPacked* unit = (TestUnitPacked*) test->unit;
+
+    uint64_t length = 1;
+    for (uint32_t i = 0; i < unit->rank; i++) {
+        length *= unit->shape[i];
+    }
+    const uint32_t values = unit->shape[unit->rank - 1];
+    const uint64_t rows = length / values;
+    const uint32_t groups = unit->group ? (values + unit->group - 1) / unit->group : 0;
+
+    uint32_t dimensions[3];
+    memcpy(dimensions, unit->shape, sizeof(dimensions));
+    dimensions[unit->rank - 1] /= data_type_values(unit->source);
+
+    float* data = malloc(sizeof(float) * length);
+    float* decoded = malloc(sizeof(float) * length);
+    float* expected = malloc(sizeof(float) * length);
+    uint8_t* nibbles = malloc(length / 2 + 1);
+    uint16_t* scales = malloc(sizeof(uint16_t) * (rows * groups + 1));
+    Tensor* input = tensor_create(unit->source, unit->rank, dimensions);
+    QuantizeQ4Packed* packed = NULL;
+    Tensor* output = NULL;
+
+    int result = 0;
+    if (!data || !decoded || !expected || !nibbles || !scales || !input) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    test_quantize_fill(data, length, 7 + (uint32_t) test->index, 2.0f);
+    test_quantize_encode(unit->source, data, input->data, (uint32_t) length);
+
+    packed = quantize_tensor_q4_packed(input, unit->group, NULL);
+    if (!unit->valid) {
+        if (packed) {
+            LOG_ERROR("%s: Test case %zu should have been rejected.\n", __func__, test->index);
+            result = 1;
+        }
+        goto cleanup;
+    }
+
+    QuantizeReport report = {0};
+    output = packed ? dequantize_tensor_q4_packed(packed, &report) : NULL;
+    if (!output || tensor_byte_size(output) != length * sizeof(float)) {
+        LOG_ERROR("%s: Test case %zu failed to convert.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    // Same codes and values as the row functions, with codes and scales in two dense arrays
+    test_quantize_decode(unit->source, input->data, decoded, (uint32_t) length);
+    for (uint64_t r = 0; r < rows; r++) {
+        uint8_t* codes = nibbles + r * values / 2;
+        uint16_t* row_scales = scales + r * groups;
+        quantize_row_q4_packed(decoded + r * values, codes, row_scales, values, unit->group);
+        dequantize_row_q4_packed(codes, row_scales, expected + r * values, values, unit->group);
+    }
+
+    if (length / 2 != quantize_q4_packed_nibble_bytes(packed)
+        || rows * groups * sizeof(uint16_t) != quantize_q4_packed_scale_bytes(packed)
+        || 0 != memcmp(nibbles, packed->nibbles, length / 2)
+        || 0 != memcmp(scales, packed->scales, rows * groups * sizeof(uint16_t))
+        || 0 != memcmp(expected, output->data, length * sizeof(float))) {
+        LOG_ERROR("%s: Test case %zu differs from the row functions.\n", __func__, test->index);
+        result = 1;
+    }
+
+    if (report.values != length || 0 == report.threads) {
+        LOG_ERROR("%s: Test case %zu: bad report.\n", __func__, test->index);
+        result = 1;
+    }
+
+cleanup:
+    tensor_free(output);
+    quantize_q4_packed_free(packed);
+    tensor_free(input);
+    free(scales);
+    free(nibbles);
+    free(expected);
+    free(decoded);
+    free(data);
+    return result;
+}
+
+int test_quantize_packed(void) {
+    TestUnitPacked units[] = {
+        {TYPE_FLOAT32, 2, {96, 4096}, Q4_PACKED_GROUP, true},
+        {TYPE_FLOAT32, 3, {3, 5, 100}, Q4_PACKED_GROUP, true},
+        {TYPE_FLOAT16, 2, {40, 2048}, 64, true},
+        {TYPE_BLOCK_Q8, 1, {320}, 2, true},
+        {TYPE_FLOAT32, 2, {4, 9}, Q4_PACKED_GROUP, false},
+        {TYPE_FLOAT32, 2, {4, 64}, 31, false},
+        {TYPE_FLOAT32, 2, {4, 64}, 0, false},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Packed qint4", .total_tests = total_tests, .test_cases = test_cases};
+
+    thread_set_count(4);
+    int result = run_unit_tests(&context, test_quantize_packed_logic, NULL);
+    thread_set_count(0);
+    thread_pool_shutdown();
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_quantize_tensor", test_quantize_tensor},
+        {"test_quantize_calibrated", test_quantize_calibrated},
+        {"test_quantize_packed", test_quantize_packed},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,175 @@
+/**
+ * @file tests/test_reduce.c
+ * @brief Tests for the axis reduction kernels.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <math.h>
+#include <stdio.h>
+
+// ALT libraries
+#include "interface/logger.h"
+#include "interface/random.h"
+#include "interface/unit_test.h"
+#include "kernels/reduce.h"
+#include "threads.h"
+
+#define TEST_REDUCE_TOLERANCE 1e-4
+
+// ---------------------- Helpers ----------------------
+
+// Fills a float buffer with deterministic values in [-1, 1]
+void test_reduce_fill(float* data, size_t length, uint32_t seed) {
+    random_seed(seed);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = random_uniform(-1.0f, 1.0f);
+    }
+}
+
+// Reduces line i of a row-major [rows, cols] matrix along the given axis in double precision
+double test_reduce_reference(
+    const float* data, uint32_t rows, uint32_t cols, uint32_t axis, uint32_t i, ReduceOp op
+) {
+    const uint32_t length = 0 == axis ? rows : cols;
+    double sum = 0.0, best = -INFINITY;
+    uint32_t best_index = 0;
+    for (uint32_t k = 0; k < length; k++) {
+        double value = 0 == axis ? data[(size_t) k * cols + i] : data[(size_t) i * cols + k];
+        sum += REDUCE_L2 == op ? value * value : value;
+        if (value > best) {
+            best = value;
+            best_index = k;
+        }
+    }
+
+    switch (op) {
+        case REDUCE_MEAN:
+            return sum / length;
+        case REDUCE_MAX:
+            return best;
+        case REDUCE_ARGMAX:
+            return best_index;
+        case REDUCE_L2:
+            return sqrt(sum);
+        default:
+            return sum;
+    }
+}
+
+// ---------------------- Axis Reductions ----------------------
+
+typedef struct TestUnitReduce {
+    uint32_t rows; // Rows of the logical input
+    uint32_t cols; // Columns of the logical input
+    uint32_t axis; // Axis to reduce
+    ReduceOp op; // Reduction under test
+    bool transpose; // Pass the input as a transposed view
+} TestUnitReduce;
+
+int test_reduce_logic(TestCase* test) {
+    TestUnitReduce* unit = (TestUnitReduce*) test->unit;
+    const uint32_t m = unit->rows, n = unit->cols;
+    const uint32_t lines = 0 == unit->axis ? n : m;
+
+    Tensor* store = unit->transpose ? tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){n, m})
+                                    : tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    Tensor* x = unit->transpose ? tensor_view_transpose(store, 0, 1) : store;
+    Tensor* expected = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){m, n});
+    DataTypeId out_type = REDUCE_ARGMAX == unit->op ? TYPE_UINT32 : TYPE_FLOAT32;
+    Tensor* out = tensor_create(out_type, 1, (uint32_t[]){lines});
+
+    int result = 0;
+    if (!x || !expected || !out) {
+        LOG_ERROR("%s: Failed to allocate test case %zu.\n", __func__, test->index);
+        result = 1;
+        goto cleanup;
+    }
+
+    // Write the logical values through the (possibly strided) view
+    float* values = (float*) expected->data;
+    test_reduce_fill(values, (size_t) m * n, 1337 + (uint32_t) test->index);
+    tensor_set_bulk(x, values);
+
+    TensorState state = tensor_reduce(x, unit->axis, unit->op, out);
+    double error = 0.0;
+    for (uint32_t i = 0; i < lines; i++) {
+        double reference = test_reduce_reference(values, m, n, unit->axis, i, unit->op);
+        double actual = REDUCE_ARGMAX == unit->op ? ((uint32_t*) out->data)[i]
+                                                  : ((float*) out->data)[i];
+        error = fmax(error, fabs(actual - reference) / fmax(1.0, fabs(reference)));
+    }
+
+    if (TENSOR_SUCCESS != state || error > TEST_REDUCE_TOLERANCE) {
+        LOG_ERROR(
+            "%s: Test case %zu failed (m=%u, n=%u, axis=%u, op=%d, state=%d, error=%g).\n",
+            __func__,
+            test->index,
+            m,
+            n,
+            unit->axis,
+            unit->op,
+            state,
+            error
+        );
+        result = 1;
+    }
+
+cleanup:
+    if (x != store) {
+        tensor_free(x);
+    }
+    tensor_free(store);
+    tensor_free(expected);
+    tensor_free(out);
+    return result;
+}
+
+int test_tensor_reduce(void) {
+    TestUnitReduce units[] = {
+        {.rows = 7, .cols = 300, .axis = 1, .op = REDUCE_SUM},
+        {.rows = 7, .cols = 300, .axis = 1, .op = REDUCE_MEAN},
+        {.rows = 7, .cols = 300, .axis = 1, .op = REDUCE_ARGMAX},
+        {.rows = 300, .cols = 37, .axis = 0, .op = REDUCE_SUM},
+        {.rows = 300, .cols = 37, .axis = 0, .op = REDUCE_MAX},
+        {.rows = 300, .cols = 37, .axis = 0, .op = REDUCE_L2},
+        {.rows = 300, .cols = 37, .axis = 0, .op = REDUCE_ARGMAX},
+        {.rows = 9, .cols = 2500, .axis = 1, .op = REDUCE_L2, .transpose = true},
+        {.rows = 9, .cols = 2500, .axis = 1, .op = REDUCE_ARGMAX, .transpose = true},
+        {.rows = 1, .cols = 100003, .axis = 1, .op = REDUCE_SUM},
+        {.rows = 1, .cols = 100003, .axis = 1, .op = REDUCE_ARGMAX},
+        {.rows = 1, .cols = 100003, .axis = 1, .op = REDUCE_MAX},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Tensor Reduce", .total_tests = total_tests, .test_cases = test_cases};
+
+    // Force several partitions so the split paths run even on a single core
+    thread_set_count(4);
+    int result = run_unit_tests(&context, test_reduce_logic, NULL);
+    thread_set_count(0);
+    thread_pool_shutdown();
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_tensor_reduce", test_tensor_reduce},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}
@@ -0,0 +1,319 @@
+/**
+ * @file tests/test_tensors.c
+ * @brief Tests for the tensors library.
+ * @note All functions must return 0 on success, and non-zero on failure.
+ */
+
+// Standard C libraries
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+// ALT libraries
+#include "interface/logger.h"
+#include "interface/unit_test.h"
+#include "tensors.h"
+
+// ---------------------- Helpers ----------------------
+
+// Creates a 2x3 float tensor holding 0, 1, ..., 5 in row-major order
+Tensor* test_tensor_create_2x3(void) {
+    Tensor* tensor = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){2, 3});
+    if (!tensor) {
+        return NULL;
+    }
+
+    float data[6] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    if (tensor_set_bulk(tensor, data) != TENSOR_SUCCESS) {
+        tensor_free(tensor);
+        return NULL;
+    }
+
+    return tensor;
+}
+
+// Reads a single float from a rank 2 tensor
+float test_tensor_get_2d(Tensor* tensor, uint32_t row, uint32_t col) {
+    float value = -1.0f;
+    FlexArray* indices = tensor_create_indices(2, (uint32_t[]){row, col});
+    if (indices) {
+        tensor_get_element(tensor, indices, &value);
+        flex_array_free(indices);
+    }
+    return value;
+}
+
+// ---------------------- Tensor Views ----------------------
+
+typedef struct TestUnitTensorView {
+    const char* label; // Operation under test
+    uint32_t row; // Row index into the view
+    uint32_t col; // Column index into the view
+    float expected; // Expected value at (row, col)
+    Tensor* view; // View under test (shared between cases)
+} TestUnitTensorView;
+
+int test_tensor_view_logic(TestCase* test) {
+    TestUnitTensorView* unit = (TestUnitTensorView*) test->unit;
+
+    ASSERT(unit->view != NULL, "Failed to create %s view in test case %zu", unit->label, test->index);
+
+    float actual = test_tensor_get_2d(unit->view, unit->row, unit->col);
+    ASSERT(
+        actual == unit->expected,
+        "Invalid %s element in test case %zu (index: (%u, %u), expected: %.1f, got: %.1f)",
+        unit->label,
+        test->index,
+        unit->row,
+        unit->col,
+        (double) unit->expected,
+        (double) actual
+    );
+
+    return 0;
+}
+
+int test_tensor_views(void) {
+    Tensor* tensor = test_tensor_create_2x3();
+    if (!tensor) {
+        LOG_ERROR("%s: Failed to create tensor.\n", __func__);
+        return 1;
+    }
+
+    Tensor* transposed = tensor_view_transpose(tensor, 0, 1); // 3x2
+    Tensor* sliced = tensor_view_slice(tensor, 1, 1, 2); // 2x2, columns 1..2
+    Tensor* reshaped = tensor_view_reshape(tensor, 2, (uint32_t[]){3, 2}); // 3x2
+    Tensor* nested = transposed ? tensor_view_slice(transposed, 0, 2, 1) : NULL; // 1x2
+
+    TestUnitTensorView units[] = {
+        {.label = "transpose", .row = 0, .col = 1, .expected = 3.0f, .view = transposed},
+        {.label = "transpose", .row = 2, .col = 0, .expected = 2.0f, .view = transposed},
+        {.label = "slice", .row = 0, .col = 0, .expected = 1.0f, .view = sliced},
+        {.label = "slice", .row = 1, .col = 1, .expected = 5.0f, .view = sliced},
+        {.label = "reshape", .row = 1, .col = 0, .expected = 2.0f, .view = reshaped},
+        {.label = "reshape", .row = 2, .col = 1, .expected = 5.0f, .view = reshaped},
+        {.label = "nested", .row = 0, .col = 1, .expected = 5.0f, .view = nested},
+    };
+
+    size_t total_tests = sizeof(units) / sizeof(units[0]);
+    TestCase test_cases[total_tests];
+
+    for (size_t i = 0; i < total_tests; i++) {
+        test_cases[i].unit = &units[i];
+    }
+
+    TestContext context
+        = {.test_name = "Tensor Views", .total_tests = total_tests, .test_cases = test_cases};
+
+    int result = run_unit_tests(&context, test_tensor_view_logic, NULL);
+
+    // Views must not be contiguous unless they preserve the row-major layout
+    if (tensor_is_contiguous(transposed) || tensor_is_contiguous(sliced)
+        || !tensor_is_contiguous(reshaped)) {
+        LOG_ERROR("%s: Invalid contiguity reported for views.\n", __func__);
+        result = 1;
+    }
+
+    // Strided views cannot be reshaped without a copy
+    Tensor* invalid = tensor_view_reshape(transposed, 1, (uint32_t[]){6});
+    if (invalid) {
+        LOG_ERROR("%s: Reshaped a non-contiguous view.\n", __func__);
+        tensor_free(invalid);
+        result = 1;
+    }
+
+    // Writing through a view must update the shared storage
+    float bulk[6] = {10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f}; // 3x2 row-major
+    if (tensor_set_bulk(transposed, bulk) != TENSOR_SUCCESS
+        || test_tensor_get_2d(tensor, 0, 1) != 12.0f || test_tensor_get_2d(tensor, 1, 0) != 11.0f) {
+        LOG_ERROR("%s: Failed to write through a transposed view.\n", __func__);
+        result = 1;
+    }
+
+    tensor_free(nested);
+    tensor_free(reshaped);
+    tensor_free(sliced);
+    tensor_free(transposed);
+    tensor_free(tensor);
+    return result;
+}
+
+// ---------------------- 64-bit Indexing ----------------------
+
+int test_tensor_compute_index_64(void) {
+    // Shape only: the element storage is never touched by index computation
+    uint32_t dimensions[2] = {100000, 100000}; // 1e10 elements overflows 32 bits
+    Tensor tensor = {
+        .rank = 2,
+        .shape = tensor_create_shape(2, dimensions),
+        .stride = tensor_create_stride(2, dimensions),
+        .type = data_type_get(TYPE_FLOAT32),
+    };
+    FlexArray* indices = tensor_create_indices(2, (uint32_t[]){99999, 99999});
+
+    int result = 0;
+    uint64_t size = 0;
+    uint64_t index = 0;
+    if (!tensor.shape || !tensor.stride || !indices) {
+        LOG_ERROR("%s: Failed to create shape, stride, or indices.\n", __func__);
+        result = 1;
+    } else if (tensor_compute_shape(&tensor, &size) != TENSOR_SUCCESS || size != 10000000000ULL) {
+        LOG_ERROR("%s: Invalid 64-bit size: %" PRIu64 ".\n", __func__, size);
+        result = 1;
+    } else if (tensor_compute_index(&tensor, indices, &index) != TENSOR_SUCCESS
+               || index != 9999999999ULL) {
+        LOG_ERROR("%s: Invalid 64-bit index: %" PRIu64 ".\n", __func__, index);
+        result = 1;
+    }
+
+    flex_array_free(indices);
+    flex_array_free(tensor.stride);
+    flex_array_free(tensor.shape);
+    return result;
+}
+
+// ---------------------- Fast Access ----------------------
+
+int test_tensor_fast_access(void) {
+    Tensor* tensor = tensor_create(TYPE_FLOAT32, 3, (uint32_t[]){2, 3, 4});
+    if (!tensor) {
+        LOG_ERROR("%s: Failed to create tensor.\n", __func__);
+        return 1;
+    }
+
+    const uint64_t* stride = tensor_stride_data(tensor);
+    float* data = (float*) tensor->data;
+    for (uint32_t i = 0; i < 2; i++) {
+        for (uint32_t j = 0; j < 3; j++) {
+            for (uint32_t k = 0; k < 4; k++) {
+                tensor_set_f32_3d(data, stride, i, j, k, (float) (i * 100 + j * 10 + k));
+            }
+        }
+    }
+
+    int result = 0;
+
+    // The checked path must agree with the unchecked path
+    float value = 0.0f;
+    FlexArray* indices = tensor_create_indices(3, (uint32_t[]){1, 2, 3});
+    if (!indices || tensor_get_element(tensor, indices, &value) != TENSOR_SUCCESS
+        || value != 123.0f || tensor_get_f32_3d(data, stride, 1, 2, 3) != 123.0f) {
+        LOG_ERROR("%s: Mismatch between checked and unchecked access.\n", __func__);
+        result = 1;
+    }
+    flex_array_free(indices);
+
+    // Walk a transposed view with a cursor: the logical order follows the view
+    Tensor* view = tensor_view_transpose(tensor, 0, 2); // 4x3x2
+    TensorCursor cursor;
+    if (!view || tensor_cursor_init(&cursor, view) != TENSOR_SUCCESS) {
+        LOG_ERROR("%s: Failed to create cursor over transposed view.\n", __func__);
+        result = 1;
+    } else {
+        uint64_t visited = 0;
+        for (; tensor_cursor_valid(&cursor); tensor_cursor_next(&cursor), visited++) {
+            uint32_t k = visited / 6, j = (visited / 2) % 3, i = visited % 2;
+            float expected = (float) (i * 100 + j * 10 + k);
+            float actual = *(float*) tensor_cursor_get(&cursor);
+            if (actual != expected) {
+                LOG_ERROR(
+                    "%s: Cursor mismatch at %" PRIu64 ": expected %.1f, got %.1f.\n",
+                    __func__,
+                    visited,
+                    (double) expected,
+                    (double) actual
+                );
+                result = 1;
+                break;
+            }
+        }
+        if (visited != 24 && result == 0) {
+            LOG_ERROR("%s: Cursor visited %" PRIu64 " of 24 elements.\n", __func__, visited);
+            result = 1;
+        }
+    }
+
+    tensor_free(view);
+    tensor_free(tensor);
+    return result;
+}
+
+// ---------------------- Tiled Layouts ----------------------
+
+int test_tensor_repack(void) {
+    const uint32_t rows = 5, cols = 7;
+    Tensor* tensor = tensor_create(TYPE_FLOAT32, 2, (uint32_t[]){rows, cols});
+    if (!tensor) {
+        LOG_ERROR("%s: Failed to create tensor.\n", __func__);
+        return 1;
+    }
+    for (uint32_t i = 0; i < rows * cols; i++) {
+        ((float*) tensor->data)[i] = (float) (i / cols * 10 + i % cols);
+    }
+
+    int result = 0;
+    Tensor* tiled = tensor_repack(tensor, 2, 3);
+    Tensor* dense = tensor_unpack(tiled);
+    if (!tiled || !dense) {
+        LOG_ERROR("%s: Failed to repack tensor.\n", __func__);
+        result = 1;
+        goto cleanup;
+    }
+
+    // Edge tiles are padded to 6 x 9 elements
+    if (TENSOR_LAYOUT_TILED != tiled->layout || tensor_is_contiguous(tiled)
+        || tensor_byte_size(tiled) != 6 * 9 * sizeof(float)) {
+        LOG_ERROR("%s: Unexpected tiled layout metadata.\n", __func__);
+        result = 1;
+    }
+
+    // Element (2, 4) lives in tile (1, 1), the fifth of the 2 x 3 tile grid
+    const float* data = (const float*) tiled->data;
+    if (data[(4 * 2 + 0) * 3 + 1] != 24.0f || test_tensor_get_2d(tiled, 2, 4) != 24.0f) {
+        LOG_ERROR("%s: Tiled element (2, 4) is misplaced.\n", __func__);
+        result = 1;
+    }
+
+    for (uint32_t i = 0; i < rows; i++) {
+        for (uint32_t j = 0; j < cols; j++) {
+            float expected = (float) (i * 10 + j);
+            if (test_tensor_get_2d(tiled, i, j) != expected
+                || ((float*) dense->data)[i * cols + j] != expected) {
+                LOG_ERROR("%s: Round trip mismatch at (%u, %u).\n", __func__, i, j);
+                result = 1;
+            }
+        }
+    }
+
+    // Views and cursors require the row-major layout
+    Tensor* view = tensor_view_transpose(tiled, 0, 1);
+    if (view) {
+        LOG_ERROR("%s: Created a view of a tiled tensor.\n", __func__);
+        tensor_free(view);
+        result = 1;
+    }
+
+cleanup:
+    tensor_free(dense);
+    tensor_free(tiled);
+    tensor_free(tensor);
+    return result;
+}
+
+int main(void) {
+    TestRegister test_registry[] = {
+        {"test_tensor_views", test_tensor_views},
+        {"test_tensor_compute_index_64", test_tensor_compute_index_64},
+        {"test_tensor_fast_access", test_tensor_fast_access},
+        {"test_tensor_repack", test_tensor_repack},
+    };
+
+    int result = 0;
+    size_t total_tests = sizeof(test_registry) / sizeof(test_registry[0]);
+
+    for (size_t i = 0; i < total_tests; i++) {
+        result += run_test_suite(test_registry[i].name, test_registry[i].test_suite);
+    }
+
+    return result > 0 ? 1 : 0; // Return 1 if any test failed, 0 otherwise
+}